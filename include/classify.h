@@ -0,0 +1,61 @@
+/*
+ * classify.h
+ *
+ * Batch triangle classification
+ * Sorts a triangle array into back-facing, outside-frustum and
+ * needs-clipping sets in one pass, written as packed bitmasks
+ */
+
+#ifndef CLASSIFY_H
+#define CLASSIFY_H
+
+#include "fixed.h"
+#include "matrix.h"
+#include "triangle.h"
+#include "vector.h"
+
+/* Clip space outcode bits, frustum is -w <= x, y, z <= w */
+#define CLASSIFY_OUT_LEFT   0x01 /* x < -w */
+#define CLASSIFY_OUT_RIGHT  0x02 /* x > w */
+#define CLASSIFY_OUT_BOTTOM 0x04 /* y < -w */
+#define CLASSIFY_OUT_TOP    0x08 /* y > w */
+#define CLASSIFY_OUT_NEAR   0x10 /* z < -w */
+#define CLASSIFY_OUT_FAR    0x20 /* z > w */
+
+/* Number of 32-bit mask words needed for n triangles */
+#define CLASSIFY_WORDS(n) (((n) + 31) >> 5)
+
+/* Per batch or per frame triangle counts */
+typedef struct {
+    int tested;   // Triangles classified
+    int back;     // Rejected as back-facing
+    int outside;  // Rejected as outside the frustum
+    int clip;     // Visible but needing polygon clipping
+    int scissor;  // Visible and crossing only screen edges inside the guard band
+    int visible;  // Passed on to be drawn, includes clip and scissor
+} classify_stats_t;
+
+/* Classification result for one triangle array */
+typedef struct {
+    unsigned long *back;     // Bit set if the triangle faces away
+    unsigned long *outside;  // Bit set if the triangle is outside the frustum
+    unsigned long *clip;     // Bit set if the triangle needs polygon clipping
+    unsigned long *visible;  // Bit set if the triangle should be drawn
+    int count;               // Number of triangles covered by the masks
+    classify_stats_t stats;  // Counts for the last classify_triangles call
+} classify_masks_t;
+
+/* Function prototypes */
+void classify_masks_init(classify_masks_t *masks, unsigned long *storage, int count);
+int classify_outcode(const vector4_t *v);
+int classify_triangles(const triangle_t *tris,
+                       int count,
+                       const matrix_t *model_view,
+                       const matrix_t *projection,
+                       classify_masks_t *masks,
+                       vector4_t *clip_coords);
+int classify_next(const unsigned long *mask, int count, int index);
+void classify_stats_reset(classify_stats_t *stats);
+void classify_stats_add(classify_stats_t *total, const classify_stats_t *batch);
+
+#endif /* CLASSIFY_H */
@@ -0,0 +1,47 @@
+/*
+ * clip.h
+ *
+ * Homogeneous clip space polygon clipping
+ * Sutherland-Hodgman clipping of triangles against the planes of the
+ * -w <= x, y, z <= w frustum, carrying color and texture coordinates
+ * so no vertex reaches the perspective divide with w near zero
+ */
+
+#ifndef CLIP_H
+#define CLIP_H
+
+#include "classify.h"
+#include "fixed.h"
+#include "triangle.h"
+#include "vector.h"
+#include "vertex.h"
+
+/* Each plane can add one vertex to a convex polygon */
+#define CLIP_MAX_VERTICES 9
+
+/* Plane sets, using the CLASSIFY_OUT_* bits */
+#define CLIP_PLANES_NEAR CLASSIFY_OUT_NEAR /* Only what the divide needs */
+#define CLIP_PLANES_ALL  0x3F              /* Every frustum plane */
+
+/* Clip space vertex with the attributes carried through clipping */
+typedef struct {
+    vector4_t position;   // Homogeneous clip space position
+    color_t color;        // Vertex color
+    texcoord_t texcoord;  // Texture coordinates
+} clip_vertex_t;
+
+/* Function prototypes */
+clip_vertex_t clip_vertex_init(const vertex_t *v, const vector4_t *position);
+int clip_polygon(const clip_vertex_t *in, int count, clip_vertex_t *out, int planes);
+int clip_triangle(const triangle_t *t,
+                  const vector4_t *clip_coords,
+                  int planes,
+                  clip_vertex_t *out);
+int clip_classified(const triangle_t *tris,
+                    const vector4_t *clip_coords,
+                    const classify_masks_t *masks,
+                    int index,
+                    int planes,
+                    clip_vertex_t *out);
+
+#endif /* CLIP_H */
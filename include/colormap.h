@@ -0,0 +1,33 @@
+/*
+ * colormap.h
+ *
+ * Light tables for shaded texturing in palette modes
+ * A colormap holds one row of 256 palette indices per light level, each
+ * entry the palette color nearest to the original faded toward the fog
+ * color. It is built once when the palette is loaded. Renderers pick a
+ * row from the light level and distance, then shading a texel is one
+ * more table lookup.
+ */
+
+#ifndef COLORMAP_H
+#define COLORMAP_H
+
+#include "fixed.h"
+#include "shade.h"
+#include "vertex.h"
+
+/* Light levels, the same steps as the shade ramps, the last row leaves colors unchanged */
+#define COLORMAP_LEVELS SHADE_LEVELS
+
+/* Light table for one palette, 8 KB of rows */
+typedef struct colormap {
+    unsigned char map[COLORMAP_LEVELS][256];  // Palette index for each light level and color
+    fixed_t fog_distance;                     // Distance fog starts at, 0 for no fog
+} colormap_t;
+
+/* Function prototypes */
+void colormap_build(colormap_t *cm, const color_t *palette, const color_t *fog);
+int colormap_level(const colormap_t *cm, fixed_t light, fixed_t inv_z);
+const unsigned char *colormap_row(const colormap_t *cm, fixed_t light, fixed_t inv_z);
+
+#endif /* COLORMAP_H */
@@ -0,0 +1,74 @@
+/*
+ * frustum.h
+ *
+ * View frustum culling of bounding volumes
+ * Extracts the six clip planes from a view-projection matrix and tests
+ * spheres and axis-aligned boxes against them, carrying a plane mask
+ * down a bounding volume hierarchy so children of a node that is fully
+ * inside a plane never test that plane again
+ */
+
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include "fixed.h"
+#include "matrix.h"
+#include "plane.h"
+#include "vector.h"
+
+/* Frustum plane indices */
+#define FRUSTUM_LEFT   0
+#define FRUSTUM_RIGHT  1
+#define FRUSTUM_BOTTOM 2
+#define FRUSTUM_TOP    3
+#define FRUSTUM_NEAR   4
+#define FRUSTUM_FAR    5
+#define FRUSTUM_PLANES 6
+
+/* Plane mask with every plane still to be tested */
+#define FRUSTUM_MASK_ALL 0x3F
+
+/* Test results */
+#define FRUSTUM_OUTSIDE   0 /* Completely outside one plane */
+#define FRUSTUM_INTERSECT 1 /* Crosses at least one plane */
+#define FRUSTUM_INSIDE    2 /* Inside every plane */
+
+/* Axis-aligned bounding box */
+typedef struct {
+    vector3_t min;
+    vector3_t max;
+} aabb_t;
+
+/* Bounding volume hierarchy node, children are stored contiguously */
+typedef struct {
+    aabb_t bounds;    // Box enclosing the node and all its children
+    int first_child;  // Index of the first child node
+    int child_count;  // Number of children, 0 for a leaf such as a maze sector
+} frustum_node_t;
+
+/* Culling statistics */
+typedef struct {
+    int nodes_tested;  // Nodes tested against at least one plane
+    int nodes_inside;  // Nodes accepted without testing their children
+    int nodes_culled;  // Nodes rejected with all their children
+    int plane_tests;   // Individual plane tests made
+} frustum_stats_t;
+
+/* View frustum */
+typedef struct {
+    plane_t planes[FRUSTUM_PLANES];  // Planes with normals facing inwards
+    frustum_stats_t stats;           // Counts since the last frustum_extract
+} frustum_t;
+
+/* Function prototypes */
+void frustum_extract(frustum_t *f, const matrix_t *view_projection);
+int frustum_test_point(const frustum_t *f, vector3_t point);
+int frustum_test_sphere(frustum_t *f, vector3_t center, fixed_t radius, int *mask);
+int frustum_test_aabb(frustum_t *f, const aabb_t *box, int *mask);
+int frustum_cull_nodes(frustum_t *f,
+                       const frustum_node_t *nodes,
+                       int root,
+                       int *visible,
+                       int max_visible);
+
+#endif /* FRUSTUM_H */
@@ -0,0 +1,47 @@
+/*
+ * guard.h
+ *
+ * Guard-band screen clipping
+ * Triangles that cross the screen edges but stay inside a much larger
+ * guard region are drawn unclipped, the rasterizer scissors their spans
+ * to the screen. Only triangles crossing the near or far plane or
+ * leaving the guard region need full polygon clipping.
+ */
+
+#ifndef GUARD_H
+#define GUARD_H
+
+#include "classify.h"
+#include "vector.h"
+#include "video.h"
+
+/*
+ * Guard region half-width in units of w. 8 gives projected x from -1120
+ * to 1440 and y from -700 to 900 pixels, well inside the 16.16 range
+ * the rasterizer steps edges in
+ */
+#define GUARD_SCALE 8
+
+/* Triangle guard-band classes */
+#define GUARD_ACCEPT  0 /* Fully on screen, drawn as is */
+#define GUARD_SCISSOR 1 /* Inside the guard region, spans are scissored */
+#define GUARD_CLIP    2 /* Needs polygon clipping */
+#define GUARD_REJECT  3 /* Entirely outside one frustum plane */
+
+/* Guard-band counts */
+typedef struct {
+    int accepted;   // Triangles fully on screen
+    int scissored;  // Triangles left to span scissoring
+    int clipped;    // Triangles that still needed full clipping
+    int rejected;   // Triangles outside the frustum
+} guard_stats_t;
+
+/* Function prototypes */
+int guard_outcode(const vector4_t *v);
+int guard_classify(const vector4_t *clip_coords, guard_stats_t *stats);
+int guard_scissor_rows(int *y0, int *y1);
+int guard_scissor_span(int *x0, int *x1);
+void guard_stats_reset(guard_stats_t *stats);
+void guard_stats_print(const guard_stats_t *stats);  // Debug function
+
+#endif /* GUARD_H */
@@ -0,0 +1,45 @@
+/*
+ * lightmap.h
+ *
+ * Baked light for static maze walls
+ * A lightmap is a grid of light values over one wall, LIGHTMAP_SCALE
+ * luxels to a unit along it and up it. Lightmaps are baked once per
+ * map on the host, see lmbake.h, so the runtime only sizes them and
+ * samples them while the surface cache combines them with wall
+ * textures.
+ */
+
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include "fixed.h"
+
+/* Luxels per unit as a power of two, 2 gives a luxel every quarter unit */
+#define LIGHTMAP_SHIFT 2
+#define LIGHTMAP_SCALE (1 << LIGHTMAP_SHIFT)
+
+/* Light value of a fully lit luxel */
+#define LIGHTMAP_FULL 255
+
+/* Light over one wall, luxel (0, 0) is at the floor under (x0, z0) */
+typedef struct lightmap {
+    unsigned char *luxels;  // width * height values, row 0 at the floor, owned by the caller
+    int width;              // Luxels along the wall
+    int height;             // Luxels up the wall
+    fixed_t x0, z0;         // First end of the wall on the floor plan
+    fixed_t x1, z1;         // Second end of the wall on the floor plan
+    fixed_t ceiling;        // Height of the wall
+} lightmap_t;
+
+/* Function prototypes */
+long lightmap_size(fixed_t x0, fixed_t z0, fixed_t x1, fixed_t z1, fixed_t ceiling);
+void lightmap_init(lightmap_t *lm,
+                   unsigned char *storage,
+                   fixed_t x0,
+                   fixed_t z0,
+                   fixed_t x1,
+                   fixed_t z1,
+                   fixed_t ceiling);
+int lightmap_sample(const lightmap_t *lm, fixed_t s, fixed_t t);
+
+#endif /* LIGHTMAP_H */
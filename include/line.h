@@ -0,0 +1,29 @@
+/*
+ * line.h
+ *
+ * Clipped line drawing into an 8-bit back buffer
+ * Cohen-Sutherland clipping to the screen followed by run-slice
+ * Bresenham, which works out the length of each horizontal or vertical
+ * run up front instead of deciding pixel by pixel, with separate fast
+ * paths for purely horizontal and vertical lines
+ */
+
+#ifndef LINE_H
+#define LINE_H
+
+#include "video.h"
+
+/* Screen outcode bits */
+#define LINE_OUT_LEFT   0x01 /* x < 0 */
+#define LINE_OUT_RIGHT  0x02 /* x >= SCREEN_WIDTH */
+#define LINE_OUT_TOP    0x04 /* y < 0 */
+#define LINE_OUT_BOTTOM 0x08 /* y >= SCREEN_HEIGHT */
+
+/* Function prototypes */
+int line_outcode(int x, int y);
+int line_clip(int *x0, int *y0, int *x1, int *y1);
+void line_hline(unsigned char *buffer, int x0, int x1, int y, unsigned char color);
+void line_vline(unsigned char *buffer, int x, int y0, int y1, unsigned char color);
+void line_draw(unsigned char *buffer, int x0, int y0, int x1, int y1, unsigned char color);
+
+#endif /* LINE_H */
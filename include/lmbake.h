@@ -0,0 +1,33 @@
+/*
+ * lmbake.h
+ *
+ * Lightmap baker
+ * Sums diffuse light from point lights into a wall's lightmap, with
+ * walls casting shadows. Far too slow for a frame, it runs once per map
+ * on the host when the map is built and is kept out of the runtime,
+ * which only samples the result through lightmap.h.
+ */
+
+#ifndef LMBAKE_H
+#define LMBAKE_H
+
+#include "fixed.h"
+#include "lightmap.h"
+#include "vector.h"
+
+/* Point light */
+typedef struct {
+    vector3_t position;  // x and z on the floor plan, y up from the floor
+    fixed_t intensity;   // Light on a surface facing it from up close, 1.0 is full
+    fixed_t radius;      // Distance at which it has faded to nothing
+} lightmap_light_t;
+
+/* Function prototypes */
+void lightmap_bake(lightmap_t *lm,
+                   const lightmap_light_t *lights,
+                   int light_count,
+                   const lightmap_t *occluders,
+                   int occluder_count,
+                   fixed_t ambient);
+
+#endif /* LMBAKE_H */
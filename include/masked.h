@@ -0,0 +1,41 @@
+/*
+ * masked.h
+ *
+ * Run-length masks for see-through wall textures
+ * Gates, bars and decals have texels that must not be drawn. Rather
+ * than testing every texel against a transparent color while drawing,
+ * each texture column is stored as a list of opaque runs, built once
+ * when the texture is loaded. The masked column drawer walks the runs
+ * and never reads a transparent texel, and solid textures do not pay
+ * anything for it.
+ */
+
+#ifndef MASKED_H
+#define MASKED_H
+
+#include "texture.h"
+
+/* Opaque texels of one column, top to bottom */
+typedef struct {
+    short top;    // First texel row of the run
+    short count;  // Texel rows in the run
+} masked_run_t;
+
+/* Opaque runs of every column of a texture */
+typedef struct masked {
+    masked_run_t *runs;       // Runs column by column, owned by the caller
+    unsigned short *columns;  // First run of each column, width + 1 entries, owned by the caller
+    int width;                // Columns, the width of the texture it was built from
+    int height;               // Rows, the height of the texture it was built from
+    long opaque;              // Opaque texels in the texture
+} masked_t;
+
+/* Function prototypes */
+long masked_count(const texture_t *t, unsigned char key);
+int masked_build(masked_t *m,
+                 const texture_t *t,
+                 unsigned char key,
+                 masked_run_t *runs,
+                 unsigned short *columns);
+
+#endif /* MASKED_H */
@@ -26,14 +26,18 @@ matrix_t matrix_sub(const matrix_t *a, const matrix_t *b);
 matrix_t matrix_scale(const matrix_t *m, fixed_t scalar);
 vector4_t matrix_mul_vector4(const matrix_t *m, const vector4_t *v);
 vector3_t matrix_mul_vector3(const matrix_t *m, const vector3_t *v);
+vector3_t matrix_rotate_vector3(const matrix_t *m, const vector3_t *v);
 matrix_t matrix_mul(const matrix_t *a, const matrix_t *b);
+matrix_t matrix_inverse_affine(const matrix_t *m);
 matrix_t matrix_translation(fixed_t x, fixed_t y, fixed_t z);
 matrix_t matrix_scaling(fixed_t x, fixed_t y, fixed_t z);
 matrix_t matrix_rotation_x(unsigned char angle);
 matrix_t matrix_rotation_y(unsigned char angle);
 matrix_t matrix_rotation_z(unsigned char angle);
+matrix_t matrix_perspective(unsigned char fov, fixed_t aspect, fixed_t near, fixed_t far);
 int matrix_is_identity(const matrix_t *mat);
 int matrix_equals(const matrix_t *a, const matrix_t *b);
+int matrix_is_orthonormal(const matrix_t *mat);
 void matrix_print(const matrix_t *mat);  // Debug function
 
 #endif /* MATRIX_H */
@@ -0,0 +1,51 @@
+/*
+ * meshopt.h
+ *
+ * Offline mesh optimization for indexed triangle meshes
+ * Welds duplicate vertices, removes degenerate triangles and reorders
+ * triangles and vertices so shared vertices are reused while still recent
+ */
+
+#ifndef MESHOPT_H
+#define MESHOPT_H
+
+#include "fixed.h"
+#include "vertex.h"
+
+/* Optimizer constants */
+#define MESHOPT_WELD_EPSILON (FIXED_ONE >> 8) /* Default weld tolerance, 1/256 unit */
+#define MESHOPT_CACHE_SIZE   16               /* Transformed vertex cache entries */
+#define MESHOPT_MAX_VALENCE  32               /* Valence score table entries */
+
+/* Scratch longs needed by the optimizer for a mesh of v vertices and t triangles */
+#define MESHOPT_SCRATCH(v, t) (4L * (v) + 7L * (t) + 1L)
+
+/* Indexed triangle mesh, three indices per triangle */
+typedef struct {
+    vertex_t *vertices;       // Vertex array
+    int vertex_count;         // Number of vertices in use
+    unsigned short *indices;  // Index array
+    int triangle_count;       // Number of triangles in use
+} mesh_t;
+
+/* Optimizer results */
+typedef struct {
+    int vertices_before;   // Vertex count before optimization
+    int vertices_after;    // Vertex count after welding and unused vertex removal
+    int triangles_before;  // Triangle count before optimization
+    int triangles_after;   // Triangle count after degenerate removal
+    fixed_t acmr_before;   // Average cache miss ratio before reordering
+    fixed_t acmr_after;    // Average cache miss ratio after reordering
+} meshopt_stats_t;
+
+/* Function prototypes */
+int meshopt_vertices_equal(const vertex_t *a, const vertex_t *b, fixed_t epsilon);
+int meshopt_is_degenerate(const mesh_t *mesh, int triangle);
+int meshopt_weld(mesh_t *mesh, fixed_t epsilon, long *scratch);
+int meshopt_remove_degenerates(mesh_t *mesh);
+void meshopt_optimize_cache(mesh_t *mesh, long *scratch);
+int meshopt_optimize_vertices(mesh_t *mesh, long *scratch);
+fixed_t meshopt_acmr(const mesh_t *mesh, int cache_size);
+void meshopt_optimize(mesh_t *mesh, fixed_t epsilon, long *scratch, meshopt_stats_t *stats);
+
+#endif /* MESHOPT_H */
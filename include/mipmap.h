@@ -0,0 +1,26 @@
+/*
+ * mipmap.h
+ *
+ * Mip chains for wall and floor textures
+ * Each level is the one before with every 2x2 block of texels averaged
+ * in color and matched back to the palette. A chain is an array of
+ * texture_t with the full size texture first, which the renderers step
+ * into with texture_mip when a surface is far enough away that its
+ * pixels would skip texels.
+ */
+
+#ifndef MIPMAP_H
+#define MIPMAP_H
+
+#include "texture.h"
+#include "vertex.h"
+
+/* Most levels a chain can have, enough to take 32768 texels down to 1 */
+#define MIPMAP_MAX_LEVELS 16
+
+/* Function prototypes */
+int mipmap_levels(int width, int height);
+long mipmap_size(int width, int height, int levels);
+int mipmap_build(texture_t *levels, int count, unsigned char *storage, const color_t *palette);
+
+#endif /* MIPMAP_H */
@@ -0,0 +1,34 @@
+/*
+ * plane.h
+ *
+ * Plane equations for culling, collision and clipping
+ * A plane is stored as a unit normal and offset, with
+ * normal . p + d = 0 for every point p on the plane
+ */
+
+#ifndef PLANE_H
+#define PLANE_H
+
+#include "fixed.h"
+#include "vector.h"
+
+/* Point classification results */
+#define PLANE_BACK  (-1) /* Behind the plane */
+#define PLANE_ON    0    /* Within epsilon of the plane */
+#define PLANE_FRONT 1    /* On the side the normal points to */
+
+/* Plane equation */
+typedef struct {
+    vector3_t normal;  // Unit plane normal
+    fixed_t d;         // Offset, minus the distance of the plane from the origin
+} plane_t;
+
+/* Function prototypes */
+plane_t plane_init(vector3_t normal, fixed_t d);
+plane_t plane_from_point_normal(vector3_t point, vector3_t normal);
+plane_t plane_from_points(vector3_t a, vector3_t b, vector3_t c);
+fixed_t plane_distance(const plane_t *p, vector3_t point);
+int plane_classify_point(const plane_t *p, vector3_t point, fixed_t epsilon);
+int plane_intersect_segment(const plane_t *p, vector3_t a, vector3_t b, fixed_t *t);
+
+#endif /* PLANE_H */
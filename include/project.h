@@ -0,0 +1,57 @@
+/*
+ * project.h
+ *
+ * Perspective divide and viewport transformation
+ * Turns clipped clip space vertices into screen vertices in one pass,
+ * taking a single reciprocal of w per vertex and keeping it for
+ * perspective-correct interpolation in the rasterizer
+ */
+
+#ifndef PROJECT_H
+#define PROJECT_H
+
+#include "clip.h"
+#include "fixed.h"
+#include "vertex.h"
+#include "video.h"
+
+/*
+ * Fractional bits of the reciprocal used for the divide. 24 keeps x, y
+ * and z exact to well under a pixel for w up to several hundred units,
+ * it overflows for w below 1/128 so the near plane must stay above that
+ */
+#define PROJECT_RECIP_SHIFT 24
+
+/* Mode 13h pixels on a 4:3 display are 5/6 as wide as they are tall */
+#define PROJECT_PIXEL_ASPECT_13H ((fixed_t) 54613L)
+
+/* Mapping from normalized device coordinates to pixels */
+typedef struct {
+    fixed_t scale_x;  // Half the viewport width in pixels
+    fixed_t scale_y;  // Half the viewport height, negative so +y is up
+    fixed_t bias_x;   // Pixel x of the viewport centre
+    fixed_t bias_y;   // Pixel y of the viewport centre
+    fixed_t aspect;   // Display aspect ratio to build the projection with
+} viewport_t;
+
+/* Projected vertex as the rasterizer consumes it */
+typedef struct {
+    fixed_t x;         // Screen x in pixels, 16.16 subpixel
+    fixed_t y;         // Screen y in pixels, 16.16 subpixel
+    fixed_t z;         // Depth, 0 at the near plane to FIXED_ONE at the far plane
+    fixed_t inv_w;     // 1 / w
+    fixed_t u_over_w;  // Texture u / w
+    fixed_t v_over_w;  // Texture v / w
+    color_t color;     // Vertex color
+    fixed_t light;     // Brightness of color, 0 to FIXED_ONE, for Gouraud shading
+} screen_vertex_t;
+
+/* Function prototypes */
+void viewport_init(viewport_t *vp, int x, int y, int width, int height, fixed_t pixel_aspect);
+void project_vertex(const viewport_t *vp, const clip_vertex_t *in, screen_vertex_t *out);
+int project_polygon(const viewport_t *vp,
+                    const clip_vertex_t *in,
+                    int count,
+                    screen_vertex_t *out);
+
+#endif /* PROJECT_H */
@@ -0,0 +1,75 @@
+/*
+ * raster.h
+ *
+ * Flat shaded scanline triangle rasterization
+ * Walks the left and right edges of a projected triangle in 16.16
+ * subpixel steps and fills each row between them in the back buffer.
+ * Pixel centres exactly on an edge belong to the triangle only if the
+ * edge is a top or left edge, so triangles sharing an edge cover every
+ * pixel along it exactly once. The same walk can hand rows to other
+ * span consumers instead of filling them. Strips and fans set up the
+ * edge each triangle shares with the next only once.
+ */
+
+#ifndef RASTER_H
+#define RASTER_H
+
+#include "fixed.h"
+#include "project.h"
+#include "video.h"
+
+/* Attributes raster_walk_triangle steps along the edges besides x */
+#define RASTER_ATTR_Z     0x01 /* 1 / w, for depth */
+#define RASTER_ATTR_UV    0x02 /* u / w and v / w, for texturing */
+#define RASTER_ATTR_LIGHT 0x04 /* Light level, for Gouraud shading */
+
+/* One row of a triangle, already scissored to the screen */
+typedef struct {
+    int y;                // Row
+    int x0;               // First pixel
+    int x1;               // One past the last pixel
+    fixed_t left_x;       // Left edge x at the row centre, before scissoring
+    fixed_t right_x;      // Right edge x at the row centre, before scissoring
+    fixed_t left_z;       // 1 / w on the left edge
+    fixed_t right_z;      // 1 / w on the right edge
+    fixed_t left_u;       // u / w on the left edge
+    fixed_t right_u;      // u / w on the right edge
+    fixed_t left_v;       // v / w on the left edge
+    fixed_t right_v;      // v / w on the right edge
+    fixed_t left_light;   // Light level on the left edge
+    fixed_t right_light;  // Light level on the right edge
+} raster_span_t;
+
+/* Receives each non-empty row of a walked triangle */
+typedef void (*raster_span_fn)(void *context, const raster_span_t *span);
+
+/* Function prototypes */
+long raster_walk_triangle(const screen_vertex_t *v0,
+                          const screen_vertex_t *v1,
+                          const screen_vertex_t *v2,
+                          int attributes,
+                          raster_span_fn emit,
+                          void *context);
+long raster_walk_strip(const screen_vertex_t *v,
+                       int count,
+                       int type,
+                       int attributes,
+                       raster_span_fn emit,
+                       void *context);
+long raster_flat_triangle(unsigned char *buffer,
+                          const screen_vertex_t *v0,
+                          const screen_vertex_t *v1,
+                          const screen_vertex_t *v2,
+                          unsigned char color);
+long raster_flat_strip(unsigned char *buffer,
+                       const screen_vertex_t *v,
+                       int count,
+                       int type,
+                       unsigned char color);
+long raster_flat_polygon(unsigned char *buffer,
+                         const screen_vertex_t *v,
+                         int count,
+                         unsigned char color);
+void raster_fill_span(unsigned char *dst, int count, unsigned char color);
+
+#endif /* RASTER_H */
@@ -0,0 +1,56 @@
+/*
+ * rqueue.h
+ *
+ * Render queue for sorting triangles by render state
+ * Buckets triangles by render mode and texture with a radix sort on a
+ * compact 32-bit key, keeping back to front order for triangles that need it
+ */
+
+#ifndef RQUEUE_H
+#define RQUEUE_H
+
+#include "fixed.h"
+#include "triangle.h"
+
+/* Queue limits */
+#define RQUEUE_MAX_TEXTURES     254 /* Distinct textures per queue, ids 1 to 254 */
+#define RQUEUE_TEXTURE_NONE     0   /* Id of a textured triangle with no texture */
+#define RQUEUE_TEXTURE_OVERFLOW 255 /* Id shared by textures past the table, sorted last */
+#define RQUEUE_DEPTH_SHIFT      8   /* Depth is stored as 16 bits of 8.8 */
+
+/* Submission flags */
+#define RQUEUE_OPAQUE  0x00 /* Sorted by state, front to back inside a state */
+#define RQUEUE_ORDERED 0x01 /* Drawn after opaque triangles, strictly back to front */
+
+/* Queue entry */
+typedef struct {
+    unsigned long key;      // Sort key built by rqueue_add
+    const triangle_t *tri;  // Triangle to draw
+} rqueue_entry_t;
+
+/* Per frame state change counts */
+typedef struct {
+    int submitted;       // Triangles added since the last clear
+    int changes_before;  // State changes in submission order
+    int changes_after;   // State changes after sorting
+} rqueue_stats_t;
+
+/* Render queue */
+typedef struct {
+    rqueue_entry_t *entries;                             // Entries, sorted by rqueue_sort
+    rqueue_entry_t *scratch;                             // Radix sort work area
+    int count;                                           // Entries in use
+    int capacity;                                        // Size of both entry arrays
+    const texture_t *textures[RQUEUE_MAX_TEXTURES + 1];  // Texture id table
+    int texture_count;                                   // Ids handed out so far
+    rqueue_stats_t stats;                                // Counts for the current frame
+} rqueue_t;
+
+/* Function prototypes */
+void rqueue_init(rqueue_t *q, rqueue_entry_t *entries, rqueue_entry_t *scratch, int capacity);
+void rqueue_clear(rqueue_t *q);
+int rqueue_add(rqueue_t *q, const triangle_t *t, fixed_t depth, int flags);
+void rqueue_sort(rqueue_t *q);
+int rqueue_count_state_changes(const rqueue_t *q);
+
+#endif /* RQUEUE_H */
@@ -0,0 +1,65 @@
+/*
+ * sbuffer.h
+ *
+ * Span buffer hidden surface removal
+ * Keeps a sorted list of non-overlapping spans for every row, each
+ * carrying 1/w across it. New spans are cut against what is already
+ * there so only their nearest parts stay, and the final lists are
+ * drawn once, writing every covered pixel exactly once.
+ */
+
+#ifndef SBUFFER_H
+#define SBUFFER_H
+
+#include "fixed.h"
+#include "project.h"
+#include "raster.h"
+#include "video.h"
+
+/* End of a span list */
+#define SBUFFER_NONE (-1)
+
+/* One visible run of pixels */
+typedef struct {
+    short x0;             // First pixel
+    short x1;             // One past the last pixel
+    short next;           // Next span to the right, SBUFFER_NONE at the end
+    unsigned char color;  // Palette index
+    fixed_t z;            // 1 / w at the centre of pixel x0
+    fixed_t dz;           // Change in 1 / w per pixel
+} sbuffer_span_t;
+
+/* Per frame span counts */
+typedef struct {
+    long inserted;    // Spans offered to the buffer
+    long clipped;     // Spans left partly hidden
+    long rejected;    // Spans entirely hidden
+    long overflow;    // Visible pieces dropped because the pool was full
+    long pixels_in;   // Pixels offered, what painter's order would write
+    long pixels_out;  // Pixels written by sbuffer_flush
+} sbuffer_stats_t;
+
+/* Span buffer for one screen */
+typedef struct {
+    short head[SCREEN_HEIGHT];  // First span of each row
+    sbuffer_span_t *pool;       // Caller-owned span storage
+    int pool_size;              // Number of spans in the pool
+    int used;                   // Spans handed out since the last clear
+    int free_list;              // Spans released by later, nearer spans
+    sbuffer_stats_t stats;      // Counts since the last clear
+} sbuffer_t;
+
+/* Function prototypes */
+void sbuffer_init(sbuffer_t *sb, sbuffer_span_t *pool, int pool_size);
+void sbuffer_clear(sbuffer_t *sb);
+int sbuffer_insert(sbuffer_t *sb, int y, int x0, int x1, fixed_t z, fixed_t dz,
+                   unsigned char color);
+long sbuffer_add_triangle(sbuffer_t *sb,
+                          const screen_vertex_t *v0,
+                          const screen_vertex_t *v1,
+                          const screen_vertex_t *v2,
+                          unsigned char color);
+long sbuffer_flush(sbuffer_t *sb, unsigned char *buffer);
+void sbuffer_stats_print(const sbuffer_stats_t *stats);  // Debug function
+
+#endif /* SBUFFER_H */
@@ -0,0 +1,45 @@
+/*
+ * shade.h
+ *
+ * Gouraud shading through palette shade ramps
+ * An 8-bit mode cannot blend colors per pixel, so a light level is
+ * turned into a palette index with a ramp built once per base color:
+ * entry l is the palette color nearest to the base color scaled by
+ * l / (SHADE_LEVELS - 1). Light is stepped linearly across each span,
+ * so a shaded pixel costs one add and one table lookup.
+ */
+
+#ifndef SHADE_H
+#define SHADE_H
+
+#include "fixed.h"
+#include "project.h"
+#include "vertex.h"
+
+/* Brightness steps in a ramp, 0 is black and SHADE_LEVELS - 1 the base color */
+#define SHADE_LEVELS 32
+
+/* Palette indices of one base color from dark to full brightness */
+typedef struct {
+    unsigned char index[SHADE_LEVELS];  // Palette index for each light level
+} shade_ramp_t;
+
+/* Function prototypes */
+unsigned char shade_nearest(const color_t *palette, int r, int g, int b);
+void shade_build_ramp(shade_ramp_t *ramp, const color_t *palette, unsigned char base);
+void shade_gouraud_span(unsigned char *dst,
+                        int count,
+                        const shade_ramp_t *ramp,
+                        fixed_t light,
+                        fixed_t dlight);
+long shade_gouraud_triangle(unsigned char *buffer,
+                            const shade_ramp_t *ramp,
+                            const screen_vertex_t *v0,
+                            const screen_vertex_t *v1,
+                            const screen_vertex_t *v2);
+long shade_gouraud_polygon(unsigned char *buffer,
+                           const shade_ramp_t *ramp,
+                           const screen_vertex_t *v,
+                           int count);
+
+#endif /* SHADE_H */
@@ -0,0 +1,43 @@
+/*
+ * stattri.h
+ *
+ * Baked setup data for static triangles
+ * Maze walls, floors and ceilings never move, so their plane, edges,
+ * inward edge planes and bounding sphere are built once at level load
+ * and culling, collision and clipping read them back each frame
+ */
+
+#ifndef STATTRI_H
+#define STATTRI_H
+
+#include "fixed.h"
+#include "matrix.h"
+#include "plane.h"
+#include "triangle.h"
+#include "vector.h"
+
+/* Baked static triangle record */
+typedef struct {
+    plane_t plane;           // Triangle plane, normal matches triangle_calculate_normal
+    vector3_t edges[3];      // Edge i runs from vertex i to vertex i + 1
+    plane_t edge_planes[3];  // Planes through each edge facing into the triangle
+    vector3_t center;        // Bounding sphere center, the vertex centroid
+    fixed_t radius;          // Bounding sphere radius
+} static_triangle_t;
+
+/* Function prototypes */
+void stattri_bake(const triangle_t *t, static_triangle_t *s);
+void stattri_bake_array(const triangle_t *tris, static_triangle_t *s, int count);
+int stattri_is_facing_point(const static_triangle_t *s, const vector3_t *eye);
+int stattri_cull_backfaces(const static_triangle_t *s,
+                           triangle_t *tris,
+                           int count,
+                           const matrix_t *m);
+int stattri_contains_point(const static_triangle_t *s, vector3_t point);
+int stattri_intersect_segment(const static_triangle_t *s,
+                              vector3_t a,
+                              vector3_t b,
+                              vector3_t *hit);
+int stattri_sphere_overlaps(const static_triangle_t *s, vector3_t center, fixed_t radius);
+
+#endif /* STATTRI_H */
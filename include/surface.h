@@ -0,0 +1,76 @@
+/*
+ * surface.h
+ *
+ * Cache of pre-lit wall texture blocks
+ * A block is one repeat of a wall's texture with the wall's lightmap
+ * already applied through the colormap, so a lit wall is drawn from it
+ * exactly as fast as an unlit one. Blocks are built when a wall column
+ * first needs them and live in a pool of fixed-size slots within a
+ * memory budget, the least recently used block making way when the
+ * pool is full.
+ */
+
+#ifndef SURFACE_H
+#define SURFACE_H
+
+#include "colormap.h"
+#include "fixed.h"
+#include "lightmap.h"
+#include "texture.h"
+
+/* Most blocks a cache tracks, whatever its budget */
+#define SURFACE_CACHE_MAX_BLOCKS 256
+
+/* Hash chains for finding a block, a power of two */
+#define SURFACE_CACHE_HASH 64
+
+/* End of a block list */
+#define SURFACE_CACHE_NONE (-1)
+
+/* One lit texture repeat */
+typedef struct {
+    const lightmap_t *lightmap;  // Wall the block belongs to, NULL while unused
+    const texture_t *source;     // Unlit texture it was built from
+    fixed_t u_offset;            // Wall u offset it was built with
+    int segment;                 // Texture repeat along the wall, counted from u = 0
+    short newer, older;          // Neighbours in use order
+    short hash_next;             // Next block on the same hash chain
+    texture_t texture;           // Lit texels in the block's slot
+} surface_block_t;
+
+/* Cache counts since the last flush */
+typedef struct {
+    long hits;       // Lookups served from the cache
+    long misses;     // Lookups that built a block
+    long evictions;  // Blocks thrown out to make room
+    long texels;     // Texels lit building blocks
+} surface_stats_t;
+
+/* Surface cache */
+typedef struct surface_cache {
+    unsigned char *pool;                               // Slot storage, owned by the caller
+    long slot_bytes;                                   // Bytes per slot, the largest block
+    int slot_count;                                    // Slots the budget allows
+    int used;                                          // Slots handed out so far
+    const colormap_t *colormap;                        // Table the light is applied through
+    surface_block_t blocks[SURFACE_CACHE_MAX_BLOCKS];  // One per slot
+    short hash[SURFACE_CACHE_HASH];                    // First block of each chain
+    short newest, oldest;                              // Ends of the use order
+    surface_stats_t stats;                             // Counts since the last flush
+} surface_cache_t;
+
+/* Function prototypes */
+void surface_cache_init(surface_cache_t *cache,
+                        unsigned char *pool,
+                        long budget,
+                        long slot_bytes,
+                        const colormap_t *colormap);
+void surface_cache_flush(surface_cache_t *cache);
+const texture_t *surface_cache_get(surface_cache_t *cache,
+                                   const lightmap_t *lightmap,
+                                   const texture_t *source,
+                                   fixed_t u_offset,
+                                   int segment);
+void surface_cache_stats_print(const surface_stats_t *stats);
+
+#endif /* SURFACE_H */
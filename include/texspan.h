@@ -0,0 +1,70 @@
+/*
+ * texspan.h
+ *
+ * Perspective-correct textured spans with affine subdivision
+ * Texture coordinates are only exact where u / w and v / w are divided
+ * by 1 / w, so each span takes an exact divide every TEXSPAN_SUBDIV
+ * pixels and steps u and v linearly in between. Texture coordinates
+ * are in texels and wrap at the texture edges.
+ */
+
+#ifndef TEXSPAN_H
+#define TEXSPAN_H
+
+#include "colormap.h"
+#include "fixed.h"
+#include "project.h"
+#include "raster.h"
+#include "texture.h"
+
+/* Pixels between exact divides, 2^shift, 3 gives 8 for sharper close-ups */
+#define TEXSPAN_SUBDIV_SHIFT 4
+#define TEXSPAN_SUBDIV       (1 << TEXSPAN_SUBDIV_SHIFT)
+
+/*
+ * Extra fractional bits 1/w carries across a span. The per-pixel change
+ * of 1/w is tiny, at 16.16 its rounding error builds up to a visible
+ * texture shift over a wide span. 1/w must stay below 64.
+ */
+#define TEXSPAN_Z_SHIFT 8
+
+/* Perspective values across one span */
+typedef struct {
+    fixed_t z;                   // 1 / w at the first pixel centre, TEXSPAN_Z_SHIFT extra bits
+    fixed_t dz;                  // Change in z per pixel, same bits as z
+    fixed_t u;                   // u / w at the first pixel centre, texels
+    fixed_t du;                  // Change in u / w per pixel
+    fixed_t v;                   // v / w at the first pixel centre, texels
+    fixed_t dv;                  // Change in v / w per pixel
+    const colormap_t *colormap;  // Light table, NULL leaves texels unlit
+    fixed_t light;               // Light level for the colormap, 0 to FIXED_ONE
+} texspan_t;
+
+/* Function prototypes */
+void texspan_setup(texspan_t *s, const raster_span_t *span);
+fixed_t texspan_divide(fixed_t value_over_w, fixed_t z);
+void texspan_draw(unsigned char *dst, int count, const texture_t *tex, const texspan_t *s);
+long texspan_triangle(unsigned char *buffer,
+                      const texture_t *tex,
+                      const screen_vertex_t *v0,
+                      const screen_vertex_t *v1,
+                      const screen_vertex_t *v2);
+long texspan_polygon(unsigned char *buffer,
+                     const texture_t *tex,
+                     const screen_vertex_t *v,
+                     int count);
+long texspan_lit_triangle(unsigned char *buffer,
+                          const texture_t *tex,
+                          const colormap_t *colormap,
+                          fixed_t light,
+                          const screen_vertex_t *v0,
+                          const screen_vertex_t *v1,
+                          const screen_vertex_t *v2);
+long texspan_lit_polygon(unsigned char *buffer,
+                         const texture_t *tex,
+                         const colormap_t *colormap,
+                         fixed_t light,
+                         const screen_vertex_t *v,
+                         int count);
+
+#endif /* TEXSPAN_H */
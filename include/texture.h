@@ -0,0 +1,35 @@
+/*
+ * texture.h
+ *
+ * Texture bitmaps for the renderers
+ * A texture is a row-major bitmap of 8-bit palette indices. Sizes that
+ * are powers of two also get a shift and masks, so renderers can wrap
+ * texture coordinates with an AND instead of a divide.
+ *
+ * A texture may be the first of an array of mip levels, each half the
+ * size of the one before, so distant surfaces can read a small level
+ * that stays in the CPU cache instead of skipping across a large one.
+ */
+
+#ifndef TEXTURE_H
+#define TEXTURE_H
+
+#include "fixed.h"
+
+/* Texture reference */
+typedef struct {
+    unsigned char *texture_data;  // Pointer to texture bitmap data
+    int width;                    // Texture width in pixels
+    int height;                   // Texture height in pixels
+    int width_shift;              // log2 of width, -1 unless both sizes are powers of two
+    int width_mask;               // width - 1 when width_shift is valid
+    int height_mask;              // height - 1 when width_shift is valid
+    int mip_levels;               // Smaller levels following this one in its array, 0 for none
+} texture_t;
+
+/* Function prototypes */
+int texture_log2(int size);
+int texture_init(texture_t *t, unsigned char *data, int width, int height);
+const texture_t *texture_mip(const texture_t *t, fixed_t footprint, int *level);
+
+#endif /* TEXTURE_H */
@@ -10,19 +10,18 @@
 
 #include "fixed.h"
 #include "matrix.h"
+#include "texture.h"
 #include "vertex.h"
 
-/* Texture reference */
-typedef struct {
-    unsigned char *texture_data;  // Pointer to texture bitmap data
-    int width;                    // Texture width in pixels
-    int height;                   // Texture height in pixels
-} texture_t;
-
 /* Triangle render modes */
 #define TRIANGLE_FLAT     0  // Flat shaded triangle
 #define TRIANGLE_TEXTURED 1  // Textured triangle
 
+/* Triangle normal update modes used by triangle_transform_mode */
+#define TRIANGLE_NORMAL_RECALC 0  // Rebuild normal from transformed edges
+#define TRIANGLE_NORMAL_ROTATE 1  // Rotate stored normal then renormalize
+#define TRIANGLE_NORMAL_RIGID  2  // Rotate stored normal, matrix must be orthonormal
+
 /* Triangle structure */
 typedef struct {
     vertex_t vertices[3];  // Array of three vertices forming the triangle
@@ -38,6 +37,16 @@ triangle_t triangle_init(vertex_t v1, vertex_t v2, vertex_t v3);
 void triangle_calculate_normal(triangle_t *t);
 int triangle_is_facing_camera(const triangle_t *t);
 triangle_t triangle_transform(const triangle_t *t, const matrix_t *m);
+triangle_t triangle_transform_mode(const triangle_t *t, const matrix_t *m, int normal_mode);
+int triangle_select_normal_mode(const matrix_t *m);
+vector3_t triangle_object_eye(const matrix_t *m);
+int triangle_is_facing_point(const triangle_t *t, const vector3_t *eye);
+int triangle_cull_backfaces(triangle_t *tris, int count, const matrix_t *m);
+int triangle_transform_visible(const triangle_t *src,
+                               triangle_t *dst,
+                               int count,
+                               const matrix_t *m,
+                               int normal_mode);
 void triangle_set_color(triangle_t *t, color_t color);
 void triangle_set_texture(triangle_t *t, texture_t *texture);
 void triangle_set_render_mode(triangle_t *t, int mode);
@@ -0,0 +1,50 @@
+/*
+ * tristrip.h
+ *
+ * Triangle strip and fan primitives
+ * Consecutive triangles share two vertices, so each new triangle costs one
+ * vertex transform and one new edge instead of three of each
+ */
+
+#ifndef TRISTRIP_H
+#define TRISTRIP_H
+
+#include "fixed.h"
+#include "matrix.h"
+#include "triangle.h"
+#include "vertex.h"
+
+/* Primitive types */
+#define TRISTRIP_STRIP 0 /* Triangle i uses vertices i, i+1, i+2 */
+#define TRISTRIP_FAN   1 /* Triangle i uses vertices 0, i+1, i+2 */
+
+/* Strip or fan of triangles sharing vertices */
+typedef struct {
+    vertex_t *vertices;          // Shared vertices, caller owned
+    int vertex_count;            // Number of vertices, at least 3 to draw anything
+    int type;                    // TRISTRIP_STRIP or TRISTRIP_FAN
+    vector3_t *normals;          // One face normal per triangle, may be NULL
+    unsigned char *face_culled;  // One culled flag per triangle, may be NULL
+    color_t color;               // Color for flat shading
+    texture_t *texture;          // Texture reference
+    int render_mode;             // TRIANGLE_FLAT or TRIANGLE_TEXTURED
+} tristrip_t;
+
+/* Function prototypes */
+void tristrip_init(tristrip_t *s,
+                   int type,
+                   vertex_t *vertices,
+                   int vertex_count,
+                   vector3_t *normals,
+                   unsigned char *face_culled);
+int tristrip_triangle_count(const tristrip_t *s);
+void tristrip_get_indices(const tristrip_t *s, int index, int *i0, int *i1, int *i2);
+triangle_t tristrip_get_triangle(const tristrip_t *s, int index);
+void tristrip_calculate_normals(tristrip_t *s);
+int tristrip_cull(tristrip_t *s, const matrix_t *m);
+int tristrip_transform(const tristrip_t *s,
+                       vertex_t *dst_vertices,
+                       vector3_t *dst_normals,
+                       const matrix_t *m);
+
+#endif /* TRISTRIP_H */
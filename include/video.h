@@ -0,0 +1,15 @@
+/*
+ * video.h
+ *
+ * Video mode constants shared by the renderer and the main loop
+ */
+
+#ifndef VIDEO_H
+#define VIDEO_H
+
+/* Screen dimensions */
+#define SCREEN_WIDTH  320                            /* Mode 13h width in pixels */
+#define SCREEN_HEIGHT 200                            /* Mode 13h height in pixels */
+#define SCREEN_SIZE   (SCREEN_WIDTH * SCREEN_HEIGHT) /* Total pixels/bytes */
+
+#endif /* VIDEO_H */
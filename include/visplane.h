@@ -0,0 +1,33 @@
+/*
+ * visplane.h
+ *
+ * Constant-Z span renderer for floors and ceilings
+ * A horizontal plane is at one distance along every screen row, so it
+ * is drawn row by row with one divide per row and a linear texture walk
+ * along each span. A visplane records which rows of each column belong
+ * to the plane, normally whatever the walls left uncovered, and turns
+ * them into row spans when drawn.
+ */
+
+#ifndef VISPLANE_H
+#define VISPLANE_H
+
+#include "fixed.h"
+#include "texture.h"
+#include "video.h"
+#include "wall.h"
+
+/* Rows of a floor or ceiling to draw */
+typedef struct {
+    fixed_t height;              // Height above the floor, below the eye for floors
+    const texture_t *texture;    // Texture, set up with texture_init, one repeat per unit
+    short top[SCREEN_WIDTH];     // First row of the plane in each column
+    short bottom[SCREEN_WIDTH];  // One past the last row, empty unless below top
+} visplane_t;
+
+/* Function prototypes */
+void visplane_init(visplane_t *plane, fixed_t height, const texture_t *texture);
+void visplane_from_walls(visplane_t *floor, visplane_t *ceiling, const wall_view_t *view);
+long visplane_draw(const visplane_t *plane, wall_view_t *view, unsigned char *buffer);
+
+#endif /* VISPLANE_H */
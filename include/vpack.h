@@ -0,0 +1,54 @@
+/*
+ * vpack.h
+ *
+ * Packed vertex format for memory and cache constrained geometry
+ * Stores sector-local 8.8 positions, a quantized normal index,
+ * a palette color index and 8.8 texture coordinates in 12 bytes
+ */
+
+#ifndef VPACK_H
+#define VPACK_H
+
+#include "fixed.h"
+#include "matrix.h"
+#include "vector.h"
+#include "vertex.h"
+
+/* Packed format constants */
+#define VPACK_POS_SHIFT    8   /* Fractional bits in packed positions */
+#define VPACK_UV_SHIFT     8   /* Fractional bits in packed texture coordinates */
+#define VPACK_NORMAL_COUNT 256 /* Entries in the shared normal table */
+
+/* Fixed normal table indices for axis-aligned maze faces */
+#define VPACK_NORMAL_POS_X 0
+#define VPACK_NORMAL_NEG_X 1
+#define VPACK_NORMAL_POS_Y 2
+#define VPACK_NORMAL_NEG_Y 3
+#define VPACK_NORMAL_POS_Z 4
+#define VPACK_NORMAL_NEG_Z 5
+
+/* Packed vertex, 12 bytes against 36 for vertex_t */
+typedef struct {
+    short x;               // Position relative to sector origin, 8.8
+    short y;
+    short z;
+    unsigned char normal;  // Index into the shared normal table
+    unsigned char color;   // Palette color index
+    unsigned short u;      // Texture coordinates, 8.8 wrapping
+    unsigned short v;
+} packed_vertex_t;
+
+/* Function prototypes */
+void vpack_init(void);
+const vector3_t *vpack_get_normal_table(void);
+unsigned char vpack_quantize_normal(vector3_t normal);
+packed_vertex_t vpack_pack(const vertex_t *v, const vector3_t *origin, unsigned char color);
+vertex_t vpack_unpack(const packed_vertex_t *p, const vector3_t *origin, const color_t *palette);
+void vpack_transform(const packed_vertex_t *src,
+                     vector3_t *dst,
+                     int count,
+                     const vector3_t *origin,
+                     const matrix_t *m);
+void vpack_rotate_normal_table(const matrix_t *m, vector3_t *table);
+
+#endif /* VPACK_H */
@@ -0,0 +1,54 @@
+/*
+ * vstream.h
+ *
+ * Structure-of-arrays vertex streams
+ * Keeps positions, normals, colors and texture coordinates in separate
+ * arrays so batch passes only walk the attributes a render mode needs
+ */
+
+#ifndef VSTREAM_H
+#define VSTREAM_H
+
+#include "fixed.h"
+#include "matrix.h"
+#include "vector.h"
+#include "vertex.h"
+
+/* Attribute stream selection flags */
+#define VSTREAM_POSITION 0x01 /* Position stream */
+#define VSTREAM_NORMAL   0x02 /* Normal stream */
+#define VSTREAM_COLOR    0x04 /* Color stream */
+#define VSTREAM_TEXCOORD 0x08 /* Texture coordinate stream */
+#define VSTREAM_ALL      0x0F /* Every stream */
+
+/* Vertex stream, each array may be NULL if that attribute is unused */
+typedef struct {
+    vector3_t *positions;   // Position per vertex
+    vector3_t *normals;     // Normal per vertex
+    color_t *colors;        // Color per vertex
+    texcoord_t *texcoords;  // Texture coordinates per vertex
+    int count;              // Number of vertices in use
+    int capacity;           // Number of vertices each array can hold
+    int attribs;            // VSTREAM_* flags for arrays that are present
+} vertex_stream_t;
+
+/* Function prototypes */
+void vstream_init(vertex_stream_t *s,
+                  vector3_t *positions,
+                  vector3_t *normals,
+                  color_t *colors,
+                  texcoord_t *texcoords,
+                  int capacity);
+int vstream_attribs_for_mode(int render_mode);
+int vstream_load(vertex_stream_t *s, const vertex_t *vertices, int count, int attribs);
+vertex_t vstream_get(const vertex_stream_t *s, int index);
+int vstream_transform(const vertex_stream_t *src,
+                      vertex_stream_t *dst,
+                      const matrix_t *m,
+                      int attribs);
+void vstream_light(const vertex_stream_t *s,
+                   vector3_t light_dir,
+                   fixed_t ambient,
+                   fixed_t *intensity);
+
+#endif /* VSTREAM_H */
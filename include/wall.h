@@ -0,0 +1,80 @@
+/*
+ * wall.h
+ *
+ * Column renderer for vertical maze walls
+ * Depth is constant down every screen column of a vertical wall, so a
+ * wall is drawn one column at a time with a single divide per column
+ * and a fixed texture step down the column, no per-pixel perspective.
+ * The view keeps the nearest wall depth and the rows it covered for
+ * every column, so walls can arrive in any order and floors and
+ * ceilings know where to fill in.
+ */
+
+#ifndef WALL_H
+#define WALL_H
+
+#include "fixed.h"
+#include "texture.h"
+#include "video.h"
+
+/* Only pointed to here, callers that fill them in include their headers */
+struct colormap;
+struct lightmap;
+struct masked;
+struct surface_cache;
+
+/* Nearest distance drawn, wall ends closer than this are clipped off */
+#define WALL_NEAR (FIXED_ONE / 8)
+
+/* Centre of the screen, where the view direction lands */
+#define WALL_CENTER_X ((fixed_t) (SCREEN_WIDTH / 2) << FIXED_SHIFT)
+#define WALL_CENTER_Y ((fixed_t) (SCREEN_HEIGHT / 2) << FIXED_SHIFT)
+
+/* Extra fractional bits 1/z carries across a wall, 1/WALL_NEAR must fit in 8.24 */
+#define WALL_Z_SHIFT 8
+
+/*
+ * Floor plan segment drawn from the floor to the ceiling. It is seen
+ * from the side where (x0, z0) is on the viewer's left. The texture
+ * repeats once per unit along the wall and once per unit up it.
+ */
+typedef struct {
+    fixed_t x0, z0;                   // First end on the floor plan
+    fixed_t x1, z1;                   // Second end on the floor plan
+    const texture_t *texture;         // Texture, set up with texture_init
+    fixed_t u_offset;                 // Texels added to u, to line up neighbouring walls
+    const struct lightmap *lightmap;  // Baked light, only read when the view has a surface cache
+    const struct masked *mask;        // Opaque runs of the texture, NULL for a solid wall
+} wall_t;
+
+/* Viewer and per-column results for one frame */
+typedef struct {
+    fixed_t x, z;                     // Eye position on the floor plan
+    fixed_t eye;                      // Eye height above the floor
+    fixed_t ceiling;                  // Ceiling height above the floor
+    unsigned char angle;              // View direction, 0 looks along +z, 64 along +x
+    fixed_t sin, cos;                 // Sine and cosine of angle
+    fixed_t focal;                    // Pixels per unit of x / z
+    const struct colormap *colormap;  // Light table for walls and planes, NULL draws them unlit
+    fixed_t light;                    // Light level for the colormap, 0 to FIXED_ONE
+    struct surface_cache *cache;      // Lit blocks for walls with lightmaps, NULL ignores lightmaps
+    fixed_t depth[SCREEN_WIDTH];      // 1 / z of the nearest wall in each column, 0 for none
+    short top[SCREEN_WIDTH];          // First row covered by a wall in each column
+    short bottom[SCREEN_WIDTH];       // One past the last row covered by a wall
+    long texels;                      // Texels read by walls and planes since the last clear
+} wall_view_t;
+
+/* Function prototypes */
+void wall_view_init(wall_view_t *view,
+                    fixed_t x,
+                    fixed_t z,
+                    fixed_t eye,
+                    fixed_t ceiling,
+                    unsigned char angle,
+                    unsigned char fov);
+void wall_view_clear(wall_view_t *view);
+void wall_view_transform(const wall_view_t *view, fixed_t x, fixed_t z, fixed_t *vx, fixed_t *vz);
+long wall_draw(wall_view_t *view, unsigned char *buffer, const wall_t *wall);
+long wall_draw_list(wall_view_t *view, unsigned char *buffer, const wall_t *walls, int count);
+
+#endif /* WALL_H */
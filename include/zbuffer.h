@@ -0,0 +1,57 @@
+/*
+ * zbuffer.h
+ *
+ * 16-bit depth buffer with lazy clearing
+ * Stores 1/w quantized to 16 bits per pixel, larger is nearer. The top
+ * bits of every value hold the frame's epoch, so values written in an
+ * earlier frame always lose to the current one and the buffer only
+ * needs a real clear once every ZBUFFER_EPOCHS frames.
+ */
+
+#ifndef ZBUFFER_H
+#define ZBUFFER_H
+
+#include "fixed.h"
+#include "project.h"
+#include "video.h"
+
+/* Epoch bits taken from each 16-bit value, a full clear every 2^bits frames */
+#define ZBUFFER_EPOCH_BITS 2
+#define ZBUFFER_EPOCHS     (1 << ZBUFFER_EPOCH_BITS)
+
+/* Depth bits left per value, 0 stays reserved for cleared memory */
+#define ZBUFFER_DEPTH_BITS (16 - ZBUFFER_EPOCH_BITS)
+#define ZBUFFER_DEPTH_MAX  ((1 << ZBUFFER_DEPTH_BITS) - 2)
+
+/* Depth buffer for one screen */
+typedef struct {
+    unsigned short *depth;  // SCREEN_SIZE values, owned by the caller
+    fixed_t scale;          // Depth units per unit of 1 / w
+    fixed_t inv_w_max;      // 1 / w that maps to ZBUFFER_DEPTH_MAX, the near plane
+    unsigned short base;    // Epoch bits of every value written this frame
+    int epoch;              // Frames since the last full clear
+    long clears;            // Full clears done since init
+} zbuffer_t;
+
+/* Function prototypes */
+void zbuffer_init(zbuffer_t *zb, unsigned short *storage, fixed_t near_dist);
+void zbuffer_begin_frame(zbuffer_t *zb);
+unsigned short zbuffer_value(const zbuffer_t *zb, fixed_t inv_w);
+int zbuffer_span_test_write(zbuffer_t *zb,
+                            unsigned char *buffer,
+                            int y,
+                            int x0,
+                            int x1,
+                            fixed_t z,
+                            fixed_t dz,
+                            unsigned char color);
+int zbuffer_span_test(const zbuffer_t *zb, int y, int x0, int x1, fixed_t z, fixed_t dz);
+void zbuffer_span_write(zbuffer_t *zb, int y, int x0, int x1, fixed_t z, fixed_t dz);
+long zbuffer_draw_triangle(zbuffer_t *zb,
+                           unsigned char *buffer,
+                           const screen_vertex_t *v0,
+                           const screen_vertex_t *v1,
+                           const screen_vertex_t *v2,
+                           unsigned char color);
+
+#endif /* ZBUFFER_H */
@@ -0,0 +1,260 @@
+/*
+ * classify.c
+ *
+ * Implementation of batch triangle classification
+ *
+ * Each triangle is tested for facing against the eye moved into object
+ * space, then its vertices are taken to clip space and given outcodes.
+ * A shared outcode bit means the whole triangle is outside one plane.
+ * A triangle crossing only the screen edges is left to span scissoring,
+ * it is flagged for clipping only if it crosses the near or far plane or
+ * leaves the guard region.
+ */
+
+#include "..\include\classify.h"
+
+#include <string.h>
+
+#include "..\include\defs.h"
+#include "..\include\guard.h"
+
+/* Set bit i of a packed mask */
+#define CLASSIFY_SET(mask, i) ((mask)[(i) >> 5] |= 1UL << ((i) & 31))
+
+/*
+ * classify_masks_init: Attach mask storage for a triangle array
+ *
+ * Parameters:
+ *   masks - Pointer to masks to initialize
+ *   storage - Array of 4 * CLASSIFY_WORDS(count) words
+ *   count - Number of triangles the masks will describe
+ *
+ * Notes:
+ *   - All masks start cleared
+ */
+void classify_masks_init(classify_masks_t *masks, unsigned long *storage, int count) {
+    int words = CLASSIFY_WORDS(count);
+
+    if (masks == NULL || storage == NULL) {
+        return;
+    }
+
+    memset(storage, 0, 4 * words * sizeof(unsigned long));
+
+    masks->back = storage;
+    masks->outside = storage + words;
+    masks->clip = storage + 2 * words;
+    masks->visible = storage + 3 * words;
+    masks->count = count;
+
+    classify_stats_reset(&masks->stats);
+}
+
+/*
+ * classify_outcode: Compute the clip space outcode of a vertex
+ *
+ * Parameters:
+ *   v - Pointer to vertex in homogeneous clip space
+ *
+ * Returns:
+ *   Combination of CLASSIFY_OUT_* bits, 0 if inside the frustum
+ */
+int classify_outcode(const vector4_t *v) {
+    int code = 0;
+
+    if (v->x < -v->w) {
+        code |= CLASSIFY_OUT_LEFT;
+    } else if (v->x > v->w) {
+        code |= CLASSIFY_OUT_RIGHT;
+    }
+
+    if (v->y < -v->w) {
+        code |= CLASSIFY_OUT_BOTTOM;
+    } else if (v->y > v->w) {
+        code |= CLASSIFY_OUT_TOP;
+    }
+
+    if (v->z < -v->w) {
+        code |= CLASSIFY_OUT_NEAR;
+    } else if (v->z > v->w) {
+        code |= CLASSIFY_OUT_FAR;
+    }
+
+    return code;
+}
+
+/*
+ * classify_triangles: Classify a triangle array in one pass
+ *
+ * Parameters:
+ *   tris - Array of triangles in object space
+ *   count - Number of triangles, must not exceed masks->count
+ *   model_view - Object to view space matrix
+ *   projection - View to clip space matrix
+ *   masks - Masks to fill, cleared first
+ *   clip_coords - Optional output of 3 clip space vertices per triangle, may be NULL
+ *
+ * Returns:
+ *   Number of visible triangles
+ *
+ * Notes:
+ *   - Back faces are found with the stored normal before any vertex is
+ *     transformed, so they cost one dot product
+ *   - clip_coords is only written for triangles that are not back-facing
+ *   - Iterate the results with classify_next on masks->visible or masks->clip
+ */
+int classify_triangles(const triangle_t *tris,
+                       int count,
+                       const matrix_t *model_view,
+                       const matrix_t *projection,
+                       classify_masks_t *masks,
+                       vector4_t *clip_coords) {
+    matrix_t mvp;
+    vector3_t eye;
+    vector4_t clip[3], *out;
+    int i, j, code, and_code, or_code, guard_code;
+
+    if (tris == NULL || model_view == NULL || projection == NULL || masks == NULL) {
+        return 0;
+    }
+
+    if (count > masks->count) {
+        count = masks->count;
+    }
+
+    memset(masks->back, 0, 4 * CLASSIFY_WORDS(masks->count) * sizeof(unsigned long));
+    classify_stats_reset(&masks->stats);
+
+    /* Per batch setup, shared by every triangle */
+    mvp = matrix_mul(projection, model_view);
+    eye = triangle_object_eye(model_view);
+
+    for (i = 0; i < count; i++) {
+        masks->stats.tested++;
+
+        if (!triangle_is_facing_point(&tris[i], &eye)) {
+            CLASSIFY_SET(masks->back, i);
+            masks->stats.back++;
+            continue;
+        }
+
+        out = (clip_coords != NULL) ? &clip_coords[i * 3] : clip;
+        and_code = ~0;
+        or_code = 0;
+        guard_code = 0;
+
+        for (j = 0; j < 3; j++) {
+            vector4_t position = vector4_from_vec3(tris[i].vertices[j].position, FIXED_ONE);
+
+            out[j] = matrix_mul_vector4(&mvp, &position);
+            code = classify_outcode(&out[j]);
+            and_code &= code;
+            or_code |= code;
+
+            if (code != 0) {
+                guard_code |= guard_outcode(&out[j]);
+            }
+        }
+
+        if (and_code != 0) {
+            /* Every vertex is outside the same plane */
+            CLASSIFY_SET(masks->outside, i);
+            masks->stats.outside++;
+            continue;
+        }
+
+        if (guard_code != 0) {
+            CLASSIFY_SET(masks->clip, i);
+            masks->stats.clip++;
+        } else if (or_code != 0) {
+            /* Crosses the screen edges only, spans are scissored instead */
+            masks->stats.scissor++;
+        }
+
+        CLASSIFY_SET(masks->visible, i);
+        masks->stats.visible++;
+    }
+
+    return masks->stats.visible;
+}
+
+/*
+ * classify_next: Find the next set bit in a mask
+ *
+ * Parameters:
+ *   mask - Packed mask to search
+ *   count - Number of bits in the mask
+ *   index - First bit index to look at
+ *
+ * Returns:
+ *   Index of the next set bit at or after index, -1 if there is none
+ *
+ * Notes:
+ *   - Empty words are skipped 32 triangles at a time
+ *   - Loop with i = classify_next(mask, n, 0); i >= 0; i = classify_next(mask, n, i + 1)
+ */
+int classify_next(const unsigned long *mask, int count, int index) {
+    unsigned long bits;
+
+    if (mask == NULL || index < 0) {
+        return -1;
+    }
+
+    while (index < count) {
+        bits = (mask[index >> 5] & 0xFFFFFFFFUL) >> (index & 31);
+
+        if (bits == 0) {
+            /* Nothing left in this word, move to the start of the next */
+            index = (index | 31) + 1;
+            continue;
+        }
+
+        while (!(bits & 1)) {
+            bits >>= 1;
+            index++;
+        }
+
+        return (index < count) ? index : -1;
+    }
+
+    return -1;
+}
+
+/*
+ * classify_stats_reset: Clear a set of classification counts
+ *
+ * Parameters:
+ *   stats - Pointer to counts to clear
+ */
+void classify_stats_reset(classify_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    stats->tested = 0;
+    stats->back = 0;
+    stats->outside = 0;
+    stats->clip = 0;
+    stats->scissor = 0;
+    stats->visible = 0;
+}
+
+/*
+ * classify_stats_add: Add one batch's counts to a running total
+ *
+ * Parameters:
+ *   total - Pointer to running counts, usually reset once per frame
+ *   batch - Pointer to counts from one classify_triangles call
+ */
+void classify_stats_add(classify_stats_t *total, const classify_stats_t *batch) {
+    if (total == NULL || batch == NULL) {
+        return;
+    }
+
+    total->tested += batch->tested;
+    total->back += batch->back;
+    total->outside += batch->outside;
+    total->clip += batch->clip;
+    total->scissor += batch->scissor;
+    total->visible += batch->visible;
+}
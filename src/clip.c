@@ -0,0 +1,277 @@
+/*
+ * clip.c
+ *
+ * Implementation of homogeneous clip space polygon clipping
+ *
+ * Each plane is a linear function of the clip space position, for
+ * example z + w for the near plane, which is negative outside. An edge
+ * crossing a plane is cut where that function is zero, always measured
+ * from the inside end so an edge shared by two triangles is cut at the
+ * same point in both.
+ */
+
+#include "..\include\clip.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+#include "..\include\interp.h"
+
+/*
+ * clip_distance: Signed distance of a vertex inside one frustum plane
+ *
+ * Parameters:
+ *   v - Clip space position
+ *   plane - One CLASSIFY_OUT_* bit
+ *
+ * Returns:
+ *   Value that is negative outside the plane
+ */
+static fixed_t clip_distance(const vector4_t *v, int plane) {
+    switch (plane) {
+    case CLASSIFY_OUT_LEFT:
+        return v->w + v->x;
+    case CLASSIFY_OUT_RIGHT:
+        return v->w - v->x;
+    case CLASSIFY_OUT_BOTTOM:
+        return v->w + v->y;
+    case CLASSIFY_OUT_TOP:
+        return v->w - v->y;
+    case CLASSIFY_OUT_NEAR:
+        return v->w + v->z;
+    default:
+        return v->w - v->z;
+    }
+}
+
+/*
+ * clip_lerp_byte: Interpolate an 8-bit color component, rounded to nearest
+ */
+static unsigned char clip_lerp_byte(unsigned char a, unsigned char b, fixed_t t) {
+    fixed_t value = linear_interp(fixed_from_int(a), fixed_from_int(b), t);
+
+    return (unsigned char) fixed_to_int(value + FIXED_HALF);
+}
+
+/*
+ * clip_lerp: Interpolate every attribute of two clip vertices
+ *
+ * Parameters:
+ *   a - Vertex at t = 0
+ *   b - Vertex at t = 1
+ *   t - Interpolation factor
+ *
+ * Returns:
+ *   Interpolated vertex
+ */
+static clip_vertex_t clip_lerp(const clip_vertex_t *a, const clip_vertex_t *b, fixed_t t) {
+    clip_vertex_t result;
+
+    result.position.x = linear_interp(a->position.x, b->position.x, t);
+    result.position.y = linear_interp(a->position.y, b->position.y, t);
+    result.position.z = linear_interp(a->position.z, b->position.z, t);
+    result.position.w = linear_interp(a->position.w, b->position.w, t);
+
+    result.color.r = clip_lerp_byte(a->color.r, b->color.r, t);
+    result.color.g = clip_lerp_byte(a->color.g, b->color.g, t);
+    result.color.b = clip_lerp_byte(a->color.b, b->color.b, t);
+
+    result.texcoord.u = linear_interp(a->texcoord.u, b->texcoord.u, t);
+    result.texcoord.v = linear_interp(a->texcoord.v, b->texcoord.v, t);
+
+    return result;
+}
+
+/*
+ * clip_against_plane: Clip a convex polygon against one plane
+ *
+ * Parameters:
+ *   in - Input polygon
+ *   count - Number of input vertices
+ *   out - Output polygon, room for count + 1 vertices
+ *   plane - One CLASSIFY_OUT_* bit
+ *
+ * Returns:
+ *   Number of output vertices, 0 if the polygon is entirely outside
+ */
+static int clip_against_plane(const clip_vertex_t *in, int count, clip_vertex_t *out, int plane) {
+    const clip_vertex_t *prev, *cur;
+    fixed_t d_prev, d_cur;
+    int i, written = 0;
+
+    prev = &in[count - 1];
+    d_prev = clip_distance(&prev->position, plane);
+
+    for (i = 0; i < count; i++) {
+        cur = &in[i];
+        d_cur = clip_distance(&cur->position, plane);
+
+        if (d_cur >= 0) {
+            if (d_prev < 0) {
+                /* Entering, cut measured from the inside vertex */
+                out[written++] = clip_lerp(cur, prev, fixed_div(d_cur, d_cur - d_prev));
+            }
+
+            out[written++] = *cur;
+        } else if (d_prev >= 0) {
+            /* Leaving */
+            out[written++] = clip_lerp(prev, cur, fixed_div(d_prev, d_prev - d_cur));
+        }
+
+        prev = cur;
+        d_prev = d_cur;
+    }
+
+    return written;
+}
+
+/*
+ * clip_vertex_init: Build a clip vertex from a vertex and its clip position
+ *
+ * Parameters:
+ *   v - Source vertex for color and texture coordinates
+ *   position - Vertex position already in clip space
+ *
+ * Returns:
+ *   Clip vertex
+ */
+clip_vertex_t clip_vertex_init(const vertex_t *v, const vector4_t *position) {
+    clip_vertex_t result;
+
+    result.position = *position;
+    result.color = v->color;
+    result.texcoord = v->texcoord;
+
+    return result;
+}
+
+/*
+ * clip_polygon: Clip a convex polygon against a set of frustum planes
+ *
+ * Parameters:
+ *   in - Input polygon in clip space
+ *   count - Number of input vertices, at most CLIP_MAX_VERTICES - 6
+ *   out - Output polygon, room for CLIP_MAX_VERTICES vertices
+ *   planes - CLASSIFY_OUT_* bits of the planes to clip against
+ *
+ * Returns:
+ *   Number of output vertices, 0 if nothing is left
+ *
+ * Notes:
+ *   - Works in two stack buffers, nothing is allocated
+ *   - Planes not in the set are skipped without touching the vertices
+ */
+int clip_polygon(const clip_vertex_t *in, int count, clip_vertex_t *out, int planes) {
+    clip_vertex_t buffer_a[CLIP_MAX_VERTICES], buffer_b[CLIP_MAX_VERTICES];
+    const clip_vertex_t *src = in;
+    clip_vertex_t *dst = buffer_a;
+    int plane, i;
+
+    if (in == NULL || out == NULL || count < 3) {
+        return 0;
+    }
+
+    for (plane = 1; plane <= CLASSIFY_OUT_FAR && count > 0; plane <<= 1) {
+        if (!(planes & plane)) {
+            continue;
+        }
+
+        count = clip_against_plane(src, count, dst, plane);
+        src = dst;
+        dst = (dst == buffer_a) ? buffer_b : buffer_a;
+    }
+
+    for (i = 0; i < count; i++) {
+        out[i] = src[i];
+    }
+
+    return count;
+}
+
+/*
+ * clip_triangle: Clip one triangle given its clip space positions
+ *
+ * Parameters:
+ *   t - Triangle for vertex colors and texture coordinates
+ *   clip_coords - The triangle's three clip space positions
+ *   planes - CLASSIFY_OUT_* bits of the planes to clip against
+ *   out - Output polygon, room for CLIP_MAX_VERTICES vertices
+ *
+ * Returns:
+ *   Number of output vertices, 3 if no plane was crossed, 0 if nothing is left
+ *
+ * Notes:
+ *   - Only planes a vertex is actually outside of are clipped against
+ */
+int clip_triangle(const triangle_t *t,
+                  const vector4_t *clip_coords,
+                  int planes,
+                  clip_vertex_t *out) {
+    clip_vertex_t in[3];
+    int i, crossed = 0;
+
+    if (t == NULL || clip_coords == NULL || out == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < 3; i++) {
+        in[i] = clip_vertex_init(&t->vertices[i], &clip_coords[i]);
+        crossed |= classify_outcode(&clip_coords[i]);
+    }
+
+    crossed &= planes;
+
+    if (crossed == 0) {
+        for (i = 0; i < 3; i++) {
+            out[i] = in[i];
+        }
+
+        return 3;
+    }
+
+    return clip_polygon(in, 3, out, crossed);
+}
+
+/*
+ * clip_classified: Get the polygon to draw for one classified triangle
+ *
+ * Parameters:
+ *   tris - Triangle array passed to classify_triangles
+ *   clip_coords - Clip space positions written by classify_triangles
+ *   masks - Classification results
+ *   index - Triangle to fetch, should be set in masks->visible
+ *   planes - CLASSIFY_OUT_* bits of the planes to clip against
+ *   out - Output polygon, room for CLIP_MAX_VERTICES vertices
+ *
+ * Returns:
+ *   Number of output vertices
+ *
+ * Notes:
+ *   - Triangles without their clip bit are copied straight through, the
+ *     clipper only runs on the few the classifier flagged as crossing
+ */
+int clip_classified(const triangle_t *tris,
+                    const vector4_t *clip_coords,
+                    const classify_masks_t *masks,
+                    int index,
+                    int planes,
+                    clip_vertex_t *out) {
+    const vector4_t *coords;
+    int i;
+
+    if (tris == NULL || clip_coords == NULL || masks == NULL || out == NULL) {
+        return 0;
+    }
+
+    coords = &clip_coords[index * 3];
+
+    if (masks->clip[index >> 5] & (1UL << (index & 31))) {
+        return clip_triangle(&tris[index], coords, planes, out);
+    }
+
+    for (i = 0; i < 3; i++) {
+        out[i] = clip_vertex_init(&tris[index].vertices[i], &coords[i]);
+    }
+
+    return 3;
+}
@@ -0,0 +1,107 @@
+/*
+ * colormap.c
+ *
+ * Implementation of light tables for shaded texturing
+ *
+ * Past the fog distance the light falls off as fog_distance / z, which
+ * needs only the 1/z the renderers already have, so choosing a row is
+ * two multiplies. Twice the fog distance away a surface is half as
+ * bright.
+ */
+
+#include "..\include\colormap.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+
+/*
+ * colormap_build: Fill every light level of a colormap from a palette
+ *
+ * Parameters:
+ *   cm - Colormap to fill, fog_distance is set to 0
+ *   palette - 256 colors
+ *   fog - Color everything fades to at level 0, NULL for black
+ *
+ * Notes:
+ *   - Each entry is a search of the whole palette, about two million
+ *     distance sums in all, so this belongs with palette loading
+ */
+void colormap_build(colormap_t *cm, const color_t *palette, const color_t *fog) {
+    const color_t *c;
+    int level, i, r, g, b, dark, fog_r = 0, fog_g = 0, fog_b = 0;
+
+    if (cm == NULL || palette == NULL) {
+        return;
+    }
+
+    if (fog != NULL) {
+        fog_r = fog->r;
+        fog_g = fog->g;
+        fog_b = fog->b;
+    }
+
+    for (level = 0; level < COLORMAP_LEVELS - 1; level++) {
+        dark = COLORMAP_LEVELS - 1 - level;
+
+        for (i = 0; i < 256; i++) {
+            c = &palette[i];
+            r = (c->r * level + fog_r * dark) / (COLORMAP_LEVELS - 1);
+            g = (c->g * level + fog_g * dark) / (COLORMAP_LEVELS - 1);
+            b = (c->b * level + fog_b * dark) / (COLORMAP_LEVELS - 1);
+            cm->map[level][i] = shade_nearest(palette, r, g, b);
+        }
+    }
+
+    for (i = 0; i < 256; i++) {
+        cm->map[COLORMAP_LEVELS - 1][i] = (unsigned char) i;
+    }
+
+    cm->fog_distance = FIXED_ZERO;
+}
+
+/*
+ * colormap_level: Light level of a surface at a distance
+ *
+ * Parameters:
+ *   cm - Colormap
+ *   light - Light level of the surface, 0 to FIXED_ONE
+ *   inv_z - 1 / distance, ignored without fog
+ *
+ * Returns:
+ *   Row of the colormap, 0 to COLORMAP_LEVELS - 1
+ */
+int colormap_level(const colormap_t *cm, fixed_t light, fixed_t inv_z) {
+    fixed_t fade;
+
+    if (light <= 0) {
+        return 0;
+    }
+
+    if (light > FIXED_ONE) {
+        light = FIXED_ONE;
+    }
+
+    if (cm->fog_distance > 0) {
+        fade = fixed_mul(inv_z, cm->fog_distance);
+
+        if (fade < FIXED_ONE) {
+            light = fixed_mul(light, fade < 0 ? FIXED_ZERO : fade);
+        }
+    }
+
+    return (int) ((light * (COLORMAP_LEVELS - 1) + FIXED_HALF) >> FIXED_SHIFT);
+}
+
+/*
+ * colormap_row: Row of palette indices for a surface at a distance
+ *
+ * Parameters:
+ *   Same as colormap_level
+ *
+ * Returns:
+ *   256 entries mapping a texel to its shaded palette index
+ */
+const unsigned char *colormap_row(const colormap_t *cm, fixed_t light, fixed_t inv_z) {
+    return cm->map[colormap_level(cm, light, inv_z)];
+}
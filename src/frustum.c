@@ -0,0 +1,312 @@
+/*
+ * frustum.c
+ *
+ * Implementation of view frustum culling
+ *
+ * Planes come straight from the rows of the view-projection matrix
+ * (Gribb and Hartmann): a clip space point is visible when
+ * -w <= x, y, z <= w, so each plane is row 3 plus or minus row 0, 1 or 2.
+ * Planes extracted from a projection alone are in view space, from a
+ * full world-view-projection they are in world space and sectors can be
+ * tested without transforming anything.
+ */
+
+#include "..\include\frustum.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+
+/*
+ * frustum_extract: Build the frustum planes from a view-projection matrix
+ *
+ * Parameters:
+ *   f - Pointer to frustum to fill
+ *   view_projection - Matrix taking the test space to clip space
+ *
+ * Notes:
+ *   - Planes are normalized so distances are in world units, sphere radii
+ *     can then be compared directly
+ *   - Resets the culling statistics
+ */
+void frustum_extract(frustum_t *f, const matrix_t *view_projection) {
+    const fixed_t (*m)[4];
+    vector3_t normal;
+    fixed_t d, length;
+    int i, row, sign;
+
+    if (f == NULL || view_projection == NULL) {
+        return;
+    }
+
+    m = view_projection->m;
+
+    for (i = 0; i < FRUSTUM_PLANES; i++) {
+        /* Left, bottom and near add the row, right, top and far subtract it */
+        row = i / 2;
+        sign = (i & 1) ? -1 : 1;
+
+        normal = vector3_init(m[3][0] + sign * m[row][0],
+                              m[3][1] + sign * m[row][1],
+                              m[3][2] + sign * m[row][2]);
+        d = m[3][3] + sign * m[row][3];
+
+        /* Scale up tiny normals like the far plane's so squaring keeps precision */
+        while (fixed_abs(normal.x) < FIXED_ONE && fixed_abs(normal.y) < FIXED_ONE &&
+               fixed_abs(normal.z) < FIXED_ONE && fixed_abs(d) < FIXED_MAX / 2 &&
+               (normal.x | normal.y | normal.z) != 0) {
+            normal = vector3_init(normal.x * 2, normal.y * 2, normal.z * 2);
+            d *= 2;
+        }
+
+        length = vector3_length(normal);
+
+        if (length > 0) {
+            normal = vector3_init(fixed_div(normal.x, length),
+                                  fixed_div(normal.y, length),
+                                  fixed_div(normal.z, length));
+            d = fixed_div(d, length);
+        }
+
+        f->planes[i] = plane_init(normal, d);
+    }
+
+    f->stats.nodes_tested = 0;
+    f->stats.nodes_inside = 0;
+    f->stats.nodes_culled = 0;
+    f->stats.plane_tests = 0;
+}
+
+/*
+ * frustum_test_point: Check if a point is inside the frustum
+ *
+ * Parameters:
+ *   f - Pointer to frustum
+ *   point - Point to test
+ *
+ * Returns:
+ *   FRUSTUM_INSIDE or FRUSTUM_OUTSIDE
+ */
+int frustum_test_point(const frustum_t *f, vector3_t point) {
+    int i;
+
+    for (i = 0; i < FRUSTUM_PLANES; i++) {
+        if (plane_distance(&f->planes[i], point) < 0) {
+            return FRUSTUM_OUTSIDE;
+        }
+    }
+
+    return FRUSTUM_INSIDE;
+}
+
+/*
+ * frustum_test_sphere: Classify a bounding sphere against the frustum
+ *
+ * Parameters:
+ *   f - Pointer to frustum
+ *   center - Sphere center
+ *   radius - Sphere radius
+ *   mask - Planes to test, bits for planes the sphere is fully inside are
+ *          cleared, NULL tests every plane
+ *
+ * Returns:
+ *   FRUSTUM_OUTSIDE, FRUSTUM_INTERSECT or FRUSTUM_INSIDE
+ *
+ * Notes:
+ *   - One dot product per plane still in the mask
+ */
+int frustum_test_sphere(frustum_t *f, vector3_t center, fixed_t radius, int *mask) {
+    int planes = (mask != NULL) ? *mask : FRUSTUM_MASK_ALL;
+    fixed_t distance;
+    int i;
+
+    for (i = 0; i < FRUSTUM_PLANES; i++) {
+        if (!(planes & (1 << i))) {
+            continue;
+        }
+
+        f->stats.plane_tests++;
+        distance = plane_distance(&f->planes[i], center);
+
+        if (distance < -radius) {
+            return FRUSTUM_OUTSIDE;
+        }
+
+        if (distance >= radius) {
+            planes &= ~(1 << i);
+        }
+    }
+
+    if (mask != NULL) {
+        *mask = planes;
+    }
+
+    return (planes == 0) ? FRUSTUM_INSIDE : FRUSTUM_INTERSECT;
+}
+
+/*
+ * frustum_test_aabb: Classify an axis-aligned box against the frustum
+ *
+ * Parameters:
+ *   f - Pointer to frustum
+ *   box - Box to test
+ *   mask - Planes to test, updated as for frustum_test_sphere, or NULL
+ *
+ * Returns:
+ *   FRUSTUM_OUTSIDE, FRUSTUM_INTERSECT or FRUSTUM_INSIDE
+ *
+ * Notes:
+ *   - Per plane only the corner furthest along the normal is tested for
+ *     rejection and the nearest corner for acceptance, not all eight
+ */
+int frustum_test_aabb(frustum_t *f, const aabb_t *box, int *mask) {
+    int planes = (mask != NULL) ? *mask : FRUSTUM_MASK_ALL;
+    const plane_t *p;
+    vector3_t far_corner, near_corner;
+    int i;
+
+    for (i = 0; i < FRUSTUM_PLANES; i++) {
+        if (!(planes & (1 << i))) {
+            continue;
+        }
+
+        f->stats.plane_tests++;
+        p = &f->planes[i];
+
+        far_corner.x = (p->normal.x >= 0) ? box->max.x : box->min.x;
+        far_corner.y = (p->normal.y >= 0) ? box->max.y : box->min.y;
+        far_corner.z = (p->normal.z >= 0) ? box->max.z : box->min.z;
+
+        if (plane_distance(p, far_corner) < 0) {
+            return FRUSTUM_OUTSIDE;
+        }
+
+        near_corner.x = (p->normal.x >= 0) ? box->min.x : box->max.x;
+        near_corner.y = (p->normal.y >= 0) ? box->min.y : box->max.y;
+        near_corner.z = (p->normal.z >= 0) ? box->min.z : box->max.z;
+
+        if (plane_distance(p, near_corner) >= 0) {
+            planes &= ~(1 << i);
+        }
+    }
+
+    if (mask != NULL) {
+        *mask = planes;
+    }
+
+    return (planes == 0) ? FRUSTUM_INSIDE : FRUSTUM_INTERSECT;
+}
+
+/*
+ * frustum_collect_leaves: Add every leaf below a node without testing
+ *
+ * Parameters:
+ *   nodes - Node array
+ *   index - Node to start from
+ *   visible - Output leaf indices
+ *   max_visible - Size of the output array
+ *   count - Number of leaves written so far, updated
+ */
+static void frustum_collect_leaves(const frustum_node_t *nodes,
+                                   int index,
+                                   int *visible,
+                                   int max_visible,
+                                   int *count) {
+    const frustum_node_t *node = &nodes[index];
+    int i;
+
+    if (node->child_count == 0) {
+        if (*count < max_visible) {
+            visible[(*count)++] = index;
+        }
+
+        return;
+    }
+
+    for (i = 0; i < node->child_count; i++) {
+        frustum_collect_leaves(nodes, node->first_child + i, visible, max_visible, count);
+    }
+}
+
+/*
+ * frustum_cull_node: Test a node and recurse into its children
+ *
+ * Parameters:
+ *   f - Pointer to frustum
+ *   nodes - Node array
+ *   index - Node to test
+ *   mask - Planes the parent was not fully inside
+ *   visible - Output leaf indices
+ *   max_visible - Size of the output array
+ *   count - Number of leaves written so far, updated
+ */
+static void frustum_cull_node(frustum_t *f,
+                              const frustum_node_t *nodes,
+                              int index,
+                              int mask,
+                              int *visible,
+                              int max_visible,
+                              int *count) {
+    const frustum_node_t *node = &nodes[index];
+    int i, result;
+
+    f->stats.nodes_tested++;
+    result = frustum_test_aabb(f, &node->bounds, &mask);
+
+    if (result == FRUSTUM_OUTSIDE) {
+        f->stats.nodes_culled++;
+        return;
+    }
+
+    /* Fully inside, the whole subtree is visible with no more plane tests */
+    if (result == FRUSTUM_INSIDE) {
+        f->stats.nodes_inside++;
+        frustum_collect_leaves(nodes, index, visible, max_visible, count);
+        return;
+    }
+
+    if (node->child_count == 0) {
+        if (*count < max_visible) {
+            visible[(*count)++] = index;
+        }
+
+        return;
+    }
+
+    for (i = 0; i < node->child_count; i++) {
+        frustum_cull_node(f, nodes, node->first_child + i, mask, visible, max_visible, count);
+    }
+}
+
+/*
+ * frustum_cull_nodes: Find the visible leaves of a bounding volume hierarchy
+ *
+ * Parameters:
+ *   f - Pointer to frustum
+ *   nodes - Node array
+ *   root - Index of the root node
+ *   visible - Receives the indices of leaves inside or crossing the frustum
+ *   max_visible - Size of the visible array
+ *
+ * Returns:
+ *   Number of leaf indices written
+ *
+ * Notes:
+ *   - A rejected node costs at most six plane tests for its whole subtree
+ *   - Children only test the planes their parent crossed
+ */
+int frustum_cull_nodes(frustum_t *f,
+                       const frustum_node_t *nodes,
+                       int root,
+                       int *visible,
+                       int max_visible) {
+    int count = 0;
+
+    if (f == NULL || nodes == NULL || visible == NULL) {
+        return 0;
+    }
+
+    frustum_cull_node(f, nodes, root, FRUSTUM_MASK_ALL, visible, max_visible, &count);
+
+    return count;
+}
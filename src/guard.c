@@ -0,0 +1,187 @@
+/*
+ * guard.c
+ *
+ * Implementation of guard-band screen clipping
+ *
+ * Screen edges are the x = +-w and y = +-w planes of clip space, the
+ * guard region edges are x = +-GUARD_SCALE * w and y = +-GUARD_SCALE * w.
+ * A triangle crossing only screen edges is cheaper to scissor span by
+ * span than to clip into a polygon and triangulate again.
+ */
+
+#include "..\include\guard.h"
+
+#include <stdio.h>
+
+#include "..\include\defs.h"
+
+/*
+ * guard_outcode: Compute the guard region outcode of a vertex
+ *
+ * Parameters:
+ *   v - Pointer to vertex in homogeneous clip space
+ *
+ * Returns:
+ *   CLASSIFY_OUT_* bits, side bits for the guard region edges and the
+ *   near and far bits for the real near and far planes
+ *
+ * Notes:
+ *   - w is scaled up, so w must stay under 32767 / GUARD_SCALE units
+ */
+int guard_outcode(const vector4_t *v) {
+    fixed_t gw = v->w * GUARD_SCALE;
+    int code = 0;
+
+    if (v->x < -gw) {
+        code |= CLASSIFY_OUT_LEFT;
+    } else if (v->x > gw) {
+        code |= CLASSIFY_OUT_RIGHT;
+    }
+
+    if (v->y < -gw) {
+        code |= CLASSIFY_OUT_BOTTOM;
+    } else if (v->y > gw) {
+        code |= CLASSIFY_OUT_TOP;
+    }
+
+    if (v->z < -v->w) {
+        code |= CLASSIFY_OUT_NEAR;
+    } else if (v->z > v->w) {
+        code |= CLASSIFY_OUT_FAR;
+    }
+
+    return code;
+}
+
+/*
+ * guard_classify: Decide how a triangle has to be clipped
+ *
+ * Parameters:
+ *   clip_coords - The triangle's three clip space positions
+ *   stats - Counts to update, or NULL
+ *
+ * Returns:
+ *   GUARD_ACCEPT, GUARD_SCISSOR, GUARD_CLIP or GUARD_REJECT
+ */
+int guard_classify(const vector4_t *clip_coords, guard_stats_t *stats) {
+    int i, code, and_code = ~0, or_code = 0, guard_code = 0, result;
+
+    for (i = 0; i < 3; i++) {
+        code = classify_outcode(&clip_coords[i]);
+        and_code &= code;
+        or_code |= code;
+
+        /* Only vertices off screen can be outside the guard region */
+        if (code != 0) {
+            guard_code |= guard_outcode(&clip_coords[i]);
+        }
+    }
+
+    if (and_code != 0) {
+        result = GUARD_REJECT;
+    } else if (guard_code != 0) {
+        result = GUARD_CLIP;
+    } else if (or_code != 0) {
+        result = GUARD_SCISSOR;
+    } else {
+        result = GUARD_ACCEPT;
+    }
+
+    if (stats != NULL) {
+        switch (result) {
+        case GUARD_ACCEPT:
+            stats->accepted++;
+            break;
+        case GUARD_SCISSOR:
+            stats->scissored++;
+            break;
+        case GUARD_CLIP:
+            stats->clipped++;
+            break;
+        default:
+            stats->rejected++;
+            break;
+        }
+    }
+
+    return result;
+}
+
+/*
+ * guard_scissor_rows: Limit a range of rows to the screen
+ *
+ * Parameters:
+ *   y0 - First row, updated
+ *   y1 - One past the last row, updated
+ *
+ * Returns:
+ *   TRUE if any rows are left to draw
+ */
+int guard_scissor_rows(int *y0, int *y1) {
+    if (*y0 < 0) {
+        *y0 = 0;
+    }
+
+    if (*y1 > SCREEN_HEIGHT) {
+        *y1 = SCREEN_HEIGHT;
+    }
+
+    return *y0 < *y1;
+}
+
+/*
+ * guard_scissor_span: Limit a span to the screen
+ *
+ * Parameters:
+ *   x0 - First pixel, updated
+ *   x1 - One past the last pixel, updated
+ *
+ * Returns:
+ *   TRUE if any pixels are left to draw
+ *
+ * Notes:
+ *   - Rasterizers stepping attributes across the span must advance them
+ *     by the number of pixels cut from the left
+ */
+int guard_scissor_span(int *x0, int *x1) {
+    if (*x0 < 0) {
+        *x0 = 0;
+    }
+
+    if (*x1 > SCREEN_WIDTH) {
+        *x1 = SCREEN_WIDTH;
+    }
+
+    return *x0 < *x1;
+}
+
+/*
+ * guard_stats_reset: Clear guard-band counts
+ *
+ * Parameters:
+ *   stats - Pointer to counts to clear
+ */
+void guard_stats_reset(guard_stats_t *stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    stats->accepted = 0;
+    stats->scissored = 0;
+    stats->clipped = 0;
+    stats->rejected = 0;
+}
+
+/*
+ * guard_stats_print: Print guard-band counts to console for debugging
+ *
+ * Parameters:
+ *   stats - Pointer to counts to print
+ */
+void guard_stats_print(const guard_stats_t *stats) {
+    printf("Guard band:\n");
+    printf("  Accepted:  %d\n", stats->accepted);
+    printf("  Scissored: %d\n", stats->scissored);
+    printf("  Clipped:   %d\n", stats->clipped);
+    printf("  Rejected:  %d\n", stats->rejected);
+}
@@ -0,0 +1,113 @@
+/*
+ * lightmap.c
+ *
+ * Implementation of lightmap storage and sampling
+ */
+
+#include "..\include\lightmap.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+
+/*
+ * lightmap_luxels: Luxels needed to cover a length, one at each end
+ */
+static int lightmap_luxels(fixed_t length) {
+    return (int) (((length << LIGHTMAP_SHIFT) + FIXED_ONE - 1) >> FIXED_SHIFT) + 1;
+}
+
+/*
+ * lightmap_size: Storage a wall's lightmap needs
+ *
+ * Parameters:
+ *   x0, z0, x1, z1 - Ends of an axis-aligned wall
+ *   ceiling - Height of the wall
+ *
+ * Returns:
+ *   Number of luxels, one byte each
+ */
+long lightmap_size(fixed_t x0, fixed_t z0, fixed_t x1, fixed_t z1, fixed_t ceiling) {
+    fixed_t length = fixed_abs(x1 - x0) + fixed_abs(z1 - z0);
+
+    return (long) lightmap_luxels(length) * lightmap_luxels(ceiling);
+}
+
+/*
+ * lightmap_init: Attach storage to a wall's lightmap
+ *
+ * Parameters:
+ *   lm - Lightmap to initialize
+ *   storage - lightmap_size bytes, owned by the caller
+ *   x0, z0, x1, z1 - Ends of the axis-aligned wall, as in its wall_t
+ *   ceiling - Height of the wall
+ *
+ * Notes:
+ *   - Luxels start dark until baked
+ */
+void lightmap_init(lightmap_t *lm,
+                   unsigned char *storage,
+                   fixed_t x0,
+                   fixed_t z0,
+                   fixed_t x1,
+                   fixed_t z1,
+                   fixed_t ceiling) {
+    long i, count;
+
+    if (lm == NULL) {
+        return;
+    }
+
+    lm->luxels = storage;
+    lm->width = lightmap_luxels(fixed_abs(x1 - x0) + fixed_abs(z1 - z0));
+    lm->height = lightmap_luxels(ceiling);
+    lm->x0 = x0;
+    lm->z0 = z0;
+    lm->x1 = x1;
+    lm->z1 = z1;
+    lm->ceiling = ceiling;
+
+    if (storage != NULL) {
+        count = (long) lm->width * lm->height;
+
+        for (i = 0; i < count; i++) {
+            storage[i] = 0;
+        }
+    }
+}
+
+/*
+ * lightmap_sample: Light between luxels
+ *
+ * Parameters:
+ *   lm - Baked lightmap
+ *   s - Luxels along the wall, 16.16, clamped to the wall
+ *   t - Luxels up from the floor, 16.16, clamped to the wall
+ *
+ * Returns:
+ *   Bilinear blend of the four nearest luxels, 0 to LIGHTMAP_FULL
+ */
+int lightmap_sample(const lightmap_t *lm, fixed_t s, fixed_t t) {
+    const unsigned char *row0, *row1;
+    long top, bottom;
+    int i, j, i1, fs, ft;
+
+    s = s < 0 ? 0 : s;
+    t = t < 0 ? 0 : t;
+    s = s > fixed_from_int(lm->width - 1) ? fixed_from_int(lm->width - 1) : s;
+    t = t > fixed_from_int(lm->height - 1) ? fixed_from_int(lm->height - 1) : t;
+
+    i = (int) (s >> FIXED_SHIFT);
+    j = (int) (t >> FIXED_SHIFT);
+    fs = (int) ((s >> 8) & 0xFF);
+    ft = (int) ((t >> 8) & 0xFF);
+    i1 = i + 1 < lm->width ? i + 1 : i;
+
+    row0 = lm->luxels + j * lm->width;
+    row1 = j + 1 < lm->height ? row0 + lm->width : row0;
+
+    top = (long) row0[i] * (256 - fs) + (long) row0[i1] * fs;
+    bottom = (long) row1[i] * (256 - fs) + (long) row1[i1] * fs;
+
+    return (int) ((top * (256 - ft) + bottom * ft + 32768L) >> 16);
+}
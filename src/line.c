@@ -0,0 +1,366 @@
+/*
+ * line.c
+ *
+ * Implementation of clipped line drawing
+ *
+ * A line with a major axis length of M and minor axis length of m is
+ * m + 1 runs of pixels along the major axis. Pixel i along the major
+ * axis sits at minor offset floor((2 * i * m + M) / (2 * M)), so the
+ * first pixel of run k is ceil((2k - 1) * M / (2m)). Stepping that
+ * ceiling with a remainder gives every run length with one compare
+ * per run instead of one per pixel, and exactly the pixels plain
+ * Bresenham would have picked. Lines are always drawn top to bottom so
+ * both directions of the same line cover the same pixels.
+ */
+
+#include "..\include\line.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "..\include\defs.h"
+
+/*
+ * line_floor_div: Divide by a positive number rounding toward negative infinity
+ */
+static long line_floor_div(long num, long den) {
+    long q = num / den;
+
+    /* C89 leaves the rounding of negative quotients to the compiler */
+    if (q * den > num) {
+        q--;
+    }
+
+    return q;
+}
+
+/*
+ * line_intercept: Find a coordinate along a line at a given other coordinate
+ *
+ * Parameters:
+ *   a0, b0 - First endpoint, a is the coordinate to find
+ *   a1, b1 - Second endpoint, b1 must differ from b0
+ *   b - Coordinate to evaluate the line at
+ *
+ * Returns:
+ *   a at b, rounded to the nearest integer
+ */
+static int line_intercept(int a0, int b0, int a1, int b1, int b) {
+    long num = (long) (a1 - a0) * (b - b0);
+    long den = b1 - b0;
+
+    if (den < 0) {
+        num = -num;
+        den = -den;
+    }
+
+    return a0 + (int) line_floor_div(2 * num + den, 2 * den);
+}
+
+/*
+ * line_outcode: Compute the screen outcode of a point
+ *
+ * Parameters:
+ *   x, y - Pixel coordinates
+ *
+ * Returns:
+ *   LINE_OUT_* bits, 0 if the point is on screen
+ */
+int line_outcode(int x, int y) {
+    int code = 0;
+
+    if (x < 0) {
+        code |= LINE_OUT_LEFT;
+    } else if (x >= SCREEN_WIDTH) {
+        code |= LINE_OUT_RIGHT;
+    }
+
+    if (y < 0) {
+        code |= LINE_OUT_TOP;
+    } else if (y >= SCREEN_HEIGHT) {
+        code |= LINE_OUT_BOTTOM;
+    }
+
+    return code;
+}
+
+/*
+ * line_clip: Clip a line to the screen with Cohen-Sutherland
+ *
+ * Parameters:
+ *   x0, y0 - First endpoint, updated
+ *   x1, y1 - Second endpoint, updated
+ *
+ * Returns:
+ *   TRUE if part of the line is on screen
+ *
+ * Notes:
+ *   - Intercepts are rounded to the nearest pixel, so a clipped line can
+ *     step differently from the same line drawn unclipped
+ */
+int line_clip(int *x0, int *y0, int *x1, int *y1) {
+    int code0 = line_outcode(*x0, *y0);
+    int code1 = line_outcode(*x1, *y1);
+    int code, x, y;
+
+    while (code0 | code1) {
+        if (code0 & code1) {
+            return FALSE;
+        }
+
+        /* Move whichever endpoint is outside onto the edge it is beyond */
+        code = code0 ? code0 : code1;
+
+        if (code & LINE_OUT_LEFT) {
+            x = 0;
+            y = line_intercept(*y0, *x0, *y1, *x1, x);
+        } else if (code & LINE_OUT_RIGHT) {
+            x = SCREEN_WIDTH - 1;
+            y = line_intercept(*y0, *x0, *y1, *x1, x);
+        } else if (code & LINE_OUT_TOP) {
+            y = 0;
+            x = line_intercept(*x0, *y0, *x1, *y1, y);
+        } else {
+            y = SCREEN_HEIGHT - 1;
+            x = line_intercept(*x0, *y0, *x1, *y1, y);
+        }
+
+        if (code == code0) {
+            *x0 = x;
+            *y0 = y;
+            code0 = line_outcode(x, y);
+        } else {
+            *x1 = x;
+            *y1 = y;
+            code1 = line_outcode(x, y);
+        }
+    }
+
+    return TRUE;
+}
+
+/*
+ * line_hline: Draw a horizontal line
+ *
+ * Parameters:
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   x0, x1 - Endpoints, inclusive, in either order
+ *   y - Row
+ *   color - Palette index
+ *
+ * Notes:
+ *   - Clipped to the screen, then filled with a single memset
+ */
+void line_hline(unsigned char *buffer, int x0, int x1, int y, unsigned char color) {
+    int t;
+
+    if (y < 0 || y >= SCREEN_HEIGHT) {
+        return;
+    }
+
+    if (x0 > x1) {
+        t = x0;
+        x0 = x1;
+        x1 = t;
+    }
+
+    if (x0 < 0) {
+        x0 = 0;
+    }
+
+    if (x1 >= SCREEN_WIDTH) {
+        x1 = SCREEN_WIDTH - 1;
+    }
+
+    if (x0 <= x1) {
+        memset(buffer + y * SCREEN_WIDTH + x0, color, x1 - x0 + 1);
+    }
+}
+
+/*
+ * line_vline: Draw a vertical line
+ *
+ * Parameters:
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   x - Column
+ *   y0, y1 - Endpoints, inclusive, in either order
+ *   color - Palette index
+ *
+ * Notes:
+ *   - Clipped to the screen, then one store per row
+ */
+void line_vline(unsigned char *buffer, int x, int y0, int y1, unsigned char color) {
+    unsigned char *p;
+    int t, count;
+
+    if (x < 0 || x >= SCREEN_WIDTH) {
+        return;
+    }
+
+    if (y0 > y1) {
+        t = y0;
+        y0 = y1;
+        y1 = t;
+    }
+
+    if (y0 < 0) {
+        y0 = 0;
+    }
+
+    if (y1 >= SCREEN_HEIGHT) {
+        y1 = SCREEN_HEIGHT - 1;
+    }
+
+    p = buffer + y0 * SCREEN_WIDTH + x;
+
+    for (count = y1 - y0 + 1; count > 0; count--) {
+        *p = color;
+        p += SCREEN_WIDTH;
+    }
+}
+
+/*
+ * line_draw_xmajor: Draw a clipped line that is wider than it is tall
+ *
+ * Parameters:
+ *   p - Buffer address of the top endpoint
+ *   dx - Horizontal length, at least dy
+ *   dy - Vertical length, at least 1
+ *   step - 1 to draw right, -1 to draw left
+ *   color - Palette index
+ */
+static void line_draw_xmajor(unsigned char *p, int dx, int dy, int step, unsigned char color) {
+    int whole, adjust, error, run, drawn = 0, k;
+
+    /* Run 1 starts at ceil(dx / (2 * dy)), error is how far that overshoots */
+    whole = dx / dy;
+    adjust = 2 * (dx % dy);
+    run = (dx + 2 * dy - 1) / (2 * dy);
+    error = run * 2 * dy - dx;
+
+    for (k = 0; k < dy; k++) {
+        if (step > 0) {
+            memset(p, color, run);
+            p += SCREEN_WIDTH + run;
+        } else {
+            memset(p - run + 1, color, run);
+            p += SCREEN_WIDTH - run;
+        }
+
+        drawn += run;
+
+        run = whole;
+        error -= adjust;
+
+        if (error < 0) {
+            error += 2 * dy;
+            run++;
+        }
+    }
+
+    /* Last run ends on the endpoint itself */
+    run = dx - drawn + 1;
+
+    if (step > 0) {
+        memset(p, color, run);
+    } else {
+        memset(p - run + 1, color, run);
+    }
+}
+
+/*
+ * line_draw_ymajor: Draw a clipped line that is taller than it is wide
+ *
+ * Parameters:
+ *   p - Buffer address of the top endpoint
+ *   dx - Horizontal length, at least 1
+ *   dy - Vertical length, more than dx
+ *   step - 1 to draw right, -1 to draw left
+ *   color - Palette index
+ */
+static void line_draw_ymajor(unsigned char *p, int dx, int dy, int step, unsigned char color) {
+    int whole, adjust, error, run, drawn = 0, k, i;
+
+    whole = dy / dx;
+    adjust = 2 * (dy % dx);
+    run = (dy + 2 * dx - 1) / (2 * dx);
+    error = run * 2 * dx - dy;
+
+    for (k = 0; k < dx; k++) {
+        for (i = 0; i < run; i++) {
+            *p = color;
+            p += SCREEN_WIDTH;
+        }
+
+        p += step;
+        drawn += run;
+
+        run = whole;
+        error -= adjust;
+
+        if (error < 0) {
+            error += 2 * dx;
+            run++;
+        }
+    }
+
+    for (run = dy - drawn + 1; run > 0; run--) {
+        *p = color;
+        p += SCREEN_WIDTH;
+    }
+}
+
+/*
+ * line_draw: Draw a line clipped to the screen
+ *
+ * Parameters:
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   x0, y0 - First endpoint
+ *   x1, y1 - Second endpoint, drawn inclusive
+ *   color - Palette index
+ *
+ * Notes:
+ *   - Horizontal runs of shallow lines are filled with memset
+ */
+void line_draw(unsigned char *buffer, int x0, int y0, int x1, int y1, unsigned char color) {
+    int dx, dy, step, t;
+
+    if (buffer == NULL || !line_clip(&x0, &y0, &x1, &y1)) {
+        return;
+    }
+
+    if (y0 == y1) {
+        line_hline(buffer, x0, x1, y0, color);
+        return;
+    }
+
+    if (x0 == x1) {
+        line_vline(buffer, x0, y0, y1, color);
+        return;
+    }
+
+    /* Always draw downwards */
+    if (y0 > y1) {
+        t = x0;
+        x0 = x1;
+        x1 = t;
+        t = y0;
+        y0 = y1;
+        y1 = t;
+    }
+
+    dy = y1 - y0;
+    dx = x1 - x0;
+    step = 1;
+
+    if (dx < 0) {
+        dx = -dx;
+        step = -1;
+    }
+
+    if (dx >= dy) {
+        line_draw_xmajor(buffer + y0 * SCREEN_WIDTH + x0, dx, dy, step, color);
+    } else {
+        line_draw_ymajor(buffer + y0 * SCREEN_WIDTH + x0, dx, dy, step, color);
+    }
+}
@@ -0,0 +1,138 @@
+/*
+ * lmbake.c
+ *
+ * Implementation of the lightmap baker
+ *
+ * Every luxel sums Lambert diffuse light from each point light in
+ * range, faded linearly to nothing at the light's radius, on top of an
+ * ambient level. Walls are full height, so a wall shadows a luxel
+ * exactly when it crosses the line to the light on the floor plan.
+ */
+
+#include "..\include\lmbake.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+
+/*
+ * lightmap_side: Which side of the line from a to b a point is on
+ *
+ * Returns:
+ *   Positive on the left, negative on the right, 0 on the line
+ */
+static fixed_t lightmap_side(fixed_t ax, fixed_t az, fixed_t bx, fixed_t bz, fixed_t px,
+                             fixed_t pz) {
+    return fixed_mul(bx - ax, pz - az) - fixed_mul(bz - az, px - ax);
+}
+
+/*
+ * lightmap_crosses: Whether a wall cuts the floor plan line between two points
+ *
+ * Notes:
+ *   - Touching an end or running along the line does not count, so
+ *     walls meeting at a corner do not shadow each other's edges
+ */
+static int lightmap_crosses(const lightmap_t *wall, fixed_t px, fixed_t pz, fixed_t lx,
+                            fixed_t lz) {
+    fixed_t d1 = lightmap_side(wall->x0, wall->z0, wall->x1, wall->z1, px, pz);
+    fixed_t d2 = lightmap_side(wall->x0, wall->z0, wall->x1, wall->z1, lx, lz);
+    fixed_t d3 = lightmap_side(px, pz, lx, lz, wall->x0, wall->z0);
+    fixed_t d4 = lightmap_side(px, pz, lx, lz, wall->x1, wall->z1);
+
+    return ((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) &&
+           ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0));
+}
+
+/*
+ * lightmap_bake: Light every luxel of a wall
+ *
+ * Parameters:
+ *   lm - Lightmap set up with lightmap_init
+ *   lights - Point lights
+ *   light_count - Number of lights
+ *   occluders - Walls that cast shadows, usually every lightmap of the
+ *               map, lm itself may be among them
+ *   occluder_count - Number of occluders
+ *   ambient - Light reaching every luxel, 0 to FIXED_ONE
+ *
+ * Notes:
+ *   - The lit face is the one seen with (x0, z0) on the left, the same
+ *     as for drawing the wall
+ *   - Lights and luxels must be within 128 units of each other on
+ *     each axis for the squared distance to fit
+ */
+void lightmap_bake(lightmap_t *lm,
+                   const lightmap_light_t *lights,
+                   int light_count,
+                   const lightmap_t *occluders,
+                   int occluder_count,
+                   fixed_t ambient) {
+    vector3_t normal, to_light, p;
+    fixed_t length, dir_x, dir_z, along, dist, facing, total;
+    int i, j, k, o, shadowed;
+
+    if (lm == NULL || lm->luxels == NULL) {
+        return;
+    }
+
+    length = fixed_abs(lm->x1 - lm->x0) + fixed_abs(lm->z1 - lm->z0);
+
+    if (length == 0) {
+        return;
+    }
+
+    /* Axis-aligned, so dividing by the length gives a unit direction */
+    dir_x = fixed_div(lm->x1 - lm->x0, length);
+    dir_z = fixed_div(lm->z1 - lm->z0, length);
+    normal = vector3_init(dir_z, FIXED_ZERO, -dir_x);
+
+    for (j = 0; j < lm->height; j++) {
+        p.y = fixed_from_int(j) >> LIGHTMAP_SHIFT;
+        p.y = p.y > lm->ceiling ? lm->ceiling : p.y;
+
+        for (i = 0; i < lm->width; i++) {
+            along = fixed_from_int(i) >> LIGHTMAP_SHIFT;
+            along = along > length ? length : along;
+            p.x = lm->x0 + fixed_mul(dir_x, along);
+            p.z = lm->z0 + fixed_mul(dir_z, along);
+            total = ambient;
+
+            for (k = 0; k < light_count; k++) {
+                to_light = vector3_sub(lights[k].position, p);
+
+                if (fixed_abs(to_light.x) >= lights[k].radius ||
+                    fixed_abs(to_light.y) >= lights[k].radius ||
+                    fixed_abs(to_light.z) >= lights[k].radius) {
+                    continue;
+                }
+
+                dist = vector3_length(to_light);
+                facing = vector3_dot(normal, to_light);
+
+                if (dist >= lights[k].radius || facing <= 0) {
+                    continue;
+                }
+
+                shadowed = FALSE;
+
+                for (o = 0; o < occluder_count && !shadowed; o++) {
+                    if (&occluders[o] != lm) {
+                        shadowed = lightmap_crosses(&occluders[o], p.x, p.z,
+                                                    lights[k].position.x, lights[k].position.z);
+                    }
+                }
+
+                if (!shadowed) {
+                    total += fixed_mul(fixed_mul(lights[k].intensity, fixed_div(facing, dist)),
+                                       FIXED_ONE - fixed_div(dist, lights[k].radius));
+                }
+            }
+
+            total = total < 0 ? 0 : total;
+            total = total > FIXED_ONE ? FIXED_ONE : total;
+            lm->luxels[j * lm->width + i] =
+                (unsigned char) ((total * LIGHTMAP_FULL + FIXED_HALF) >> FIXED_SHIFT);
+        }
+    }
+}
@@ -4,6 +4,7 @@
 
 #include "keyboard.h"
 #include "timer.h"
+#include "video.h"
 
 /* VGA/Video Constants */
 #define VIDEO_INT 0x10    /* BIOS video interrupt number */
@@ -12,11 +13,6 @@
 #define MODE_TEXT 0x03    /* AL value for 80x25 text mode */
 #define VGA_BASE  0xA0000 /* Video memory base address */
 
-/* Screen dimensions */
-#define SCREEN_WIDTH  320                            /* Mode 13h width in pixels */
-#define SCREEN_HEIGHT 200                            /* Mode 13h height in pixels */
-#define SCREEN_SIZE   (SCREEN_WIDTH * SCREEN_HEIGHT) /* Total pixels/bytes */
-
 /* Our internal, private back buffer for drawing */
 static unsigned char back_buffer[SCREEN_SIZE];
 
@@ -0,0 +1,121 @@
+/*
+ * masked.c
+ *
+ * Implementation of run-length texture masks
+ *
+ * A texture is scanned down each column once. A run starts at the
+ * first opaque texel after a transparent one, or at the top of the
+ * column, and ends at the next transparent texel or the bottom.
+ */
+
+#include "..\include\masked.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+
+/*
+ * masked_count: Opaque runs a texture has
+ *
+ * Parameters:
+ *   t - Texture
+ *   key - Palette index of transparent texels
+ *
+ * Returns:
+ *   Runs in all columns, the size of the runs array masked_build needs
+ */
+long masked_count(const texture_t *t, unsigned char key) {
+    const unsigned char *column;
+    long runs = 0;
+    int u, v, open;
+
+    if (t == NULL || t->texture_data == NULL) {
+        return 0;
+    }
+
+    for (u = 0; u < t->width; u++) {
+        column = t->texture_data + u;
+        open = FALSE;
+
+        for (v = 0; v < t->height; v++) {
+            if (column[v * t->width] != key) {
+                runs += !open;
+                open = TRUE;
+            } else {
+                open = FALSE;
+            }
+        }
+    }
+
+    return runs;
+}
+
+/*
+ * masked_build: Find the opaque runs of every column of a texture
+ *
+ * Parameters:
+ *   m - Mask to fill
+ *   t - Texture, at most 32767 rows
+ *   key - Palette index of transparent texels
+ *   runs - masked_count entries, owned by the caller
+ *   columns - t->width + 1 entries, owned by the caller
+ *
+ * Returns:
+ *   FALSE if the texture is missing or has more runs than the column
+ *   index can count
+ *
+ * Notes:
+ *   - Run i of column u is runs[columns[u] + i], and the column has
+ *     columns[u + 1] - columns[u] runs
+ */
+int masked_build(masked_t *m,
+                 const texture_t *t,
+                 unsigned char key,
+                 masked_run_t *runs,
+                 unsigned short *columns) {
+    const unsigned char *column;
+    masked_run_t *run = NULL;
+    long count;
+    int u, v;
+
+    if (m == NULL || runs == NULL || columns == NULL || t == NULL || t->texture_data == NULL) {
+        return FALSE;
+    }
+
+    if (masked_count(t, key) > 65535L) {
+        return FALSE;
+    }
+
+    m->runs = runs;
+    m->columns = columns;
+    m->width = t->width;
+    m->height = t->height;
+    m->opaque = 0;
+    count = 0;
+
+    for (u = 0; u < t->width; u++) {
+        column = t->texture_data + u;
+        columns[u] = (unsigned short) count;
+        run = NULL;
+
+        for (v = 0; v < t->height; v++) {
+            if (column[v * t->width] == key) {
+                run = NULL;
+                continue;
+            }
+
+            if (run == NULL) {
+                run = &runs[count++];
+                run->top = (short) v;
+                run->count = 0;
+            }
+
+            run->count++;
+            m->opaque++;
+        }
+    }
+
+    columns[t->width] = (unsigned short) count;
+
+    return TRUE;
+}
@@ -210,6 +210,31 @@ vector3_t matrix_mul_vector3(const matrix_t *m, const vector3_t *v) {
     return result;
 }
 
+/*
+ * matrix_rotate_vector3: Multiply a 3D vector by the upper-left 3x3 block of a matrix
+ *
+ * Parameters:
+ *   m - Pointer to the matrix
+ *   v - Pointer to the 3D vector
+ *
+ * Returns:
+ *   The rotated 3D vector, translation is ignored
+ *
+ * Notes:
+ *   - Intended for direction vectors such as normals
+ */
+vector3_t matrix_rotate_vector3(const matrix_t *m, const vector3_t *v) {
+    vector3_t result;
+    int i;
+
+    for (i = 0; i < 3; i++) {
+        result.v[i] = fixed_add(fixed_add(fixed_mul(m->m[i][0], v->x), fixed_mul(m->m[i][1], v->y)),
+                                fixed_mul(m->m[i][2], v->z));
+    }
+
+    return result;
+}
+
 /*
  * matrix_mul: Multiply two 4x4 matrices
  *
@@ -242,6 +267,79 @@ matrix_t matrix_mul(const matrix_t *a, const matrix_t *b) {
     return result;
 }
 
+/*
+ * matrix_inverse_affine: Invert a matrix made of a 3x3 linear part and a translation
+ *
+ * Parameters:
+ *   m - Pointer to the matrix to invert
+ *
+ * Returns:
+ *   The inverse matrix, or the identity if the 3x3 block is singular
+ *
+ * Notes:
+ *   - The bottom row is assumed to be 0 0 0 1, projections are not supported
+ *   - Orthonormal matrices take a transpose fast path with no divides
+ *   - Otherwise uses the cofactor method with one divide per element
+ */
+matrix_t matrix_inverse_affine(const matrix_t *m) {
+    matrix_t result = matrix_identity();
+    fixed_t det;
+    int i, j;
+
+    if (matrix_is_orthonormal(m)) {
+        /* Inverse of a rotation is its transpose */
+        for (i = 0; i < 3; i++) {
+            for (j = 0; j < 3; j++) {
+                result.m[i][j] = m->m[j][i];
+            }
+        }
+    } else {
+        /* Cofactors of the 3x3 block, already transposed into the adjugate */
+        result.m[0][0] = fixed_sub(fixed_mul(m->m[1][1], m->m[2][2]),
+                                   fixed_mul(m->m[1][2], m->m[2][1]));
+        result.m[0][1] = fixed_sub(fixed_mul(m->m[0][2], m->m[2][1]),
+                                   fixed_mul(m->m[0][1], m->m[2][2]));
+        result.m[0][2] = fixed_sub(fixed_mul(m->m[0][1], m->m[1][2]),
+                                   fixed_mul(m->m[0][2], m->m[1][1]));
+        result.m[1][0] = fixed_sub(fixed_mul(m->m[1][2], m->m[2][0]),
+                                   fixed_mul(m->m[1][0], m->m[2][2]));
+        result.m[1][1] = fixed_sub(fixed_mul(m->m[0][0], m->m[2][2]),
+                                   fixed_mul(m->m[0][2], m->m[2][0]));
+        result.m[1][2] = fixed_sub(fixed_mul(m->m[0][2], m->m[1][0]),
+                                   fixed_mul(m->m[0][0], m->m[1][2]));
+        result.m[2][0] = fixed_sub(fixed_mul(m->m[1][0], m->m[2][1]),
+                                   fixed_mul(m->m[1][1], m->m[2][0]));
+        result.m[2][1] = fixed_sub(fixed_mul(m->m[0][1], m->m[2][0]),
+                                   fixed_mul(m->m[0][0], m->m[2][1]));
+        result.m[2][2] = fixed_sub(fixed_mul(m->m[0][0], m->m[1][1]),
+                                   fixed_mul(m->m[0][1], m->m[1][0]));
+
+        /* Determinant by expansion along the first row */
+        det = fixed_add(fixed_add(fixed_mul(m->m[0][0], result.m[0][0]),
+                                  fixed_mul(m->m[0][1], result.m[1][0])),
+                        fixed_mul(m->m[0][2], result.m[2][0]));
+
+        if (det == FIXED_ZERO) {
+            return matrix_identity();
+        }
+
+        for (i = 0; i < 3; i++) {
+            for (j = 0; j < 3; j++) {
+                result.m[i][j] = fixed_div(result.m[i][j], det);
+            }
+        }
+    }
+
+    /* Inverse translation is the original translation run backwards */
+    for (i = 0; i < 3; i++) {
+        result.m[i][3] = fixed_neg(fixed_add(fixed_add(fixed_mul(result.m[i][0], m->m[0][3]),
+                                                       fixed_mul(result.m[i][1], m->m[1][3])),
+                                             fixed_mul(result.m[i][2], m->m[2][3])));
+    }
+
+    return result;
+}
+
 /*
  * matrix_translation: Create a translation matrix
  *
@@ -374,6 +472,39 @@ matrix_t matrix_rotation_z(unsigned char angle) {
     return result;
 }
 
+/*
+ * matrix_perspective: Create a perspective projection matrix
+ *
+ * Parameters:
+ *   fov - Vertical field of view in trig_angle units, 1 - 127
+ *   aspect - Viewport width divided by height
+ *   near - Distance to the near plane, greater than zero
+ *   far - Distance to the far plane, greater than near
+ *
+ * Returns:
+ *   Matrix taking view space, looking down +Z, to clip space where
+ *   -w <= x, y, z <= w is visible and w is the view space depth
+ *
+ * Notes:
+ *   - Requires trig_init() to be called before use
+ */
+matrix_t matrix_perspective(unsigned char fov, fixed_t aspect, fixed_t near, fixed_t far) {
+    matrix_t result = matrix_init();
+    fixed_t focal, depth;
+
+    /* Focal length is the cotangent of half the field of view */
+    focal = fixed_div(trig_cosine(fov / 2), trig_sine(fov / 2));
+    depth = far - near;
+
+    result.m[0][0] = fixed_div(focal, aspect);
+    result.m[1][1] = focal;
+    result.m[2][2] = fixed_div(far + near, depth);
+    result.m[2][3] = fixed_neg(fixed_div(fixed_mul(far * 2, near), depth));
+    result.m[3][2] = FIXED_ONE;
+
+    return result;
+}
+
 /*
  * matrix_is_identity: Check if a matrix is an identity matrix
  *
@@ -429,6 +560,63 @@ int matrix_equals(const matrix_t *a, const matrix_t *b) {
     return 1;  // All elements are equal
 }
 
+/*
+ * matrix_is_orthonormal: Check if the upper-left 3x3 block is a pure rotation
+ *
+ * Parameters:
+ *   mat - Pointer to the matrix to check
+ *
+ * Returns:
+ *   1 if the 3x3 rows are unit length, mutually perpendicular and
+ *   right handed, 0 otherwise
+ *
+ * Notes:
+ *   - Translation is ignored, so rigid transforms also pass
+ *   - Mirrors fail, they flip triangle winding so a rotated normal would
+ *     point the opposite way to one recalculated from the vertices
+ *   - Tolerance is loose enough for products of table based rotations
+ *   - Meant to be called once per mesh, not per triangle
+ */
+int matrix_is_orthonormal(const matrix_t *mat) {
+    int i, j, k;
+    fixed_t dot, expected, cross;
+    fixed_t epsilon = 64; /* Approx 0.001 in fixed-point */
+
+    for (i = 0; i < 3; i++) {
+        for (j = i; j < 3; j++) {
+            dot = FIXED_ZERO;
+
+            for (k = 0; k < 3; k++) {
+                dot = fixed_add(dot, fixed_mul(mat->m[i][k], mat->m[j][k]));
+            }
+
+            /* Rows dotted with themselves must be 1, with each other 0 */
+            expected = (i == j) ? FIXED_ONE : FIXED_ZERO;
+
+            if (fixed_abs(dot - expected) > epsilon) {
+                return 0;  // Scaled or skewed
+            }
+        }
+    }
+
+    /* Determinant is row 0 dotted with row 1 cross row 2, -1 for a mirror */
+    dot = FIXED_ZERO;
+
+    for (k = 0; k < 3; k++) {
+        i = (k + 1) % 3;
+        j = (k + 2) % 3;
+        cross = fixed_sub(fixed_mul(mat->m[1][i], mat->m[2][j]),
+                          fixed_mul(mat->m[1][j], mat->m[2][i]));
+        dot = fixed_add(dot, fixed_mul(mat->m[0][k], cross));
+    }
+
+    if (dot < FIXED_ZERO) {
+        return 0;  // Reflection
+    }
+
+    return 1;  // Pure rotation
+}
+
 /*
  * matrix_print: Print matrix values to console for debugging
  *
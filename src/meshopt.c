@@ -0,0 +1,590 @@
+/*
+ * meshopt.c
+ *
+ * Implementation of offline mesh optimization
+ *
+ * Welding sorts vertices along X and only compares vertices whose X values
+ * are within the tolerance, instead of every pair. Triangle reordering is
+ * greedy: each vertex scores higher the more recently it was used and the
+ * fewer triangles still need it, and the highest scoring triangle touching
+ * the cache is emitted next (after Forsyth's linear-speed optimizer).
+ *
+ * All working storage comes from a caller supplied scratch array, sized
+ * with MESHOPT_SCRATCH, so the same code runs in the tools and the game.
+ */
+
+#include "..\include\meshopt.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+
+/* Vertex score weights */
+#define MESHOPT_LAST_TRI_SCORE  (FIXED_ONE * 3 / 4) /* Vertices of the last triangle */
+#define MESHOPT_VALENCE_WEIGHT  (FIXED_ONE * 2)     /* Boost for vertices nearly done */
+
+/*
+ * meshopt_sort_by_x: Sort vertex indices by position X
+ *
+ * Parameters:
+ *   order - Vertex indices to sort
+ *   count - Number of indices
+ *   vertices - Vertex array the indices refer to
+ *
+ * Notes:
+ *   - Shell sort, in place with no recursion
+ */
+static void meshopt_sort_by_x(long *order, int count, const vertex_t *vertices) {
+    int gap, i, j;
+    long item;
+
+    for (gap = count / 2; gap > 0; gap /= 2) {
+        for (i = gap; i < count; i++) {
+            item = order[i];
+
+            for (j = i; j >= gap &&
+                        vertices[order[j - gap]].position.x > vertices[item].position.x;
+                 j -= gap) {
+                order[j] = order[j - gap];
+            }
+
+            order[j] = item;
+        }
+    }
+}
+
+/*
+ * meshopt_within: Check two fixed-point values are within a tolerance
+ */
+static int meshopt_within(fixed_t a, fixed_t b, fixed_t epsilon) {
+    return fixed_abs(a - b) <= epsilon;
+}
+
+/*
+ * meshopt_vertices_equal: Check if two vertices can be welded
+ *
+ * Parameters:
+ *   a, b - Vertices to compare
+ *   epsilon - Largest difference allowed in any position, normal or UV component
+ *
+ * Returns:
+ *   TRUE if every component is within epsilon and the colors match exactly
+ */
+int meshopt_vertices_equal(const vertex_t *a, const vertex_t *b, fixed_t epsilon) {
+    return meshopt_within(a->position.x, b->position.x, epsilon) &&
+           meshopt_within(a->position.y, b->position.y, epsilon) &&
+           meshopt_within(a->position.z, b->position.z, epsilon) &&
+           meshopt_within(a->normal.x, b->normal.x, epsilon) &&
+           meshopt_within(a->normal.y, b->normal.y, epsilon) &&
+           meshopt_within(a->normal.z, b->normal.z, epsilon) &&
+           meshopt_within(a->texcoord.u, b->texcoord.u, epsilon) &&
+           meshopt_within(a->texcoord.v, b->texcoord.v, epsilon) &&
+           a->color.r == b->color.r && a->color.g == b->color.g && a->color.b == b->color.b;
+}
+
+/*
+ * meshopt_is_degenerate: Check if a triangle has no area
+ *
+ * Parameters:
+ *   mesh - Pointer to mesh
+ *   triangle - Triangle index
+ *
+ * Returns:
+ *   TRUE if two indices repeat or the three positions are collinear
+ *
+ * Notes:
+ *   - These are the triangles triangle_calculate_normal gives a zero normal
+ */
+int meshopt_is_degenerate(const mesh_t *mesh, int triangle) {
+    const unsigned short *idx = &mesh->indices[triangle * 3];
+    vector3_t e1, e2, n;
+
+    if (idx[0] == idx[1] || idx[1] == idx[2] || idx[0] == idx[2]) {
+        return TRUE;
+    }
+
+    e1 = vector3_sub(mesh->vertices[idx[1]].position, mesh->vertices[idx[0]].position);
+    e2 = vector3_sub(mesh->vertices[idx[2]].position, mesh->vertices[idx[0]].position);
+    n = vector3_cross(e1, e2);
+
+    return (n.x == 0 && n.y == 0 && n.z == 0);
+}
+
+/*
+ * meshopt_weld: Merge vertices that are equal within a tolerance
+ *
+ * Parameters:
+ *   mesh - Pointer to mesh to weld in place
+ *   epsilon - Weld tolerance, MESHOPT_WELD_EPSILON for the default
+ *   scratch - At least 2 * vertex_count longs
+ *
+ * Returns:
+ *   Number of vertices removed
+ *
+ * Notes:
+ *   - Surviving vertices keep their relative order
+ *   - Welding is not transitive, a chain of vertices each just within
+ *     epsilon of the next keeps the first vertex of each match
+ */
+int meshopt_weld(mesh_t *mesh, fixed_t epsilon, long *scratch) {
+    long *order, *rep;
+    int a, b, i, j, k, count;
+
+    if (mesh == NULL || scratch == NULL || mesh->vertex_count == 0) {
+        return 0;
+    }
+
+    order = scratch;
+    rep = scratch + mesh->vertex_count;
+
+    for (i = 0; i < mesh->vertex_count; i++) {
+        order[i] = i;
+        rep[i] = i;
+    }
+
+    meshopt_sort_by_x(order, mesh->vertex_count, mesh->vertices);
+
+    /* Sweep, each unmerged vertex claims later matches inside its X window */
+    for (a = 0; a < mesh->vertex_count; a++) {
+        i = (int) order[a];
+
+        if (rep[i] != i) {
+            continue;
+        }
+
+        for (b = a + 1; b < mesh->vertex_count; b++) {
+            j = (int) order[b];
+
+            if (mesh->vertices[j].position.x - mesh->vertices[i].position.x > epsilon) {
+                break;
+            }
+
+            if (rep[j] == j && meshopt_vertices_equal(&mesh->vertices[i], &mesh->vertices[j],
+                                                      epsilon)) {
+                rep[j] = i;
+            }
+        }
+    }
+
+    /* Number the survivors, then point merged vertices at their survivor */
+    count = 0;
+
+    for (i = 0; i < mesh->vertex_count; i++) {
+        if (rep[i] == i) {
+            order[i] = count++;
+        }
+    }
+
+    for (i = 0; i < mesh->vertex_count; i++) {
+        if (rep[i] != i) {
+            order[i] = order[rep[i]];
+        } else {
+            mesh->vertices[order[i]] = mesh->vertices[i];
+        }
+    }
+
+    for (k = 0; k < mesh->triangle_count * 3; k++) {
+        mesh->indices[k] = (unsigned short) order[mesh->indices[k]];
+    }
+
+    count = mesh->vertex_count - count;
+    mesh->vertex_count -= count;
+
+    return count;
+}
+
+/*
+ * meshopt_remove_degenerates: Drop triangles with no area
+ *
+ * Parameters:
+ *   mesh - Pointer to mesh to compact in place
+ *
+ * Returns:
+ *   Number of triangles removed
+ *
+ * Notes:
+ *   - Run after welding so nearly coincident vertices are caught too
+ *   - Vertices left unused are dropped by meshopt_optimize_vertices
+ */
+int meshopt_remove_degenerates(mesh_t *mesh) {
+    int t, k, count = 0;
+
+    if (mesh == NULL) {
+        return 0;
+    }
+
+    for (t = 0; t < mesh->triangle_count; t++) {
+        if (meshopt_is_degenerate(mesh, t)) {
+            continue;
+        }
+
+        for (k = 0; k < 3; k++) {
+            mesh->indices[count * 3 + k] = mesh->indices[t * 3 + k];
+        }
+
+        count++;
+    }
+
+    count = mesh->triangle_count - count;
+    mesh->triangle_count -= count;
+
+    return count;
+}
+
+/*
+ * meshopt_vertex_score: Score a vertex for triangle reordering
+ *
+ * Parameters:
+ *   cache_pos - Position in the cache, -1 if not cached
+ *   valence - Number of triangles still needing the vertex
+ *   cache_table - Score for each cache position
+ *   valence_table - Score for each remaining valence
+ *
+ * Returns:
+ *   Vertex score, higher is better
+ */
+static fixed_t meshopt_vertex_score(long cache_pos,
+                                    long valence,
+                                    const fixed_t *cache_table,
+                                    const fixed_t *valence_table) {
+    fixed_t score = FIXED_ZERO;
+
+    if (valence == 0) {
+        return FIXED_ZERO;
+    }
+
+    if (cache_pos >= 0) {
+        score = cache_table[cache_pos];
+    }
+
+    if (valence >= MESHOPT_MAX_VALENCE) {
+        valence = MESHOPT_MAX_VALENCE - 1;
+    }
+
+    return score + valence_table[valence];
+}
+
+/*
+ * meshopt_optimize_cache: Reorder triangles for vertex reuse
+ *
+ * Parameters:
+ *   mesh - Pointer to mesh to reorder in place
+ *   scratch - MESHOPT_SCRATCH(vertex_count, triangle_count) longs
+ *
+ * Notes:
+ *   - Simulates an LRU cache of MESHOPT_CACHE_SIZE vertices
+ *   - Only triangles touching the cache are rescored after each step, a
+ *     full scan is made only when none of them are left
+ */
+void meshopt_optimize_cache(mesh_t *mesh, long *scratch) {
+    fixed_t cache_table[MESHOPT_CACHE_SIZE];
+    fixed_t valence_table[MESHOPT_MAX_VALENCE];
+    long cache[MESHOPT_CACHE_SIZE + 3], next_cache[MESHOPT_CACHE_SIZE + 3];
+    long *valence, *adj_start, *cache_pos, *vscore, *adj, *tri_score, *out;
+    const unsigned short *idx;
+    fixed_t s, best_score;
+    long v, a, last;
+    int vertex_count, triangle_count, cache_count, next_count;
+    int i, k, c, t, best, emitted, scan;
+
+    if (mesh == NULL || scratch == NULL || mesh->triangle_count == 0) {
+        return;
+    }
+
+    vertex_count = mesh->vertex_count;
+    triangle_count = mesh->triangle_count;
+
+    valence = scratch;
+    adj_start = valence + vertex_count;
+    cache_pos = adj_start + vertex_count + 1;
+    vscore = cache_pos + vertex_count;
+    adj = vscore + vertex_count;
+    tri_score = adj + 3L * triangle_count;
+    out = tri_score + triangle_count;
+
+    /* Recently used vertices score high, falling off as (1 - age)^1.5 */
+    for (i = 0; i < MESHOPT_CACHE_SIZE; i++) {
+        if (i < 3) {
+            cache_table[i] = MESHOPT_LAST_TRI_SCORE;
+        } else {
+            s = FIXED_ONE - fixed_div(fixed_from_int(i - 3),
+                                      fixed_from_int(MESHOPT_CACHE_SIZE - 3));
+            cache_table[i] = fixed_mul(s, fixed_sqrt(s));
+        }
+    }
+
+    /* Vertices with few triangles left score high so they can be retired */
+    valence_table[0] = FIXED_ZERO;
+
+    for (i = 1; i < MESHOPT_MAX_VALENCE; i++) {
+        valence_table[i] = fixed_div(MESHOPT_VALENCE_WEIGHT, fixed_sqrt(fixed_from_int(i)));
+    }
+
+    /* Build vertex to triangle adjacency */
+    for (v = 0; v < vertex_count; v++) {
+        valence[v] = 0;
+    }
+
+    for (k = 0; k < triangle_count * 3; k++) {
+        valence[mesh->indices[k]]++;
+    }
+
+    adj_start[0] = 0;
+
+    for (v = 0; v < vertex_count; v++) {
+        adj_start[v + 1] = adj_start[v] + valence[v];
+        cache_pos[v] = adj_start[v];
+    }
+
+    for (k = 0; k < triangle_count * 3; k++) {
+        adj[cache_pos[mesh->indices[k]]++] = k / 3;
+    }
+
+    for (v = 0; v < vertex_count; v++) {
+        cache_pos[v] = -1;
+        vscore[v] = meshopt_vertex_score(-1, valence[v], cache_table, valence_table);
+    }
+
+    for (t = 0; t < triangle_count; t++) {
+        idx = &mesh->indices[t * 3];
+        tri_score[t] = vscore[idx[0]] + vscore[idx[1]] + vscore[idx[2]];
+    }
+
+    cache_count = 0;
+    best = -1;
+    scan = 0;
+
+    for (emitted = 0; emitted < triangle_count; emitted++) {
+        /* Nothing in the cache to continue from, take the best remaining */
+        if (best < 0) {
+            while (tri_score[scan] < 0) {
+                scan++;
+            }
+
+            best = scan;
+
+            for (t = scan + 1; t < triangle_count; t++) {
+                if (tri_score[t] > tri_score[best]) {
+                    best = t;
+                }
+            }
+        }
+
+        idx = &mesh->indices[best * 3];
+        out[emitted * 3] = idx[0];
+        out[emitted * 3 + 1] = idx[1];
+        out[emitted * 3 + 2] = idx[2];
+        tri_score[best] = -1;
+
+        /* Retire the triangle from its vertices, new cache starts with them */
+        next_count = 0;
+
+        for (k = 0; k < 3; k++) {
+            v = idx[k];
+            last = adj_start[v] + valence[v] - 1;
+
+            for (a = adj_start[v]; a <= last; a++) {
+                if (adj[a] == best) {
+                    adj[a] = adj[last];
+                    valence[v]--;
+                    break;
+                }
+            }
+
+            for (c = 0; c < next_count && next_cache[c] != v; c++) {
+            }
+
+            if (c == next_count) {
+                next_cache[next_count++] = v;
+            }
+        }
+
+        /* Older entries move down, anything past the end is evicted */
+        for (c = 0; c < cache_count; c++) {
+            v = cache[c];
+
+            if (v != idx[0] && v != idx[1] && v != idx[2]) {
+                next_cache[next_count++] = v;
+            }
+        }
+
+        for (c = 0; c < next_count; c++) {
+            v = next_cache[c];
+            cache_pos[v] = (c < MESHOPT_CACHE_SIZE) ? c : -1;
+            vscore[v] = meshopt_vertex_score(cache_pos[v], valence[v], cache_table,
+                                             valence_table);
+
+            if (c < MESHOPT_CACHE_SIZE) {
+                cache[c] = v;
+            }
+        }
+
+        cache_count = (next_count < MESHOPT_CACHE_SIZE) ? next_count : MESHOPT_CACHE_SIZE;
+
+        /* Rescore triangles touching the changed vertices */
+        best = -1;
+        best_score = -1;
+
+        for (c = 0; c < next_count; c++) {
+            v = next_cache[c];
+
+            for (a = adj_start[v]; a < adj_start[v] + valence[v]; a++) {
+                t = (int) adj[a];
+                idx = &mesh->indices[t * 3];
+                tri_score[t] = vscore[idx[0]] + vscore[idx[1]] + vscore[idx[2]];
+
+                if (tri_score[t] > best_score) {
+                    best_score = tri_score[t];
+                    best = t;
+                }
+            }
+        }
+    }
+
+    for (k = 0; k < triangle_count * 3; k++) {
+        mesh->indices[k] = (unsigned short) out[k];
+    }
+}
+
+/*
+ * meshopt_optimize_vertices: Reorder vertices into first use order
+ *
+ * Parameters:
+ *   mesh - Pointer to mesh to reorder in place
+ *   scratch - At least vertex_count longs
+ *
+ * Returns:
+ *   Number of unused vertices removed
+ *
+ * Notes:
+ *   - Run after meshopt_optimize_cache so vertices are read in sequence
+ *   - Vertices are permuted in place by following cycles, no copy is made
+ */
+int meshopt_optimize_vertices(mesh_t *mesh, long *scratch) {
+    long *remap = scratch;
+    long next, j;
+    vertex_t temp;
+    int i, k, unused;
+
+    if (mesh == NULL || scratch == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < mesh->vertex_count; i++) {
+        remap[i] = -1;
+    }
+
+    next = 0;
+
+    for (k = 0; k < mesh->triangle_count * 3; k++) {
+        if (remap[mesh->indices[k]] < 0) {
+            remap[mesh->indices[k]] = next++;
+        }
+
+        mesh->indices[k] = (unsigned short) remap[mesh->indices[k]];
+    }
+
+    unused = mesh->vertex_count - (int) next;
+
+    /* Unused vertices go to the end so remap is a full permutation */
+    for (i = 0; i < mesh->vertex_count; i++) {
+        if (remap[i] < 0) {
+            remap[i] = next++;
+        }
+    }
+
+    for (i = 0; i < mesh->vertex_count; i++) {
+        while (remap[i] != i) {
+            j = remap[i];
+
+            temp = mesh->vertices[i];
+            mesh->vertices[i] = mesh->vertices[j];
+            mesh->vertices[j] = temp;
+
+            remap[i] = remap[j];
+            remap[j] = j;
+        }
+    }
+
+    mesh->vertex_count -= unused;
+
+    return unused;
+}
+
+/*
+ * meshopt_acmr: Measure the average cache miss ratio of a mesh
+ *
+ * Parameters:
+ *   mesh - Pointer to mesh
+ *   cache_size - FIFO cache entries to simulate, clamped to 64
+ *
+ * Returns:
+ *   Vertex transforms per triangle, between 0.5 and 3.0
+ */
+fixed_t meshopt_acmr(const mesh_t *mesh, int cache_size) {
+    unsigned short cache[64];
+    long misses = 0;
+    int k, c, head = 0, count = 0;
+
+    if (mesh == NULL || mesh->triangle_count == 0) {
+        return FIXED_ZERO;
+    }
+
+    if (cache_size > 64) {
+        cache_size = 64;
+    }
+
+    for (k = 0; k < mesh->triangle_count * 3; k++) {
+        for (c = 0; c < count && cache[c] != mesh->indices[k]; c++) {
+        }
+
+        if (c == count) {
+            misses++;
+
+            if (count < cache_size) {
+                cache[count++] = mesh->indices[k];
+            } else {
+                cache[head] = mesh->indices[k];
+                head = (head + 1) % cache_size;
+            }
+        }
+    }
+
+    /* Split the divide so large meshes cannot overflow the shift */
+    return ((misses / mesh->triangle_count) << FIXED_SHIFT) +
+           ((misses % mesh->triangle_count) << FIXED_SHIFT) / mesh->triangle_count;
+}
+
+/*
+ * meshopt_optimize: Run every optimization pass over a mesh
+ *
+ * Parameters:
+ *   mesh - Pointer to mesh to optimize in place
+ *   epsilon - Weld tolerance
+ *   scratch - MESHOPT_SCRATCH(vertex_count, triangle_count) longs
+ *   stats - Receives before and after counts, or NULL
+ */
+void meshopt_optimize(mesh_t *mesh, fixed_t epsilon, long *scratch, meshopt_stats_t *stats) {
+    meshopt_stats_t local;
+
+    if (mesh == NULL || scratch == NULL) {
+        return;
+    }
+
+    if (stats == NULL) {
+        stats = &local;
+    }
+
+    stats->vertices_before = mesh->vertex_count;
+    stats->triangles_before = mesh->triangle_count;
+    stats->acmr_before = meshopt_acmr(mesh, MESHOPT_CACHE_SIZE);
+
+    meshopt_weld(mesh, epsilon, scratch);
+    meshopt_remove_degenerates(mesh);
+    meshopt_optimize_cache(mesh, scratch);
+    meshopt_optimize_vertices(mesh, scratch);
+
+    stats->vertices_after = mesh->vertex_count;
+    stats->triangles_after = mesh->triangle_count;
+    stats->acmr_after = meshopt_acmr(mesh, MESHOPT_CACHE_SIZE);
+}
@@ -0,0 +1,122 @@
+/*
+ * mipmap.c
+ *
+ * Implementation of mip chain building
+ *
+ * Averaging is done on the palette colors rather than the indices,
+ * which mean nothing to each other, and the average is matched back to
+ * the nearest palette entry. Every level is built from the one above
+ * it, so each costs a quarter of the last.
+ */
+
+#include "..\include\mipmap.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+#include "..\include\shade.h"
+
+/*
+ * mipmap_levels: Levels a full chain for a texture has
+ *
+ * Parameters:
+ *   width, height - Size of the full size texture
+ *
+ * Returns:
+ *   Levels including the full size one, halving until the smaller
+ *   side is 1, 1 if either size is not a power of two
+ */
+int mipmap_levels(int width, int height) {
+    int w = texture_log2(width), h = texture_log2(height);
+
+    if (w < 0 || h < 0) {
+        return 1;
+    }
+
+    w = (w < h ? w : h) + 1;
+
+    return w < MIPMAP_MAX_LEVELS ? w : MIPMAP_MAX_LEVELS;
+}
+
+/*
+ * mipmap_size: Storage the smaller levels of a chain need
+ *
+ * Parameters:
+ *   width, height - Size of the full size texture
+ *   levels - Levels in the chain including the full size one
+ *
+ * Returns:
+ *   Bytes for every level after the first, about a third of the first
+ */
+long mipmap_size(int width, int height, int levels) {
+    long bytes = 0;
+    int l;
+
+    if (levels > mipmap_levels(width, height)) {
+        levels = mipmap_levels(width, height);
+    }
+
+    for (l = 1; l < levels; l++) {
+        bytes += (long) (width >> l) * (height >> l);
+    }
+
+    return bytes;
+}
+
+/*
+ * mipmap_build: Fill in the smaller levels of a chain
+ *
+ * Parameters:
+ *   levels - count textures, the first set up with texture_init
+ *   count - Levels wanted including the first
+ *   storage - mipmap_size bytes for the smaller levels, owned by the caller
+ *   palette - 256 colors the texels index
+ *
+ * Returns:
+ *   Levels built including the first, fewer than count when the
+ *   texture runs out of halvings and 1 when it is not a power of two
+ *
+ * Notes:
+ *   - Each texel is a search of the whole palette, so this belongs
+ *     with texture loading
+ */
+int mipmap_build(texture_t *levels, int count, unsigned char *storage, const color_t *palette) {
+    const texture_t *src;
+    const unsigned char *row0, *row1;
+    int l, u, v, r, g, b;
+
+    if (levels == NULL || storage == NULL || palette == NULL ||
+        levels[0].texture_data == NULL) {
+        return 1;
+    }
+
+    if (count > mipmap_levels(levels[0].width, levels[0].height)) {
+        count = mipmap_levels(levels[0].width, levels[0].height);
+    }
+
+    for (l = 1; l < count; l++) {
+        src = &levels[l - 1];
+        texture_init(&levels[l], storage, src->width / 2, src->height / 2);
+
+        for (v = 0; v < levels[l].height; v++) {
+            row0 = src->texture_data + 2 * v * src->width;
+            row1 = row0 + src->width;
+
+            for (u = 0; u < levels[l].width; u++) {
+                r = palette[row0[2 * u]].r + palette[row0[2 * u + 1]].r +
+                    palette[row1[2 * u]].r + palette[row1[2 * u + 1]].r;
+                g = palette[row0[2 * u]].g + palette[row0[2 * u + 1]].g +
+                    palette[row1[2 * u]].g + palette[row1[2 * u + 1]].g;
+                b = palette[row0[2 * u]].b + palette[row0[2 * u + 1]].b +
+                    palette[row1[2 * u]].b + palette[row1[2 * u + 1]].b;
+                *storage++ = shade_nearest(palette, (r + 2) >> 2, (g + 2) >> 2, (b + 2) >> 2);
+            }
+        }
+    }
+
+    for (l = 0; l < count; l++) {
+        levels[l].mip_levels = count - 1 - l;
+    }
+
+    return count;
+}
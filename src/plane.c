@@ -0,0 +1,135 @@
+/*
+ * plane.c
+ *
+ * Implementation of plane equations
+ */
+
+#include "..\include\plane.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+
+/*
+ * plane_init: Initialize a plane from its equation
+ *
+ * Parameters:
+ *   normal - Unit plane normal
+ *   d - Plane offset
+ *
+ * Returns:
+ *   Initialized plane
+ */
+plane_t plane_init(vector3_t normal, fixed_t d) {
+    plane_t result;
+
+    result.normal = normal;
+    result.d = d;
+
+    return result;
+}
+
+/*
+ * plane_from_point_normal: Build the plane through a point
+ *
+ * Parameters:
+ *   point - Any point on the plane
+ *   normal - Unit plane normal
+ *
+ * Returns:
+ *   Plane through point facing along normal
+ */
+plane_t plane_from_point_normal(vector3_t point, vector3_t normal) {
+    return plane_init(normal, fixed_neg(vector3_dot(normal, point)));
+}
+
+/*
+ * plane_from_points: Build the plane through three points
+ *
+ * Parameters:
+ *   a, b, c - Points in winding order
+ *
+ * Returns:
+ *   Plane with the same normal triangle_calculate_normal gives
+ *
+ * Notes:
+ *   - Costs a cross product and a square root, build planes at load time
+ */
+plane_t plane_from_points(vector3_t a, vector3_t b, vector3_t c) {
+    vector3_t normal;
+
+    normal = vector3_cross(vector3_sub(b, a), vector3_sub(c, a));
+
+    return plane_from_point_normal(a, vector3_normalize(normal));
+}
+
+/*
+ * plane_distance: Get the signed distance from a plane to a point
+ *
+ * Parameters:
+ *   p - Pointer to plane
+ *   point - Point to measure
+ *
+ * Returns:
+ *   Distance, positive in front of the plane
+ */
+fixed_t plane_distance(const plane_t *p, vector3_t point) {
+    return vector3_dot(p->normal, point) + p->d;
+}
+
+/*
+ * plane_classify_point: Find which side of a plane a point is on
+ *
+ * Parameters:
+ *   p - Pointer to plane
+ *   point - Point to classify
+ *   epsilon - Thickness of the plane either side
+ *
+ * Returns:
+ *   PLANE_FRONT, PLANE_BACK or PLANE_ON
+ */
+int plane_classify_point(const plane_t *p, vector3_t point, fixed_t epsilon) {
+    fixed_t distance = plane_distance(p, point);
+
+    if (distance > epsilon) {
+        return PLANE_FRONT;
+    }
+
+    if (distance < -epsilon) {
+        return PLANE_BACK;
+    }
+
+    return PLANE_ON;
+}
+
+/*
+ * plane_intersect_segment: Find where a segment crosses a plane
+ *
+ * Parameters:
+ *   p - Pointer to plane
+ *   a, b - Segment end points
+ *   t - Receives the crossing as a fraction from a to b, or NULL
+ *
+ * Returns:
+ *   TRUE if a and b are on opposite sides or one of them touches the plane
+ *
+ * Notes:
+ *   - The crossing point is a + (b - a) * t, the same t clips any
+ *     attribute interpolated along the segment
+ */
+int plane_intersect_segment(const plane_t *p, vector3_t a, vector3_t b, fixed_t *t) {
+    fixed_t da, db;
+
+    da = plane_distance(p, a);
+    db = plane_distance(p, b);
+
+    if ((da > 0 && db > 0) || (da < 0 && db < 0)) {
+        return FALSE;
+    }
+
+    if (t != NULL) {
+        *t = (da == db) ? FIXED_ZERO : fixed_div(da, da - db);
+    }
+
+    return TRUE;
+}
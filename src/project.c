@@ -0,0 +1,124 @@
+/*
+ * project.c
+ *
+ * Implementation of the perspective divide and viewport transformation
+ *
+ * Dividing x, y and z by w separately costs three divides per vertex.
+ * Here w is inverted once at PROJECT_RECIP_SHIFT fractional bits and
+ * the clipped position is a multiply, with the viewport scale and bias
+ * applied before the value is written. Texture coordinates are not
+ * bounded by w the way clipped positions are, so u and v take their own
+ * 16.16 divide rather than overflow the extra bits past 128 texels.
+ */
+
+#include "..\include\project.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+
+/* Bits the reciprocal carries beyond 16.16 */
+#define PROJECT_EXTRA_SHIFT (PROJECT_RECIP_SHIFT - FIXED_SHIFT)
+
+/* Luma weights out of 256 for the brightness of a vertex color */
+#define PROJECT_LUMA_R 77
+#define PROJECT_LUMA_G 150
+#define PROJECT_LUMA_B 29
+
+/*
+ * viewport_init: Set up the mapping from device coordinates to pixels
+ *
+ * Parameters:
+ *   vp - Viewport to fill
+ *   x, y - Top-left pixel of the viewport
+ *   width, height - Viewport size in pixels
+ *   pixel_aspect - Width of one pixel over its height on the display
+ *
+ * Notes:
+ *   - Device x = -1 maps to the left edge of the first column and y = 1
+ *     to the top edge of the first row
+ *   - vp->aspect is what matrix_perspective needs so the clip frustum
+ *     covers exactly this viewport with undistorted proportions
+ */
+void viewport_init(viewport_t *vp, int x, int y, int width, int height, fixed_t pixel_aspect) {
+    if (vp == NULL || height <= 0) {
+        return;
+    }
+
+    vp->scale_x = fixed_from_int(width) >> 1;
+    vp->scale_y = -(fixed_from_int(height) >> 1);
+    vp->bias_x = fixed_from_int(x) + vp->scale_x;
+    vp->bias_y = fixed_from_int(y) - vp->scale_y;
+    vp->aspect = fixed_mul(fixed_from_int(width), pixel_aspect) / height;
+}
+
+/*
+ * project_vertex: Divide one vertex by w and map it to the viewport
+ *
+ * Parameters:
+ *   vp - Viewport to map into
+ *   in - Clipped vertex, w must be at least 1/128
+ *   out - Screen vertex to write
+ *
+ * Notes:
+ *   - The color's brightness is kept as a light level, 8-bit modes
+ *     shade through the palette rather than blend colors
+ *   - u / w and v / w hold up to 32767 texels, the range texspan
+ *     divides them back into
+ */
+void project_vertex(const viewport_t *vp, const clip_vertex_t *in, screen_vertex_t *out) {
+    fixed_t recip, nx, ny, nz;
+
+    recip = fixed_div(FIXED_ONE << PROJECT_EXTRA_SHIFT, in->position.w);
+
+    /* Device coordinates back at 16.16 before scaling to pixels */
+    nx = fixed_mul(in->position.x, recip) >> PROJECT_EXTRA_SHIFT;
+    ny = fixed_mul(in->position.y, recip) >> PROJECT_EXTRA_SHIFT;
+    nz = fixed_mul(in->position.z, recip) >> PROJECT_EXTRA_SHIFT;
+
+    out->x = vp->bias_x + fixed_mul(nx, vp->scale_x);
+    out->y = vp->bias_y + fixed_mul(ny, vp->scale_y);
+    out->z = (nz + FIXED_ONE) >> 1;
+
+    out->inv_w = recip >> PROJECT_EXTRA_SHIFT;
+    out->u_over_w = fixed_div(in->texcoord.u, in->position.w);
+    out->v_over_w = fixed_div(in->texcoord.v, in->position.w);
+    out->color = in->color;
+
+    /* White is exactly FIXED_ONE */
+    out->light = (fixed_t) (((long) in->color.r * PROJECT_LUMA_R +
+                             (long) in->color.g * PROJECT_LUMA_G +
+                             (long) in->color.b * PROJECT_LUMA_B) * 256 / 255);
+}
+
+/*
+ * project_polygon: Project every vertex of a clipped polygon
+ *
+ * Parameters:
+ *   vp - Viewport to map into
+ *   in - Polygon written by clip_polygon or clip_classified
+ *   count - Number of vertices
+ *   out - Screen vertices, room for count entries
+ *
+ * Returns:
+ *   Number of vertices written
+ *
+ * Notes:
+ *   - Vertices must have been clipped against at least the near plane
+ */
+int project_polygon(const viewport_t *vp,
+                    const clip_vertex_t *in,
+                    int count,
+                    screen_vertex_t *out) {
+    int i;
+
+    if (vp == NULL || in == NULL || out == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < count; i++) {
+        project_vertex(vp, &in[i], &out[i]);
+    }
+
+    return count;
+}
@@ -0,0 +1,529 @@
+/*
+ * raster.c
+ *
+ * Implementation of flat shaded scanline triangle rasterization
+ *
+ * Row n is covered by an edge from a to b when a.y <= n + 0.5 < b.y,
+ * pixel n of a row when left <= n + 0.5 < right. Both bounds round
+ * up from the pixel centre, so a shared edge computed from the same two
+ * endpoints ends one triangle's spans exactly where the next triangle's
+ * start. Edges are always walked from their upper endpoint for the same
+ * reason.
+ */
+
+#include "..\include\raster.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+#include "..\include\guard.h"
+#include "..\include\tristrip.h"
+
+/* First pixel whose centre is at or past a 16.16 coordinate */
+#define RASTER_CEIL(v) ((int) (((v) - FIXED_HALF + FIXED_ONE - 1) >> FIXED_SHIFT))
+
+/* Triangle edge being walked down the screen */
+typedef struct {
+    fixed_t x;       // Edge x at the centre of the current row
+    fixed_t step;    // Change in x per row
+    fixed_t z;       // 1 / w at the centre of the current row
+    fixed_t z_step;  // Change in 1 / w per row
+    fixed_t u;       // u / w at the centre of the current row
+    fixed_t u_step;  // Change in u / w per row
+    fixed_t v;       // v / w at the centre of the current row
+    fixed_t v_step;  // Change in v / w per row
+    fixed_t l;       // Light at the centre of the current row
+    fixed_t l_step;  // Change in light per row
+    int y;           // First row the edge covers
+    int y_end;       // One past the last row the edge covers
+} raster_edge_t;
+
+/* Destination of raster_flat_triangle spans */
+typedef struct {
+    unsigned char *buffer;
+    unsigned char color;
+} raster_flat_target_t;
+
+/*
+ * raster_edge_attr: Start an attribute at the first row of an edge
+ *
+ * Parameters:
+ *   value - Receives the attribute at the first row centre
+ *   step - Receives the change per row
+ *   a, b - Attribute at the upper and lower endpoints
+ *   prestep - Distance from the upper endpoint down to the first row centre
+ *   dy - Height of the edge
+ *
+ * Notes:
+ *   - The first value is interpolated directly rather than by the
+ *     rounded step so it is exact at the first row
+ *   - Changes too steep for the step to fit in 16.16 only happen on
+ *     edges less than one row high, they get a zero step since they
+ *     only cover one row
+ */
+static void raster_edge_attr(fixed_t *value, fixed_t *step, fixed_t a, fixed_t b, fixed_t prestep,
+                             fixed_t dy) {
+    fixed_t d = b - a;
+
+    *value = a + fixed_div(fixed_mul(d, prestep), dy);
+    *step = FIXED_ZERO;
+
+    if ((fixed_abs(d) >> 14) < dy) {
+        *step = fixed_div(d, dy);
+    }
+}
+
+/*
+ * raster_edge_setup: Prepare an edge for walking
+ *
+ * Parameters:
+ *   e - Edge to fill
+ *   a - Upper endpoint
+ *   b - Lower endpoint
+ *   attributes - RASTER_ATTR_* flags of the values to step besides x
+ *
+ * Notes:
+ *   - Attributes not asked for stay at zero
+ */
+static void raster_edge_setup(raster_edge_t *e, const screen_vertex_t *a, const screen_vertex_t *b,
+                              int attributes) {
+    fixed_t dy = b->y - a->y;
+    fixed_t prestep;
+
+    e->y = RASTER_CEIL(a->y);
+    e->y_end = RASTER_CEIL(b->y);
+    e->x = a->x;
+    e->step = FIXED_ZERO;
+    e->z = e->z_step = FIXED_ZERO;
+    e->u = e->u_step = FIXED_ZERO;
+    e->v = e->v_step = FIXED_ZERO;
+    e->l = e->l_step = FIXED_ZERO;
+
+    if (e->y_end <= e->y) {
+        return;
+    }
+
+    /* Subpixel prestep from the vertex down to the first row centre */
+    prestep = fixed_from_int(e->y) + FIXED_HALF - a->y;
+    raster_edge_attr(&e->x, &e->step, a->x, b->x, prestep, dy);
+
+    if (attributes & RASTER_ATTR_Z) {
+        raster_edge_attr(&e->z, &e->z_step, a->inv_w, b->inv_w, prestep, dy);
+    }
+
+    if (attributes & RASTER_ATTR_UV) {
+        raster_edge_attr(&e->u, &e->u_step, a->u_over_w, b->u_over_w, prestep, dy);
+        raster_edge_attr(&e->v, &e->v_step, a->v_over_w, b->v_over_w, prestep, dy);
+    }
+
+    if (attributes & RASTER_ATTR_LIGHT) {
+        raster_edge_attr(&e->l, &e->l_step, a->light, b->light, prestep, dy);
+    }
+}
+
+/*
+ * raster_edge_advance: Move an edge down a number of rows
+ */
+static void raster_edge_advance(raster_edge_t *e, int rows) {
+    e->x += e->step * rows;
+    e->z += e->z_step * rows;
+    e->u += e->u_step * rows;
+    e->v += e->v_step * rows;
+    e->l += e->l_step * rows;
+}
+
+/*
+ * raster_rows: Walk the rows between two edges
+ *
+ * Parameters:
+ *   left, right - Edges at row y0, left each advanced to row y1
+ *   y0, y1 - First row and one past the last row
+ *   emit - Span consumer
+ *   context - Passed through to emit
+ *
+ * Returns:
+ *   Number of pixels emitted
+ */
+static long raster_rows(raster_edge_t *left,
+                        raster_edge_t *right,
+                        int y0,
+                        int y1,
+                        raster_span_fn emit,
+                        void *context) {
+    raster_span_t span;
+    long pixels = 0;
+    int first = y0, last = y1;
+
+    if (y1 <= y0) {
+        return 0;
+    }
+
+    if (!guard_scissor_rows(&first, &last)) {
+        raster_edge_advance(left, y1 - y0);
+        raster_edge_advance(right, y1 - y0);
+        return 0;
+    }
+
+    raster_edge_advance(left, first - y0);
+    raster_edge_advance(right, first - y0);
+
+    for (span.y = first; span.y < last; span.y++) {
+        span.x0 = RASTER_CEIL(left->x);
+        span.x1 = RASTER_CEIL(right->x);
+
+        if (guard_scissor_span(&span.x0, &span.x1)) {
+            span.left_x = left->x;
+            span.right_x = right->x;
+            span.left_z = left->z;
+            span.right_z = right->z;
+            span.left_u = left->u;
+            span.right_u = right->u;
+            span.left_v = left->v;
+            span.right_v = right->v;
+            span.left_light = left->l;
+            span.right_light = right->l;
+            emit(context, &span);
+            pixels += span.x1 - span.x0;
+        }
+
+        raster_edge_advance(left, 1);
+        raster_edge_advance(right, 1);
+    }
+
+    raster_edge_advance(left, y1 - last);
+    raster_edge_advance(right, y1 - last);
+
+    return pixels;
+}
+
+/*
+ * raster_emit_flat: Fill one span with the target color
+ */
+static void raster_emit_flat(void *context, const raster_span_t *span) {
+    raster_flat_target_t *target = (raster_flat_target_t *) context;
+
+    raster_fill_span(target->buffer + span->y * SCREEN_WIDTH + span->x0, span->x1 - span->x0,
+                     target->color);
+}
+
+/*
+ * raster_fill_span: Fill a run of pixels with one color
+ *
+ * Parameters:
+ *   dst - First pixel
+ *   count - Number of pixels
+ *   color - Palette index
+ *
+ * Notes:
+ *   - Aligns to a long and then stores a long at a time, four pixels per
+ *     store on the 486, the same work rep stosd does
+ */
+void raster_fill_span(unsigned char *dst, int count, unsigned char color) {
+    unsigned long pattern, *words;
+
+    /* Leading pixels up to long alignment */
+    while (count > 0 && ((unsigned long) dst & (sizeof(unsigned long) - 1)) != 0) {
+        *dst++ = color;
+        count--;
+    }
+
+    if (count >= (int) sizeof(unsigned long)) {
+        pattern = color * (~0UL / 0xFF);
+        words = (unsigned long *) dst;
+
+        while (count >= (int) sizeof(unsigned long)) {
+            *words++ = pattern;
+            count -= sizeof(unsigned long);
+        }
+
+        dst = (unsigned char *) words;
+    }
+
+    while (count > 0) {
+        *dst++ = color;
+        count--;
+    }
+}
+
+/*
+ * raster_sort_y: Order three vertices top to bottom
+ *
+ * Parameters:
+ *   p - Vertices to sort in place, p[0] ends up the top one
+ */
+static void raster_sort_y(const screen_vertex_t **p) {
+    const screen_vertex_t *t;
+
+    if (p[1]->y < p[0]->y) {
+        t = p[0];
+        p[0] = p[1];
+        p[1] = t;
+    }
+
+    if (p[2]->y < p[1]->y) {
+        t = p[1];
+        p[1] = p[2];
+        p[2] = t;
+
+        if (p[1]->y < p[0]->y) {
+            t = p[0];
+            p[0] = p[1];
+            p[1] = t;
+        }
+    }
+}
+
+/*
+ * raster_walk_edges: Walk a triangle whose edges are already set up
+ *
+ * Parameters:
+ *   a, b, c - Vertices sorted top to bottom
+ *   major - Edge from a to c
+ *   upper - Edge from a to b
+ *   lower - Edge from b to c
+ *   emit - Span consumer
+ *   context - Passed through to emit
+ *
+ * Returns:
+ *   Number of pixels emitted
+ *
+ * Notes:
+ *   - The edges are advanced as they are walked
+ */
+static long raster_walk_edges(const screen_vertex_t *a,
+                              const screen_vertex_t *b,
+                              const screen_vertex_t *c,
+                              raster_edge_t *major,
+                              raster_edge_t *upper,
+                              raster_edge_t *lower,
+                              raster_span_fn emit,
+                              void *context) {
+    fixed_t split;
+    long pixels;
+
+    if (major->y_end <= major->y) {
+        return 0;
+    }
+
+    /* x of the long edge level with the middle vertex decides its side */
+    split = a->x + fixed_mul(c->x - a->x, fixed_div(b->y - a->y, c->y - a->y));
+
+    if (b->x < split) {
+        pixels = raster_rows(upper, major, upper->y, upper->y_end, emit, context);
+        pixels += raster_rows(lower, major, lower->y, lower->y_end, emit, context);
+    } else {
+        pixels = raster_rows(major, upper, upper->y, upper->y_end, emit, context);
+        pixels += raster_rows(major, lower, lower->y, lower->y_end, emit, context);
+    }
+
+    return pixels;
+}
+
+/*
+ * raster_walk_triangle: Walk a triangle row by row
+ *
+ * Parameters:
+ *   v0, v1, v2 - Projected vertices in either winding
+ *   attributes - RASTER_ATTR_* flags of the values spans need
+ *   emit - Called once for every row with pixels on screen
+ *   context - Passed through to emit
+ *
+ * Returns:
+ *   Number of pixels covered on screen
+ *
+ * Notes:
+ *   - Vertices may lie anywhere in the guard band, rows and spans are
+ *     scissored to the screen before they are emitted
+ *   - Every consumer sees exactly the coverage raster_flat_triangle draws
+ *   - Each attribute costs two divides per edge, so only the ones asked
+ *     for are stepped, the rest read as zero
+ */
+long raster_walk_triangle(const screen_vertex_t *v0,
+                          const screen_vertex_t *v1,
+                          const screen_vertex_t *v2,
+                          int attributes,
+                          raster_span_fn emit,
+                          void *context) {
+    const screen_vertex_t *p[3];
+    raster_edge_t major, upper, lower;
+
+    if (v0 == NULL || v1 == NULL || v2 == NULL || emit == NULL) {
+        return 0;
+    }
+
+    p[0] = v0;
+    p[1] = v1;
+    p[2] = v2;
+    raster_sort_y(p);
+
+    raster_edge_setup(&major, p[0], p[2], attributes);
+
+    if (major.y_end <= major.y) {
+        return 0;
+    }
+
+    raster_edge_setup(&upper, p[0], p[1], attributes);
+    raster_edge_setup(&lower, p[1], p[2], attributes);
+
+    return raster_walk_edges(p[0], p[1], p[2], &major, &upper, &lower, emit, context);
+}
+
+/*
+ * raster_walk_strip: Walk every triangle of a strip or fan row by row
+ *
+ * Parameters:
+ *   v - Projected vertices in strip or fan order
+ *   count - Number of vertices, count - 2 triangles
+ *   type - TRISTRIP_STRIP or TRISTRIP_FAN
+ *   attributes - RASTER_ATTR_* flags of the values spans need
+ *   emit - Called once for every row with pixels on screen
+ *   context - Passed through to emit
+ *
+ * Returns:
+ *   Number of pixels covered on screen
+ *
+ * Notes:
+ *   - Covers exactly what walking each triangle on its own would
+ *   - The edge a triangle shares with the next one, i+1 to i+2 in a
+ *     strip and 0 to i+2 in a fan, is set up once and copied, so each
+ *     triangle after the first sets up two edges instead of three
+ */
+long raster_walk_strip(const screen_vertex_t *v,
+                       int count,
+                       int type,
+                       int attributes,
+                       raster_span_fn emit,
+                       void *context) {
+    static const int ends[3][2] = {{0, 2}, {0, 1}, {1, 2}};
+    const screen_vertex_t *p[3], *a, *b, *keep_a, *keep_b;
+    const screen_vertex_t *shared_a = NULL, *shared_b = NULL;
+    raster_edge_t edges[3], shared;
+    long pixels = 0;
+    int i, k;
+
+    if (v == NULL || emit == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i + 2 < count; i++) {
+        p[0] = (type == TRISTRIP_FAN) ? &v[0] : &v[i];
+        p[1] = &v[i + 1];
+        p[2] = &v[i + 2];
+        raster_sort_y(p);
+
+        /* Major, upper and lower edges, walked from their upper endpoint */
+        for (k = 0; k < 3; k++) {
+            a = p[ends[k][0]];
+            b = p[ends[k][1]];
+
+            if (a == shared_a && b == shared_b) {
+                edges[k] = shared;
+            } else {
+                raster_edge_setup(&edges[k], a, b, attributes);
+            }
+        }
+
+        /* Keep the edge the next triangle has too, before walking moves it */
+        keep_a = (type == TRISTRIP_FAN) ? &v[0] : &v[i + 1];
+        keep_b = &v[i + 2];
+        shared_a = shared_b = NULL;
+
+        for (k = 0; k < 3; k++) {
+            a = p[ends[k][0]];
+            b = p[ends[k][1]];
+
+            if ((a == keep_a && b == keep_b) || (a == keep_b && b == keep_a)) {
+                shared = edges[k];
+                shared_a = a;
+                shared_b = b;
+            }
+        }
+
+        pixels += raster_walk_edges(p[0], p[1], p[2], &edges[0], &edges[1], &edges[2], emit,
+                                    context);
+    }
+
+    return pixels;
+}
+
+/*
+ * raster_flat_triangle: Draw a flat shaded triangle
+ *
+ * Parameters:
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   v0, v1, v2 - Projected vertices in either winding
+ *   color - Palette index
+ *
+ * Returns:
+ *   Number of pixels written
+ */
+long raster_flat_triangle(unsigned char *buffer,
+                          const screen_vertex_t *v0,
+                          const screen_vertex_t *v1,
+                          const screen_vertex_t *v2,
+                          unsigned char color) {
+    raster_flat_target_t target;
+
+    if (buffer == NULL) {
+        return 0;
+    }
+
+    target.buffer = buffer;
+    target.color = color;
+
+    return raster_walk_triangle(v0, v1, v2, 0, raster_emit_flat, &target);
+}
+
+/*
+ * raster_flat_strip: Draw a flat shaded strip or fan
+ *
+ * Parameters:
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   v - Projected vertices in strip or fan order
+ *   count - Number of vertices
+ *   type - TRISTRIP_STRIP or TRISTRIP_FAN
+ *   color - Palette index
+ *
+ * Returns:
+ *   Number of pixels written
+ */
+long raster_flat_strip(unsigned char *buffer,
+                       const screen_vertex_t *v,
+                       int count,
+                       int type,
+                       unsigned char color) {
+    raster_flat_target_t target;
+
+    if (buffer == NULL) {
+        return 0;
+    }
+
+    target.buffer = buffer;
+    target.color = color;
+
+    return raster_walk_strip(v, count, type, 0, raster_emit_flat, &target);
+}
+
+/*
+ * raster_flat_polygon: Draw a flat shaded convex polygon
+ *
+ * Parameters:
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   v - Vertices written by project_polygon
+ *   count - Number of vertices
+ *   color - Palette index
+ *
+ * Returns:
+ *   Number of pixels written
+ *
+ * Notes:
+ *   - Drawn as a fan from the first vertex, the fill rule keeps the
+ *     internal edges from being written twice and each internal edge
+ *     is only set up once
+ */
+long raster_flat_polygon(unsigned char *buffer,
+                         const screen_vertex_t *v,
+                         int count,
+                         unsigned char color) {
+    return raster_flat_strip(buffer, v, count, TRISTRIP_FAN, color);
+}
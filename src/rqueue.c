@@ -0,0 +1,270 @@
+/*
+ * rqueue.c
+ *
+ * Implementation of the render state sorting queue
+ *
+ * Key layout, opaque triangles (bit 31 clear):
+ *   bits 24-30 render mode, bits 16-23 texture id, bits 0-15 depth
+ * Ordered triangles (bit 31 set):
+ *   bits 15-30 inverted depth, bits 8-14 render mode, bits 0-7 texture id
+ *
+ * Opaque triangles therefore group by mode then texture and run front to
+ * back inside a group. Ordered triangles come after all opaque ones and
+ * run back to front, with state only breaking ties at equal depth.
+ */
+
+#include "..\include\rqueue.h"
+
+#include <string.h>
+
+#include "..\include\defs.h"
+
+/* Key fields */
+#define RQUEUE_KEY_ORDERED 0x80000000UL
+#define RQUEUE_DEPTH_MAX   0xFFFFL
+
+/*
+ * rqueue_texture_id: Find or assign the small id for a texture
+ *
+ * Parameters:
+ *   q - Pointer to queue owning the id table
+ *   texture - Texture to look up, NULL maps to RQUEUE_TEXTURE_NONE
+ *
+ * Returns:
+ *   Texture id, RQUEUE_TEXTURE_OVERFLOW if the table is full
+ *
+ * Notes:
+ *   - Textures past the table still group apart from missing ones, they
+ *     just share one bucket among themselves
+ */
+static unsigned long rqueue_texture_id(rqueue_t *q, const texture_t *texture) {
+    int i;
+
+    if (texture == NULL) {
+        return RQUEUE_TEXTURE_NONE;
+    }
+
+    for (i = 1; i <= q->texture_count; i++) {
+        if (q->textures[i] == texture) {
+            return (unsigned long) i;
+        }
+    }
+
+    if (q->texture_count == RQUEUE_MAX_TEXTURES) {
+        return RQUEUE_TEXTURE_OVERFLOW;
+    }
+
+    q->textures[++q->texture_count] = texture;
+
+    return (unsigned long) q->texture_count;
+}
+
+/*
+ * rqueue_state_differs: Check if drawing b after a needs a state change
+ *
+ * Parameters:
+ *   a, b - Triangles drawn one after the other
+ *
+ * Returns:
+ *   TRUE if the inner loop or texture must change between them
+ */
+static int rqueue_state_differs(const triangle_t *a, const triangle_t *b) {
+    if (a->render_mode != b->render_mode) {
+        return TRUE;
+    }
+
+    /* Flat triangles ignore their texture pointer */
+    return (a->render_mode == TRIANGLE_TEXTURED && a->texture != b->texture);
+}
+
+/*
+ * rqueue_init: Attach entry storage to a render queue
+ *
+ * Parameters:
+ *   q - Pointer to queue to initialize
+ *   entries - Entry array
+ *   scratch - Second entry array of the same size used while sorting
+ *   capacity - Number of entries in each array
+ *
+ * Notes:
+ *   - Texture ids persist across rqueue_clear calls
+ */
+void rqueue_init(rqueue_t *q, rqueue_entry_t *entries, rqueue_entry_t *scratch, int capacity) {
+    if (q == NULL) {
+        return;
+    }
+
+    q->entries = entries;
+    q->scratch = scratch;
+    q->capacity = capacity;
+    q->texture_count = 0;
+    q->textures[0] = NULL;
+
+    rqueue_clear(q);
+}
+
+/*
+ * rqueue_clear: Empty the queue for a new frame
+ *
+ * Parameters:
+ *   q - Pointer to queue to clear
+ */
+void rqueue_clear(rqueue_t *q) {
+    if (q == NULL) {
+        return;
+    }
+
+    q->count = 0;
+    q->stats.submitted = 0;
+    q->stats.changes_before = 0;
+    q->stats.changes_after = 0;
+}
+
+/*
+ * rqueue_add: Submit a triangle for drawing
+ *
+ * Parameters:
+ *   q - Pointer to queue
+ *   t - Triangle to draw, must stay valid until the queue is drawn
+ *   depth - View space depth of the triangle, larger is further away
+ *   flags - RQUEUE_OPAQUE or RQUEUE_ORDERED
+ *
+ * Returns:
+ *   TRUE if the triangle was queued, FALSE if the queue is full
+ *
+ * Notes:
+ *   - Depth is kept to 8.8 precision, further than 256 units all sort equal
+ */
+int rqueue_add(rqueue_t *q, const triangle_t *t, fixed_t depth, int flags) {
+    unsigned long key, mode, texture_id;
+    fixed_t d;
+
+    if (q == NULL || t == NULL || q->count >= q->capacity) {
+        return FALSE;
+    }
+
+    /* Quantize depth to 16 bits */
+    d = depth >> RQUEUE_DEPTH_SHIFT;
+
+    if (d < 0) {
+        d = 0;
+    } else if (d > RQUEUE_DEPTH_MAX) {
+        d = RQUEUE_DEPTH_MAX;
+    }
+
+    mode = (unsigned long) t->render_mode & 0x7F;
+    texture_id =
+        (mode == TRIANGLE_TEXTURED) ? rqueue_texture_id(q, t->texture) : RQUEUE_TEXTURE_NONE;
+
+    if (flags & RQUEUE_ORDERED) {
+        key = RQUEUE_KEY_ORDERED | ((unsigned long) (RQUEUE_DEPTH_MAX - d) << 15) |
+              (mode << 8) | texture_id;
+    } else {
+        key = (mode << 24) | (texture_id << 16) | (unsigned long) d;
+    }
+
+    q->entries[q->count].key = key;
+    q->entries[q->count].tri = t;
+    q->count++;
+    q->stats.submitted++;
+
+    return TRUE;
+}
+
+/*
+ * rqueue_sort: Sort queued triangles by their keys
+ *
+ * Parameters:
+ *   q - Pointer to queue to sort
+ *
+ * Notes:
+ *   - LSD radix sort with four 8-bit counting passes, stable, no compares
+ *   - A pass is skipped when every key has the same byte in that position,
+ *     so frames with few textures and depths often need two passes
+ *   - The sorted result is left in q->entries, which may swap with q->scratch
+ *   - Fills in the before and after state change counts
+ *   - The digit counts are static rather than on the stack, so this is
+ *     not reentrant
+ */
+void rqueue_sort(rqueue_t *q) {
+    static unsigned int counts[256];
+    unsigned int offset, total;
+    rqueue_entry_t *src, *dst, *swap;
+    int pass, shift, i;
+    unsigned int digit;
+
+    if (q == NULL || q->scratch == NULL) {
+        return;
+    }
+
+    q->stats.changes_before = rqueue_count_state_changes(q);
+
+    src = q->entries;
+    dst = q->scratch;
+
+    for (pass = 0; pass < 4; pass++) {
+        shift = pass * 8;
+
+        memset(counts, 0, sizeof(counts));
+
+        for (i = 0; i < q->count; i++) {
+            counts[(src[i].key >> shift) & 0xFF]++;
+        }
+
+        /* All keys share this byte, order is already right */
+        if (q->count == 0 || counts[(src[0].key >> shift) & 0xFF] == (unsigned int) q->count) {
+            continue;
+        }
+
+        /* Turn counts into starting offsets */
+        total = 0;
+
+        for (i = 0; i < 256; i++) {
+            offset = counts[i];
+            counts[i] = total;
+            total += offset;
+        }
+
+        for (i = 0; i < q->count; i++) {
+            digit = (unsigned int) ((src[i].key >> shift) & 0xFF);
+            dst[counts[digit]++] = src[i];
+        }
+
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    q->entries = src;
+    q->scratch = dst;
+
+    q->stats.changes_after = rqueue_count_state_changes(q);
+}
+
+/*
+ * rqueue_count_state_changes: Count state changes in current queue order
+ *
+ * Parameters:
+ *   q - Pointer to queue
+ *
+ * Returns:
+ *   Number of times the mode or texture must be set to draw the queue,
+ *   including the initial set for the first triangle
+ */
+int rqueue_count_state_changes(const rqueue_t *q) {
+    int i, changes;
+
+    if (q == NULL || q->count == 0) {
+        return 0;
+    }
+
+    changes = 1;
+
+    for (i = 1; i < q->count; i++) {
+        if (rqueue_state_differs(q->entries[i - 1].tri, q->entries[i].tri)) {
+            changes++;
+        }
+    }
+
+    return changes;
+}
@@ -0,0 +1,478 @@
+/*
+ * sbuffer.c
+ *
+ * Implementation of span buffer hidden surface removal
+ *
+ * 1/w is linear in screen x, so the depth difference between a new
+ * span and an existing one is linear over their overlap. The new span
+ * is therefore in front over all of it, none of it, or one side of a
+ * single crossing pixel, found with one divide. Spans cut away entirely
+ * go on a free list so a frame of heavy overdraw does not drain the
+ * pool.
+ */
+
+#include "..\include\sbuffer.h"
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "..\include\defs.h"
+
+/* A span being inserted, with the running state of the insertion */
+typedef struct {
+    int x0;               // First pixel of the whole span
+    fixed_t z;            // 1 / w at pixel x0
+    fixed_t dz;           // Change in 1 / w per pixel
+    unsigned char color;  // Palette index
+    int last;             // Node holding the span's previous visible piece
+    int visible;          // Pixels of the span left visible
+} sbuffer_insert_t;
+
+/* Destination of sbuffer_add_triangle rows */
+typedef struct {
+    sbuffer_t *sb;        // Span buffer being filled
+    unsigned char color;  // Palette index of the triangle
+    long visible;         // Pixels of the triangle left visible
+} sbuffer_target_t;
+
+/*
+ * sbuffer_z_at: 1/w of a stored span at a pixel
+ */
+static fixed_t sbuffer_z_at(const sbuffer_span_t *s, int x) {
+    return s->z + s->dz * (x - s->x0);
+}
+
+/*
+ * sbuffer_alloc: Take a span from the free list or the pool
+ *
+ * Returns:
+ *   Span index, SBUFFER_NONE if the pool is exhausted
+ */
+static int sbuffer_alloc(sbuffer_t *sb) {
+    int node;
+
+    if (sb->free_list != SBUFFER_NONE) {
+        node = sb->free_list;
+        sb->free_list = sb->pool[node].next;
+        return node;
+    }
+
+    if (sb->used >= sb->pool_size) {
+        sb->stats.overflow++;
+        return SBUFFER_NONE;
+    }
+
+    return sb->used++;
+}
+
+/*
+ * sbuffer_release: Put a span on the free list
+ */
+static void sbuffer_release(sbuffer_t *sb, int node) {
+    sb->pool[node].next = (short) sb->free_list;
+    sb->free_list = node;
+}
+
+/*
+ * sbuffer_extends: Whether a piece at link continues the span's previous piece
+ */
+static int sbuffer_extends(const sbuffer_t *sb, const short *link, const sbuffer_insert_t *ins,
+                           int x0) {
+    return ins->last != SBUFFER_NONE && link == &sb->pool[ins->last].next &&
+           sb->pool[ins->last].x1 == x0;
+}
+
+/*
+ * sbuffer_reserve: Take the nodes needed to cut a stored span around a piece
+ *
+ * Parameters:
+ *   sb - Span buffer
+ *   link - Link field holding the stored span
+ *   ins - Span being inserted
+ *   x, end - Pixels of the piece, inside the stored span
+ *   piece - Receives the node for the piece
+ *   tail - Receives the node for the stored span's part right of the piece
+ *
+ * Returns:
+ *   1 if every node needed was taken, 0 if the pool ran short
+ *
+ * Notes:
+ *   - Nodes that are not needed are returned as SBUFFER_NONE, and nothing
+ *     is kept when the pool runs short
+ */
+static int sbuffer_reserve(sbuffer_t *sb, const short *link, const sbuffer_insert_t *ins, int x,
+                           int end, int *piece, int *tail) {
+    const sbuffer_span_t *e = &sb->pool[*link];
+
+    *piece = SBUFFER_NONE;
+    *tail = SBUFFER_NONE;
+
+    /* A stored span covered whole frees its own node for the piece */
+    if (e->x0 == x && e->x1 == end) {
+        return 1;
+    }
+
+    if (!sbuffer_extends(sb, link, ins, x)) {
+        *piece = sbuffer_alloc(sb);
+
+        if (*piece == SBUFFER_NONE) {
+            return 0;
+        }
+    }
+
+    if (e->x0 < x && end < e->x1) {
+        *tail = sbuffer_alloc(sb);
+
+        if (*tail == SBUFFER_NONE) {
+            if (*piece != SBUFFER_NONE) {
+                sbuffer_release(sb, *piece);
+                *piece = SBUFFER_NONE;
+            }
+
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * sbuffer_link_piece: Link a visible piece of the inserted span into a row
+ *
+ * Parameters:
+ *   sb - Span buffer
+ *   link - Link field the piece goes in front of
+ *   ins - Span being inserted
+ *   x0, x1 - Pixels of the piece
+ *   node - Node reserved for the piece, SBUFFER_NONE to take one
+ *
+ * Returns:
+ *   Link field following the piece
+ *
+ * Notes:
+ *   - A piece directly after the span's previous piece extends it
+ *     instead of using another node
+ */
+static short *sbuffer_link_piece(sbuffer_t *sb, short *link, sbuffer_insert_t *ins, int x0,
+                                 int x1, int node) {
+    sbuffer_span_t *s;
+
+    ins->visible += x1 - x0;
+
+    if (sbuffer_extends(sb, link, ins, x0)) {
+        sb->pool[ins->last].x1 = (short) x1;
+        return link;
+    }
+
+    if (node == SBUFFER_NONE) {
+        node = sbuffer_alloc(sb);
+    }
+
+    if (node == SBUFFER_NONE) {
+        ins->visible -= x1 - x0;
+        return link;
+    }
+
+    s = &sb->pool[node];
+    s->x0 = (short) x0;
+    s->x1 = (short) x1;
+    s->z = ins->z + ins->dz * (x0 - ins->x0);
+    s->dz = ins->dz;
+    s->color = ins->color;
+    s->next = *link;
+    *link = (short) node;
+    ins->last = node;
+
+    return &s->next;
+}
+
+/*
+ * sbuffer_init: Attach a span pool to a span buffer and clear it
+ *
+ * Parameters:
+ *   sb - Span buffer to initialize
+ *   pool - Span storage, owned by the caller
+ *   pool_size - Number of spans in pool, at most 32767
+ */
+void sbuffer_init(sbuffer_t *sb, sbuffer_span_t *pool, int pool_size) {
+    if (sb == NULL) {
+        return;
+    }
+
+    sb->pool = pool;
+    sb->pool_size = pool_size;
+    sbuffer_clear(sb);
+}
+
+/*
+ * sbuffer_clear: Empty every row and reset the counts for a new frame
+ *
+ * Parameters:
+ *   sb - Span buffer to clear
+ */
+void sbuffer_clear(sbuffer_t *sb) {
+    int y;
+
+    if (sb == NULL) {
+        return;
+    }
+
+    for (y = 0; y < SCREEN_HEIGHT; y++) {
+        sb->head[y] = SBUFFER_NONE;
+    }
+
+    sb->used = 0;
+    sb->free_list = SBUFFER_NONE;
+
+    sb->stats.inserted = 0;
+    sb->stats.clipped = 0;
+    sb->stats.rejected = 0;
+    sb->stats.overflow = 0;
+    sb->stats.pixels_in = 0;
+    sb->stats.pixels_out = 0;
+}
+
+/*
+ * sbuffer_insert: Add a span, keeping only the parts nearer than what is there
+ *
+ * Parameters:
+ *   sb - Span buffer
+ *   y - Row, 0 to SCREEN_HEIGHT - 1
+ *   x0, x1 - First pixel and one past the last, inside the screen
+ *   z - 1 / w at the centre of pixel x0, larger is nearer
+ *   dz - Change in 1 / w per pixel
+ *   color - Palette index
+ *
+ * Returns:
+ *   Number of pixels of the span left visible
+ *
+ * Notes:
+ *   - Where depths are equal the span already in the buffer wins
+ *   - Parts of older spans the new one hides are cut away, so the
+ *     result does not depend on the order spans arrive in
+ *   - When the pool runs short a stored span is never cut, the new span
+ *     loses the piece in front of it instead
+ */
+int sbuffer_insert(sbuffer_t *sb, int y, int x0, int x1, fixed_t z, fixed_t dz,
+                   unsigned char color) {
+    sbuffer_insert_t ins;
+    sbuffer_span_t *e;
+    short *link;
+    fixed_t d0, d1, dd;
+    int cur, piece, tail, x, end, k;
+
+    if (sb == NULL || y < 0 || y >= SCREEN_HEIGHT || x0 >= x1) {
+        return 0;
+    }
+
+    ins.x0 = x0;
+    ins.z = z;
+    ins.dz = dz;
+    ins.color = color;
+    ins.last = SBUFFER_NONE;
+    ins.visible = 0;
+
+    link = &sb->head[y];
+    x = x0;
+
+    while (x < x1) {
+        cur = *link;
+
+        /* Nothing left on the row under the rest of the span */
+        if (cur == SBUFFER_NONE || sb->pool[cur].x0 >= x1) {
+            sbuffer_link_piece(sb, link, &ins, x, x1, SBUFFER_NONE);
+            break;
+        }
+
+        e = &sb->pool[cur];
+
+        if (e->x1 <= x) {
+            link = &e->next;
+            continue;
+        }
+
+        /* Uncovered gap before the next stored span */
+        if (e->x0 > x) {
+            link = sbuffer_link_piece(sb, link, &ins, x, e->x0, SBUFFER_NONE);
+            x = e->x0;
+            continue;
+        }
+
+        end = (e->x1 < x1) ? e->x1 : x1;
+        d0 = ins.z + ins.dz * (x - x0) - sbuffer_z_at(e, x);
+        d1 = ins.z + ins.dz * (end - 1 - x0) - sbuffer_z_at(e, end - 1);
+
+        /* Depths cross, shorten the overlap to the part on one side */
+        if ((d0 > 0) != (d1 > 0)) {
+            dd = ins.dz - e->dz;
+
+            if (d0 > 0) {
+                k = (int) ((d0 - dd - 1) / -dd);
+            } else {
+                k = (int) (-d0 / dd) + 1;
+            }
+
+            if (k < 1) {
+                k = 1;
+            } else if (k > end - x - 1) {
+                k = end - x - 1;
+            }
+
+            end = x + k;
+        }
+
+        /* Hidden behind the stored span, or no nodes left to cut it with */
+        if (d0 <= 0 || !sbuffer_reserve(sb, link, &ins, x, end, &piece, &tail)) {
+            x = end;
+
+            if (end == e->x1) {
+                link = &e->next;
+            }
+
+            continue;
+        }
+
+        /* In front, cut the stored span back around [x, end) */
+        if (e->x0 < x) {
+            if (tail != SBUFFER_NONE) {
+                sb->pool[tail] = *e;
+                sb->pool[tail].z = sbuffer_z_at(e, end);
+                sb->pool[tail].x0 = (short) end;
+                e->next = (short) tail;
+            }
+
+            e->x1 = (short) x;
+            link = &e->next;
+        } else if (end < e->x1) {
+            e->z = sbuffer_z_at(e, end);
+            e->x0 = (short) end;
+        } else {
+            /* Completely covered, release it */
+            *link = e->next;
+            sbuffer_release(sb, cur);
+        }
+
+        link = sbuffer_link_piece(sb, link, &ins, x, end, piece);
+        x = end;
+    }
+
+    sb->stats.inserted++;
+    sb->stats.pixels_in += x1 - x0;
+
+    if (ins.visible == 0) {
+        sb->stats.rejected++;
+    } else if (ins.visible < x1 - x0) {
+        sb->stats.clipped++;
+    }
+
+    return ins.visible;
+}
+
+/*
+ * sbuffer_emit: Insert one rasterized row, raster_span_fn for sbuffer_add_triangle
+ */
+static void sbuffer_emit(void *context, const raster_span_t *span) {
+    sbuffer_target_t *target = (sbuffer_target_t *) context;
+    fixed_t width = span->right_x - span->left_x;
+    fixed_t dz = FIXED_ZERO, z;
+
+    /* Spans under a pixel wide keep a flat depth rather than a huge slope */
+    if (width > FIXED_ONE) {
+        dz = fixed_div(span->right_z - span->left_z, width);
+    }
+
+    z = span->left_z + fixed_mul(dz, fixed_from_int(span->x0) + FIXED_HALF - span->left_x);
+    target->visible += sbuffer_insert(target->sb, span->y, span->x0, span->x1, z, dz,
+                                      target->color);
+}
+
+/*
+ * sbuffer_add_triangle: Insert every row of a projected triangle
+ *
+ * Parameters:
+ *   sb - Span buffer
+ *   v0, v1, v2 - Projected vertices, inv_w gives the depth
+ *   color - Palette index
+ *
+ * Returns:
+ *   Number of the triangle's pixels left visible
+ *
+ * Notes:
+ *   - Rows are produced by raster_walk_triangle, so coverage matches
+ *     raster_flat_triangle pixel for pixel
+ */
+long sbuffer_add_triangle(sbuffer_t *sb,
+                          const screen_vertex_t *v0,
+                          const screen_vertex_t *v1,
+                          const screen_vertex_t *v2,
+                          unsigned char color) {
+    sbuffer_target_t target;
+
+    if (sb == NULL) {
+        return 0;
+    }
+
+    target.sb = sb;
+    target.color = color;
+    target.visible = 0;
+
+    raster_walk_triangle(v0, v1, v2, RASTER_ATTR_Z, sbuffer_emit, &target);
+
+    return target.visible;
+}
+
+/*
+ * sbuffer_flush: Draw every stored span
+ *
+ * Parameters:
+ *   sb - Span buffer
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *
+ * Returns:
+ *   Number of pixels written
+ *
+ * Notes:
+ *   - Each covered pixel is written once, uncovered pixels are untouched
+ */
+long sbuffer_flush(sbuffer_t *sb, unsigned char *buffer) {
+    const sbuffer_span_t *s;
+    unsigned char *row;
+    long pixels = 0;
+    int y, node;
+
+    if (sb == NULL || buffer == NULL) {
+        return 0;
+    }
+
+    row = buffer;
+
+    for (y = 0; y < SCREEN_HEIGHT; y++) {
+        for (node = sb->head[y]; node != SBUFFER_NONE; node = s->next) {
+            s = &sb->pool[node];
+            raster_fill_span(row + s->x0, s->x1 - s->x0, s->color);
+            pixels += s->x1 - s->x0;
+        }
+
+        row += SCREEN_WIDTH;
+    }
+
+    sb->stats.pixels_out += pixels;
+
+    return pixels;
+}
+
+/*
+ * sbuffer_stats_print: Print span buffer counts to console for debugging
+ *
+ * Parameters:
+ *   stats - Pointer to counts to print
+ */
+void sbuffer_stats_print(const sbuffer_stats_t *stats) {
+    printf("Span buffer:\n");
+    printf("  Inserted:   %ld\n", stats->inserted);
+    printf("  Clipped:    %ld\n", stats->clipped);
+    printf("  Rejected:   %ld\n", stats->rejected);
+    printf("  Overflow:   %ld\n", stats->overflow);
+    printf("  Pixels in:  %ld\n", stats->pixels_in);
+    printf("  Pixels out: %ld\n", stats->pixels_out);
+}
@@ -0,0 +1,239 @@
+/*
+ * shade.c
+ *
+ * Implementation of Gouraud shading through palette shade ramps
+ *
+ * Light is interpolated in screen space rather than perspective
+ * corrected. It changes slowly across a surface and is quantized to
+ * SHADE_LEVELS steps anyway, so the difference is not visible and the
+ * spans need no divide.
+ */
+
+#include "..\include\shade.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+#include "..\include\raster.h"
+
+/* Destination of shade_gouraud_triangle spans */
+typedef struct {
+    unsigned char *buffer;     // Surface to draw into
+    const shade_ramp_t *ramp;  // Ramp of the triangle's base color
+} shade_target_t;
+
+/*
+ * shade_level: Clamp a light level and scale it to ramp entries
+ *
+ * Parameters:
+ *   light - Light level, 0 to FIXED_ONE
+ *
+ * Returns:
+ *   Ramp entry with 16 fractional bits, 0 to SHADE_LEVELS - 1
+ */
+static fixed_t shade_level(fixed_t light) {
+    if (light <= 0) {
+        return FIXED_ZERO;
+    }
+
+    if (light >= FIXED_ONE) {
+        return fixed_from_int(SHADE_LEVELS - 1);
+    }
+
+    return light * (SHADE_LEVELS - 1);
+}
+
+/*
+ * shade_nearest: Find the palette entry closest to a color
+ *
+ * Parameters:
+ *   palette - 256 colors
+ *   r, g, b - Color to match, 0 to 255
+ *
+ * Returns:
+ *   Index with the smallest squared distance, the lowest on ties
+ *
+ * Notes:
+ *   - Searches all 256 entries, meant for building tables at load time
+ */
+unsigned char shade_nearest(const color_t *palette, int r, int g, int b) {
+    long best = 0x7FFFFFFFL, dist;
+    int i, dr, dg, db, found = 0;
+
+    if (palette == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < 256; i++) {
+        dr = palette[i].r - r;
+        dg = palette[i].g - g;
+        db = palette[i].b - b;
+        dist = (long) dr * dr + (long) dg * dg + (long) db * db;
+
+        if (dist < best) {
+            best = dist;
+            found = i;
+
+            if (dist == 0) {
+                break;
+            }
+        }
+    }
+
+    return (unsigned char) found;
+}
+
+/*
+ * shade_build_ramp: Build the shade ramp of one palette color
+ *
+ * Parameters:
+ *   ramp - Ramp to fill
+ *   palette - 256 colors
+ *   base - Palette index of the fully lit color
+ *
+ * Notes:
+ *   - Level 0 is the entry nearest black, the last level is base itself
+ */
+void shade_build_ramp(shade_ramp_t *ramp, const color_t *palette, unsigned char base) {
+    const color_t *c;
+    int level;
+
+    if (ramp == NULL || palette == NULL) {
+        return;
+    }
+
+    c = &palette[base];
+
+    for (level = 0; level < SHADE_LEVELS - 1; level++) {
+        ramp->index[level] = shade_nearest(palette,
+                                           c->r * level / (SHADE_LEVELS - 1),
+                                           c->g * level / (SHADE_LEVELS - 1),
+                                           c->b * level / (SHADE_LEVELS - 1));
+    }
+
+    ramp->index[SHADE_LEVELS - 1] = base;
+}
+
+/*
+ * shade_gouraud_span: Draw a span with linearly changing light
+ *
+ * Parameters:
+ *   dst - First pixel
+ *   count - Number of pixels
+ *   ramp - Ramp of the span's base color
+ *   light - Light level at the first pixel centre, 0 to FIXED_ONE
+ *   dlight - Change in light per pixel
+ *
+ * Notes:
+ *   - Both ends are clamped before the step is worked out, so the
+ *     inner loop needs no range checks
+ */
+void shade_gouraud_span(unsigned char *dst,
+                        int count,
+                        const shade_ramp_t *ramp,
+                        fixed_t light,
+                        fixed_t dlight) {
+    const unsigned char *index;
+    fixed_t level, step = FIXED_ZERO;
+
+    if (count <= 0) {
+        return;
+    }
+
+    index = ramp->index;
+    level = shade_level(light);
+
+    if (count > 1) {
+        step = (shade_level(light + dlight * (count - 1)) - level) / (count - 1);
+    }
+
+    /* Rounding to the nearest entry is folded into the start */
+    level += FIXED_HALF;
+
+    while (count-- > 0) {
+        *dst++ = index[level >> FIXED_SHIFT];
+        level += step;
+    }
+}
+
+/*
+ * shade_emit: Shade one rasterized row, raster_span_fn for shade_gouraud_triangle
+ */
+static void shade_emit(void *context, const raster_span_t *span) {
+    shade_target_t *target = (shade_target_t *) context;
+    fixed_t width = span->right_x - span->left_x;
+    fixed_t dlight = FIXED_ZERO, light;
+
+    /* Spans under a pixel wide take the light halfway along rather than a huge slope */
+    if (width > FIXED_ONE) {
+        dlight = fixed_div(span->right_light - span->left_light, width);
+        light = span->left_light + fixed_mul(dlight, fixed_from_int(span->x0) + FIXED_HALF -
+                                                         span->left_x);
+    } else {
+        light = span->left_light + (span->right_light - span->left_light) / 2;
+    }
+
+    shade_gouraud_span(target->buffer + span->y * SCREEN_WIDTH + span->x0, span->x1 - span->x0,
+                       target->ramp, light, dlight);
+}
+
+/*
+ * shade_gouraud_triangle: Draw a Gouraud shaded triangle
+ *
+ * Parameters:
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   ramp - Ramp of the triangle's base color
+ *   v0, v1, v2 - Projected vertices in either winding, light gives the shade
+ *
+ * Returns:
+ *   Number of pixels written
+ *
+ * Notes:
+ *   - Coverage is the same as raster_flat_triangle
+ */
+long shade_gouraud_triangle(unsigned char *buffer,
+                            const shade_ramp_t *ramp,
+                            const screen_vertex_t *v0,
+                            const screen_vertex_t *v1,
+                            const screen_vertex_t *v2) {
+    shade_target_t target;
+
+    if (buffer == NULL || ramp == NULL) {
+        return 0;
+    }
+
+    target.buffer = buffer;
+    target.ramp = ramp;
+
+    return raster_walk_triangle(v0, v1, v2, RASTER_ATTR_LIGHT, shade_emit, &target);
+}
+
+/*
+ * shade_gouraud_polygon: Draw a Gouraud shaded convex polygon
+ *
+ * Parameters:
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   ramp - Ramp of the polygon's base color
+ *   v - Vertices written by project_polygon
+ *   count - Number of vertices
+ *
+ * Returns:
+ *   Number of pixels written
+ */
+long shade_gouraud_polygon(unsigned char *buffer,
+                           const shade_ramp_t *ramp,
+                           const screen_vertex_t *v,
+                           int count) {
+    long pixels = 0;
+    int i;
+
+    if (v == NULL) {
+        return 0;
+    }
+
+    for (i = 1; i + 1 < count; i++) {
+        pixels += shade_gouraud_triangle(buffer, ramp, &v[0], &v[i], &v[i + 1]);
+    }
+
+    return pixels;
+}
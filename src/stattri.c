@@ -0,0 +1,242 @@
+/*
+ * stattri.c
+ *
+ * Implementation of baked static triangle setup data
+ *
+ * Baking pays for every cross product and square root once. Afterwards a
+ * facing test is one dot product against the plane, point containment is
+ * three edge plane distances and a segment hit is two plane distances and
+ * one divide, none of which need the triangle's vertices.
+ */
+
+#include "..\include\stattri.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+
+/* One third, for the centroid */
+#define STATTRI_THIRD (FIXED_ONE / 3)
+
+/*
+ * stattri_bake: Build the static record for one triangle
+ *
+ * Parameters:
+ *   t - Pointer to source triangle in world space
+ *   s - Pointer to record to fill
+ *
+ * Notes:
+ *   - Call at level load, costs four normalizations and three lengths
+ */
+void stattri_bake(const triangle_t *t, static_triangle_t *s) {
+    vector3_t inward, offset;
+    fixed_t length;
+    int i, next;
+
+    if (t == NULL || s == NULL) {
+        return;
+    }
+
+    s->plane = plane_from_points(t->vertices[0].position,
+                                 t->vertices[1].position,
+                                 t->vertices[2].position);
+
+    s->center = vector3_init(FIXED_ZERO, FIXED_ZERO, FIXED_ZERO);
+
+    for (i = 0; i < 3; i++) {
+        next = (i == 2) ? 0 : i + 1;
+        s->edges[i] = vector3_sub(t->vertices[next].position, t->vertices[i].position);
+
+        /* Normal cross edge points to the inside for counter-clockwise winding */
+        inward = vector3_normalize(vector3_cross(s->plane.normal, s->edges[i]));
+        s->edge_planes[i] = plane_from_point_normal(t->vertices[i].position, inward);
+
+        s->center = vector3_add(s->center, t->vertices[i].position);
+    }
+
+    s->center = vector3_scale(s->center, STATTRI_THIRD);
+    s->radius = FIXED_ZERO;
+
+    for (i = 0; i < 3; i++) {
+        offset = vector3_sub(t->vertices[i].position, s->center);
+        length = vector3_length(offset);
+
+        if (length > s->radius) {
+            s->radius = length;
+        }
+    }
+}
+
+/*
+ * stattri_bake_array: Build static records for a level's triangles
+ *
+ * Parameters:
+ *   tris - Source triangles in world space
+ *   s - Output records, one per triangle
+ *   count - Number of triangles
+ */
+void stattri_bake_array(const triangle_t *tris, static_triangle_t *s, int count) {
+    int i;
+
+    if (tris == NULL || s == NULL) {
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        stattri_bake(&tris[i], &s[i]);
+    }
+}
+
+/*
+ * stattri_is_facing_point: Determine if a static triangle faces a point
+ *
+ * Parameters:
+ *   s - Pointer to baked record
+ *   eye - Pointer to the viewer position in world space
+ *
+ * Returns:
+ *   TRUE if the front side can be seen from eye
+ *
+ * Notes:
+ *   - Same result as triangle_is_facing_point, one dot product and one add
+ */
+int stattri_is_facing_point(const static_triangle_t *s, const vector3_t *eye) {
+    if (s == NULL || eye == NULL) {
+        return FALSE;
+    }
+
+    return (plane_distance(&s->plane, *eye) > 0);
+}
+
+/*
+ * stattri_cull_backfaces: Mark back-facing static triangles
+ *
+ * Parameters:
+ *   s - Baked records for the triangles
+ *   tris - Triangles to mark, in the same order as s
+ *   count - Number of triangles
+ *   m - World to view space matrix
+ *
+ * Returns:
+ *   Number of triangles left facing the camera
+ *
+ * Notes:
+ *   - Sets face_culled on every triangle like triangle_cull_backfaces
+ */
+int stattri_cull_backfaces(const static_triangle_t *s,
+                           triangle_t *tris,
+                           int count,
+                           const matrix_t *m) {
+    vector3_t eye;
+    int i, visible = 0;
+
+    if (s == NULL || tris == NULL || m == NULL) {
+        return 0;
+    }
+
+    eye = triangle_object_eye(m);
+
+    for (i = 0; i < count; i++) {
+        tris[i].face_culled = !stattri_is_facing_point(&s[i], &eye);
+
+        if (!tris[i].face_culled) {
+            visible++;
+        }
+    }
+
+    return visible;
+}
+
+/*
+ * stattri_contains_point: Check if a point on the plane lies inside the triangle
+ *
+ * Parameters:
+ *   s - Pointer to baked record
+ *   point - Point on or near the triangle's plane
+ *
+ * Returns:
+ *   TRUE if the point is inside or on an edge
+ *
+ * Notes:
+ *   - Distance from the triangle's plane is ignored, the point is
+ *     effectively projected along the normal
+ */
+int stattri_contains_point(const static_triangle_t *s, vector3_t point) {
+    if (s == NULL) {
+        return FALSE;
+    }
+
+    return plane_distance(&s->edge_planes[0], point) >= 0 &&
+           plane_distance(&s->edge_planes[1], point) >= 0 &&
+           plane_distance(&s->edge_planes[2], point) >= 0;
+}
+
+/*
+ * stattri_intersect_segment: Find where a segment hits a static triangle
+ *
+ * Parameters:
+ *   s - Pointer to baked record
+ *   a, b - Segment end points, such as a move from a to b
+ *   hit - Receives the hit point, or NULL
+ *
+ * Returns:
+ *   TRUE if the segment passes through the triangle from either side
+ */
+int stattri_intersect_segment(const static_triangle_t *s,
+                              vector3_t a,
+                              vector3_t b,
+                              vector3_t *hit) {
+    vector3_t point;
+    fixed_t t;
+
+    if (s == NULL || !plane_intersect_segment(&s->plane, a, b, &t)) {
+        return FALSE;
+    }
+
+    point = vector3_add(a, vector3_scale(vector3_sub(b, a), t));
+
+    if (!stattri_contains_point(s, point)) {
+        return FALSE;
+    }
+
+    if (hit != NULL) {
+        *hit = point;
+    }
+
+    return TRUE;
+}
+
+/*
+ * stattri_sphere_overlaps: Check a sphere against the bounding sphere
+ *
+ * Parameters:
+ *   s - Pointer to baked record
+ *   center - Sphere center
+ *   radius - Sphere radius
+ *
+ * Returns:
+ *   TRUE if the spheres overlap
+ *
+ * Notes:
+ *   - Quick reject before any finer collision or clipping test
+ *   - Compares squared lengths, with a per-axis reject first so far away
+ *     spheres cannot overflow the squares
+ */
+int stattri_sphere_overlaps(const static_triangle_t *s, vector3_t center, fixed_t radius) {
+    vector3_t offset;
+    fixed_t reach;
+
+    if (s == NULL) {
+        return FALSE;
+    }
+
+    reach = s->radius + radius;
+    offset = vector3_sub(center, s->center);
+
+    if (fixed_abs(offset.x) > reach || fixed_abs(offset.y) > reach ||
+        fixed_abs(offset.z) > reach) {
+        return FALSE;
+    }
+
+    return vector3_length_squared(offset) <= fixed_mul(reach, reach);
+}
@@ -0,0 +1,314 @@
+/*
+ * surface.c
+ *
+ * Implementation of the pre-lit wall block cache
+ *
+ * Blocks sit on a hash chain for lookup and on a list in use order.
+ * The newest block is checked first, since neighbouring columns of a
+ * wall nearly always want the same block, then the hash chain. A miss
+ * takes an unused slot while the budget lasts and the oldest block's
+ * slot after that.
+ *
+ * A block covers one texture repeat along the wall and the full height
+ * of the wall, so a wall taller than one unit gets several repeats of
+ * the texture stacked in one block, each with its own light.
+ */
+
+#include "..\include\surface.h"
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "..\include\defs.h"
+
+/*
+ * surface_cache_hash: Hash chain of a block key
+ */
+static int surface_cache_hash(const lightmap_t *lightmap, int segment) {
+    unsigned long key = (unsigned long) (size_t) lightmap;
+
+    return (int) (((key >> 4) ^ (key >> 10) ^ (unsigned long) segment * 7UL) &
+                  (SURFACE_CACHE_HASH - 1));
+}
+
+/*
+ * surface_cache_repeats: Texture repeats stacked up a wall, one per unit of height
+ */
+static int surface_cache_repeats(const lightmap_t *lightmap) {
+    int repeats = (int) ((lightmap->ceiling + FIXED_ONE - 1) >> FIXED_SHIFT);
+
+    return repeats < 1 ? 1 : repeats;
+}
+
+/*
+ * surface_cache_unlink: Take a block out of the use order
+ */
+static void surface_cache_unlink(surface_cache_t *cache, int b) {
+    surface_block_t *block = &cache->blocks[b];
+
+    if (block->newer != SURFACE_CACHE_NONE) {
+        cache->blocks[block->newer].older = block->older;
+    } else {
+        cache->newest = block->older;
+    }
+
+    if (block->older != SURFACE_CACHE_NONE) {
+        cache->blocks[block->older].newer = block->newer;
+    } else {
+        cache->oldest = block->newer;
+    }
+}
+
+/*
+ * surface_cache_push: Put a block at the newest end of the use order
+ */
+static void surface_cache_push(surface_cache_t *cache, int b) {
+    surface_block_t *block = &cache->blocks[b];
+
+    block->newer = SURFACE_CACHE_NONE;
+    block->older = cache->newest;
+
+    if (cache->newest != SURFACE_CACHE_NONE) {
+        cache->blocks[cache->newest].newer = (short) b;
+    } else {
+        cache->oldest = (short) b;
+    }
+
+    cache->newest = (short) b;
+}
+
+/*
+ * surface_cache_evict: Throw out the oldest block
+ *
+ * Returns:
+ *   Slot freed, SURFACE_CACHE_NONE if the cache is empty
+ */
+static int surface_cache_evict(surface_cache_t *cache) {
+    short *link;
+    int b = cache->oldest;
+
+    if (b == SURFACE_CACHE_NONE) {
+        return SURFACE_CACHE_NONE;
+    }
+
+    surface_cache_unlink(cache, b);
+    link = &cache->hash[surface_cache_hash(cache->blocks[b].lightmap, cache->blocks[b].segment)];
+
+    while (*link != b) {
+        link = &cache->blocks[*link].hash_next;
+    }
+
+    *link = cache->blocks[b].hash_next;
+    cache->blocks[b].lightmap = NULL;
+    cache->stats.evictions++;
+
+    return b;
+}
+
+/*
+ * surface_cache_build: Light one texture repeat into a block's slot
+ *
+ * Parameters:
+ *   cache - Cache owning the slot
+ *   block - Block with its key filled in
+ *   texels - The block's slot
+ *
+ * Notes:
+ *   - Each texel takes the light at its centre on the wall, rounded to
+ *     a colormap level
+ */
+static void surface_cache_build(surface_cache_t *cache, surface_block_t *block,
+                                unsigned char *texels) {
+    const lightmap_t *lm = block->lightmap;
+    const texture_t *src = block->source;
+    const unsigned char *src_row, *shade;
+    fixed_t s, t;
+    int tu, tv, light, rows = src->height * surface_cache_repeats(lm);
+    int first = block->segment * src->width;
+
+    texture_init(&block->texture, texels, src->width, rows);
+
+    for (tv = 0; tv < rows; tv++) {
+        /* Counted down from the ceiling, like v when the wall is drawn */
+        t = (lm->ceiling - (fixed_from_int(tv) + FIXED_HALF) / src->height) << LIGHTMAP_SHIFT;
+        src_row = src->texture_data + (tv % src->height) * src->width;
+
+        for (tu = 0; tu < src->width; tu++) {
+            s = ((fixed_from_int(first + tu) + FIXED_HALF - block->u_offset) / src->width)
+                << LIGHTMAP_SHIFT;
+            light = lightmap_sample(lm, s, t);
+            shade = cache->colormap->map[(light * (COLORMAP_LEVELS - 1) + LIGHTMAP_FULL / 2) /
+                                         LIGHTMAP_FULL];
+            *texels++ = shade[src_row[tu]];
+        }
+    }
+
+    cache->stats.texels += (long) rows * src->width;
+}
+
+/*
+ * surface_cache_init: Give a cache its pool and empty it
+ *
+ * Parameters:
+ *   cache - Cache to initialize
+ *   pool - Block storage of budget bytes, owned by the caller
+ *   budget - Bytes the cache may use
+ *   slot_bytes - Bytes per block, texture width * height * the wall
+ *                height in units, rounded up, for the largest texture
+ *   colormap - Table to light texels through
+ *
+ * Notes:
+ *   - The budget is split into whole slots, at most SURFACE_CACHE_MAX_BLOCKS
+ */
+void surface_cache_init(surface_cache_t *cache,
+                        unsigned char *pool,
+                        long budget,
+                        long slot_bytes,
+                        const colormap_t *colormap) {
+    if (cache == NULL) {
+        return;
+    }
+
+    cache->pool = pool;
+    cache->slot_bytes = slot_bytes;
+    cache->slot_count = 0;
+    cache->colormap = colormap;
+
+    if (pool != NULL && slot_bytes > 0 && budget > 0) {
+        cache->slot_count = (int) (budget / slot_bytes < SURFACE_CACHE_MAX_BLOCKS ?
+                                   budget / slot_bytes : SURFACE_CACHE_MAX_BLOCKS);
+    }
+
+    surface_cache_flush(cache);
+}
+
+/*
+ * surface_cache_flush: Throw out every block
+ *
+ * Parameters:
+ *   cache - Cache to empty
+ *
+ * Notes:
+ *   - Needed whenever the colormap, a lightmap or a texture changes
+ */
+void surface_cache_flush(surface_cache_t *cache) {
+    int i;
+
+    if (cache == NULL) {
+        return;
+    }
+
+    for (i = 0; i < SURFACE_CACHE_HASH; i++) {
+        cache->hash[i] = SURFACE_CACHE_NONE;
+    }
+
+    for (i = 0; i < SURFACE_CACHE_MAX_BLOCKS; i++) {
+        cache->blocks[i].lightmap = NULL;
+    }
+
+    cache->used = 0;
+    cache->newest = SURFACE_CACHE_NONE;
+    cache->oldest = SURFACE_CACHE_NONE;
+
+    cache->stats.hits = 0;
+    cache->stats.misses = 0;
+    cache->stats.evictions = 0;
+    cache->stats.texels = 0;
+}
+
+/*
+ * surface_cache_get: Find or build the lit block for one texture repeat of a wall
+ *
+ * Parameters:
+ *   cache - Surface cache
+ *   lightmap - Baked light of the wall
+ *   source - Unlit wall texture
+ *   u_offset - The wall's u offset, texels
+ *   segment - Texture repeat, texel u / source->width rounded down
+ *
+ * Returns:
+ *   Lit texture, source->width wide and source->height times the wall
+ *   height in units tall, NULL if it does not fit a slot
+ *
+ * Notes:
+ *   - The texture stays valid until the block is evicted, at the
+ *     earliest by the lookup after the next miss
+ */
+const texture_t *surface_cache_get(surface_cache_t *cache,
+                                   const lightmap_t *lightmap,
+                                   const texture_t *source,
+                                   fixed_t u_offset,
+                                   int segment) {
+    surface_block_t *block;
+    int b, chain;
+
+    if (cache == NULL || lightmap == NULL || lightmap->luxels == NULL || source == NULL ||
+        source->texture_data == NULL || cache->colormap == NULL) {
+        return NULL;
+    }
+
+    b = cache->newest;
+
+    /* Neighbouring columns of a wall usually want the block just used */
+    if (b == SURFACE_CACHE_NONE || cache->blocks[b].lightmap != lightmap ||
+        cache->blocks[b].segment != segment || cache->blocks[b].source != source ||
+        cache->blocks[b].u_offset != u_offset) {
+        chain = surface_cache_hash(lightmap, segment);
+
+        for (b = cache->hash[chain]; b != SURFACE_CACHE_NONE; b = cache->blocks[b].hash_next) {
+            block = &cache->blocks[b];
+
+            if (block->lightmap == lightmap && block->segment == segment &&
+                block->source == source && block->u_offset == u_offset) {
+                break;
+            }
+        }
+
+        if (b != SURFACE_CACHE_NONE) {
+            surface_cache_unlink(cache, b);
+            surface_cache_push(cache, b);
+        } else {
+            if ((long) source->width * source->height * surface_cache_repeats(lightmap) >
+                cache->slot_bytes) {
+                return NULL;
+            }
+
+            b = cache->used < cache->slot_count ? cache->used++ : surface_cache_evict(cache);
+
+            if (b == SURFACE_CACHE_NONE) {
+                return NULL;
+            }
+
+            block = &cache->blocks[b];
+            block->lightmap = lightmap;
+            block->source = source;
+            block->u_offset = u_offset;
+            block->segment = segment;
+            block->hash_next = cache->hash[chain];
+            cache->hash[chain] = (short) b;
+            surface_cache_push(cache, b);
+            surface_cache_build(cache, block, cache->pool + b * cache->slot_bytes);
+            cache->stats.misses++;
+
+            return &block->texture;
+        }
+    }
+
+    cache->stats.hits++;
+
+    return &cache->blocks[b].texture;
+}
+
+/*
+ * surface_cache_stats_print: Print surface cache counts to console for debugging
+ *
+ * Parameters:
+ *   stats - Pointer to counts to print
+ */
+void surface_cache_stats_print(const surface_stats_t *stats) {
+    printf("Surface cache:\n");
+    printf("  Hits:      %ld\n", stats->hits);
+    printf("  Misses:    %ld\n", stats->misses);
+    printf("  Evictions: %ld\n", stats->evictions);
+    printf("  Texels:    %ld\n", stats->texels);
+}
@@ -0,0 +1,375 @@
+/*
+ * texspan.c
+ *
+ * Implementation of perspective-correct textured spans
+ *
+ * u / w, v / w and 1 / w are linear in screen space, u and v are not.
+ * A span is cut into runs of TEXSPAN_SUBDIV pixels, u and v are found
+ * exactly at the ends of each run and stepped linearly along it. The
+ * error is largest in the middle of a run and grows with the square of
+ * the run length and with how steeply the surface recedes, so it is
+ * worst where the texture is already squeezed to several texels a pixel.
+ */
+
+#include "..\include\texspan.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+
+/* Destination of texspan_triangle spans */
+typedef struct {
+    unsigned char *buffer;       // Surface to draw into
+    const texture_t *tex;        // Texture to sample
+    const colormap_t *colormap;  // Light table, NULL for unlit texels
+    fixed_t light;               // Light level for the colormap
+} texspan_target_t;
+
+/*
+ * texspan_run_pow2: Draw an affine run from a power of two texture
+ *
+ * Parameters:
+ *   dst - First pixel
+ *   count - Number of pixels
+ *   tex - Texture with a valid width_shift
+ *   u, v - Texture coordinate of the first pixel, 16.16 texels
+ *   du, dv - Change per pixel
+ *   shade - Colormap row applied to each texel, NULL to copy texels
+ *
+ * Notes:
+ *   - v is shifted straight to its row offset and masked there, so a
+ *     texel costs two shifts, two ANDs and an add, and shading one
+ *     more lookup
+ */
+static void texspan_run_pow2(unsigned char *dst, int count, const texture_t *tex, fixed_t u,
+                             fixed_t v, fixed_t du, fixed_t dv, const unsigned char *shade) {
+    const unsigned char *texels = tex->texture_data;
+    int v_shift = FIXED_SHIFT - tex->width_shift;
+    unsigned long u_mask = (unsigned long) tex->width_mask;
+    unsigned long v_mask = (unsigned long) tex->height_mask << tex->width_shift;
+
+    if (shade != NULL) {
+        while (count-- > 0) {
+            *dst++ = shade[texels[(((unsigned long) v >> v_shift) & v_mask) +
+                                  (((unsigned long) u >> FIXED_SHIFT) & u_mask)]];
+            u += du;
+            v += dv;
+        }
+
+        return;
+    }
+
+    while (count-- > 0) {
+        *dst++ = texels[(((unsigned long) v >> v_shift) & v_mask) +
+                        (((unsigned long) u >> FIXED_SHIFT) & u_mask)];
+        u += du;
+        v += dv;
+    }
+}
+
+/*
+ * texspan_run_any: Draw an affine run from a texture of any size
+ *
+ * Parameters:
+ *   Same as texspan_run_pow2
+ *
+ * Notes:
+ *   - Wraps with a remainder per texel, several times slower than the
+ *     power of two path, so shading is just tested per texel
+ */
+static void texspan_run_any(unsigned char *dst, int count, const texture_t *tex, fixed_t u,
+                            fixed_t v, fixed_t du, fixed_t dv, const unsigned char *shade) {
+    const unsigned char *texels = tex->texture_data;
+    unsigned char texel;
+    int tu, tv;
+
+    while (count-- > 0) {
+        tu = (int) ((u >> FIXED_SHIFT) % tex->width);
+        tv = (int) ((v >> FIXED_SHIFT) % tex->height);
+
+        if (tu < 0) {
+            tu += tex->width;
+        }
+
+        if (tv < 0) {
+            tv += tex->height;
+        }
+
+        texel = texels[tv * tex->width + tu];
+        *dst++ = shade != NULL ? shade[texel] : texel;
+        u += du;
+        v += dv;
+    }
+}
+
+/*
+ * texspan_setup: Work out the perspective values across a rasterized span
+ *
+ * Parameters:
+ *   s - Receives the values at pixel span->x0 and their per-pixel change
+ *   span - Row from raster_walk_triangle with RASTER_ATTR_Z and RASTER_ATTR_UV
+ *
+ * Notes:
+ *   - Spans under a pixel wide keep flat values rather than a huge slope
+ *   - The span starts unlit, set colormap and light after setup to shade it
+ */
+void texspan_setup(texspan_t *s, const raster_span_t *span) {
+    fixed_t width = span->right_x - span->left_x;
+    fixed_t offset = fixed_from_int(span->x0) + FIXED_HALF - span->left_x;
+
+    s->dz = FIXED_ZERO;
+    s->du = FIXED_ZERO;
+    s->dv = FIXED_ZERO;
+
+    s->colormap = NULL;
+    s->light = FIXED_ONE;
+
+    if (width > FIXED_ONE) {
+        /* Dividing by the width with 8 fewer bits gives 8 more in the result */
+        s->dz = fixed_div(span->right_z - span->left_z, width >> TEXSPAN_Z_SHIFT);
+        s->du = fixed_div(span->right_u - span->left_u, width);
+        s->dv = fixed_div(span->right_v - span->left_v, width);
+    }
+
+    s->z = (span->left_z << TEXSPAN_Z_SHIFT) + fixed_mul(s->dz, offset);
+    s->u = span->left_u + fixed_mul(s->du, offset);
+    s->v = span->left_v + fixed_mul(s->dv, offset);
+}
+
+/*
+ * texspan_divide: Recover a texture coordinate from its value over w
+ *
+ * Parameters:
+ *   value_over_w - u / w or v / w
+ *   z - 1 / w with TEXSPAN_Z_SHIFT extra bits
+ *
+ * Returns:
+ *   Texture coordinate, 16.16 texels
+ *
+ * Notes:
+ *   - z is rounded back to 16.16 for the divide, which keeps the
+ *     quotient inside fixed_div's range for coordinates up to 32767
+ */
+fixed_t texspan_divide(fixed_t value_over_w, fixed_t z) {
+    z = (z + (1L << (TEXSPAN_Z_SHIFT - 1))) >> TEXSPAN_Z_SHIFT;
+
+    /* Rounding can leave the far edge of a span just short of zero */
+    if (z < 1) {
+        z = 1;
+    }
+
+    return fixed_div(value_over_w, z);
+}
+
+/*
+ * texspan_draw: Draw a perspective-correct textured span
+ *
+ * Parameters:
+ *   dst - First pixel
+ *   count - Number of pixels
+ *   tex - Texture to sample, set up with texture_init
+ *   s - Values at the first pixel from texspan_setup
+ *
+ * Notes:
+ *   - Full runs end one pixel past themselves, where the next run
+ *     starts, so their step is a shift. The last run ends on the span's
+ *     last pixel so nothing is sampled outside the span.
+ *   - With a colormap, each run takes its light row from the depth at
+ *     its first pixel, so distance fog changes every TEXSPAN_SUBDIV pixels
+ */
+void texspan_draw(unsigned char *dst, int count, const texture_t *tex, const texspan_t *s) {
+    const unsigned char *shade = NULL;
+    fixed_t z, uz, vz, u0, v0, u1, v1, du, dv;
+    int run;
+
+    if (dst == NULL || tex == NULL || tex->texture_data == NULL || s == NULL || count <= 0) {
+        return;
+    }
+
+    z = s->z;
+    uz = s->u;
+    vz = s->v;
+    u0 = texspan_divide(uz, z);
+    v0 = texspan_divide(vz, z);
+
+    while (count > 0) {
+        if (s->colormap != NULL) {
+            shade = colormap_row(s->colormap, s->light, z >> TEXSPAN_Z_SHIFT);
+        }
+
+        if (count > TEXSPAN_SUBDIV) {
+            run = TEXSPAN_SUBDIV;
+            z += s->dz * TEXSPAN_SUBDIV;
+            uz += s->du * TEXSPAN_SUBDIV;
+            vz += s->dv * TEXSPAN_SUBDIV;
+            u1 = texspan_divide(uz, z);
+            v1 = texspan_divide(vz, z);
+            du = (u1 - u0) >> TEXSPAN_SUBDIV_SHIFT;
+            dv = (v1 - v0) >> TEXSPAN_SUBDIV_SHIFT;
+        } else {
+            run = count;
+            u1 = u0;
+            v1 = v0;
+            du = FIXED_ZERO;
+            dv = FIXED_ZERO;
+
+            if (run > 1) {
+                z += s->dz * (run - 1);
+                uz += s->du * (run - 1);
+                vz += s->dv * (run - 1);
+                u1 = texspan_divide(uz, z);
+                v1 = texspan_divide(vz, z);
+                du = (u1 - u0) / (run - 1);
+                dv = (v1 - v0) / (run - 1);
+            }
+        }
+
+        if (tex->width_shift >= 0) {
+            texspan_run_pow2(dst, run, tex, u0, v0, du, dv, shade);
+        } else {
+            texspan_run_any(dst, run, tex, u0, v0, du, dv, shade);
+        }
+
+        dst += run;
+        count -= run;
+        u0 = u1;
+        v0 = v1;
+    }
+}
+
+/*
+ * texspan_emit: Texture one rasterized row, raster_span_fn for texspan_triangle
+ */
+static void texspan_emit(void *context, const raster_span_t *span) {
+    texspan_target_t *target = (texspan_target_t *) context;
+    texspan_t s;
+
+    texspan_setup(&s, span);
+    s.colormap = target->colormap;
+    s.light = target->light;
+    texspan_draw(target->buffer + span->y * SCREEN_WIDTH + span->x0, span->x1 - span->x0,
+                 target->tex, &s);
+}
+
+/*
+ * texspan_lit_triangle: Draw a perspective-correct textured triangle through a colormap
+ *
+ * Parameters:
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   tex - Texture to sample, set up with texture_init
+ *   colormap - Light table, NULL draws the texture unlit
+ *   light - Light level of the triangle, 0 to FIXED_ONE
+ *   v0, v1, v2 - Projected vertices in either winding
+ *
+ * Returns:
+ *   Number of pixels written
+ *
+ * Notes:
+ *   - The colormap's fog is applied from each run's 1 / w
+ */
+long texspan_lit_triangle(unsigned char *buffer,
+                          const texture_t *tex,
+                          const colormap_t *colormap,
+                          fixed_t light,
+                          const screen_vertex_t *v0,
+                          const screen_vertex_t *v1,
+                          const screen_vertex_t *v2) {
+    texspan_target_t target;
+
+    if (buffer == NULL || tex == NULL) {
+        return 0;
+    }
+
+    target.buffer = buffer;
+    target.tex = tex;
+    target.colormap = colormap;
+    target.light = light;
+
+    return raster_walk_triangle(v0, v1, v2, RASTER_ATTR_Z | RASTER_ATTR_UV, texspan_emit, &target);
+}
+
+/*
+ * texspan_triangle: Draw a perspective-correct textured triangle
+ *
+ * Parameters:
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   tex - Texture to sample, set up with texture_init
+ *   v0, v1, v2 - Projected vertices in either winding
+ *
+ * Returns:
+ *   Number of pixels written
+ *
+ * Notes:
+ *   - Coverage is the same as raster_flat_triangle
+ */
+long texspan_triangle(unsigned char *buffer,
+                      const texture_t *tex,
+                      const screen_vertex_t *v0,
+                      const screen_vertex_t *v1,
+                      const screen_vertex_t *v2) {
+    return texspan_lit_triangle(buffer, tex, NULL, FIXED_ONE, v0, v1, v2);
+}
+
+/*
+ * texspan_polygon: Draw a perspective-correct textured convex polygon
+ *
+ * Parameters:
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   tex - Texture to sample, set up with texture_init
+ *   v - Vertices written by project_polygon
+ *   count - Number of vertices
+ *
+ * Returns:
+ *   Number of pixels written
+ */
+long texspan_polygon(unsigned char *buffer,
+                     const texture_t *tex,
+                     const screen_vertex_t *v,
+                     int count) {
+    long pixels = 0;
+    int i;
+
+    if (v == NULL) {
+        return 0;
+    }
+
+    for (i = 1; i + 1 < count; i++) {
+        pixels += texspan_triangle(buffer, tex, &v[0], &v[i], &v[i + 1]);
+    }
+
+    return pixels;
+}
+
+/*
+ * texspan_lit_polygon: Draw a perspective-correct textured convex polygon through a colormap
+ *
+ * Parameters:
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   tex - Texture to sample, set up with texture_init
+ *   colormap - Light table, NULL draws the texture unlit
+ *   light - Light level of the polygon, 0 to FIXED_ONE
+ *   v - Vertices written by project_polygon
+ *   count - Number of vertices
+ *
+ * Returns:
+ *   Number of pixels written
+ */
+long texspan_lit_polygon(unsigned char *buffer,
+                         const texture_t *tex,
+                         const colormap_t *colormap,
+                         fixed_t light,
+                         const screen_vertex_t *v,
+                         int count) {
+    long pixels = 0;
+    int i;
+
+    if (v == NULL) {
+        return 0;
+    }
+
+    for (i = 1; i + 1 < count; i++) {
+        pixels += texspan_lit_triangle(buffer, tex, colormap, light, &v[0], &v[i], &v[i + 1]);
+    }
+
+    return pixels;
+}
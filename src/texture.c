@@ -0,0 +1,101 @@
+/*
+ * texture.c
+ *
+ * Implementation of texture setup
+ */
+
+#include "..\include\texture.h"
+
+#include <stddef.h>
+
+#include "..\include\defs.h"
+
+/*
+ * texture_log2: Get the power of two a size is
+ *
+ * Parameters:
+ *   size - Size in pixels
+ *
+ * Returns:
+ *   n where size is 2^n, -1 if size is not a power of two
+ */
+int texture_log2(int size) {
+    int shift = 0;
+
+    if (size <= 0 || (size & (size - 1)) != 0) {
+        return -1;
+    }
+
+    while ((1 << shift) < size) {
+        shift++;
+    }
+
+    return shift;
+}
+
+/*
+ * texture_init: Describe a bitmap as a texture
+ *
+ * Parameters:
+ *   t - Texture to fill
+ *   data - width * height palette indices, row by row, owned by the caller
+ *   width, height - Size in pixels
+ *
+ * Returns:
+ *   TRUE if both sizes are powers of two and the fast wrapping paths apply
+ *
+ * Notes:
+ *   - Textures filled in by hand must set width_shift to -1, otherwise
+ *     renderers take the shift and masks as valid
+ */
+int texture_init(texture_t *t, unsigned char *data, int width, int height) {
+    if (t == NULL) {
+        return FALSE;
+    }
+
+    t->texture_data = data;
+    t->width = width;
+    t->height = height;
+    t->width_shift = -1;
+    t->width_mask = 0;
+    t->height_mask = 0;
+    t->mip_levels = 0;
+
+    if (texture_log2(width) < 0 || texture_log2(height) < 0) {
+        return FALSE;
+    }
+
+    t->width_shift = texture_log2(width);
+    t->width_mask = width - 1;
+    t->height_mask = height - 1;
+
+    return TRUE;
+}
+
+/*
+ * texture_mip: Choose the mip level for a surface
+ *
+ * Parameters:
+ *   t - Texture, the first of its mip levels
+ *   footprint - Level 0 texels one pixel covers, 16.16
+ *   level - Receives the level chosen, 0 for t itself
+ *
+ * Returns:
+ *   The smallest level that still has a texel or more per pixel, as
+ *   sharp as the screen can show
+ *
+ * Notes:
+ *   - Coordinates in level 0 texels are shifted right by the level
+ */
+const texture_t *texture_mip(const texture_t *t, fixed_t footprint, int *level) {
+    int l = 0;
+
+    while (l < t->mip_levels && footprint >= 2 * FIXED_ONE) {
+        footprint >>= 1;
+        l++;
+    }
+
+    *level = l;
+
+    return t + l;
+}
@@ -105,8 +105,32 @@ int triangle_is_facing_camera(const triangle_t *t) {
  *
  * Returns:
  *   Transformed triangle with updated normal
+ *
+ * Notes:
+ *   - Always rebuilds the normal, see triangle_transform_mode for cheaper modes
  */
 triangle_t triangle_transform(const triangle_t *t, const matrix_t *m) {
+    return triangle_transform_mode(t, m, TRIANGLE_NORMAL_RECALC);
+}
+
+/*
+ * triangle_transform_mode: Transform a triangle choosing how the normal is updated
+ *
+ * Parameters:
+ *   t - Pointer to triangle to transform
+ *   m - Transformation matrix
+ *   normal_mode - TRIANGLE_NORMAL_RECALC, TRIANGLE_NORMAL_ROTATE or TRIANGLE_NORMAL_RIGID
+ *
+ * Returns:
+ *   Transformed triangle with updated normal
+ *
+ * Notes:
+ *   - RECALC costs two subtractions, a cross product, a square root and three divides
+ *   - ROTATE is nine multiplies plus a renormalize, valid for rotation and uniform scale
+ *   - RIGID is nine multiplies only, the caller must know the matrix is orthonormal
+ *   - Use triangle_select_normal_mode once per mesh to pick the cheapest valid mode
+ */
+triangle_t triangle_transform_mode(const triangle_t *t, const matrix_t *m, int normal_mode) {
     triangle_t result;
     int i;
 
@@ -114,15 +138,19 @@ triangle_t triangle_transform(const triangle_t *t, const matrix_t *m) {
         triangle_t empty;
 
         /* Initialize and return an empty triangle if inputs are invalid */
+        memset(&empty, 0, sizeof(empty));
         empty.vertices[0] = vertex_init(FIXED_ZERO, FIXED_ZERO, FIXED_ZERO);
         empty.vertices[1] = vertex_init(FIXED_ZERO, FIXED_ZERO, FIXED_ZERO);
         empty.vertices[2] = vertex_init(FIXED_ZERO, FIXED_ZERO, FIXED_ZERO);
         empty.normal = vector3_init(FIXED_ZERO, FIXED_ZERO, FIXED_ZERO);
         empty.face_culled = TRUE;
-        empty.color = t ? t->color : empty.color;
         empty.texture = NULL;
         empty.render_mode = TRIANGLE_FLAT;
 
+        if (t != NULL) {
+            empty.color = t->color;
+        }
+
         return empty;
     }
 
@@ -137,12 +165,172 @@ triangle_t triangle_transform(const triangle_t *t, const matrix_t *m) {
         result.vertices[i] = vertex_transform(&t->vertices[i], m);
     }
 
-    /* Recalculate normal after transformation */
-    triangle_calculate_normal(&result);
+    switch (normal_mode) {
+        case TRIANGLE_NORMAL_RIGID:
+            /* Rotation preserves length so the stored unit normal stays unit */
+            result.normal = matrix_rotate_vector3(m, &t->normal);
+            break;
+
+        case TRIANGLE_NORMAL_ROTATE:
+            /* Uniform scale only changes length, so renormalize */
+            result.normal = matrix_rotate_vector3(m, &t->normal);
+            result.normal = vector3_normalize(result.normal);
+            break;
+
+        default:
+            /* Recalculate normal after transformation */
+            triangle_calculate_normal(&result);
+            break;
+    }
 
     return result;
 }
 
+/*
+ * triangle_select_normal_mode: Pick the cheapest valid normal mode for a matrix
+ *
+ * Parameters:
+ *   m - Transformation matrix that will be applied to a mesh
+ *
+ * Returns:
+ *   TRIANGLE_NORMAL_RIGID if the matrix is orthonormal, TRIANGLE_NORMAL_RECALC otherwise
+ *
+ * Notes:
+ *   - Call once per mesh and pass the result to triangle_transform_mode
+ */
+int triangle_select_normal_mode(const matrix_t *m) {
+    if (m != NULL && matrix_is_orthonormal(m)) {
+        return TRIANGLE_NORMAL_RIGID;
+    }
+
+    return TRIANGLE_NORMAL_RECALC;
+}
+
+/*
+ * triangle_object_eye: Find the camera position in a mesh's object space
+ *
+ * Parameters:
+ *   m - Object to view space matrix for the mesh
+ *
+ * Returns:
+ *   Position of the view space origin expressed in object space
+ *
+ * Notes:
+ *   - Call once per mesh, the result feeds triangle_is_facing_point
+ *   - Costs one affine inverse instead of transforming every triangle
+ */
+vector3_t triangle_object_eye(const matrix_t *m) {
+    matrix_t inverse;
+
+    if (m == NULL) {
+        return vector3_init(FIXED_ZERO, FIXED_ZERO, FIXED_ZERO);
+    }
+
+    inverse = matrix_inverse_affine(m);
+
+    /* The view origin maps to the translation column of the inverse */
+    return vector3_init(inverse.m[0][3], inverse.m[1][3], inverse.m[2][3]);
+}
+
+/*
+ * triangle_is_facing_point: Determine if a triangle faces a point in its own space
+ *
+ * Parameters:
+ *   t - Pointer to triangle to check
+ *   eye - Pointer to the viewer position in the same space as the triangle
+ *
+ * Returns:
+ *   TRUE if the front side of the triangle can be seen from eye, FALSE otherwise
+ *
+ * Notes:
+ *   - Uses the stored normal, so no cross product or square root is needed
+ *   - One subtraction and one dot product per triangle
+ *   - Agrees with triangle_is_facing_camera for geometry in front of the camera
+ */
+int triangle_is_facing_point(const triangle_t *t, const vector3_t *eye) {
+    vector3_t to_eye;
+
+    if (t == NULL || eye == NULL) {
+        return FALSE;
+    }
+
+    to_eye = vector3_sub(*eye, t->vertices[0].position);
+
+    return (vector3_dot(t->normal, to_eye) > 0);
+}
+
+/*
+ * triangle_cull_backfaces: Mark back-facing triangles of a mesh before transformation
+ *
+ * Parameters:
+ *   tris - Array of triangles in object space
+ *   count - Number of triangles in the array
+ *   m - Object to view space matrix for the mesh
+ *
+ * Returns:
+ *   Number of triangles left facing the camera
+ *
+ * Notes:
+ *   - Sets face_culled on every triangle, TRUE for back faces
+ *   - The eye is moved into object space once for the whole mesh
+ */
+int triangle_cull_backfaces(triangle_t *tris, int count, const matrix_t *m) {
+    vector3_t eye;
+    int i, visible = 0;
+
+    if (tris == NULL || m == NULL) {
+        return 0;
+    }
+
+    eye = triangle_object_eye(m);
+
+    for (i = 0; i < count; i++) {
+        tris[i].face_culled = !triangle_is_facing_point(&tris[i], &eye);
+
+        if (!tris[i].face_culled) {
+            visible++;
+        }
+    }
+
+    return visible;
+}
+
+/*
+ * triangle_transform_visible: Transform only the triangles that survived culling
+ *
+ * Parameters:
+ *   src - Array of triangles, face_culled already set
+ *   dst - Output array, packed with the transformed visible triangles
+ *   count - Number of triangles in src
+ *   m - Transformation matrix
+ *   normal_mode - Normal update mode passed to triangle_transform_mode
+ *
+ * Returns:
+ *   Number of triangles written to dst
+ *
+ * Notes:
+ *   - Run triangle_cull_backfaces first so back faces never reach the transform
+ */
+int triangle_transform_visible(const triangle_t *src,
+                               triangle_t *dst,
+                               int count,
+                               const matrix_t *m,
+                               int normal_mode) {
+    int i, written = 0;
+
+    if (src == NULL || dst == NULL || m == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (!src[i].face_culled) {
+            dst[written++] = triangle_transform_mode(&src[i], m, normal_mode);
+        }
+    }
+
+    return written;
+}
+
 /*
  * triangle_set_color: Set the flat shading color for a triangle
  *
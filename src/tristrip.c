@@ -0,0 +1,307 @@
+/*
+ * tristrip.c
+ *
+ * Implementation of triangle strip and fan primitives
+ *
+ * Strip triangle i is (i, i+1, i+2) for even i and (i+1, i, i+2) for odd i
+ * so every triangle keeps the same winding. With edges e(i) = v(i+1) - v(i)
+ * its normal is cross(e(i), e(i+1)), negated for odd i. Fan triangle i is
+ * (0, i+1, i+2) with edges f(i) = v(i+1) - v(0) and normal cross(f(i), f(i+1)).
+ * Either way each triangle reuses the previous triangle's edge and only
+ * computes one new one.
+ */
+
+#include "..\include\tristrip.h"
+
+#include <string.h>
+
+#include "..\include\defs.h"
+
+/*
+ * tristrip_init: Attach caller owned arrays to a strip or fan
+ *
+ * Parameters:
+ *   s - Pointer to strip to initialize
+ *   type - TRISTRIP_STRIP or TRISTRIP_FAN
+ *   vertices - Shared vertex array
+ *   vertex_count - Number of vertices
+ *   normals - Array for vertex_count - 2 face normals, or NULL
+ *   face_culled - Array for vertex_count - 2 culled flags, or NULL
+ *
+ * Notes:
+ *   - Face normals are calculated when a normal array is given
+ */
+void tristrip_init(tristrip_t *s,
+                   int type,
+                   vertex_t *vertices,
+                   int vertex_count,
+                   vector3_t *normals,
+                   unsigned char *face_culled) {
+    if (s == NULL) {
+        return;
+    }
+
+    s->vertices = vertices;
+    s->vertex_count = vertex_count;
+    s->type = type;
+    s->normals = normals;
+    s->face_culled = face_culled;
+    s->texture = NULL;
+    s->render_mode = TRIANGLE_FLAT;
+
+    /* Set default color to white */
+    s->color.r = 255;
+    s->color.g = 255;
+    s->color.b = 255;
+
+    if (face_culled != NULL && vertex_count > 2) {
+        memset(face_culled, FALSE, vertex_count - 2);
+    }
+
+    tristrip_calculate_normals(s);
+}
+
+/*
+ * tristrip_triangle_count: Get the number of triangles in a strip or fan
+ *
+ * Parameters:
+ *   s - Pointer to strip
+ *
+ * Returns:
+ *   vertex_count - 2, or 0 if there are too few vertices
+ */
+int tristrip_triangle_count(const tristrip_t *s) {
+    if (s == NULL || s->vertex_count < 3) {
+        return 0;
+    }
+
+    return s->vertex_count - 2;
+}
+
+/*
+ * tristrip_get_indices: Get the vertex indices of one triangle
+ *
+ * Parameters:
+ *   s - Pointer to strip
+ *   index - Triangle index
+ *   i0, i1, i2 - Receive the vertex indices in winding order
+ */
+void tristrip_get_indices(const tristrip_t *s, int index, int *i0, int *i1, int *i2) {
+    if (s->type == TRISTRIP_FAN) {
+        *i0 = 0;
+        *i1 = index + 1;
+    } else if (index & 1) {
+        /* Odd strip triangles swap the first two to keep the winding */
+        *i0 = index + 1;
+        *i1 = index;
+    } else {
+        *i0 = index;
+        *i1 = index + 1;
+    }
+
+    *i2 = index + 2;
+}
+
+/*
+ * tristrip_get_triangle: Expand one triangle of a strip or fan
+ *
+ * Parameters:
+ *   s - Pointer to strip
+ *   index - Triangle index
+ *
+ * Returns:
+ *   Independent triangle with the strip's properties
+ *
+ * Notes:
+ *   - Uses the stored face normal when there is one instead of recalculating
+ */
+triangle_t tristrip_get_triangle(const tristrip_t *s, int index) {
+    triangle_t result;
+    int i0, i1, i2;
+
+    if (s == NULL || index < 0 || index >= tristrip_triangle_count(s)) {
+        vertex_t zero = vertex_init(FIXED_ZERO, FIXED_ZERO, FIXED_ZERO);
+
+        result = triangle_init(zero, zero, zero);
+        result.face_culled = TRUE;
+
+        return result;
+    }
+
+    tristrip_get_indices(s, index, &i0, &i1, &i2);
+
+    result.vertices[0] = s->vertices[i0];
+    result.vertices[1] = s->vertices[i1];
+    result.vertices[2] = s->vertices[i2];
+    result.color = s->color;
+    result.texture = s->texture;
+    result.render_mode = s->render_mode;
+    result.face_culled = (s->face_culled != NULL) ? s->face_culled[index] : FALSE;
+
+    if (s->normals != NULL) {
+        result.normal = s->normals[index];
+    } else {
+        triangle_calculate_normal(&result);
+    }
+
+    return result;
+}
+
+/*
+ * tristrip_calculate_normals: Calculate every face normal of a strip or fan
+ *
+ * Parameters:
+ *   s - Pointer to strip with a normal array
+ *
+ * Notes:
+ *   - One vector subtraction per triangle instead of two, the previous
+ *     triangle's second edge is this triangle's first
+ */
+void tristrip_calculate_normals(tristrip_t *s) {
+    vector3_t edge, next_edge, normal;
+    int i, count;
+
+    count = tristrip_triangle_count(s);
+
+    if (count == 0 || s->normals == NULL) {
+        return;
+    }
+
+    /* First edge is v1 - v0 for both strips and fans */
+    edge = vector3_sub(s->vertices[1].position, s->vertices[0].position);
+
+    for (i = 0; i < count; i++) {
+        if (s->type == TRISTRIP_FAN) {
+            next_edge = vector3_sub(s->vertices[i + 2].position, s->vertices[0].position);
+        } else {
+            next_edge = vector3_sub(s->vertices[i + 2].position, s->vertices[i + 1].position);
+        }
+
+        normal = vector3_cross(edge, next_edge);
+
+        /* Odd strip triangles are wound the other way round */
+        if (s->type == TRISTRIP_STRIP && (i & 1)) {
+            normal = vector3_init(fixed_neg(normal.x), fixed_neg(normal.y), fixed_neg(normal.z));
+        }
+
+        s->normals[i] = vector3_normalize(normal);
+        edge = next_edge;
+    }
+}
+
+/*
+ * tristrip_cull: Mark back-facing triangles before transformation
+ *
+ * Parameters:
+ *   s - Pointer to strip with normal and culled arrays
+ *   m - Object to view space matrix
+ *
+ * Returns:
+ *   Number of triangles left facing the camera
+ *
+ * Notes:
+ *   - Same test as triangle_cull_backfaces, one dot product per triangle
+ *     against the eye moved into object space once per strip
+ */
+int tristrip_cull(tristrip_t *s, const matrix_t *m) {
+    vector3_t eye, to_eye;
+    int i, count, visible = 0;
+
+    count = tristrip_triangle_count(s);
+
+    if (count == 0 || m == NULL || s->normals == NULL || s->face_culled == NULL) {
+        return count;
+    }
+
+    eye = triangle_object_eye(m);
+
+    for (i = 0; i < count; i++) {
+        /* Vertex i + 2 belongs to triangle i for both strips and fans */
+        to_eye = vector3_sub(eye, s->vertices[i + 2].position);
+        s->face_culled[i] = (vector3_dot(s->normals[i], to_eye) <= 0);
+
+        if (!s->face_culled[i]) {
+            visible++;
+        }
+    }
+
+    return visible;
+}
+
+/*
+ * tristrip_transform: Transform the shared vertices of a strip or fan
+ *
+ * Parameters:
+ *   s - Pointer to source strip
+ *   dst_vertices - Output array of vertex_count vertices
+ *   dst_normals - Output array of face normals, or NULL to skip them
+ *   m - Transformation matrix
+ *
+ * Returns:
+ *   Number of vertices transformed
+ *
+ * Notes:
+ *   - Each shared vertex is transformed once, not once per triangle
+ *   - Vertices only used by culled triangles are left untouched
+ *   - Normals are rotated and only renormalized if m is not orthonormal
+ */
+int tristrip_transform(const tristrip_t *s,
+                       vertex_t *dst_vertices,
+                       vector3_t *dst_normals,
+                       const matrix_t *m) {
+    int i, count, first, last, needed, transformed = 0, renormalize;
+
+    count = tristrip_triangle_count(s);
+
+    if (count == 0 || dst_vertices == NULL || m == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < s->vertex_count; i++) {
+        needed = TRUE;
+
+        if (s->face_culled != NULL) {
+            /* Triangles using vertex i, the fan centre is used by all */
+            if (s->type == TRISTRIP_FAN && i == 0) {
+                first = 0;
+                last = count - 1;
+            } else {
+                first = i - 2;
+                last = (s->type == TRISTRIP_FAN) ? i - 1 : i;
+            }
+
+            if (first < 0) {
+                first = 0;
+            }
+
+            if (last > count - 1) {
+                last = count - 1;
+            }
+
+            needed = FALSE;
+
+            while (first <= last && !needed) {
+                needed = !s->face_culled[first++];
+            }
+        }
+
+        if (needed) {
+            dst_vertices[i] = vertex_transform(&s->vertices[i], m);
+            transformed++;
+        }
+    }
+
+    if (dst_normals != NULL && s->normals != NULL) {
+        renormalize = !matrix_is_orthonormal(m);
+
+        for (i = 0; i < count; i++) {
+            dst_normals[i] = matrix_rotate_vector3(m, &s->normals[i]);
+
+            if (renormalize) {
+                dst_normals[i] = vector3_normalize(dst_normals[i]);
+            }
+        }
+    }
+
+    return transformed;
+}
@@ -0,0 +1,378 @@
+/*
+ * visplane.c
+ *
+ * Implementation of the floor and ceiling span renderer
+ *
+ * Column ranges become row spans the way a span buffer is built from
+ * the side: walking across the columns, a row's span starts where the
+ * plane first covers it and ends where it stops. Only the rows at the
+ * ends of each column's range change between neighbouring columns, so
+ * this costs a few steps per column rather than a pass over every row.
+ *
+ * The distance to a row follows from the eye height and the row's
+ * angle below the horizon. Across the row the texture moves along the
+ * view's right vector, so the whole row is a constant step in u and v.
+ * 1/z is linear in the row's distance from the horizon, so with a
+ * colormap each row also gets its light row without another divide.
+ *
+ * A mipmapped plane picks a level per row. Going down the screen a
+ * row moves further in depth than a pixel moves across, focal / dy
+ * times further, so that step is the one the level is chosen from.
+ */
+
+#include "..\include\visplane.h"
+
+#include <stddef.h>
+
+#include "..\include\colormap.h"
+#include "..\include\defs.h"
+
+/* Per-draw state shared by the spans of one plane */
+typedef struct {
+    const wall_view_t *view;                    // Viewer
+    const texture_t *tex;                       // Plane texture
+    unsigned char *buffer;                      // Surface to draw into
+    fixed_t height;                             // Eye height above the plane, negative for ceilings
+    fixed_t step[SCREEN_HEIGHT];                // World units per pixel on each row, 0 until needed
+    const unsigned char *shade[SCREEN_HEIGHT];  // Light row of each row, found with its step
+    unsigned char level[SCREEN_HEIGHT];         // Mip level of each row, found with its step
+    fixed_t inv_z_scale;                        // 1 / z per pixel below the horizon, 0 when unlit
+    int u_bits;                                 // log2 of the texture width, 0 for the general walk
+    int v_bits;                                 // log2 of the texture height
+    int size;                                   // Larger side of the texture
+    long pixels;                                // Pixels written
+    long texels;                                // Texels read, as counted for the view
+} visplane_target_t;
+
+/*
+ * visplane_row_step: World units one pixel covers on a row
+ *
+ * Parameters:
+ *   target - Plane being drawn
+ *   y - Row
+ *
+ * Returns:
+ *   Units per pixel, 0 if the row is on the wrong side of the horizon
+ *
+ * Notes:
+ *   - This is the row's only divide, it is kept for every other span
+ *     on the same row along with the row's light and mip level
+ */
+static fixed_t visplane_row_step(visplane_target_t *target, int y) {
+    fixed_t dy, depth;
+    int level;
+
+    if (target->step[y] == FIXED_ZERO) {
+        dy = fixed_from_int(y) + FIXED_HALF - WALL_CENTER_Y;
+
+        /* Floors are below the horizon and ceilings above it */
+        if ((target->height > 0) == (dy > 0) && target->height != 0) {
+            target->step[y] = fixed_div(target->height, dy);
+
+            if (target->view->colormap != NULL) {
+                target->shade[y] = colormap_row(target->view->colormap, target->view->light,
+                                                fixed_mul(dy, target->inv_z_scale));
+            }
+
+            /* Units to the next row in depth, step * focal / dy */
+            if (target->tex->mip_levels > 0) {
+                depth = fixed_div(fixed_mul(target->step[y], target->view->focal),
+                                  fixed_abs(dy));
+                depth = depth > FIXED_MAX / target->size ? FIXED_MAX : depth * target->size;
+                texture_mip(target->tex, depth, &level);
+                target->level[y] = (unsigned char) level;
+            }
+        }
+    }
+
+    return target->step[y];
+}
+
+/*
+ * visplane_walk_packed: Draw a span from a power of two texture
+ *
+ * Parameters:
+ *   dst - First pixel
+ *   count - Number of pixels
+ *   tex - Texture with width_shift of at least 1
+ *   u_bits, v_bits - log2 of the texture size, adding up to 16 or less
+ *   u, v - Texture coordinate of the first pixel, 16.16 texels
+ *   du, dv - Change per pixel
+ *   shade - Colormap row applied to each texel, NULL to copy texels
+ *
+ * Notes:
+ *   - u sits in the top half of one register and v in the bottom
+ *     half, each scaled so its texture wraps at the top of its half.
+ *     The walk is one position and one step, a texel costs two shifts,
+ *     two ANDs and an OR. The u mask only matters where longs are
+ *     wider than 32 bits.
+ *   - A carry or borrow out of v when it wraps nudges u by 2^-(16 - u_bits)
+ *     of a texel, far too little to see
+ */
+static void visplane_walk_packed(unsigned char *dst, int count, const texture_t *tex, int u_bits,
+                                 int v_bits, fixed_t u, fixed_t v, fixed_t du, fixed_t dv,
+                                 const unsigned char *shade) {
+    const unsigned char *texels = tex->texture_data;
+    unsigned long pos, step;
+    unsigned long u_mask = (unsigned long) tex->width_mask;
+    unsigned long v_mask = (unsigned long) tex->height_mask << u_bits;
+    int u_shift = 32 - u_bits;
+    int v_shift = 16 - v_bits - u_bits;
+
+    pos = ((unsigned long) (u >> u_bits) << 16) + ((unsigned long) (v >> v_bits) & 0xFFFFUL);
+    step = ((unsigned long) (du >> u_bits) << 16) + (unsigned long) (dv >> v_bits);
+
+    if (shade != NULL) {
+        while (count-- > 0) {
+            *dst++ = shade[texels[((pos >> v_shift) & v_mask) | ((pos >> u_shift) & u_mask)]];
+            pos += step;
+        }
+
+        return;
+    }
+
+    while (count-- > 0) {
+        *dst++ = texels[((pos >> v_shift) & v_mask) | ((pos >> u_shift) & u_mask)];
+        pos += step;
+    }
+}
+
+/*
+ * visplane_walk_any: Draw a span from a texture of any size
+ *
+ * Parameters:
+ *   Same as visplane_walk_packed without the sizes
+ */
+static void visplane_walk_any(unsigned char *dst, int count, const texture_t *tex, fixed_t u,
+                              fixed_t v, fixed_t du, fixed_t dv, const unsigned char *shade) {
+    unsigned char texel;
+    int tu, tv;
+
+    while (count-- > 0) {
+        tu = (int) ((u >> FIXED_SHIFT) % tex->width);
+        tv = (int) ((v >> FIXED_SHIFT) % tex->height);
+
+        if (tu < 0) {
+            tu += tex->width;
+        }
+
+        if (tv < 0) {
+            tv += tex->height;
+        }
+
+        texel = tex->texture_data[tv * tex->width + tu];
+        *dst++ = shade != NULL ? shade[texel] : texel;
+        u += du;
+        v += dv;
+    }
+}
+
+/*
+ * visplane_span: Draw one row span of the plane
+ *
+ * Parameters:
+ *   target - Plane being drawn
+ *   y - Row
+ *   x0, x1 - First pixel and one past the last
+ */
+static void visplane_span(visplane_target_t *target, int y, int x0, int x1) {
+    const wall_view_t *view = target->view;
+    const texture_t *tex;
+    fixed_t step = visplane_row_step(target, y);
+    fixed_t dist, side, px, pz, du, dv, most;
+    int level = target->level[y], touched;
+
+    if (step == FIXED_ZERO || x1 <= x0) {
+        return;
+    }
+
+    tex = target->tex + level;
+
+    /* Straight ahead to the row, then right to the first pixel centre */
+    dist = fixed_mul(step, view->focal);
+    side = fixed_mul(fixed_from_int(x0) + FIXED_HALF - WALL_CENTER_X, step);
+    px = view->x + fixed_mul(view->sin, dist) + fixed_mul(view->cos, side);
+    pz = view->z + fixed_mul(view->cos, dist) - fixed_mul(view->sin, side);
+
+    /* Scaled to texels before the multiply to keep the small step exact */
+    du = fixed_mul(view->cos, step * tex->width);
+    dv = -fixed_mul(view->sin, step * tex->height);
+
+    if (target->u_bits - level > 0) {
+        visplane_walk_packed(target->buffer + y * SCREEN_WIDTH + x0, x1 - x0, tex,
+                             target->u_bits - level, target->v_bits - level, px * tex->width,
+                             pz * tex->height, du, dv, target->shade[y]);
+    } else {
+        visplane_walk_any(target->buffer + y * SCREEN_WIDTH + x0, x1 - x0, tex,
+                          px * tex->width, pz * tex->height, du, dv, target->shade[y]);
+    }
+
+    /* Distinct texels read, one a pixel once the walk moves a texel a pixel */
+    most = fixed_abs(du) > fixed_abs(dv) ? fixed_abs(du) : fixed_abs(dv);
+    touched = most >= FIXED_ONE ? x1 - x0 : (int) (((x1 - x0) * most) >> FIXED_SHIFT) + 1;
+
+    target->pixels += x1 - x0;
+    target->texels += touched;
+}
+
+/*
+ * visplane_init: Set up an empty plane
+ *
+ * Parameters:
+ *   plane - Plane to initialize
+ *   height - Height above the floor, 0 for the floor itself
+ *   texture - Texture, set up with texture_init
+ */
+void visplane_init(visplane_t *plane, fixed_t height, const texture_t *texture) {
+    int c;
+
+    if (plane == NULL) {
+        return;
+    }
+
+    plane->height = height;
+    plane->texture = texture;
+
+    for (c = 0; c < SCREEN_WIDTH; c++) {
+        plane->top[c] = 0;
+        plane->bottom[c] = 0;
+    }
+}
+
+/*
+ * visplane_from_walls: Give a floor and ceiling the rows walls left
+ *
+ * Parameters:
+ *   floor - Floor plane, may be NULL
+ *   ceiling - Ceiling plane, may be NULL
+ *   view - View after every wall of the frame has been drawn
+ *
+ * Notes:
+ *   - The floor takes every row below the wall in each column and the
+ *     ceiling every row above it, so together with the walls each
+ *     pixel is drawn exactly once
+ */
+void visplane_from_walls(visplane_t *floor, visplane_t *ceiling, const wall_view_t *view) {
+    int c;
+
+    if (view == NULL) {
+        return;
+    }
+
+    for (c = 0; c < SCREEN_WIDTH; c++) {
+        if (floor != NULL) {
+            floor->top[c] = view->bottom[c];
+            floor->bottom[c] = SCREEN_HEIGHT;
+        }
+
+        if (ceiling != NULL) {
+            ceiling->top[c] = 0;
+            ceiling->bottom[c] = view->top[c];
+        }
+    }
+}
+
+/*
+ * visplane_draw: Draw a floor or ceiling
+ *
+ * Parameters:
+ *   plane - Plane with its rows filled in
+ *   view - Viewer, as used for the walls
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *
+ * Returns:
+ *   Number of pixels written
+ *
+ * Notes:
+ *   - Rows on the far side of the horizon from the plane are skipped,
+ *     a floor can never be seen above it
+ *   - No perspective divide is done per pixel or per span, only one
+ *     divide for each row the plane touches
+ *   - The texels read are added to the view's count
+ *   - The per-row tables are static rather than on the stack, so
+ *     one plane is drawn at a time and this is not reentrant
+ */
+long visplane_draw(const visplane_t *plane, wall_view_t *view, unsigned char *buffer) {
+    static visplane_target_t target;
+    static short start[SCREEN_HEIGHT];
+    int c, y, t1 = 0, b1 = 0, t2, b2;
+
+    if (plane == NULL || view == NULL || buffer == NULL || plane->texture == NULL ||
+        plane->texture->texture_data == NULL) {
+        return 0;
+    }
+
+    target.view = view;
+    target.tex = plane->texture;
+    target.buffer = buffer;
+    target.height = view->eye - plane->height;
+    target.u_bits = 0;
+    target.v_bits = 0;
+    target.inv_z_scale = FIXED_ZERO;
+    target.size = target.tex->width > target.tex->height ? target.tex->width : target.tex->height;
+    target.pixels = 0;
+    target.texels = 0;
+
+    for (y = 0; y < SCREEN_HEIGHT; y++) {
+        target.step[y] = FIXED_ZERO;
+        target.shade[y] = NULL;
+        target.level[y] = 0;
+    }
+
+    /* Distance is height * focal / dy, so 1 / z is dy times this */
+    if (view->colormap != NULL && target.height != 0) {
+        target.inv_z_scale = fixed_div(FIXED_ONE, fixed_mul(target.height, view->focal));
+    }
+
+    if (target.tex->width_shift >= 1) {
+        y = texture_log2(target.tex->height);
+
+        if (target.tex->width_shift + y <= 16) {
+            target.u_bits = target.tex->width_shift;
+            target.v_bits = y;
+        }
+    }
+
+    /* One column past the edge is empty, which closes every open span */
+    for (c = 0; c <= SCREEN_WIDTH; c++) {
+        t2 = 0;
+        b2 = 0;
+
+        if (c < SCREEN_WIDTH && plane->top[c] < plane->bottom[c]) {
+            t2 = plane->top[c] < 0 ? 0 : plane->top[c];
+            b2 = plane->bottom[c] > SCREEN_HEIGHT ? SCREEN_HEIGHT : plane->bottom[c];
+
+            if (b2 <= t2) {
+                t2 = 0;
+                b2 = 0;
+            }
+        }
+
+        /* Rows the last column had and this one does not end here */
+        while (t1 < b1 && t1 < t2) {
+            visplane_span(&target, t1, start[t1], c);
+            t1++;
+        }
+
+        while (b1 > t1 && b1 > b2) {
+            b1--;
+            visplane_span(&target, b1, start[b1], c);
+        }
+
+        /* Rows this column has and the last one did not start here */
+        for (y = t2; y < b2 && y < t1; y++) {
+            start[y] = (short) c;
+        }
+
+        for (y = b2; y > t2 && y > b1; y--) {
+            start[y - 1] = (short) c;
+        }
+
+        t1 = t2;
+        b1 = b2;
+    }
+
+    view->texels += target.texels;
+
+    return target.pixels;
+}
@@ -0,0 +1,258 @@
+/*
+ * vpack.c
+ *
+ * Implementation of the packed vertex format
+ */
+
+#include "..\include\vpack.h"
+
+#include <string.h>
+
+#include "..\include\trig.h"
+
+/* Shared table of unit normals addressed by packed_vertex_t.normal */
+static vector3_t normal_table[VPACK_NORMAL_COUNT];
+
+/* Layout of the non axis-aligned part of the normal table */
+#define VPACK_RINGS       10 /* Elevation rings between the poles */
+#define VPACK_RING_POINTS 25 /* Azimuth steps per ring */
+
+/*
+ * vpack_pack_coord: Convert a 16.16 value to a clamped 8.8 short
+ *
+ * Parameters:
+ *   x - Fixed-point value to convert
+ *
+ * Returns:
+ *   Rounded 8.8 value clamped to the range of a short
+ */
+static short vpack_pack_coord(fixed_t x) {
+    fixed_t packed = (x + (1L << (FIXED_SHIFT - VPACK_POS_SHIFT - 1))) >>
+                     (FIXED_SHIFT - VPACK_POS_SHIFT);
+
+    if (packed > 32767) {
+        return 32767;
+    }
+
+    if (packed < -32768) {
+        return -32768;
+    }
+
+    return (short) packed;
+}
+
+/*
+ * vpack_init: Build the shared normal table
+ *
+ * Notes:
+ *   - Requires trig_init() to be called before use
+ *   - The first six entries are exact axis directions so maze walls,
+ *     floors and ceilings quantize without error
+ *   - The rest are spread over rings of constant elevation
+ */
+void vpack_init(void) {
+    int ring, point, index;
+    unsigned char elevation, azimuth;
+    fixed_t ring_radius;
+
+    normal_table[VPACK_NORMAL_POS_X] = vector3_init(FIXED_ONE, FIXED_ZERO, FIXED_ZERO);
+    normal_table[VPACK_NORMAL_NEG_X] = vector3_init(-FIXED_ONE, FIXED_ZERO, FIXED_ZERO);
+    normal_table[VPACK_NORMAL_POS_Y] = vector3_init(FIXED_ZERO, FIXED_ONE, FIXED_ZERO);
+    normal_table[VPACK_NORMAL_NEG_Y] = vector3_init(FIXED_ZERO, -FIXED_ONE, FIXED_ZERO);
+    normal_table[VPACK_NORMAL_POS_Z] = vector3_init(FIXED_ZERO, FIXED_ZERO, FIXED_ONE);
+    normal_table[VPACK_NORMAL_NEG_Z] = vector3_init(FIXED_ZERO, FIXED_ZERO, -FIXED_ONE);
+
+    index = VPACK_NORMAL_NEG_Z + 1;
+
+    for (ring = 1; ring <= VPACK_RINGS; ring++) {
+        /* Elevation from just above -90 to just below +90 degrees */
+        elevation = (unsigned char) (192 + (ring * 128) / (VPACK_RINGS + 1));
+        ring_radius = trig_cosine(elevation);
+
+        for (point = 0; point < VPACK_RING_POINTS; point++) {
+            azimuth = (unsigned char) ((point * TRIG_ANGLE_MAX) / VPACK_RING_POINTS);
+
+            normal_table[index++] = vector3_init(fixed_mul(ring_radius, trig_cosine(azimuth)),
+                                                 trig_sine(elevation),
+                                                 fixed_mul(ring_radius, trig_sine(azimuth)));
+        }
+    }
+}
+
+/*
+ * vpack_get_normal_table: Get pointer to the shared normal table
+ *
+ * Returns:
+ *   Pointer to VPACK_NORMAL_COUNT unit normals
+ */
+const vector3_t *vpack_get_normal_table(void) {
+    return normal_table;
+}
+
+/*
+ * vpack_quantize_normal: Find the table entry closest to a normal
+ *
+ * Parameters:
+ *   normal - Unit normal to quantize
+ *
+ * Returns:
+ *   Index of the table normal with the largest dot product
+ *
+ * Notes:
+ *   - Linear search, intended for load time packing only
+ */
+unsigned char vpack_quantize_normal(vector3_t normal) {
+    int i, best = 0;
+    fixed_t dot, best_dot = FIXED_MIN;
+
+    for (i = 0; i < VPACK_NORMAL_COUNT; i++) {
+        dot = vector3_dot(normal, normal_table[i]);
+
+        if (dot > best_dot) {
+            best_dot = dot;
+            best = i;
+        }
+    }
+
+    return (unsigned char) best;
+}
+
+/*
+ * vpack_pack: Pack a vertex relative to a sector origin
+ *
+ * Parameters:
+ *   v - Pointer to vertex to pack
+ *   origin - Pointer to the sector origin the position is stored against
+ *   color - Palette index for the vertex color
+ *
+ * Returns:
+ *   Packed vertex
+ *
+ * Notes:
+ *   - Positions must lie within 128 units of the origin
+ *   - Texture coordinates wrap every 256 units
+ */
+packed_vertex_t vpack_pack(const vertex_t *v, const vector3_t *origin, unsigned char color) {
+    packed_vertex_t result;
+    vector3_t local;
+
+    memset(&result, 0, sizeof(result));
+
+    if (v == NULL || origin == NULL) {
+        return result;
+    }
+
+    local = vector3_sub(v->position, *origin);
+
+    result.x = vpack_pack_coord(local.x);
+    result.y = vpack_pack_coord(local.y);
+    result.z = vpack_pack_coord(local.z);
+    result.normal = vpack_quantize_normal(v->normal);
+    result.color = color;
+    result.u = (unsigned short) ((v->texcoord.u + (1L << (FIXED_SHIFT - VPACK_UV_SHIFT - 1))) >>
+                                 (FIXED_SHIFT - VPACK_UV_SHIFT));
+    result.v = (unsigned short) ((v->texcoord.v + (1L << (FIXED_SHIFT - VPACK_UV_SHIFT - 1))) >>
+                                 (FIXED_SHIFT - VPACK_UV_SHIFT));
+
+    return result;
+}
+
+/*
+ * vpack_unpack: Expand a packed vertex back to the full vertex format
+ *
+ * Parameters:
+ *   p - Pointer to packed vertex
+ *   origin - Pointer to the sector origin used when packing
+ *   palette - 256 entry palette to resolve the color, or NULL for white
+ *
+ * Returns:
+ *   Unpacked vertex
+ */
+vertex_t vpack_unpack(const packed_vertex_t *p, const vector3_t *origin, const color_t *palette) {
+    vertex_t result;
+
+    if (p == NULL || origin == NULL) {
+        return vertex_init(FIXED_ZERO, FIXED_ZERO, FIXED_ZERO);
+    }
+
+    result = vertex_init(origin->x + ((fixed_t) p->x << (FIXED_SHIFT - VPACK_POS_SHIFT)),
+                         origin->y + ((fixed_t) p->y << (FIXED_SHIFT - VPACK_POS_SHIFT)),
+                         origin->z + ((fixed_t) p->z << (FIXED_SHIFT - VPACK_POS_SHIFT)));
+
+    result.normal = normal_table[p->normal];
+    result.texcoord.u = (fixed_t) p->u << (FIXED_SHIFT - VPACK_UV_SHIFT);
+    result.texcoord.v = (fixed_t) p->v << (FIXED_SHIFT - VPACK_UV_SHIFT);
+
+    if (palette != NULL) {
+        result.color = palette[p->color];
+    }
+
+    return result;
+}
+
+/*
+ * vpack_transform: Transform packed positions straight into 16.16 space
+ *
+ * Parameters:
+ *   src - Array of packed vertices
+ *   dst - Output array of transformed positions
+ *   count - Number of vertices
+ *   origin - Pointer to the sector origin used when packing
+ *   m - Transformation matrix
+ *
+ * Notes:
+ *   - The sector origin is folded into the translation once per call
+ *   - Only the 12 byte packed records are read, nothing is unpacked
+ */
+void vpack_transform(const packed_vertex_t *src,
+                     vector3_t *dst,
+                     int count,
+                     const vector3_t *origin,
+                     const matrix_t *m) {
+    vector3_t base;
+    fixed_t x, y, z;
+    int i, j;
+
+    if (src == NULL || dst == NULL || origin == NULL || m == NULL) {
+        return;
+    }
+
+    /* Where the sector origin lands after the transform */
+    base = matrix_mul_vector3(m, origin);
+
+    for (i = 0; i < count; i++) {
+        x = (fixed_t) src[i].x << (FIXED_SHIFT - VPACK_POS_SHIFT);
+        y = (fixed_t) src[i].y << (FIXED_SHIFT - VPACK_POS_SHIFT);
+        z = (fixed_t) src[i].z << (FIXED_SHIFT - VPACK_POS_SHIFT);
+
+        for (j = 0; j < 3; j++) {
+            dst[i].v[j] = base.v[j] + fixed_mul(m->m[j][0], x) + fixed_mul(m->m[j][1], y) +
+                          fixed_mul(m->m[j][2], z);
+        }
+    }
+}
+
+/*
+ * vpack_rotate_normal_table: Rotate the whole shared normal table
+ *
+ * Parameters:
+ *   m - Transformation matrix, only the 3x3 block is used
+ *   table - Output array of VPACK_NORMAL_COUNT normals
+ *
+ * Notes:
+ *   - Done once per mesh, after which each packed vertex finds its
+ *     transformed normal with a single lookup of table[p->normal]
+ *   - Only worth it for meshes with more vertices than table entries
+ *   - The matrix should be orthonormal, results are not renormalized
+ */
+void vpack_rotate_normal_table(const matrix_t *m, vector3_t *table) {
+    int i;
+
+    if (m == NULL || table == NULL) {
+        return;
+    }
+
+    for (i = 0; i < VPACK_NORMAL_COUNT; i++) {
+        table[i] = matrix_rotate_vector3(m, &normal_table[i]);
+    }
+}
@@ -0,0 +1,265 @@
+/*
+ * vstream.c
+ *
+ * Implementation of structure-of-arrays vertex streams
+ */
+
+#include "..\include\vstream.h"
+
+#include <string.h>
+
+#include "..\include\triangle.h"
+
+/*
+ * vstream_init: Attach caller owned arrays to a vertex stream
+ *
+ * Parameters:
+ *   s - Pointer to stream to initialize
+ *   positions - Position array or NULL
+ *   normals - Normal array or NULL
+ *   colors - Color array or NULL
+ *   texcoords - Texture coordinate array or NULL
+ *   capacity - Number of vertices each non-NULL array can hold
+ *
+ * Notes:
+ *   - No memory is allocated, streams that are never needed can be left NULL
+ */
+void vstream_init(vertex_stream_t *s,
+                  vector3_t *positions,
+                  vector3_t *normals,
+                  color_t *colors,
+                  texcoord_t *texcoords,
+                  int capacity) {
+    if (s == NULL) {
+        return;
+    }
+
+    s->positions = positions;
+    s->normals = normals;
+    s->colors = colors;
+    s->texcoords = texcoords;
+    s->count = 0;
+    s->capacity = capacity;
+    s->attribs = 0;
+
+    if (positions != NULL) {
+        s->attribs |= VSTREAM_POSITION;
+    }
+
+    if (normals != NULL) {
+        s->attribs |= VSTREAM_NORMAL;
+    }
+
+    if (colors != NULL) {
+        s->attribs |= VSTREAM_COLOR;
+    }
+
+    if (texcoords != NULL) {
+        s->attribs |= VSTREAM_TEXCOORD;
+    }
+}
+
+/*
+ * vstream_attribs_for_mode: Get the streams a triangle render mode reads
+ *
+ * Parameters:
+ *   render_mode - TRIANGLE_FLAT or TRIANGLE_TEXTURED
+ *
+ * Returns:
+ *   VSTREAM_* flags needed to draw that mode
+ *
+ * Notes:
+ *   - Flat triangles take their color from the triangle, so only positions
+ *   - Add VSTREAM_NORMAL when a lighting pass is run
+ */
+int vstream_attribs_for_mode(int render_mode) {
+    if (render_mode == TRIANGLE_TEXTURED) {
+        return VSTREAM_POSITION | VSTREAM_TEXCOORD;
+    }
+
+    return VSTREAM_POSITION;
+}
+
+/*
+ * vstream_load: Scatter an array of vertices into a stream
+ *
+ * Parameters:
+ *   s - Pointer to destination stream
+ *   vertices - Array of vertices to load
+ *   count - Number of vertices
+ *   attribs - VSTREAM_* flags of the attributes to copy
+ *
+ * Returns:
+ *   Number of vertices loaded, 0 if the stream is too small
+ *
+ * Notes:
+ *   - Attributes without an array in the stream are skipped
+ *   - Meant for load time conversion of existing vertex_t data
+ */
+int vstream_load(vertex_stream_t *s, const vertex_t *vertices, int count, int attribs) {
+    int i;
+
+    if (s == NULL || vertices == NULL || count > s->capacity) {
+        return 0;
+    }
+
+    attribs &= s->attribs;
+
+    for (i = 0; i < count; i++) {
+        if (attribs & VSTREAM_POSITION) {
+            s->positions[i] = vertices[i].position;
+        }
+
+        if (attribs & VSTREAM_NORMAL) {
+            s->normals[i] = vertices[i].normal;
+        }
+
+        if (attribs & VSTREAM_COLOR) {
+            s->colors[i] = vertices[i].color;
+        }
+
+        if (attribs & VSTREAM_TEXCOORD) {
+            s->texcoords[i] = vertices[i].texcoord;
+        }
+    }
+
+    s->count = count;
+
+    return count;
+}
+
+/*
+ * vstream_get: Gather one vertex back out of a stream
+ *
+ * Parameters:
+ *   s - Pointer to source stream
+ *   index - Vertex index
+ *
+ * Returns:
+ *   Vertex with the stream's attributes, defaults for missing streams
+ */
+vertex_t vstream_get(const vertex_stream_t *s, int index) {
+    vertex_t result = vertex_init(FIXED_ZERO, FIXED_ZERO, FIXED_ZERO);
+
+    if (s == NULL || index < 0 || index >= s->count) {
+        return result;
+    }
+
+    if (s->positions != NULL) {
+        result.position = s->positions[index];
+    }
+
+    if (s->normals != NULL) {
+        result.normal = s->normals[index];
+    }
+
+    if (s->colors != NULL) {
+        result.color = s->colors[index];
+    }
+
+    if (s->texcoords != NULL) {
+        result.texcoord = s->texcoords[index];
+    }
+
+    return result;
+}
+
+/*
+ * vstream_transform: Transform selected streams of a vertex stream
+ *
+ * Parameters:
+ *   src - Pointer to source stream
+ *   dst - Pointer to destination stream
+ *   m - Transformation matrix
+ *   attribs - VSTREAM_* flags of the attributes the caller needs
+ *
+ * Returns:
+ *   Number of vertices written to dst, 0 on error
+ *
+ * Notes:
+ *   - Each requested attribute is a separate sequential walk of one array
+ *   - Positions are transformed, normals rotated by the 3x3 block and only
+ *     renormalized if the matrix is not orthonormal
+ *   - Colors and texture coordinates are unchanged by a transform, so they
+ *     are copied only when dst has its own arrays, never when they alias src
+ */
+int vstream_transform(const vertex_stream_t *src,
+                      vertex_stream_t *dst,
+                      const matrix_t *m,
+                      int attribs) {
+    int i, count, renormalize;
+
+    if (src == NULL || dst == NULL || m == NULL || src->count > dst->capacity) {
+        return 0;
+    }
+
+    count = src->count;
+    attribs &= src->attribs & dst->attribs;
+
+    if (attribs & VSTREAM_POSITION) {
+        for (i = 0; i < count; i++) {
+            dst->positions[i] = matrix_mul_vector3(m, &src->positions[i]);
+        }
+    }
+
+    if (attribs & VSTREAM_NORMAL) {
+        renormalize = !matrix_is_orthonormal(m);
+
+        for (i = 0; i < count; i++) {
+            dst->normals[i] = matrix_rotate_vector3(m, &src->normals[i]);
+        }
+
+        if (renormalize) {
+            for (i = 0; i < count; i++) {
+                dst->normals[i] = vector3_normalize(dst->normals[i]);
+            }
+        }
+    }
+
+    if ((attribs & VSTREAM_COLOR) && dst->colors != src->colors) {
+        memcpy(dst->colors, src->colors, count * sizeof(color_t));
+    }
+
+    if ((attribs & VSTREAM_TEXCOORD) && dst->texcoords != src->texcoords) {
+        memcpy(dst->texcoords, src->texcoords, count * sizeof(texcoord_t));
+    }
+
+    dst->count = count;
+
+    return count;
+}
+
+/*
+ * vstream_light: Compute a diffuse light intensity per vertex
+ *
+ * Parameters:
+ *   s - Pointer to stream with a normal array
+ *   light_dir - Unit vector pointing towards the light
+ *   ambient - Ambient intensity added to every vertex
+ *   intensity - Output array, one value in [0, 1] per vertex
+ *
+ * Notes:
+ *   - Only the normal stream is read
+ */
+void vstream_light(const vertex_stream_t *s,
+                   vector3_t light_dir,
+                   fixed_t ambient,
+                   fixed_t *intensity) {
+    fixed_t diffuse, total;
+    int i;
+
+    if (s == NULL || s->normals == NULL || intensity == NULL) {
+        return;
+    }
+
+    for (i = 0; i < s->count; i++) {
+        diffuse = vector3_dot(s->normals[i], light_dir);
+
+        if (diffuse < FIXED_ZERO) {
+            diffuse = FIXED_ZERO;
+        }
+
+        total = fixed_add(ambient, diffuse);
+        intensity[i] = (total > FIXED_ONE) ? FIXED_ONE : total;
+    }
+}
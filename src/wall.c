@@ -0,0 +1,614 @@
+/*
+ * wall.c
+ *
+ * Implementation of the wall column renderer
+ *
+ * Walls are moved into view space with the sine and cosine of the view
+ * angle and clipped to the near plane and the sides of the view. 1/z
+ * and u/z are linear in screen x, so they are stepped across the
+ * wall's columns and each column takes one divide to get its distance.
+ * From the distance come the column's height on screen, its texture
+ * column, the texture step per row and its light row, and the column
+ * is drawn by stepping v down it in 16.16.
+ */
+
+#include "..\include\wall.h"
+
+#include <stddef.h>
+
+#include "..\include\colormap.h"
+#include "..\include\defs.h"
+#include "..\include\masked.h"
+#include "..\include\surface.h"
+#include "..\include\trig.h"
+
+/* First pixel whose centre is at or past a 16.16 coordinate */
+#define WALL_CEIL(v) ((int) (((v) - FIXED_HALF + FIXED_ONE - 1) >> FIXED_SHIFT))
+
+/* One end of a wall in view space */
+typedef struct {
+    fixed_t x;  // View space x, +x to the right
+    fixed_t z;  // Distance along the view direction
+    fixed_t u;  // Texture u, texels
+} wall_end_t;
+
+/*
+ * wall_clip_plane: Cut off the part of a wall behind a plane
+ *
+ * Parameters:
+ *   a, b - Wall ends, the one behind the plane is moved onto it
+ *   da, db - Signed distance of each end from the plane, negative behind
+ *
+ * Returns:
+ *   FALSE if the whole wall is behind the plane
+ */
+static int wall_clip_plane(wall_end_t *a, wall_end_t *b, fixed_t da, fixed_t db) {
+    wall_end_t *from = a, *to = b;
+    fixed_t t;
+
+    if (da < 0 && db < 0) {
+        return FALSE;
+    }
+
+    if (da >= 0 && db >= 0) {
+        return TRUE;
+    }
+
+    if (db < 0) {
+        from = b;
+        to = a;
+        t = fixed_div(db, db - da);
+    } else {
+        t = fixed_div(da, da - db);
+    }
+
+    from->x += fixed_mul(to->x - from->x, t);
+    from->z += fixed_mul(to->z - from->z, t);
+    from->u += fixed_mul(to->u - from->u, t);
+
+    return TRUE;
+}
+
+/*
+ * wall_column: Draw one textured wall column
+ *
+ * Parameters:
+ *   view - View, the column's depth and rows are recorded in it
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   c - Column
+ *   inv_z - 1 / z of the wall in this column
+ *   uz - u / z of the wall in this column
+ *   du, dz - Change in u / z and in 1 / z << WALL_Z_SHIFT per column
+ *   wall - Wall being drawn
+ *   texel_step - Texture rows per screen row at distance 1
+ *
+ * Returns:
+ *   Number of pixels written
+ *
+ * Notes:
+ *   - The only divide is for the distance, everything else in the
+ *     column follows from it with multiplies
+ *   - A lit column costs one more lookup per pixel, its light and fog
+ *     are the same all the way down
+ *   - A wall with a lightmap is drawn from its pre-lit block when the
+ *     view has a surface cache, at unlit cost and without fog
+ *   - A mipmapped texture takes the level for the larger of the texel
+ *     steps down the column and across to the next one
+ */
+static int wall_column(wall_view_t *view,
+                       unsigned char *buffer,
+                       int c,
+                       fixed_t inv_z,
+                       fixed_t uz,
+                       fixed_t du,
+                       fixed_t dz,
+                       const wall_t *wall,
+                       fixed_t texel_step) {
+    const texture_t *tex = wall->texture, *lit = NULL;
+    const unsigned char *column, *shade = NULL;
+    unsigned char *dst, texel;
+    unsigned long v_mask;
+    fixed_t dist, scale, v, step, u_fixed, across;
+    long u;
+    int r0, r1, count, touched, tu, tv, v_shift, segment, level = 0;
+
+    dist = fixed_div(FIXED_ONE, inv_z);
+    scale = fixed_mul(view->focal, inv_z);
+
+    r0 = WALL_CEIL(WALL_CENTER_Y - fixed_mul(view->ceiling - view->eye, scale));
+    r1 = WALL_CEIL(WALL_CENTER_Y + fixed_mul(view->eye, scale));
+
+    if (r0 < 0) {
+        r0 = 0;
+    }
+
+    if (r1 > SCREEN_HEIGHT) {
+        r1 = SCREEN_HEIGHT;
+    }
+
+    view->depth[c] = inv_z;
+    view->top[c] = (short) r0;
+    view->bottom[c] = (short) r1;
+
+    if (r0 >= r1) {
+        return 0;
+    }
+
+    step = fixed_mul(texel_step, dist);
+    u_fixed = fixed_mul(uz, dist);
+
+    /* u = (u / z) / (1 / z), so across a column u moves by (du - u dz) z */
+    if (tex->mip_levels > 0) {
+        across = fixed_abs(fixed_mul(du - (fixed_mul(u_fixed, dz) >> WALL_Z_SHIFT), dist));
+        tex = texture_mip(tex, across > step ? across : step, &level);
+        step >>= level;
+    }
+
+    /* v at the centre of the first row, counted down from the ceiling */
+    v = (view->ceiling - view->eye) * tex->height -
+        fixed_mul(WALL_CENTER_Y - fixed_from_int(r0) - FIXED_HALF, step);
+
+    u = u_fixed >> (FIXED_SHIFT + level);
+    tu = (int) (u % tex->width);
+
+    if (tu < 0) {
+        tu += tex->width;
+    }
+
+    if (view->cache != NULL && wall->lightmap != NULL) {
+        segment = (int) ((u - tu) / tex->width);
+        lit = surface_cache_get(view->cache, wall->lightmap, tex, wall->u_offset >> level,
+                                segment);
+    }
+
+    /* Lit blocks are as wide as the texture and start at the same v */
+    if (lit != NULL) {
+        tex = lit;
+    } else if (view->colormap != NULL) {
+        shade = colormap_row(view->colormap, view->light, inv_z);
+    }
+
+    column = tex->texture_data + tu;
+    dst = buffer + r0 * SCREEN_WIDTH + c;
+    count = r1 - r0;
+
+    /* Distinct texels read, at most one a row and one texture column in all */
+    touched = step >= FIXED_ONE ? count : (int) ((count * step) >> FIXED_SHIFT) + 1;
+    view->texels += touched < tex->height ? touched : tex->height;
+
+    if (tex->width_shift >= 0) {
+        /* v goes straight to its row offset, masked there */
+        v_shift = FIXED_SHIFT - tex->width_shift;
+        v_mask = (unsigned long) tex->height_mask << tex->width_shift;
+
+        if (shade != NULL) {
+            while (count-- > 0) {
+                *dst = shade[column[((unsigned long) v >> v_shift) & v_mask]];
+                dst += SCREEN_WIDTH;
+                v += step;
+            }
+
+            return r1 - r0;
+        }
+
+        while (count-- > 0) {
+            *dst = column[((unsigned long) v >> v_shift) & v_mask];
+            dst += SCREEN_WIDTH;
+            v += step;
+        }
+    } else {
+        while (count-- > 0) {
+            tv = (int) ((v >> FIXED_SHIFT) % tex->height);
+
+            if (tv < 0) {
+                tv += tex->height;
+            }
+
+            texel = column[tv * tex->width];
+            *dst = shade != NULL ? shade[texel] : texel;
+            dst += SCREEN_WIDTH;
+            v += step;
+        }
+    }
+
+    return r1 - r0;
+}
+
+/*
+ * wall_rows_before: Rows down a column before v reaches a texel row
+ *
+ * Parameters:
+ *   v0 - v at the first row
+ *   step - Change in v per row
+ *   rows_per_texel - 1 / step, for the estimate
+ *   target - v to reach, 16.16 texels
+ *   count - Rows in the column
+ *
+ * Returns:
+ *   Rows whose v is below target, at most count
+ *
+ * Notes:
+ *   - The estimate is a multiply, off by a row at most, and is nudged
+ *     so the answer matches stepping v exactly
+ */
+static int wall_rows_before(fixed_t v0, fixed_t step, fixed_t rows_per_texel, fixed_t target,
+                            int count) {
+    long n;
+
+    if (target <= v0) {
+        return 0;
+    }
+
+    n = (fixed_mul(target - v0, rows_per_texel) + FIXED_ONE - 1) >> FIXED_SHIFT;
+
+    if (n > count) {
+        return count;
+    }
+
+    while (n > 0 && v0 + (n - 1) * step >= target) {
+        n--;
+    }
+
+    while (n < count && v0 + n * step < target) {
+        n++;
+    }
+
+    return (int) n;
+}
+
+/*
+ * wall_masked_column: Draw the opaque runs of one see-through wall column
+ *
+ * Parameters:
+ *   Same as wall_column, without the steps across
+ *
+ * Returns:
+ *   Number of pixels written
+ *
+ * Notes:
+ *   - The view's column results are left alone, whatever shows through
+ *     still belongs to the walls, floors and ceilings behind
+ *   - Every row drawn has its v inside an opaque run, so transparent
+ *     texels are never read and no texel is tested
+ *   - Only the full size texture is used, mip levels and the surface
+ *     cache have no masks
+ */
+static int wall_masked_column(wall_view_t *view,
+                              unsigned char *buffer,
+                              int c,
+                              fixed_t inv_z,
+                              fixed_t uz,
+                              const wall_t *wall,
+                              fixed_t texel_step) {
+    const texture_t *tex = wall->texture;
+    const masked_run_t *run, *end;
+    const unsigned char *column, *shade = NULL;
+    unsigned char *dst, texel;
+    unsigned long row_mask;
+    fixed_t dist, scale, step, rows_per_texel, v0, v, base;
+    long u, t0, t1, k, k1;
+    int r0, r1, count, n0, n1, tu, v_shift, pixels = 0;
+
+    dist = fixed_div(FIXED_ONE, inv_z);
+    scale = fixed_mul(view->focal, inv_z);
+    r0 = WALL_CEIL(WALL_CENTER_Y - fixed_mul(view->ceiling - view->eye, scale));
+    r1 = WALL_CEIL(WALL_CENTER_Y + fixed_mul(view->eye, scale));
+
+    if (r0 < 0) {
+        r0 = 0;
+    }
+
+    if (r1 > SCREEN_HEIGHT) {
+        r1 = SCREEN_HEIGHT;
+    }
+
+    if (r0 >= r1) {
+        return 0;
+    }
+
+    step = fixed_mul(texel_step, dist);
+    rows_per_texel = scale / tex->height;
+    count = r1 - r0;
+    v0 = (view->ceiling - view->eye) * tex->height -
+         fixed_mul(WALL_CENTER_Y - fixed_from_int(r0) - FIXED_HALF, step);
+
+    u = fixed_mul(uz, dist) >> FIXED_SHIFT;
+    tu = (int) (u % tex->width);
+
+    if (tu < 0) {
+        tu += tex->width;
+    }
+
+    if (view->colormap != NULL) {
+        shade = colormap_row(view->colormap, view->light, inv_z);
+    }
+
+    column = tex->texture_data + tu;
+    end = wall->mask->runs + wall->mask->columns[tu + 1];
+    v_shift = FIXED_SHIFT - tex->width_shift;
+    row_mask = ~(unsigned long) tex->width_mask;
+
+    /* Texture repeats the column passes through, rounded down */
+    t0 = v0 >> FIXED_SHIFT;
+    t1 = (v0 + (count - 1) * step) >> FIXED_SHIFT;
+    k = (t0 < 0 ? t0 - tex->height + 1 : t0) / tex->height;
+    k1 = (t1 < 0 ? t1 - tex->height + 1 : t1) / tex->height;
+
+    for (; k <= k1; k++) {
+        base = fixed_from_int(k * tex->height);
+
+        for (run = wall->mask->runs + wall->mask->columns[tu]; run < end; run++) {
+            n0 = wall_rows_before(v0, step, rows_per_texel, base + fixed_from_int(run->top),
+                                  count);
+            n1 = wall_rows_before(v0, step, rows_per_texel,
+                                  base + fixed_from_int(run->top + run->count), count);
+
+            if (n0 >= n1) {
+                continue;
+            }
+
+            /* v - base stays inside the run, so it needs no wrapping */
+            dst = buffer + (r0 + n0) * SCREEN_WIDTH + c;
+            v = v0 + n0 * step - base;
+            pixels += n1 - n0;
+
+            if (tex->width_shift < 0) {
+                while (n0++ < n1) {
+                    texel = column[(v >> FIXED_SHIFT) * tex->width];
+                    *dst = shade != NULL ? shade[texel] : texel;
+                    dst += SCREEN_WIDTH;
+                    v += step;
+                }
+            } else if (shade != NULL) {
+                while (n0++ < n1) {
+                    *dst = shade[column[((unsigned long) v >> v_shift) & row_mask]];
+                    dst += SCREEN_WIDTH;
+                    v += step;
+                }
+            } else {
+                while (n0++ < n1) {
+                    *dst = column[((unsigned long) v >> v_shift) & row_mask];
+                    dst += SCREEN_WIDTH;
+                    v += step;
+                }
+            }
+        }
+    }
+
+    return pixels;
+}
+
+/*
+ * wall_view_init: Place the viewer for a frame
+ *
+ * Parameters:
+ *   view - View to initialize
+ *   x, z - Eye position on the floor plan
+ *   eye - Eye height above the floor
+ *   ceiling - Ceiling height above the floor
+ *   angle - View direction, 0 looks along +z and 64 along +x
+ *   fov - Horizontal field of view in the same units, 1 to 127
+ *
+ * Notes:
+ *   - trig_init must have been called
+ *   - The column results are cleared as by wall_view_clear
+ *   - The view starts unlit, set colormap and light to shade it, and
+ *     cache to draw walls with lightmaps from pre-lit blocks
+ */
+void wall_view_init(wall_view_t *view,
+                    fixed_t x,
+                    fixed_t z,
+                    fixed_t eye,
+                    fixed_t ceiling,
+                    unsigned char angle,
+                    unsigned char fov) {
+    int half = fov / 2;
+
+    if (view == NULL) {
+        return;
+    }
+
+    /* Tangents at and past a right angle are unusable, fall back to 90 degrees */
+    if (half < 1 || half >= TRIG_ANGLE_MAX / 4) {
+        half = TRIG_ANGLE_MAX / 8;
+    }
+
+    view->x = x;
+    view->z = z;
+    view->eye = eye;
+    view->ceiling = ceiling;
+    view->angle = angle;
+    view->sin = trig_sine(angle);
+    view->cos = trig_cosine(angle);
+    view->focal = fixed_div(WALL_CENTER_X, trig_tangent((unsigned char) half));
+    view->colormap = NULL;
+    view->light = FIXED_ONE;
+    view->cache = NULL;
+
+    wall_view_clear(view);
+}
+
+/*
+ * wall_view_clear: Forget every column's wall for a new frame
+ *
+ * Parameters:
+ *   view - View to clear
+ *
+ * Notes:
+ *   - An empty column has its floor and ceiling meet at the horizon
+ *   - The texel count starts again from 0
+ */
+void wall_view_clear(wall_view_t *view) {
+    int c;
+
+    if (view == NULL) {
+        return;
+    }
+
+    for (c = 0; c < SCREEN_WIDTH; c++) {
+        view->depth[c] = FIXED_ZERO;
+        view->top[c] = SCREEN_HEIGHT / 2;
+        view->bottom[c] = SCREEN_HEIGHT / 2;
+    }
+
+    view->texels = 0;
+}
+
+/*
+ * wall_view_transform: Move a floor plan point into view space
+ *
+ * Parameters:
+ *   view - View
+ *   x, z - Floor plan point
+ *   vx - Receives the distance to the right of the view direction
+ *   vz - Receives the distance along the view direction
+ */
+void wall_view_transform(const wall_view_t *view, fixed_t x, fixed_t z, fixed_t *vx, fixed_t *vz) {
+    fixed_t dx = x - view->x;
+    fixed_t dz = z - view->z;
+
+    *vx = fixed_mul(dx, view->cos) - fixed_mul(dz, view->sin);
+    *vz = fixed_mul(dx, view->sin) + fixed_mul(dz, view->cos);
+}
+
+/*
+ * wall_draw: Draw the columns of a wall nearer than what is there
+ *
+ * Parameters:
+ *   view - View, records each column the wall wins
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   wall - Axis-aligned wall
+ *
+ * Returns:
+ *   Number of pixels written
+ *
+ * Notes:
+ *   - A column is drawn when the wall is nearer there than any wall
+ *     drawn before, so walls may come in any order. Front to back
+ *     order draws each column once.
+ *   - Columns follow the same fill rule as the triangle rasterizer,
+ *     walls sharing an end cover each column between them once
+ *   - A wall with a mask draws only its opaque runs and does not record
+ *     its columns, so it must come after the solid walls, floors and
+ *     ceilings of the frame, far to near. It also draws where it is
+ *     exactly as near as the solid wall, so a decal can share one.
+ */
+long wall_draw(wall_view_t *view, unsigned char *buffer, const wall_t *wall) {
+    const texture_t *tex;
+    wall_end_t a, b;
+    fixed_t limit, inv_z0, inv_z1, sx0, sx1, width, uz0, uz1;
+    fixed_t z, uz, dz, du, offset, inv_z, texel_step;
+    long pixels = 0;
+    int c, c0, c1;
+
+    if (view == NULL || buffer == NULL || wall == NULL || wall->texture == NULL ||
+        wall->texture->texture_data == NULL) {
+        return 0;
+    }
+
+    /* A mask only fits the texture it was built from */
+    if (wall->mask != NULL && (wall->mask->width != wall->texture->width ||
+                               wall->mask->height != wall->texture->height)) {
+        return 0;
+    }
+
+    tex = wall->texture;
+    wall_view_transform(view, wall->x0, wall->z0, &a.x, &a.z);
+    wall_view_transform(view, wall->x1, wall->z1, &b.x, &b.z);
+
+    /* Axis-aligned walls measure their length without a square root */
+    a.u = wall->u_offset;
+    b.u = wall->u_offset +
+          (fixed_abs(wall->x1 - wall->x0) + fixed_abs(wall->z1 - wall->z0)) * tex->width;
+
+    /* Near plane, then the sides of the view one pixel outside the screen */
+    limit = fixed_div(WALL_CENTER_X + FIXED_ONE, view->focal);
+
+    if (!wall_clip_plane(&a, &b, a.z - WALL_NEAR, b.z - WALL_NEAR) ||
+        !wall_clip_plane(&a, &b, a.x + fixed_mul(a.z, limit), b.x + fixed_mul(b.z, limit)) ||
+        !wall_clip_plane(&a, &b, fixed_mul(a.z, limit) - a.x, fixed_mul(b.z, limit) - b.x)) {
+        return 0;
+    }
+
+    inv_z0 = fixed_div(FIXED_ONE, a.z);
+    inv_z1 = fixed_div(FIXED_ONE, b.z);
+    sx0 = WALL_CENTER_X + fixed_mul(fixed_mul(a.x, inv_z0), view->focal);
+    sx1 = WALL_CENTER_X + fixed_mul(fixed_mul(b.x, inv_z1), view->focal);
+    width = sx1 - sx0;
+
+    /* Seen from behind or edge on */
+    if (width <= 0) {
+        return 0;
+    }
+
+    c0 = WALL_CEIL(sx0);
+    c1 = WALL_CEIL(sx1);
+
+    if (c0 < 0) {
+        c0 = 0;
+    }
+
+    if (c1 > SCREEN_WIDTH) {
+        c1 = SCREEN_WIDTH;
+    }
+
+    uz0 = fixed_mul(a.u, inv_z0);
+    uz1 = fixed_mul(b.u, inv_z1);
+    dz = FIXED_ZERO;
+    du = FIXED_ZERO;
+
+    /* Walls under a pixel wide keep flat values rather than a huge slope */
+    if (width > FIXED_ONE) {
+        dz = fixed_div(inv_z1 - inv_z0, width >> WALL_Z_SHIFT);
+        du = fixed_div(uz1 - uz0, width);
+    }
+
+    offset = fixed_from_int(c0) + FIXED_HALF - sx0;
+    z = (inv_z0 << WALL_Z_SHIFT) + fixed_mul(dz, offset);
+    uz = uz0 + fixed_mul(du, offset);
+    texel_step = fixed_div(fixed_from_int(tex->height), view->focal);
+
+    for (c = c0; c < c1; c++) {
+        inv_z = (z + (1L << (WALL_Z_SHIFT - 1))) >> WALL_Z_SHIFT;
+
+        if (wall->mask != NULL) {
+            if (inv_z >= view->depth[c]) {
+                pixels += wall_masked_column(view, buffer, c, inv_z, uz, wall, texel_step);
+            }
+        } else if (inv_z > view->depth[c]) {
+            pixels += wall_column(view, buffer, c, inv_z, uz, du, dz, wall, texel_step);
+        }
+
+        z += dz;
+        uz += du;
+    }
+
+    return pixels;
+}
+
+/*
+ * wall_draw_list: Draw a list of walls
+ *
+ * Parameters:
+ *   view - View, records each column a wall wins
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   walls - Walls, front to back order draws each column once
+ *   count - Number of walls
+ *
+ * Returns:
+ *   Number of pixels written
+ */
+long wall_draw_list(wall_view_t *view, unsigned char *buffer, const wall_t *walls, int count) {
+    long pixels = 0;
+    int i;
+
+    if (walls == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < count; i++) {
+        pixels += wall_draw(view, buffer, &walls[i]);
+    }
+
+    return pixels;
+}
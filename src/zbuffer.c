@@ -0,0 +1,328 @@
+/*
+ * zbuffer.c
+ *
+ * Implementation of the 16-bit lazily cleared depth buffer
+ *
+ * A value is the frame's epoch in the top ZBUFFER_EPOCH_BITS, then
+ * 1 + the quantized 1/w. Each frame's epoch is higher than the last, so
+ * anything left from earlier frames compares as farther than every
+ * depth this frame writes, exactly as if it had been cleared. When the
+ * epochs run out the buffer is really cleared and counting restarts.
+ */
+
+#include "..\include\zbuffer.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "..\include\defs.h"
+#include "..\include\raster.h"
+
+/* Destination of zbuffer_draw_triangle rows */
+typedef struct {
+    zbuffer_t *zb;          // Depth buffer to test against
+    unsigned char *buffer;  // Surface to draw passing pixels into
+    unsigned char color;    // Palette index of the triangle
+    long written;           // Pixels that passed
+} zbuffer_target_t;
+
+/*
+ * zbuffer_depth: Quantize 1/w to 16.16 depth units
+ *
+ * Parameters:
+ *   zb - Depth buffer
+ *   inv_w - 1 / w, clamped to 0 and the near plane
+ *
+ * Returns:
+ *   Depth from 0 to ZBUFFER_DEPTH_MAX with 16 fractional bits
+ */
+static fixed_t zbuffer_depth(const zbuffer_t *zb, fixed_t inv_w) {
+    if (inv_w <= 0) {
+        return FIXED_ZERO;
+    }
+
+    if (inv_w >= zb->inv_w_max) {
+        return fixed_from_int(ZBUFFER_DEPTH_MAX);
+    }
+
+    return fixed_mul(inv_w, zb->scale);
+}
+
+/*
+ * zbuffer_span_start: Set up stepping of stored values across a span
+ *
+ * Parameters:
+ *   zb - Depth buffer
+ *   count - Pixels in the span, at least 1
+ *   z - 1 / w at the first pixel
+ *   dz - Change in 1 / w per pixel
+ *   step - Receives the change in value per pixel, 16.16
+ *
+ * Returns:
+ *   Value of the first pixel in the top 16 bits, fraction below
+ *
+ * Notes:
+ *   - Both ends are clamped before the step is worked out, so no pixel
+ *     between them can leave the current epoch
+ */
+static unsigned long zbuffer_span_start(const zbuffer_t *zb, int count, fixed_t z, fixed_t dz,
+                                        fixed_t *step) {
+    fixed_t first = zbuffer_depth(zb, z);
+
+    *step = FIXED_ZERO;
+
+    if (count > 1) {
+        *step = (zbuffer_depth(zb, z + dz * (count - 1)) - first) / (count - 1);
+    }
+
+    return ((unsigned long) (zb->base + 1) << FIXED_SHIFT) + (unsigned long) first;
+}
+
+/*
+ * zbuffer_init: Attach storage to a depth buffer and clear it
+ *
+ * Parameters:
+ *   zb - Depth buffer to initialize
+ *   storage - SCREEN_SIZE values, owned by the caller
+ *   near_dist - Near plane distance, no more than 2.0
+ *
+ * Notes:
+ *   - 1/w is spread over the full depth range from 0 at infinity to
+ *     ZBUFFER_DEPTH_MAX at the near plane
+ */
+void zbuffer_init(zbuffer_t *zb, unsigned short *storage, fixed_t near_dist) {
+    if (zb == NULL) {
+        return;
+    }
+
+    zb->depth = storage;
+    zb->scale = fixed_mul(fixed_from_int(ZBUFFER_DEPTH_MAX), near_dist);
+    zb->inv_w_max = fixed_div(FIXED_ONE, near_dist);
+    zb->epoch = -1;
+    zb->base = 0;
+    zb->clears = 0;
+
+    if (storage != NULL) {
+        memset(storage, 0, SCREEN_SIZE * sizeof(unsigned short));
+    }
+}
+
+/*
+ * zbuffer_begin_frame: Start a new frame
+ *
+ * Parameters:
+ *   zb - Depth buffer
+ *
+ * Notes:
+ *   - Moves to the next epoch, which hides every earlier value without
+ *     touching memory, and only clears for real when epochs run out
+ */
+void zbuffer_begin_frame(zbuffer_t *zb) {
+    if (zb == NULL) {
+        return;
+    }
+
+    zb->epoch++;
+
+    if (zb->epoch >= ZBUFFER_EPOCHS) {
+        memset(zb->depth, 0, SCREEN_SIZE * sizeof(unsigned short));
+        zb->epoch = 0;
+        zb->clears++;
+    }
+
+    zb->base = (unsigned short) (zb->epoch << ZBUFFER_DEPTH_BITS);
+}
+
+/*
+ * zbuffer_value: Get the value stored for a 1/w this frame
+ *
+ * Parameters:
+ *   zb - Depth buffer
+ *   inv_w - 1 / w
+ *
+ * Returns:
+ *   Stored value, including the epoch bits
+ */
+unsigned short zbuffer_value(const zbuffer_t *zb, fixed_t inv_w) {
+    return (unsigned short) (zb->base + 1 + fixed_to_int(zbuffer_depth(zb, inv_w)));
+}
+
+/*
+ * zbuffer_span_test_write: Draw the parts of a span nearer than the buffer
+ *
+ * Parameters:
+ *   zb - Depth buffer
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   y - Row
+ *   x0, x1 - First pixel and one past the last, inside the screen
+ *   z - 1 / w at the centre of pixel x0, larger is nearer
+ *   dz - Change in 1 / w per pixel
+ *   color - Palette index
+ *
+ * Returns:
+ *   Number of pixels written
+ */
+int zbuffer_span_test_write(zbuffer_t *zb,
+                            unsigned char *buffer,
+                            int y,
+                            int x0,
+                            int x1,
+                            fixed_t z,
+                            fixed_t dz,
+                            unsigned char color) {
+    unsigned short *d;
+    unsigned char *p;
+    unsigned short value;
+    unsigned long acc;
+    fixed_t step;
+    int count = x1 - x0, written = 0;
+
+    if (count <= 0) {
+        return 0;
+    }
+
+    acc = zbuffer_span_start(zb, count, z, dz, &step);
+    d = zb->depth + y * SCREEN_WIDTH + x0;
+    p = buffer + y * SCREEN_WIDTH + x0;
+
+    while (count-- > 0) {
+        value = (unsigned short) (acc >> FIXED_SHIFT);
+
+        if (value > *d) {
+            *d = value;
+            *p = color;
+            written++;
+        }
+
+        d++;
+        p++;
+        acc += step;
+    }
+
+    return written;
+}
+
+/*
+ * zbuffer_span_test: Count the pixels of a span nearer than the buffer
+ *
+ * Parameters:
+ *   zb - Depth buffer
+ *   y - Row
+ *   x0, x1 - First pixel and one past the last, inside the screen
+ *   z - 1 / w at the centre of pixel x0
+ *   dz - Change in 1 / w per pixel
+ *
+ * Returns:
+ *   Number of pixels that would pass, nothing is written
+ *
+ * Notes:
+ *   - Meant for occlusion queries against bounding geometry
+ */
+int zbuffer_span_test(const zbuffer_t *zb, int y, int x0, int x1, fixed_t z, fixed_t dz) {
+    const unsigned short *d;
+    unsigned long acc;
+    fixed_t step;
+    int count = x1 - x0, visible = 0;
+
+    if (count <= 0) {
+        return 0;
+    }
+
+    acc = zbuffer_span_start(zb, count, z, dz, &step);
+    d = zb->depth + y * SCREEN_WIDTH + x0;
+
+    while (count-- > 0) {
+        if ((unsigned short) (acc >> FIXED_SHIFT) > *d++) {
+            visible++;
+        }
+
+        acc += step;
+    }
+
+    return visible;
+}
+
+/*
+ * zbuffer_span_write: Store the depth of a span without testing
+ *
+ * Parameters:
+ *   zb - Depth buffer
+ *   y - Row
+ *   x0, x1 - First pixel and one past the last, inside the screen
+ *   z - 1 / w at the centre of pixel x0
+ *   dz - Change in 1 / w per pixel
+ *
+ * Notes:
+ *   - For geometry already known to be visible, such as the spans left
+ *     by the span buffer, that later z-buffered objects must respect
+ */
+void zbuffer_span_write(zbuffer_t *zb, int y, int x0, int x1, fixed_t z, fixed_t dz) {
+    unsigned short *d;
+    unsigned long acc;
+    fixed_t step;
+    int count = x1 - x0;
+
+    if (count <= 0) {
+        return;
+    }
+
+    acc = zbuffer_span_start(zb, count, z, dz, &step);
+    d = zb->depth + y * SCREEN_WIDTH + x0;
+
+    while (count-- > 0) {
+        *d++ = (unsigned short) (acc >> FIXED_SHIFT);
+        acc += step;
+    }
+}
+
+/*
+ * zbuffer_emit: Depth test one rasterized row, raster_span_fn for zbuffer_draw_triangle
+ */
+static void zbuffer_emit(void *context, const raster_span_t *span) {
+    zbuffer_target_t *target = (zbuffer_target_t *) context;
+    fixed_t width = span->right_x - span->left_x;
+    fixed_t dz = FIXED_ZERO, z;
+
+    /* Spans under a pixel wide keep a flat depth rather than a huge slope */
+    if (width > FIXED_ONE) {
+        dz = fixed_div(span->right_z - span->left_z, width);
+    }
+
+    z = span->left_z + fixed_mul(dz, fixed_from_int(span->x0) + FIXED_HALF - span->left_x);
+    target->written += zbuffer_span_test_write(target->zb, target->buffer, span->y, span->x0,
+                                               span->x1, z, dz, target->color);
+}
+
+/*
+ * zbuffer_draw_triangle: Draw the visible pixels of a flat shaded triangle
+ *
+ * Parameters:
+ *   zb - Depth buffer
+ *   buffer - SCREEN_WIDTH by SCREEN_HEIGHT 8-bit surface
+ *   v0, v1, v2 - Projected vertices, inv_w gives the depth
+ *   color - Palette index
+ *
+ * Returns:
+ *   Number of pixels written
+ */
+long zbuffer_draw_triangle(zbuffer_t *zb,
+                           unsigned char *buffer,
+                           const screen_vertex_t *v0,
+                           const screen_vertex_t *v1,
+                           const screen_vertex_t *v2,
+                           unsigned char color) {
+    zbuffer_target_t target;
+
+    if (zb == NULL || buffer == NULL) {
+        return 0;
+    }
+
+    target.zb = zb;
+    target.buffer = buffer;
+    target.color = color;
+    target.written = 0;
+
+    raster_walk_triangle(v0, v1, v2, RASTER_ATTR_Z, zbuffer_emit, &target);
+
+    return target.written;
+}
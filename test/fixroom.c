@@ -0,0 +1,64 @@
+/*
+ * fixroom.c
+ *
+ * Implementation of the shared wall fixtures
+ */
+
+#include "fixroom.h"
+
+#include <stddef.h>
+
+#include "..\include\trig.h"
+
+/*
+ * fixture_wall: Fill in an unlit solid wall from floor plan coordinates
+ *
+ * Parameters:
+ *   w - Wall to fill
+ *   t - Texture
+ *   x0, z0 - First end
+ *   x1, z1 - Second end, the wall faces a viewer it runs left to right for
+ */
+void fixture_wall(wall_t *w, const texture_t *t, float x0, float z0, float x1, float z1) {
+    w->x0 = fixed_from_float(x0);
+    w->z0 = fixed_from_float(z0);
+    w->x1 = fixed_from_float(x1);
+    w->z1 = fixed_from_float(z1);
+    w->texture = t;
+    w->u_offset = 0;
+    w->lightmap = NULL;
+    w->mask = NULL;
+}
+
+/*
+ * fixture_room: The inside of a 4 by 4 room around the origin
+ *
+ * Parameters:
+ *   walls - 4 walls to fill
+ *   t - Texture of every wall
+ */
+void fixture_room(wall_t *walls, const texture_t *t) {
+    static const float corners[5][2] = {{-2, 2}, {2, 2}, {2, -2}, {-2, -2}, {-2, 2}};
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        fixture_wall(&walls[i], t, corners[i][0], corners[i][1], corners[i + 1][0],
+                     corners[i + 1][1]);
+    }
+}
+
+/*
+ * fixture_room_view: The viewpoint the room is drawn from
+ *
+ * Parameters:
+ *   view - View to initialize, unlit and with no surface cache
+ *   ceiling - Height of the ceiling
+ *
+ * Notes:
+ *   - Off center and turned so every wall is seen at an angle
+ */
+void fixture_room_view(wall_view_t *view, fixed_t ceiling) {
+    trig_init();
+    wall_view_init(view, fixed_from_float(0.3f), fixed_from_float(-0.7f), FIXED_HALF, ceiling, 40,
+                   64);
+}
@@ -0,0 +1,19 @@
+/*
+ * fixroom.h
+ *
+ * Shared wall fixtures for the renderer test suites
+ * Kept apart from the palette fixtures so that only suites which draw
+ * walls link the wall renderer.
+ */
+
+#ifndef FIXROOM_H
+#define FIXROOM_H
+
+#include "..\include\wall.h"
+
+/* Function prototypes */
+void fixture_wall(wall_t *w, const texture_t *t, float x0, float z0, float x1, float z1);
+void fixture_room(wall_t *walls, const texture_t *t);
+void fixture_room_view(wall_view_t *view, fixed_t ceiling);
+
+#endif /* FIXROOM_H */
@@ -0,0 +1,75 @@
+/*
+ * fixture.c
+ *
+ * Implementation of the shared test fixtures
+ */
+
+#include "fixture.h"
+
+/*
+ * fixture_grey_palette: Fill a palette with a grey ramp
+ *
+ * Parameters:
+ *   palette - 256 entries to fill
+ *
+ * Notes:
+ *   - Every index is its own brightness
+ */
+void fixture_grey_palette(color_t *palette) {
+    int i;
+
+    for (i = 0; i < 256; i++) {
+        palette[i].r = (unsigned char) i;
+        palette[i].g = (unsigned char) i;
+        palette[i].b = (unsigned char) i;
+    }
+}
+
+/*
+ * fixture_hue_palette: Fill a palette with ramps of FIXTURE_HUES hues
+ *
+ * Parameters:
+ *   palette - 256 entries, the first FIXTURE_HUES * levels are filled
+ *   levels - Entries in each ramp
+ *
+ * Notes:
+ *   - Entry hue * levels + level is the hue scaled by
+ *     level / (levels - 1), so level 0 of every ramp is black
+ */
+void fixture_hue_palette(color_t *palette, int levels) {
+    static const unsigned char hues[FIXTURE_HUES][3] = {
+        {255, 0, 0}, {0, 255, 0}, {0, 0, 255}, {255, 255, 0},
+        {0, 255, 255}, {255, 0, 255}, {255, 255, 255}, {255, 128, 64}
+    };
+    int hue, level, i;
+
+    for (hue = 0; hue < FIXTURE_HUES; hue++) {
+        for (level = 0; level < levels; level++) {
+            i = hue * levels + level;
+            palette[i].r = (unsigned char) (hues[hue][0] * level / (levels - 1));
+            palette[i].g = (unsigned char) (hues[hue][1] * level / (levels - 1));
+            palette[i].b = (unsigned char) (hues[hue][2] * level / (levels - 1));
+        }
+    }
+}
+
+/*
+ * fixture_hue_texels: Fill a texture with bright texels of every hue
+ *
+ * Parameters:
+ *   texels - Texels to fill
+ *   count - Number of texels
+ *   levels - Entries in each ramp of the palette
+ *
+ * Notes:
+ *   - Hues change every texel and brightness every FIXTURE_HUES,
+ *     staying in the upper half of each ramp so darkening shows
+ */
+void fixture_hue_texels(unsigned char *texels, int count, int levels) {
+    int i;
+
+    for (i = 0; i < count; i++) {
+        texels[i] = (unsigned char) ((i % FIXTURE_HUES) * levels + levels / 2 +
+                                     (i / FIXTURE_HUES) % (levels / 2));
+    }
+}
@@ -0,0 +1,21 @@
+/*
+ * fixture.h
+ *
+ * Shared fixtures for the renderer test suites
+ * Palettes and textures that several suites draw with, so that each
+ * suite only builds what is particular to the module under test.
+ */
+
+#ifndef FIXTURE_H
+#define FIXTURE_H
+
+#include "..\include\vertex.h"
+
+#define FIXTURE_HUES 8  // Color ramps in the hue palette
+
+/* Function prototypes */
+void fixture_grey_palette(color_t *palette);
+void fixture_hue_palette(color_t *palette, int levels);
+void fixture_hue_texels(unsigned char *texels, int count, int levels);
+
+#endif /* FIXTURE_H */
@@ -0,0 +1,160 @@
+/*
+ * tclassif.c
+ *
+ * Test suite for batch triangle classification
+ */
+
+#include <stdio.h>
+
+#include "..\include\classify.h"
+#include "..\include\matrix.h"
+#include "..\include\triangle.h"
+#include "..\include\vertex.h"
+#include "tmath.h"
+
+#define TEST_TRIS 4
+
+/* Make a triangle from three float positions */
+static triangle_t make_tri(float x0,
+                           float y0,
+                           float z0,
+                           float x1,
+                           float y1,
+                           float z1,
+                           float x2,
+                           float y2,
+                           float z2) {
+    return triangle_init(
+        vertex_init(fixed_from_float(x0), fixed_from_float(y0), fixed_from_float(z0)),
+        vertex_init(fixed_from_float(x1), fixed_from_float(y1), fixed_from_float(z1)),
+        vertex_init(fixed_from_float(x2), fixed_from_float(y2), fixed_from_float(z2)));
+}
+
+/* Build one triangle of each class, unit cube frustum with the eye at the origin */
+static void make_scene(triangle_t *tris) {
+    /* Inside and facing the eye */
+    tris[0] = make_tri(0.0f, 0.0f, 0.5f, 0.0f, 0.5f, 0.5f, 0.5f, 0.0f, 0.5f);
+
+    /* Same triangle wound the other way */
+    tris[1] = make_tri(0.0f, 0.0f, 0.5f, 0.5f, 0.0f, 0.5f, 0.0f, 0.5f, 0.5f);
+
+    /* Facing the eye but entirely right of the frustum */
+    tris[2] = make_tri(2.0f, 0.0f, 0.5f, 2.0f, 0.5f, 0.5f, 3.0f, 0.0f, 0.5f);
+
+    /* Facing the eye and reaching through the near plane */
+    tris[3] = make_tri(0.5f, 0.0f, 0.5f, 0.5f, 0.5f, 0.5f, 0.5f, 0.0f, -2.0f);
+}
+
+/* Test clip space outcodes */
+void test_classify_outcode(void) {
+    vector4_t v;
+
+    v = vector4_init(FIXED_ZERO, FIXED_ZERO, FIXED_ZERO, FIXED_ONE);
+    TEST_ASSERT_EQUAL_INT(0, classify_outcode(&v));
+
+    v = vector4_init(fixed_from_int(2), fixed_from_int(-2), FIXED_ZERO, FIXED_ONE);
+    TEST_ASSERT_EQUAL_INT(CLASSIFY_OUT_RIGHT | CLASSIFY_OUT_BOTTOM, classify_outcode(&v));
+
+    v = vector4_init(FIXED_ZERO, FIXED_ZERO, fixed_from_int(-3), fixed_from_int(2));
+    TEST_ASSERT_EQUAL_INT(CLASSIFY_OUT_NEAR, classify_outcode(&v));
+}
+
+/* Test one pass classification into bitmasks */
+void test_classify_triangles(void) {
+    triangle_t tris[TEST_TRIS];
+    unsigned long storage[4 * CLASSIFY_WORDS(TEST_TRIS)];
+    vector4_t clip[3 * TEST_TRIS];
+    classify_masks_t masks;
+    matrix_t identity = matrix_identity();
+    int visible;
+
+    make_scene(tris);
+    classify_masks_init(&masks, storage, TEST_TRIS);
+
+    visible = classify_triangles(tris, TEST_TRIS, &identity, &identity, &masks, clip);
+
+    TEST_ASSERT_EQUAL_INT(2, visible);
+    TEST_ASSERT_EQUAL_INT(0x2, (int) masks.back[0]);
+    TEST_ASSERT_EQUAL_INT(0x4, (int) masks.outside[0]);
+    TEST_ASSERT_EQUAL_INT(0x8, (int) masks.clip[0]);
+    TEST_ASSERT_EQUAL_INT(0x9, (int) masks.visible[0]);
+
+    TEST_ASSERT_EQUAL_INT(TEST_TRIS, masks.stats.tested);
+    TEST_ASSERT_EQUAL_INT(1, masks.stats.back);
+    TEST_ASSERT_EQUAL_INT(1, masks.stats.outside);
+    TEST_ASSERT_EQUAL_INT(1, masks.stats.clip);
+    TEST_ASSERT_EQUAL_INT(0, masks.stats.scissor);
+
+    /* Clip coordinates were written for the visible triangles */
+    TEST_ASSERT_EQUAL_FLOAT(-2.0f, fixed_to_float(clip[3 * 3 + 2].z), 0.001f);
+}
+
+/* Test walking set bits across word boundaries */
+void test_classify_next(void) {
+    unsigned long mask[3] = {0, 0, 0};
+    int i, found = 0, last = -1;
+
+    mask[0] = 1UL << 31;
+    mask[1] = 1UL << 3;
+    mask[2] = 1UL;
+
+    TEST_ASSERT_EQUAL_INT(31, classify_next(mask, 96, 0));
+    TEST_ASSERT_EQUAL_INT(35, classify_next(mask, 96, 32));
+    TEST_ASSERT_EQUAL_INT(64, classify_next(mask, 96, 36));
+    TEST_ASSERT_EQUAL_INT(-1, classify_next(mask, 96, 65));
+    TEST_ASSERT_EQUAL_INT(-1, classify_next(mask, 64, 36));
+
+    for (i = classify_next(mask, 96, 0); i >= 0; i = classify_next(mask, 96, i + 1)) {
+        found++;
+        last = i;
+    }
+
+    TEST_ASSERT_EQUAL_INT(3, found);
+    TEST_ASSERT_EQUAL_INT(64, last);
+}
+
+/* Test frame totals across batches */
+void test_classify_stats(void) {
+    triangle_t tris[TEST_TRIS];
+    unsigned long storage[4 * CLASSIFY_WORDS(TEST_TRIS)];
+    classify_masks_t masks;
+    classify_stats_t frame;
+    matrix_t identity = matrix_identity();
+
+    make_scene(tris);
+    classify_masks_init(&masks, storage, TEST_TRIS);
+    classify_stats_reset(&frame);
+
+    classify_triangles(tris, TEST_TRIS, &identity, &identity, &masks, NULL);
+    classify_stats_add(&frame, &masks.stats);
+    classify_triangles(tris, TEST_TRIS, &identity, &identity, &masks, NULL);
+    classify_stats_add(&frame, &masks.stats);
+
+    TEST_ASSERT_EQUAL_INT(8, frame.tested);
+    TEST_ASSERT_EQUAL_INT(4, frame.visible);
+    TEST_ASSERT_EQUAL_INT(2, frame.back);
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run classification tests */
+    test_begin_suite(&results, "Triangle Classification");
+    test_run(&results, test_classify_outcode, "Clip Space Outcodes");
+    test_run(&results, test_classify_triangles, "Batch Classification");
+    test_end_suite(&results);
+
+    /* Run mask iteration tests */
+    test_begin_suite(&results, "Classification Masks");
+    test_run(&results, test_classify_next, "Set Bit Iteration");
+    test_run(&results, test_classify_stats, "Frame Statistics");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
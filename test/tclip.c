@@ -0,0 +1,172 @@
+/*
+ * tclip.c
+ *
+ * Test suite for homogeneous polygon clipping
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+#include "..\include\classify.h"
+#include "..\include\clip.h"
+#include "..\include\matrix.h"
+#include "..\include\triangle.h"
+#include "..\include\vertex.h"
+#include "tmath.h"
+
+#define BENCH_TRIS 4
+#define BENCH_RUNS 2000
+
+/* Make a clip vertex from clip space floats */
+static clip_vertex_t make_vertex(float x, float y, float z, float w, unsigned char r, float u) {
+    clip_vertex_t v;
+
+    v.position = vector4_init(fixed_from_float(x), fixed_from_float(y), fixed_from_float(z),
+                              fixed_from_float(w));
+    v.color.r = r;
+    v.color.g = 0;
+    v.color.b = 0;
+    v.texcoord.u = fixed_from_float(u);
+    v.texcoord.v = FIXED_ZERO;
+
+    return v;
+}
+
+/* Test a triangle with one vertex behind the near plane becomes a quad */
+void test_clip_near_one_out(void) {
+    clip_vertex_t in[3], out[CLIP_MAX_VERTICES];
+    int count, i;
+
+    /* Near plane is z = -w, the last vertex is behind the eye */
+    in[0] = make_vertex(-1.0f, 0.0f, 1.0f, 2.0f, 0, 0.0f);
+    in[1] = make_vertex(1.0f, 0.0f, 1.0f, 2.0f, 0, 1.0f);
+    in[2] = make_vertex(0.0f, 1.0f, -3.0f, 1.0f, 200, 0.0f);
+
+    count = clip_polygon(in, 3, out, CLIP_PLANES_NEAR);
+    TEST_ASSERT_EQUAL_INT(4, count);
+
+    /* Every output vertex lies on or inside the near plane with w > 0 */
+    for (i = 0; i < count; i++) {
+        TEST_ASSERT("Inside near", out[i].position.z + out[i].position.w >= 0);
+        TEST_ASSERT("Positive w", out[i].position.w > 0);
+    }
+
+    /* Cut from in[1] towards in[2]: z + w goes 3 to -2, t = 0.6 */
+    TEST_ASSERT_EQUAL_FLOAT(1.4f, fixed_to_float(out[3].position.w), 0.01f);
+    TEST_ASSERT_EQUAL_FLOAT(0.4f, fixed_to_float(out[3].texcoord.u), 0.01f);
+    TEST_ASSERT_EQUAL_INT(120, out[3].color.r);
+}
+
+/* Test trivial cases and plane selection */
+void test_clip_trivial(void) {
+    clip_vertex_t in[3], out[CLIP_MAX_VERTICES];
+
+    in[0] = make_vertex(0.0f, 0.0f, 0.0f, 1.0f, 0, 0.0f);
+    in[1] = make_vertex(0.5f, 0.0f, 0.0f, 1.0f, 0, 0.0f);
+    in[2] = make_vertex(0.0f, 0.5f, 0.0f, 1.0f, 0, 0.0f);
+    TEST_ASSERT_EQUAL_INT(3, clip_polygon(in, 3, out, CLIP_PLANES_ALL));
+
+    /* Entirely behind the near plane */
+    in[0].position.z = fixed_from_int(-2);
+    in[1].position.z = fixed_from_int(-2);
+    in[2].position.z = fixed_from_int(-2);
+    TEST_ASSERT_EQUAL_INT(0, clip_polygon(in, 3, out, CLIP_PLANES_NEAR));
+
+    /* Off the right side only matters when the right plane is selected */
+    in[0] = make_vertex(0.0f, 0.0f, 0.0f, 1.0f, 0, 0.0f);
+    in[1] = make_vertex(3.0f, 0.0f, 0.0f, 1.0f, 0, 0.0f);
+    in[2] = make_vertex(0.0f, 0.5f, 0.0f, 1.0f, 0, 0.0f);
+    TEST_ASSERT_EQUAL_INT(3, clip_polygon(in, 3, out, CLIP_PLANES_NEAR));
+    TEST_ASSERT_EQUAL_INT(4, clip_polygon(in, 3, out, CLIP_PLANES_ALL));
+}
+
+/* Build a batch where one triangle reaches behind the eye */
+static void make_scene(triangle_t *tris) {
+    vertex_t a = vertex_init(fixed_from_float(0.0f), FIXED_ZERO, FIXED_HALF);
+    vertex_t b = vertex_init(fixed_from_float(0.0f), FIXED_HALF, FIXED_HALF);
+    vertex_t c = vertex_init(FIXED_HALF, FIXED_ZERO, FIXED_HALF);
+    vertex_t d = vertex_init(FIXED_HALF, FIXED_ZERO, fixed_from_int(-2));
+    int i;
+
+    for (i = 0; i < BENCH_TRIS - 1; i++) {
+        tris[i] = triangle_init(a, b, c);
+    }
+
+    tris[BENCH_TRIS - 1] = triangle_init(c, vertex_init(FIXED_HALF, FIXED_HALF, FIXED_HALF), d);
+}
+
+/* Test the clipper only runs for triangles the classifier flagged */
+void test_clip_classified(void) {
+    triangle_t tris[BENCH_TRIS];
+    unsigned long storage[4 * CLASSIFY_WORDS(BENCH_TRIS)];
+    vector4_t coords[3 * BENCH_TRIS];
+    clip_vertex_t out[CLIP_MAX_VERTICES];
+    classify_masks_t masks;
+    matrix_t identity = matrix_identity();
+
+    make_scene(tris);
+    classify_masks_init(&masks, storage, BENCH_TRIS);
+    classify_triangles(tris, BENCH_TRIS, &identity, &identity, &masks, coords);
+
+    TEST_ASSERT_EQUAL_INT(1, masks.stats.clip);
+    TEST_ASSERT_EQUAL_INT(3, clip_classified(tris, coords, &masks, 0, CLIP_PLANES_NEAR, out));
+    TEST_ASSERT_EQUAL_INT(4, clip_classified(tris, coords, &masks, BENCH_TRIS - 1,
+                                             CLIP_PLANES_NEAR, out));
+}
+
+/* Measure clipped triangle throughput, reported rather than asserted */
+void test_clip_benchmark(void) {
+    triangle_t tris[BENCH_TRIS];
+    unsigned long storage[4 * CLASSIFY_WORDS(BENCH_TRIS)];
+    vector4_t coords[3 * BENCH_TRIS];
+    clip_vertex_t out[CLIP_MAX_VERTICES];
+    classify_masks_t masks;
+    matrix_t identity = matrix_identity();
+    clock_t start, ticks;
+    long clipped = 0, vertices = 0;
+    int run, i;
+
+    make_scene(tris);
+    classify_masks_init(&masks, storage, BENCH_TRIS);
+    classify_triangles(tris, BENCH_TRIS, &identity, &identity, &masks, coords);
+
+    start = clock();
+
+    for (run = 0; run < BENCH_RUNS; run++) {
+        for (i = classify_next(masks.clip, BENCH_TRIS, 0); i >= 0;
+             i = classify_next(masks.clip, BENCH_TRIS, i + 1)) {
+            vertices += clip_classified(tris, coords, &masks, i, CLIP_PLANES_NEAR, out);
+            clipped++;
+        }
+    }
+
+    ticks = clock() - start;
+
+    TEST_ASSERT_EQUAL_INT(BENCH_RUNS, (int) clipped);
+    TEST_ASSERT_EQUAL_INT(BENCH_RUNS * 4, (int) vertices);
+
+    if (ticks > 0) {
+        printf("\n  %ld near clipped triangles in %ld ticks, %ld per second\n", clipped,
+               (long) ticks, (long) (clipped * CLOCKS_PER_SEC / ticks));
+    }
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run clipping tests */
+    test_begin_suite(&results, "Polygon Clipping");
+    test_run(&results, test_clip_near_one_out, "Near Plane Split");
+    test_run(&results, test_clip_trivial, "Trivial Cases");
+    test_run(&results, test_clip_classified, "Classified Triangles");
+    test_run(&results, test_clip_benchmark, "Clipping Throughput");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
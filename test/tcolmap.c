@@ -0,0 +1,314 @@
+/*
+ * tcolmap.c
+ *
+ * Test suite for light tables and shaded texturing
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "..\include\colormap.h"
+#include "..\include\texspan.h"
+#include "..\include\visplane.h"
+#include "..\include\wall.h"
+#include "fixroom.h"
+#include "fixture.h"
+#include "tmath.h"
+
+#define TEX_SIZE   16
+#define ODD_SIZE   12
+#define FOCAL      160.0f
+#define BENCH_RUNS 20
+
+static color_t palette[256];
+static colormap_t cm;
+static unsigned char texels[TEX_SIZE * TEX_SIZE];
+static unsigned char odd_texels[ODD_SIZE * ODD_SIZE];
+static unsigned char screen[SCREEN_SIZE];
+static unsigned char reference[SCREEN_SIZE];
+static texture_t tex, odd_tex;
+static wall_view_t view;
+static visplane_t floor_plane, ceiling_plane;
+static wall_t walls[4];
+
+/* Palette, black fog colormap and textures of bright texels from every hue */
+static void setup(void) {
+    int i;
+
+    fixture_hue_palette(palette, COLORMAP_LEVELS);
+    colormap_build(&cm, palette, NULL);
+
+    fixture_hue_texels(texels, TEX_SIZE * TEX_SIZE, COLORMAP_LEVELS);
+
+    for (i = 0; i < ODD_SIZE * ODD_SIZE; i++) {
+        odd_texels[i] = (unsigned char) ((i % FIXTURE_HUES) * COLORMAP_LEVELS + 31 - i % 8);
+    }
+
+    texture_init(&tex, texels, TEX_SIZE, TEX_SIZE);
+    texture_init(&odd_tex, odd_texels, ODD_SIZE, ODD_SIZE);
+}
+
+/* Draw the room from a fixed viewpoint, lit if a colormap is given */
+static long draw_room(unsigned char *buffer, const texture_t *t, const colormap_t *colormap,
+                      fixed_t light) {
+    long pixels;
+
+    fixture_room(walls, t);
+    fixture_room_view(&view, FIXED_ONE);
+    view.colormap = colormap;
+    view.light = light;
+
+    pixels = wall_draw_list(&view, buffer, walls, 4);
+    visplane_init(&floor_plane, 0, t);
+    visplane_init(&ceiling_plane, FIXED_ONE, t);
+    visplane_from_walls(&floor_plane, &ceiling_plane, &view);
+    pixels += visplane_draw(&floor_plane, &view, buffer);
+    pixels += visplane_draw(&ceiling_plane, &view, buffer);
+
+    return pixels;
+}
+
+/* Whether a lit pixel is the unlit one through a row within one level of expected */
+static int near_level(unsigned char lit, unsigned char unlit, int expected) {
+    int level;
+
+    for (level = expected - 1; level <= expected + 1; level++) {
+        if (level >= 0 && level < COLORMAP_LEVELS && cm.map[level][unlit] == lit) {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/* Test the table darkens each hue along its own ramp */
+void test_colormap_build(void) {
+    color_t white;
+    int hue, level, i;
+
+    setup();
+
+    for (i = 0; i < 256; i++) {
+        TEST_ASSERT_EQUAL_INT(i, cm.map[COLORMAP_LEVELS - 1][i]);
+        TEST_ASSERT_EQUAL_INT(0, cm.map[0][i]);
+    }
+
+    for (hue = 0; hue < FIXTURE_HUES; hue++) {
+        for (level = 1; level < COLORMAP_LEVELS; level++) {
+            TEST_ASSERT_EQUAL_INT(hue * COLORMAP_LEVELS + level,
+                                  cm.map[level][hue * COLORMAP_LEVELS + COLORMAP_LEVELS - 1]);
+        }
+    }
+
+    /* Fading to white, level 0 is white and half way is lighter than the color */
+    white.r = 255;
+    white.g = 255;
+    white.b = 255;
+    colormap_build(&cm, palette, &white);
+
+    TEST_ASSERT_EQUAL_INT(6 * COLORMAP_LEVELS + 31, cm.map[0][COLORMAP_LEVELS + 31]);
+    TEST_ASSERT_EQUAL_INT(COLORMAP_LEVELS + 31, cm.map[COLORMAP_LEVELS - 1][COLORMAP_LEVELS + 31]);
+    TEST_ASSERT("Washed out", palette[cm.map[16][31]].g > 100);
+}
+
+/* Test light levels with and without distance fog */
+void test_colormap_level(void) {
+    setup();
+
+    TEST_ASSERT_EQUAL_INT(COLORMAP_LEVELS - 1, colormap_level(&cm, FIXED_ONE, FIXED_ZERO));
+    TEST_ASSERT_EQUAL_INT(16, colormap_level(&cm, FIXED_HALF, FIXED_ZERO));
+    TEST_ASSERT_EQUAL_INT(0, colormap_level(&cm, -FIXED_ONE, FIXED_ONE));
+    TEST_ASSERT_EQUAL_INT(COLORMAP_LEVELS - 1, colormap_level(&cm, 2 * FIXED_ONE, FIXED_ZERO));
+
+    /* Full light up to the fog distance, then falling off with 1 / z */
+    cm.fog_distance = 2 * FIXED_ONE;
+    TEST_ASSERT_EQUAL_INT(COLORMAP_LEVELS - 1, colormap_level(&cm, FIXED_ONE, FIXED_ONE));
+    TEST_ASSERT_EQUAL_INT(COLORMAP_LEVELS - 1, colormap_level(&cm, FIXED_ONE, FIXED_HALF));
+    TEST_ASSERT_EQUAL_INT(16, colormap_level(&cm, FIXED_ONE, FIXED_ONE / 4));
+    TEST_ASSERT_EQUAL_INT(8, colormap_level(&cm, FIXED_ONE, FIXED_ONE / 8));
+    TEST_ASSERT_EQUAL_INT(8, colormap_level(&cm, FIXED_HALF, FIXED_ONE / 4));
+    TEST_ASSERT_EQUAL_INT(0, colormap_level(&cm, FIXED_ONE, FIXED_ZERO));
+    TEST_ASSERT("Row", colormap_row(&cm, FIXED_ONE, FIXED_ONE / 4) == cm.map[16]);
+}
+
+/* Test a lit room is the unlit room through the right rows */
+void test_colormap_room(void) {
+    const texture_t *textures[2];
+    fixed_t height;
+    float inv_z;
+    long lit, unlit;
+    int pass, c, y, i, wrong = 0, fogged = 0, near = 0, far = 0;
+
+    setup();
+    textures[0] = &tex;
+    textures[1] = &odd_tex;
+
+    for (pass = 0; pass < 2; pass++) {
+        /* Without fog every pixel takes the same row */
+        cm.fog_distance = FIXED_ZERO;
+        unlit = draw_room(reference, textures[pass], NULL, FIXED_ONE);
+        lit = draw_room(screen, textures[pass], &cm, FIXED_HALF);
+        TEST_ASSERT_EQUAL_INT((int) unlit, (int) lit);
+
+        for (i = 0; i < SCREEN_SIZE; i++) {
+            wrong += screen[i] != cm.map[16][reference[i]];
+        }
+
+        /* With fog walls take the row of their column's depth */
+        cm.fog_distance = FIXED_ONE;
+        draw_room(screen, textures[pass], &cm, FIXED_ONE);
+
+        for (c = 0; c < SCREEN_WIDTH; c++) {
+            for (y = 0; y < SCREEN_HEIGHT; y++) {
+                i = y * SCREEN_WIDTH + c;
+
+                if (y >= view.top[c] && y < view.bottom[c]) {
+                    wrong += screen[i] !=
+                             colormap_row(&cm, FIXED_ONE, view.depth[c])[reference[i]];
+                    continue;
+                }
+
+                /* Floors and ceilings take the row of the row's distance */
+                height = y < view.top[c] ? view.eye - FIXED_ONE : view.eye;
+                inv_z = (y + 0.5f - SCREEN_HEIGHT / 2) /
+                        (fixed_to_float(height) * fixed_to_float(view.focal));
+                inv_z = inv_z > 1.0f ? 1.0f : inv_z;
+                fogged += !near_level(screen[i], reference[i],
+                                      (int) (inv_z * (COLORMAP_LEVELS - 1) + 0.5f));
+            }
+        }
+
+        /* The far wall is fogged, the floor under the viewer is not */
+        near += screen[(SCREEN_HEIGHT - 1) * SCREEN_WIDTH + SCREEN_WIDTH / 2] ==
+                reference[(SCREEN_HEIGHT - 1) * SCREEN_WIDTH + SCREEN_WIDTH / 2];
+        far += screen[(SCREEN_HEIGHT / 2) * SCREEN_WIDTH] !=
+               reference[(SCREEN_HEIGHT / 2) * SCREEN_WIDTH];
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, wrong);
+    TEST_ASSERT_EQUAL_INT(0, fogged);
+    TEST_ASSERT_EQUAL_INT(2, near);
+    TEST_ASSERT_EQUAL_INT(2, far);
+}
+
+/* Project a camera space floor point the way project_vertex would */
+static void make_vertex(screen_vertex_t *sv, float x, float z, float u, float v) {
+    memset(sv, 0, sizeof(*sv));
+    sv->x = fixed_from_float(160.0f + FOCAL * x / z);
+    sv->y = fixed_from_float(100.0f + FOCAL / z);
+    sv->inv_w = fixed_from_float(1.0f / z);
+    sv->u_over_w = fixed_from_float(u / z);
+    sv->v_over_w = fixed_from_float(v / z);
+}
+
+/* Test textured spans fog by the depth of each run */
+void test_colormap_texspan(void) {
+    screen_vertex_t v[4];
+    long lit, unlit;
+    float inv_z;
+    int y, x, i, wrong = 0, fogged = 0;
+
+    setup();
+    make_vertex(&v[0], -4.0f, 1.5f, 0.0f, 24.0f);
+    make_vertex(&v[1], 4.0f, 1.5f, 128.0f, 24.0f);
+    make_vertex(&v[2], 4.0f, 30.0f, 128.0f, 480.0f);
+    make_vertex(&v[3], -4.0f, 30.0f, 0.0f, 480.0f);
+
+    memset(reference, 0, SCREEN_SIZE);
+    memset(screen, 0, SCREEN_SIZE);
+    unlit = texspan_polygon(reference, &tex, v, 4);
+    lit = texspan_lit_polygon(screen, &tex, &cm, FIXED_ONE / 4, v, 4);
+    TEST_ASSERT_EQUAL_INT((int) unlit, (int) lit);
+
+    for (i = 0; i < SCREEN_SIZE; i++) {
+        wrong += screen[i] != cm.map[8][reference[i]];
+    }
+
+    /* The floor is one unit below the eye, so 1 / z is the row's offset over the focal length */
+    cm.fog_distance = 3 * FIXED_ONE;
+    memset(screen, 0, SCREEN_SIZE);
+    texspan_lit_polygon(screen, &tex, &cm, FIXED_ONE, v, 4);
+
+    for (y = 0; y < SCREEN_HEIGHT; y++) {
+        inv_z = (y + 0.5f - 100.0f) / FOCAL * 3.0f;
+        inv_z = inv_z > 1.0f ? 1.0f : inv_z;
+
+        for (x = 0; x < SCREEN_WIDTH; x++) {
+            i = y * SCREEN_WIDTH + x;
+
+            if (reference[i] != 0) {
+                fogged += !near_level(screen[i], reference[i],
+                                      (int) (inv_z * (COLORMAP_LEVELS - 1) + 0.5f));
+            }
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, wrong);
+    TEST_ASSERT_EQUAL_INT(0, fogged);
+}
+
+/* Measure lit against unlit fill rate, reported rather than asserted */
+void test_colormap_benchmark(void) {
+    screen_vertex_t v[4];
+    clock_t start, ticks[4];
+    long pixels[4];
+    int run, k;
+
+    setup();
+    cm.fog_distance = 2 * FIXED_ONE;
+    make_vertex(&v[0], -4.0f, 1.5f, 0.0f, 24.0f);
+    make_vertex(&v[1], 4.0f, 1.5f, 128.0f, 24.0f);
+    make_vertex(&v[2], 4.0f, 40.0f, 128.0f, 640.0f);
+    make_vertex(&v[3], -4.0f, 40.0f, 0.0f, 640.0f);
+
+    for (k = 0; k < 4; k++) {
+        pixels[k] = 0;
+        start = clock();
+
+        for (run = 0; run < BENCH_RUNS; run++) {
+            if (k == 0) {
+                pixels[k] += texspan_polygon(screen, &tex, v, 4);
+            } else if (k == 1) {
+                pixels[k] += texspan_lit_polygon(screen, &tex, &cm, FIXED_ONE, v, 4);
+            } else {
+                pixels[k] += draw_room(screen, &tex, k == 3 ? &cm : NULL, FIXED_ONE);
+            }
+        }
+
+        ticks[k] = clock() - start;
+    }
+
+    TEST_ASSERT_EQUAL_INT((int) pixels[0], (int) pixels[1]);
+    TEST_ASSERT_EQUAL_INT((int) pixels[2], (int) pixels[3]);
+
+    if (ticks[0] > 0 && ticks[1] > 0 && ticks[2] > 0 && ticks[3] > 0) {
+        printf("\n  Spans unlit %ld, lit %ld pixels per second\n",
+               (long) ((double) pixels[0] * CLOCKS_PER_SEC / ticks[0]),
+               (long) ((double) pixels[1] * CLOCKS_PER_SEC / ticks[1]));
+        printf("  Room unlit %ld, lit %ld pixels per second\n",
+               (long) ((double) pixels[2] * CLOCKS_PER_SEC / ticks[2]),
+               (long) ((double) pixels[3] * CLOCKS_PER_SEC / ticks[3]));
+    }
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run colormap tests */
+    test_begin_suite(&results, "Colormaps");
+    test_run(&results, test_colormap_build, "Table Build");
+    test_run(&results, test_colormap_level, "Light Levels");
+    test_run(&results, test_colormap_room, "Lit Room");
+    test_run(&results, test_colormap_texspan, "Lit Textured Spans");
+    test_run(&results, test_colormap_benchmark, "Fill Rate");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * tfrustum.c
+ *
+ * Test suite for view frustum culling
+ */
+
+#include <stdio.h>
+
+#include "..\include\frustum.h"
+#include "..\include\matrix.h"
+#include "..\include\trig.h"
+#include "tmath.h"
+
+#define TEST_NODES 7
+
+/* 90 degree square frustum looking down +Z from the origin, near 1, far 65 */
+static void make_frustum(frustum_t *f) {
+    matrix_t projection;
+
+    trig_init();
+    projection = matrix_perspective(64, FIXED_ONE, FIXED_ONE, fixed_from_int(65));
+    frustum_extract(f, &projection);
+}
+
+/* Make a box from integer bounds */
+static aabb_t make_box(int x0, int y0, int z0, int x1, int y1, int z1) {
+    aabb_t box;
+
+    box.min = vector3_init_int(x0, y0, z0);
+    box.max = vector3_init_int(x1, y1, z1);
+
+    return box;
+}
+
+/* Test extracted planes are normalized and face inwards */
+void test_frustum_extract(void) {
+    frustum_t f;
+
+    make_frustum(&f);
+
+    TEST_ASSERT_EQUAL_FLOAT(0.707f, fixed_to_float(f.planes[FRUSTUM_LEFT].normal.x), 0.01f);
+    TEST_ASSERT_EQUAL_FLOAT(0.707f, fixed_to_float(f.planes[FRUSTUM_LEFT].normal.z), 0.01f);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, fixed_to_float(f.planes[FRUSTUM_NEAR].normal.z), 0.01f);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, fixed_to_float(f.planes[FRUSTUM_NEAR].d), 0.01f);
+    TEST_ASSERT_EQUAL_FLOAT(65.0f, fixed_to_float(f.planes[FRUSTUM_FAR].d), 0.05f);
+
+    TEST_ASSERT_EQUAL_INT(FRUSTUM_INSIDE, frustum_test_point(&f, vector3_init_int(0, 0, 10)));
+    TEST_ASSERT_EQUAL_INT(FRUSTUM_OUTSIDE, frustum_test_point(&f, vector3_init_int(20, 0, 10)));
+    TEST_ASSERT_EQUAL_INT(FRUSTUM_OUTSIDE,
+                          frustum_test_point(&f, vector3_init(0, 0, FIXED_HALF)));
+    TEST_ASSERT_EQUAL_INT(FRUSTUM_OUTSIDE, frustum_test_point(&f, vector3_init_int(0, 0, 70)));
+}
+
+/* Test sphere classification and plane masks */
+void test_frustum_sphere(void) {
+    frustum_t f;
+    int mask;
+
+    make_frustum(&f);
+
+    mask = FRUSTUM_MASK_ALL;
+    TEST_ASSERT_EQUAL_INT(FRUSTUM_INSIDE,
+                          frustum_test_sphere(&f, vector3_init_int(0, 0, 10), FIXED_ONE, &mask));
+    TEST_ASSERT_EQUAL_INT(0, mask);
+
+    /* Crossing the right plane leaves only that plane in the mask */
+    mask = FRUSTUM_MASK_ALL;
+    TEST_ASSERT_EQUAL_INT(FRUSTUM_INTERSECT, frustum_test_sphere(&f, vector3_init_int(10, 0, 10),
+                                                                 fixed_from_int(2), &mask));
+    TEST_ASSERT_EQUAL_INT(1 << FRUSTUM_RIGHT, mask);
+
+    TEST_ASSERT_EQUAL_INT(FRUSTUM_OUTSIDE, frustum_test_sphere(&f, vector3_init_int(20, 0, 10),
+                                                               FIXED_ONE, NULL));
+
+    /* A cleared mask tests nothing */
+    mask = 0;
+    f.stats.plane_tests = 0;
+    frustum_test_sphere(&f, vector3_init_int(20, 0, 10), FIXED_ONE, &mask);
+    TEST_ASSERT_EQUAL_INT(0, f.stats.plane_tests);
+}
+
+/* Test box classification */
+void test_frustum_aabb(void) {
+    frustum_t f;
+    aabb_t box;
+
+    make_frustum(&f);
+
+    box = make_box(-1, -1, 10, 1, 1, 12);
+    TEST_ASSERT_EQUAL_INT(FRUSTUM_INSIDE, frustum_test_aabb(&f, &box, NULL));
+
+    box = make_box(8, -1, 10, 12, 1, 12);
+    TEST_ASSERT_EQUAL_INT(FRUSTUM_INTERSECT, frustum_test_aabb(&f, &box, NULL));
+
+    box = make_box(-1, -1, -10, 1, 1, -5);
+    TEST_ASSERT_EQUAL_INT(FRUSTUM_OUTSIDE, frustum_test_aabb(&f, &box, NULL));
+}
+
+/* Test hierarchical culling skips tests below fully inside nodes */
+void test_frustum_hierarchy(void) {
+    frustum_node_t nodes[TEST_NODES];
+    int visible[TEST_NODES];
+    frustum_t f;
+    matrix_t projection, view, view_projection;
+    int count;
+
+    make_frustum(&f);
+
+    /* Root with four sectors, the first split in two */
+    nodes[0].bounds = make_box(-40, -4, -10, 40, 4, 40);
+    nodes[0].first_child = 1;
+    nodes[0].child_count = 4;
+
+    nodes[1].bounds = make_box(-1, -1, 10, 1, 1, 12);
+    nodes[1].first_child = 5;
+    nodes[1].child_count = 2;
+
+    nodes[2].bounds = make_box(8, -1, 10, 12, 1, 12);
+    nodes[3].bounds = make_box(30, -1, 5, 35, 1, 8);
+    nodes[4].bounds = make_box(-1, -1, -10, 1, 1, -5);
+    nodes[5].bounds = make_box(-1, -1, 10, 0, 1, 12);
+    nodes[6].bounds = make_box(0, -1, 10, 1, 1, 12);
+
+    for (count = 2; count < TEST_NODES; count++) {
+        nodes[count].first_child = 0;
+        nodes[count].child_count = 0;
+    }
+
+    count = frustum_cull_nodes(&f, nodes, 0, visible, TEST_NODES);
+
+    TEST_ASSERT_EQUAL_INT(3, count);
+    TEST_ASSERT_EQUAL_INT(5, visible[0]);
+    TEST_ASSERT_EQUAL_INT(6, visible[1]);
+    TEST_ASSERT_EQUAL_INT(2, visible[2]);
+
+    /* The split sector's children were accepted without being tested */
+    TEST_ASSERT_EQUAL_INT(5, f.stats.nodes_tested);
+    TEST_ASSERT_EQUAL_INT(1, f.stats.nodes_inside);
+    TEST_ASSERT_EQUAL_INT(2, f.stats.nodes_culled);
+
+    /* World space planes, camera backed off 100 units sees nothing */
+    projection = matrix_perspective(64, FIXED_ONE, FIXED_ONE, fixed_from_int(65));
+    view = matrix_translation(FIXED_ZERO, FIXED_ZERO, fixed_from_int(100));
+    view_projection = matrix_mul(&projection, &view);
+    frustum_extract(&f, &view_projection);
+
+    TEST_ASSERT_EQUAL_INT(0, frustum_cull_nodes(&f, nodes, 0, visible, TEST_NODES));
+    TEST_ASSERT_EQUAL_INT(1, f.stats.nodes_tested);
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run frustum tests */
+    test_begin_suite(&results, "Frustum Culling");
+    test_run(&results, test_frustum_extract, "Plane Extraction");
+    test_run(&results, test_frustum_sphere, "Sphere Tests");
+    test_run(&results, test_frustum_aabb, "Box Tests");
+    test_run(&results, test_frustum_hierarchy, "Hierarchical Culling");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * tguard.c
+ *
+ * Test suite for guard-band screen clipping
+ */
+
+#include <stdio.h>
+
+#include "..\include\classify.h"
+#include "..\include\guard.h"
+#include "..\include\matrix.h"
+#include "..\include\triangle.h"
+#include "..\include\vertex.h"
+#include "tmath.h"
+
+/* Fill three clip space vertices, the first two fixed on screen */
+static void make_coords(vector4_t *coords, float x, float z, float w) {
+    coords[0] = vector4_init(FIXED_ZERO, FIXED_ZERO, FIXED_ZERO, FIXED_ONE);
+    coords[1] = vector4_init(FIXED_ZERO, FIXED_HALF, FIXED_ZERO, FIXED_ONE);
+    coords[2] = vector4_init(fixed_from_float(x), FIXED_ZERO, fixed_from_float(z),
+                             fixed_from_float(w));
+}
+
+/* Test guard region outcodes */
+void test_guard_outcode(void) {
+    vector4_t v;
+
+    v = vector4_init(fixed_from_int(5), FIXED_ZERO, FIXED_ZERO, FIXED_ONE);
+    TEST_ASSERT_EQUAL_INT(0, guard_outcode(&v));
+
+    v = vector4_init(fixed_from_int(9), fixed_from_int(-20), FIXED_ZERO, FIXED_ONE);
+    TEST_ASSERT_EQUAL_INT(CLASSIFY_OUT_RIGHT | CLASSIFY_OUT_BOTTOM, guard_outcode(&v));
+
+    /* Near and far stay the real planes */
+    v = vector4_init(FIXED_ZERO, FIXED_ZERO, fixed_from_int(-2), FIXED_ONE);
+    TEST_ASSERT_EQUAL_INT(CLASSIFY_OUT_NEAR, guard_outcode(&v));
+}
+
+/* Test triangle guard-band classes and counts */
+void test_guard_classify(void) {
+    vector4_t coords[3];
+    guard_stats_t stats;
+
+    guard_stats_reset(&stats);
+
+    make_coords(coords, 0.5f, 0.0f, 1.0f);
+    TEST_ASSERT_EQUAL_INT(GUARD_ACCEPT, guard_classify(coords, &stats));
+
+    /* Three screens to the right is still inside the guard region */
+    make_coords(coords, 3.0f, 0.0f, 1.0f);
+    TEST_ASSERT_EQUAL_INT(GUARD_SCISSOR, guard_classify(coords, &stats));
+
+    make_coords(coords, 20.0f, 0.0f, 1.0f);
+    TEST_ASSERT_EQUAL_INT(GUARD_CLIP, guard_classify(coords, &stats));
+
+    make_coords(coords, 0.0f, -3.0f, 1.0f);
+    TEST_ASSERT_EQUAL_INT(GUARD_CLIP, guard_classify(coords, &stats));
+
+    /* All three past the right edge */
+    coords[0].x = fixed_from_int(2);
+    coords[1].x = fixed_from_int(2);
+    coords[2] = vector4_init(fixed_from_int(3), FIXED_ZERO, FIXED_ZERO, FIXED_ONE);
+    TEST_ASSERT_EQUAL_INT(GUARD_REJECT, guard_classify(coords, &stats));
+
+    TEST_ASSERT_EQUAL_INT(1, stats.accepted);
+    TEST_ASSERT_EQUAL_INT(1, stats.scissored);
+    TEST_ASSERT_EQUAL_INT(2, stats.clipped);
+    TEST_ASSERT_EQUAL_INT(1, stats.rejected);
+}
+
+/* Test span and row scissoring */
+void test_guard_scissor(void) {
+    int a, b;
+
+    a = -50;
+    b = 100;
+    TEST_ASSERT("Left cut", guard_scissor_span(&a, &b));
+    TEST_ASSERT_EQUAL_INT(0, a);
+    TEST_ASSERT_EQUAL_INT(100, b);
+
+    a = 300;
+    b = 900;
+    TEST_ASSERT("Right cut", guard_scissor_span(&a, &b));
+    TEST_ASSERT_EQUAL_INT(SCREEN_WIDTH, b);
+
+    a = 400;
+    b = 500;
+    TEST_ASSERT("Off screen", !guard_scissor_span(&a, &b));
+
+    a = -10;
+    b = 250;
+    TEST_ASSERT("Rows", guard_scissor_rows(&a, &b));
+    TEST_ASSERT_EQUAL_INT(0, a);
+    TEST_ASSERT_EQUAL_INT(SCREEN_HEIGHT, b);
+}
+
+/* Test the classifier only flags triangles the guard band cannot take */
+void test_guard_batch(void) {
+    triangle_t tris[2];
+    unsigned long storage[4 * CLASSIFY_WORDS(2)];
+    classify_masks_t masks;
+    matrix_t identity = matrix_identity();
+
+    /* Facing the eye and reaching two screens right, then twenty */
+    tris[0] = triangle_init(vertex_init(FIXED_ZERO, FIXED_ZERO, FIXED_HALF),
+                            vertex_init(FIXED_ZERO, FIXED_HALF, FIXED_HALF),
+                            vertex_init(fixed_from_int(2), FIXED_ZERO, FIXED_HALF));
+    tris[1] = triangle_init(vertex_init(FIXED_ZERO, FIXED_ZERO, FIXED_HALF),
+                            vertex_init(FIXED_ZERO, FIXED_HALF, FIXED_HALF),
+                            vertex_init(fixed_from_int(20), FIXED_ZERO, FIXED_HALF));
+
+    classify_masks_init(&masks, storage, 2);
+    TEST_ASSERT_EQUAL_INT(2, classify_triangles(tris, 2, &identity, &identity, &masks, NULL));
+
+    TEST_ASSERT_EQUAL_INT(0x2, (int) masks.clip[0]);
+    TEST_ASSERT_EQUAL_INT(1, masks.stats.scissor);
+    TEST_ASSERT_EQUAL_INT(1, masks.stats.clip);
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run guard-band tests */
+    test_begin_suite(&results, "Guard Band Clipping");
+    test_run(&results, test_guard_outcode, "Guard Outcodes");
+    test_run(&results, test_guard_classify, "Triangle Classes");
+    test_run(&results, test_guard_scissor, "Span Scissoring");
+    test_run(&results, test_guard_batch, "Batch Classification");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
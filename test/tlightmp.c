@@ -0,0 +1,67 @@
+/*
+ * tlightmp.c
+ *
+ * Test suite for lightmap storage and sampling
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "..\include\lightmap.h"
+#include "tmath.h"
+
+#define MAX_LUXELS 256
+
+static unsigned char luxels[MAX_LUXELS];
+static lightmap_t lm;
+
+/* Test luxel counts cover the wall with a luxel at each end */
+void test_lightmap_size(void) {
+    TEST_ASSERT_EQUAL_INT(17 * 5, (int) lightmap_size(0, 0, 4 * FIXED_ONE, 0, FIXED_ONE));
+    TEST_ASSERT_EQUAL_INT(10 * 9, (int) lightmap_size(FIXED_ONE, 0, FIXED_ONE,
+                                                      fixed_from_float(-2.1f), 2 * FIXED_ONE));
+
+    lightmap_init(&lm, luxels, 0, 3 * FIXED_ONE, 4 * FIXED_ONE, 3 * FIXED_ONE, FIXED_ONE);
+    TEST_ASSERT_EQUAL_INT(17, lm.width);
+    TEST_ASSERT_EQUAL_INT(5, lm.height);
+    TEST_ASSERT_EQUAL_INT(0, lm.luxels[84]);
+}
+
+/* Test bilinear sampling between luxels */
+void test_lightmap_sample(void) {
+    lightmap_init(&lm, luxels, 0, 0, FIXED_ONE / 4, 0, FIXED_ONE / 4);
+
+    TEST_ASSERT_EQUAL_INT(2, lm.width);
+    TEST_ASSERT_EQUAL_INT(2, lm.height);
+
+    lm.luxels[0] = 0;
+    lm.luxels[1] = 200;
+    lm.luxels[2] = 100;
+    lm.luxels[3] = 255;
+
+    TEST_ASSERT_EQUAL_INT(0, lightmap_sample(&lm, 0, 0));
+    TEST_ASSERT_EQUAL_INT(255, lightmap_sample(&lm, FIXED_ONE, FIXED_ONE));
+    TEST_ASSERT_EQUAL_INT(50, lightmap_sample(&lm, FIXED_ZERO, FIXED_HALF));
+    TEST_ASSERT_EQUAL_INT(139, lightmap_sample(&lm, FIXED_HALF, FIXED_HALF));
+
+    /* Outside the wall the nearest edge is used */
+    TEST_ASSERT_EQUAL_INT(200, lightmap_sample(&lm, 5 * FIXED_ONE, -FIXED_ONE));
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run lightmap tests */
+    test_begin_suite(&results, "Lightmaps");
+    test_run(&results, test_lightmap_size, "Luxel Counts");
+    test_run(&results, test_lightmap_sample, "Bilinear Sampling");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
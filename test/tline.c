@@ -0,0 +1,249 @@
+/*
+ * tline.c
+ *
+ * Test suite for clipped line drawing
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "..\include\line.h"
+#include "tmath.h"
+
+#define GUARD_BYTES 64
+#define BENCH_RUNS  20
+
+/* Surfaces for the line under test and the reference, with guard bytes around the first */
+static unsigned char surface[GUARD_BYTES + SCREEN_SIZE + GUARD_BYTES];
+static unsigned char reference[SCREEN_SIZE];
+
+#define SCREEN (surface + GUARD_BYTES)
+
+/* Plot one pixel per major axis step, the definition line_draw must match */
+static void reference_line(unsigned char *buffer, int x0, int y0, int x1, int y1,
+                           unsigned char color) {
+    int dx, dy, step, i, x, y, t;
+
+    if (y0 > y1 || (y0 == y1 && x0 > x1)) {
+        t = x0;
+        x0 = x1;
+        x1 = t;
+        t = y0;
+        y0 = y1;
+        y1 = t;
+    }
+
+    dx = x1 - x0;
+    dy = y1 - y0;
+    step = 1;
+
+    if (dx < 0) {
+        dx = -dx;
+        step = -1;
+    }
+
+    for (i = 0; i <= (dx >= dy ? dx : dy); i++) {
+        if (dx >= dy) {
+            x = x0 + step * i;
+            y = y0 + (dx ? (2 * i * dy + dx) / (2 * dx) : 0);
+        } else {
+            x = x0 + step * ((2 * i * dx + dy) / (2 * dy));
+            y = y0 + i;
+        }
+
+        if (line_outcode(x, y) == 0) {
+            buffer[y * SCREEN_WIDTH + x] = color;
+        }
+    }
+}
+
+/* Count pixels of one color */
+static long count_pixels(const unsigned char *buffer, unsigned char color) {
+    long count = 0;
+    int i;
+
+    for (i = 0; i < SCREEN_SIZE; i++) {
+        if (buffer[i] == color) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/* Number of pixels in an unclipped line */
+static int line_length(int x0, int y0, int x1, int y1) {
+    int dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int dy = y1 > y0 ? y1 - y0 : y0 - y1;
+
+    return (dx > dy ? dx : dy) + 1;
+}
+
+/* Compare one line both ways round against the reference */
+static int matches_reference(int x0, int y0, int x1, int y1) {
+    memset(SCREEN, 0, SCREEN_SIZE);
+    memset(reference, 0, SCREEN_SIZE);
+
+    line_draw(SCREEN, x0, y0, x1, y1, 7);
+    reference_line(reference, x0, y0, x1, y1, 7);
+
+    if (memcmp(SCREEN, reference, SCREEN_SIZE) != 0) {
+        return FALSE;
+    }
+
+    memset(SCREEN, 0, SCREEN_SIZE);
+    line_draw(SCREEN, x1, y1, x0, y0, 7);
+
+    return memcmp(SCREEN, reference, SCREEN_SIZE) == 0;
+}
+
+/* Test a star of lines in every octant against the reference */
+void test_line_pattern(void) {
+    int i, failures = 0;
+
+    for (i = 0; i < SCREEN_WIDTH; i += 7) {
+        failures += !matches_reference(160, 100, i, 0);
+        failures += !matches_reference(160, 100, i, SCREEN_HEIGHT - 1);
+    }
+
+    for (i = 0; i < SCREEN_HEIGHT; i += 7) {
+        failures += !matches_reference(160, 100, 0, i);
+        failures += !matches_reference(160, 100, SCREEN_WIDTH - 1, i);
+    }
+
+    /* Short lines where run lengths tie */
+    for (i = 1; i < 12; i++) {
+        failures += !matches_reference(10, 10, 10 + i, 12);
+        failures += !matches_reference(10, 10, 12, 10 + i);
+        failures += !matches_reference(50, 50, 50 - i, 53);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, failures);
+}
+
+/* Test the horizontal and vertical fast paths */
+void test_line_straight(void) {
+    memset(SCREEN, 0, SCREEN_SIZE);
+
+    line_hline(SCREEN, 30, 10, 5, 3);
+    TEST_ASSERT_EQUAL_INT(21, (int) count_pixels(SCREEN, 3));
+    TEST_ASSERT_EQUAL_INT(3, SCREEN[5 * SCREEN_WIDTH + 10]);
+
+    line_vline(SCREEN, 40, 0, 9, 4);
+    TEST_ASSERT_EQUAL_INT(10, (int) count_pixels(SCREEN, 4));
+    TEST_ASSERT_EQUAL_INT(4, SCREEN[9 * SCREEN_WIDTH + 40]);
+
+    /* Both fast paths clip themselves */
+    line_hline(SCREEN, -100, 1000, SCREEN_HEIGHT - 1, 5);
+    TEST_ASSERT_EQUAL_INT(SCREEN_WIDTH, (int) count_pixels(SCREEN, 5));
+
+    line_vline(SCREEN, 0, -100, 1000, 6);
+    TEST_ASSERT_EQUAL_INT(SCREEN_HEIGHT, (int) count_pixels(SCREEN, 6));
+
+    TEST_ASSERT("Matches reference", matches_reference(3, 7, 300, 7));
+    TEST_ASSERT("Matches reference", matches_reference(3, 7, 3, 190));
+}
+
+/* Test Cohen-Sutherland endpoints */
+void test_line_clip(void) {
+    int x0, y0, x1, y1;
+
+    x0 = -10;
+    y0 = 50;
+    x1 = 330;
+    y1 = 50;
+    TEST_ASSERT("Horizontal", line_clip(&x0, &y0, &x1, &y1));
+    TEST_ASSERT_EQUAL_INT(0, x0);
+    TEST_ASSERT_EQUAL_INT(SCREEN_WIDTH - 1, x1);
+
+    /* Slope of 1/2 entering through the left edge */
+    x0 = -20;
+    y0 = 0;
+    x1 = 20;
+    y1 = 20;
+    TEST_ASSERT("Diagonal", line_clip(&x0, &y0, &x1, &y1));
+    TEST_ASSERT_EQUAL_INT(0, x0);
+    TEST_ASSERT_EQUAL_INT(10, y0);
+    TEST_ASSERT_EQUAL_INT(20, x1);
+
+    /* Passes above the top left corner */
+    x0 = -20;
+    y0 = 10;
+    x1 = 10;
+    y1 = -20;
+    TEST_ASSERT("Corner miss", !line_clip(&x0, &y0, &x1, &y1));
+
+    x0 = 400;
+    y0 = 10;
+    x1 = 500;
+    y1 = 100;
+    TEST_ASSERT("Outside", !line_clip(&x0, &y0, &x1, &y1));
+}
+
+/* Test lines far off screen only ever write inside the surface */
+void test_line_bounds(void) {
+    int i, dirty = 0;
+
+    memset(surface, 0, sizeof(surface));
+
+    for (i = -2000; i <= 2000; i += 250) {
+        line_draw(SCREEN, -3000, i, 3000, -i, 9);
+        line_draw(SCREEN, i, -3000, -i, 3000, 9);
+    }
+
+    for (i = 0; i < GUARD_BYTES; i++) {
+        dirty |= surface[i] | surface[GUARD_BYTES + SCREEN_SIZE + i];
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, dirty);
+    TEST_ASSERT("Drew something", count_pixels(SCREEN, 9) > 0);
+}
+
+/* Measure line fill rate, reported rather than asserted */
+void test_line_benchmark(void) {
+    clock_t start, ticks;
+    long pixels = 0;
+    int run, i;
+
+    memset(SCREEN, 0, SCREEN_SIZE);
+    start = clock();
+
+    for (run = 0; run < BENCH_RUNS; run++) {
+        for (i = 0; i < SCREEN_WIDTH; i += 2) {
+            line_draw(SCREEN, 160, 100, i, 0, (unsigned char) run);
+            line_draw(SCREEN, 160, 100, i, SCREEN_HEIGHT - 1, (unsigned char) run);
+            pixels += line_length(160, 100, i, 0) + line_length(160, 100, i, SCREEN_HEIGHT - 1);
+        }
+    }
+
+    ticks = clock() - start;
+
+    TEST_ASSERT("Pixels drawn", pixels > 0);
+
+    if (ticks > 0) {
+        printf("\n  %ld line pixels in %ld ticks, %ld per second\n", pixels, (long) ticks,
+               (long) ((double) pixels * CLOCKS_PER_SEC / ticks));
+    }
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run line drawing tests */
+    test_begin_suite(&results, "Line Drawing");
+    test_run(&results, test_line_pattern, "Reference Patterns");
+    test_run(&results, test_line_straight, "Straight Fast Paths");
+    test_run(&results, test_line_clip, "Cohen-Sutherland Clipping");
+    test_run(&results, test_line_bounds, "Off Screen Lines");
+    test_run(&results, test_line_benchmark, "Fill Rate");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * tlmbake.c
+ *
+ * Test suite for the lightmap baker
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "..\include\lmbake.h"
+#include "tmath.h"
+
+#define MAX_LUXELS 256
+
+static unsigned char luxels[MAX_LUXELS];
+static unsigned char occluder_luxels[MAX_LUXELS];
+static lightmap_t lm;
+
+/* Light a luxel should get from one unshadowed light, worked out in floating point */
+static int reference_luxel(float px, float py, float pz, float nx, float nz,
+                           const lightmap_light_t *light, float ambient) {
+    float lx = fixed_to_float(light->position.x) - px;
+    float ly = fixed_to_float(light->position.y) - py;
+    float lz = fixed_to_float(light->position.z) - pz;
+    float dist = (float) sqrt(lx * lx + ly * ly + lz * lz);
+    float radius = fixed_to_float(light->radius);
+    float facing = nx * lx + nz * lz;
+    float total = ambient;
+
+    if (dist < radius && facing > 0.0f) {
+        total += fixed_to_float(light->intensity) * facing / dist * (1.0f - dist / radius);
+    }
+
+    total = total > 1.0f ? 1.0f : total;
+
+    return (int) (total * LIGHTMAP_FULL + 0.5f);
+}
+
+/* Light with a position, intensity and radius */
+static void make_light(lightmap_light_t *light, float x, float y, float z, float intensity,
+                       float radius) {
+    light->position = vector3_init(fixed_from_float(x), fixed_from_float(y), fixed_from_float(z));
+    light->intensity = fixed_from_float(intensity);
+    light->radius = fixed_from_float(radius);
+}
+
+/* Test a baked wall against the floating point reference */
+void test_lightmap_reference(void) {
+    lightmap_light_t light;
+    fixed_t ambient = fixed_from_float(0.1f);
+    int i, j, error, worst = 0;
+
+    /* Runs along +x, so the lit face looks toward -z */
+    lightmap_init(&lm, luxels, 0, 3 * FIXED_ONE, 4 * FIXED_ONE, 3 * FIXED_ONE, FIXED_ONE);
+    make_light(&light, 1.3f, 0.6f, 1.5f, 1.0f, 4.0f);
+    lightmap_bake(&lm, &light, 1, &lm, 1, ambient);
+
+    for (j = 0; j < lm.height; j++) {
+        for (i = 0; i < lm.width; i++) {
+            error = lm.luxels[j * lm.width + i] -
+                    reference_luxel(i / 4.0f, j / 4.0f, 3.0f, 0.0f, -1.0f, &light,
+                                    fixed_to_float(ambient));
+            error = error < 0 ? -error : error;
+            worst = error > worst ? error : worst;
+        }
+    }
+
+    TEST_ASSERT("Within two steps", worst <= 2);
+    TEST_ASSERT("Brightest nearest the light", lm.luxels[2 * lm.width + 5] > lm.luxels[16]);
+
+    /* From behind only the ambient light arrives */
+    make_light(&light, 1.3f, 0.6f, 3.5f, 1.0f, 4.0f);
+    lightmap_bake(&lm, &light, 1, NULL, 0, ambient);
+    worst = 0;
+
+    for (i = 0; i < lm.width * lm.height; i++) {
+        worst += lm.luxels[i] != ((ambient * LIGHTMAP_FULL + FIXED_HALF) >> FIXED_SHIFT);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, worst);
+}
+
+/* Test walls between a luxel and the light shadow it, walls meeting it at a corner do not */
+void test_lightmap_shadow(void) {
+    lightmap_t walls[3];
+    lightmap_light_t light;
+    int dark, i;
+
+    lightmap_init(&walls[0], luxels, 0, 3 * FIXED_ONE, 4 * FIXED_ONE, 3 * FIXED_ONE, FIXED_ONE);
+    lightmap_init(&walls[1], occluder_luxels, fixed_from_float(1.5f), 2 * FIXED_ONE,
+                  fixed_from_float(2.5f), 2 * FIXED_ONE, FIXED_ONE);
+    lightmap_init(&walls[2], NULL, 4 * FIXED_ONE, 3 * FIXED_ONE, 4 * FIXED_ONE, 0, FIXED_ONE);
+    make_light(&light, 2.0f, 0.5f, 1.0f, 1.0f, 6.0f);
+    lightmap_bake(&walls[0], &light, 1, walls, 3, 0);
+    dark = 0;
+
+    /* Behind the short wall, a 2 unit shadow centred on x = 2 */
+    for (i = 0; i < walls[0].width; i++) {
+        dark += walls[0].luxels[2 * walls[0].width + i] == 0;
+    }
+
+    TEST_ASSERT_EQUAL_INT(7, dark);
+    TEST_ASSERT_EQUAL_INT(0, walls[0].luxels[2 * walls[0].width + 8]);
+    TEST_ASSERT("Lit beside the shadow", walls[0].luxels[2 * walls[0].width + 2] > 0);
+    TEST_ASSERT("Corner lit", walls[0].luxels[2 * walls[0].width + 16] > 0);
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run baker tests */
+    test_begin_suite(&results, "Lightmap Baker");
+    test_run(&results, test_lightmap_reference, "Floating Point Reference");
+    test_run(&results, test_lightmap_shadow, "Shadows");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * tmasked.c
+ *
+ * Test suite for run-length masks and see-through walls
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "..\include\masked.h"
+#include "..\include\trig.h"
+#include "..\include\wall.h"
+#include "fixroom.h"
+#include "tmath.h"
+
+#define KEY        0
+#define TEX_SIZE   16
+#define ODD_SIZE   12
+#define MAX_RUNS   (TEX_SIZE * TEX_SIZE / 2)
+#define BENCH_RUNS 40
+
+static unsigned char back_texels[TEX_SIZE * TEX_SIZE];
+static unsigned char gate_texels[TEX_SIZE * TEX_SIZE];
+static unsigned char solid_texels[TEX_SIZE * TEX_SIZE];
+static unsigned char odd_texels[ODD_SIZE * ODD_SIZE];
+static unsigned char screen[SCREEN_SIZE];
+static unsigned char back[SCREEN_SIZE];
+static unsigned char gate_only[SCREEN_SIZE];
+static masked_run_t runs[MAX_RUNS];
+static unsigned short columns[TEX_SIZE + 1];
+static texture_t back_tex, gate_tex, solid_tex, odd_tex;
+static masked_t mask;
+static wall_view_t view;
+
+/* Textures: a solid back wall, bars with gaps, the bars with no gaps and odd sized bars */
+static void setup(void) {
+    int u, v;
+
+    trig_init();
+
+    for (v = 0; v < TEX_SIZE; v++) {
+        for (u = 0; u < TEX_SIZE; u++) {
+            back_texels[v * TEX_SIZE + u] = (unsigned char) (((v << 4) | u) | 1);
+            gate_texels[v * TEX_SIZE + u] =
+                (unsigned char) ((u % 4 == 1 || v % 8 == 2) ? 100 + u + v : KEY);
+            solid_texels[v * TEX_SIZE + u] = (unsigned char) (100 + u + v);
+        }
+    }
+
+    for (v = 0; v < ODD_SIZE; v++) {
+        for (u = 0; u < ODD_SIZE; u++) {
+            odd_texels[v * ODD_SIZE + u] = (unsigned char) ((u % 3 == 0 || v == 5) ? 50 + v : KEY);
+        }
+    }
+
+    texture_init(&back_tex, back_texels, TEX_SIZE, TEX_SIZE);
+    texture_init(&gate_tex, gate_texels, TEX_SIZE, TEX_SIZE);
+    texture_init(&solid_tex, solid_texels, TEX_SIZE, TEX_SIZE);
+    texture_init(&odd_tex, odd_texels, ODD_SIZE, ODD_SIZE);
+}
+
+/* Fill in a wall from floor plan coordinates, drawn through a mask if one is given */
+static void make_wall(wall_t *w, const texture_t *t, const masked_t *m, float x0, float z0,
+                      float x1, float z1) {
+    fixture_wall(w, t, x0, z0, x1, z1);
+    w->mask = m;
+}
+
+/* A fresh view with a given angle and ceiling */
+static void make_view(unsigned char angle, fixed_t ceiling) {
+    wall_view_init(&view, 0, 0, FIXED_HALF, ceiling, angle, 64);
+}
+
+/* Test runs found in each column */
+void test_masked_build(void) {
+    static unsigned char small[16] = {
+        9, 0, 9, 0,
+        9, 0, 0, 9,
+        9, 0, 9, 0,
+        9, 0, 9, 9
+    };
+    texture_t t;
+
+    texture_init(&t, small, 4, 4);
+    TEST_ASSERT_EQUAL_INT(5, (int) masked_count(&t, KEY));
+    TEST_ASSERT("Built", masked_build(&mask, &t, KEY, runs, columns));
+
+    TEST_ASSERT_EQUAL_INT(9, (int) mask.opaque);
+    TEST_ASSERT_EQUAL_INT(0, columns[0]);
+    TEST_ASSERT_EQUAL_INT(1, columns[1]);
+    TEST_ASSERT_EQUAL_INT(1, columns[2]);
+    TEST_ASSERT_EQUAL_INT(3, columns[3]);
+    TEST_ASSERT_EQUAL_INT(5, columns[4]);
+
+    /* Full column, then an empty one, then split columns */
+    TEST_ASSERT_EQUAL_INT(0, runs[0].top);
+    TEST_ASSERT_EQUAL_INT(4, runs[0].count);
+    TEST_ASSERT_EQUAL_INT(0, runs[1].top);
+    TEST_ASSERT_EQUAL_INT(1, runs[1].count);
+    TEST_ASSERT_EQUAL_INT(2, runs[2].top);
+    TEST_ASSERT_EQUAL_INT(2, runs[2].count);
+    TEST_ASSERT_EQUAL_INT(1, runs[3].top);
+    TEST_ASSERT_EQUAL_INT(3, runs[4].top);
+    TEST_ASSERT_EQUAL_INT(1, runs[4].count);
+
+    TEST_ASSERT("No texture", !masked_build(&mask, NULL, KEY, runs, columns));
+}
+
+/* Test a gate over a wall matches drawing it solid and keeping the back wall where it is clear */
+void test_masked_gate(void) {
+    static const unsigned char angles[3] = {0, 12, 244};
+    const texture_t *textures[2];
+    wall_t behind, gate;
+    fixed_t depth[SCREEN_WIDTH], ceiling;
+    long drawn, expected;
+    int pass, i, wrong = 0, recorded = 0;
+
+    setup();
+    textures[0] = &gate_tex;
+    textures[1] = &odd_tex;
+
+    for (pass = 0; pass < 6; pass++) {
+        ceiling = pass < 2 ? FIXED_ONE : fixed_from_float(1.7f);
+        masked_build(&mask, textures[pass & 1], KEY, runs, columns);
+        make_wall(&behind, &back_tex, NULL, -6.0f, 4.0f, 6.0f, 4.0f);
+        make_wall(&gate, textures[pass & 1], NULL, -1.5f, 2.0f, 1.5f, 2.0f);
+
+        /* The gate alone and solid, on a clear screen */
+        memset(gate_only, KEY, SCREEN_SIZE);
+        make_view(angles[pass / 2], ceiling);
+        wall_draw(&view, gate_only, &gate);
+
+        /* The back wall, then the gate through its mask */
+        memset(screen, 0xFF, SCREEN_SIZE);
+        make_view(angles[pass / 2], ceiling);
+        wall_draw(&view, screen, &behind);
+        memcpy(back, screen, SCREEN_SIZE);
+        memcpy(depth, view.depth, sizeof(depth));
+        gate.mask = &mask;
+        drawn = wall_draw(&view, screen, &gate);
+        expected = 0;
+
+        for (i = 0; i < SCREEN_SIZE; i++) {
+            expected += gate_only[i] != KEY;
+            wrong += screen[i] != (gate_only[i] != KEY ? gate_only[i] : back[i]);
+        }
+
+        /* The back wall still owns every column */
+        recorded += memcmp(depth, view.depth, sizeof(depth)) != 0;
+        TEST_ASSERT_EQUAL_INT((int) expected, (int) drawn);
+        TEST_ASSERT("Gate drawn", drawn > 0);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, wrong);
+    TEST_ASSERT_EQUAL_INT(0, recorded);
+}
+
+/* Test a masked wall hides behind solid walls and shows on one it lies against */
+void test_masked_depth(void) {
+    wall_t front, gate;
+
+    setup();
+    masked_build(&mask, &gate_tex, KEY, runs, columns);
+    make_wall(&front, &back_tex, NULL, -2.0f, 2.0f, 2.0f, 2.0f);
+
+    /* Behind a nearer wall nothing shows */
+    make_view(0, FIXED_ONE);
+    wall_draw(&view, screen, &front);
+    make_wall(&gate, &gate_tex, &mask, -1.0f, 3.0f, 1.0f, 3.0f);
+    TEST_ASSERT_EQUAL_INT(0, (int) wall_draw(&view, screen, &gate));
+
+    /* A decal on the wall itself does */
+    make_wall(&gate, &gate_tex, &mask, -2.0f, 2.0f, 2.0f, 2.0f);
+    TEST_ASSERT("Decal drawn", wall_draw(&view, screen, &gate) > 0);
+    TEST_ASSERT_EQUAL_INT(60, view.top[160]);
+
+    /* A mask built for another texture draws nothing */
+    make_wall(&gate, &odd_tex, &mask, -1.0f, 1.0f, 1.0f, 1.0f);
+    TEST_ASSERT_EQUAL_INT(0, (int) wall_draw(&view, screen, &gate));
+}
+
+/* Measure masked fill rate against solid walls, reported rather than asserted */
+void test_masked_benchmark(void) {
+    static masked_run_t solid_runs[TEX_SIZE];
+    static unsigned short solid_columns[TEX_SIZE + 1];
+    masked_t solid_mask;
+    wall_t w[3];
+    clock_t start, ticks[3];
+    long pixels[3];
+    int run, k;
+
+    setup();
+    masked_build(&mask, &gate_tex, KEY, runs, columns);
+    masked_build(&solid_mask, &solid_tex, KEY, solid_runs, solid_columns);
+    make_wall(&w[0], &solid_tex, NULL, -3.0f, 1.5f, 3.0f, 4.5f);
+    make_wall(&w[1], &solid_tex, &solid_mask, -3.0f, 1.5f, 3.0f, 4.5f);
+    make_wall(&w[2], &gate_tex, &mask, -3.0f, 1.5f, 3.0f, 4.5f);
+    make_view(0, FIXED_ONE);
+
+    for (k = 0; k < 3; k++) {
+        pixels[k] = 0;
+        start = clock();
+
+        for (run = 0; run < BENCH_RUNS; run++) {
+            wall_view_clear(&view);
+            pixels[k] += wall_draw(&view, screen, &w[k]);
+        }
+
+        ticks[k] = clock() - start;
+    }
+
+    TEST_ASSERT_EQUAL_INT((int) pixels[0], (int) pixels[1]);
+    TEST_ASSERT("Gaps skipped", pixels[2] < pixels[1]);
+
+    if (ticks[0] > 0 && ticks[1] > 0 && ticks[2] > 0) {
+        printf("\n  Solid %ld, masked without gaps %ld, masked bars %ld pixels per second\n",
+               (long) ((double) pixels[0] * CLOCKS_PER_SEC / ticks[0]),
+               (long) ((double) pixels[1] * CLOCKS_PER_SEC / ticks[1]),
+               (long) ((double) pixels[2] * CLOCKS_PER_SEC / ticks[2]));
+    }
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run masked wall tests */
+    test_begin_suite(&results, "Masked Walls");
+    test_run(&results, test_masked_build, "Opaque Runs");
+    test_run(&results, test_masked_gate, "Gate Over a Wall");
+    test_run(&results, test_masked_depth, "Depth");
+    test_run(&results, test_masked_benchmark, "Fill Rate");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
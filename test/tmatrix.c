@@ -735,6 +735,121 @@ void test_combined_transformations(void) {
     TEST_ASSERT_EQUAL_INT(1, fixed_to_int(result.w));
 }
 
+/* Test rotating a vector by the 3x3 block only */
+void test_matrix_rotate_vector3(void) {
+    vector3_t v = vector3_init_int(0, 0, 1);
+    vector3_t result;
+    matrix_t m;
+
+    trig_init();
+
+    /* Translation must not affect a rotated direction */
+    m = matrix_translation(fixed_from_int(5), fixed_from_int(6), fixed_from_int(7));
+    result = matrix_rotate_vector3(&m, &v);
+
+    TEST_ASSERT_EQUAL_INT(0, fixed_to_int(result.x));
+    TEST_ASSERT_EQUAL_INT(0, fixed_to_int(result.y));
+    TEST_ASSERT_EQUAL_INT(1, fixed_to_int(result.z));
+
+    /* 90 degrees around Y takes +Z to +X */
+    m = matrix_rotation_y(64);
+    result = matrix_rotate_vector3(&m, &v);
+
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, fixed_to_float(result.x), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fixed_to_float(result.y), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fixed_to_float(result.z), 0.001f);
+}
+
+/* Test orthonormal matrix detection */
+void test_matrix_is_orthonormal(void) {
+    matrix_t rot_x, rot_y, trans, combined, scale;
+
+    trig_init();
+
+    rot_x = matrix_rotation_x(32);
+    rot_y = matrix_rotation_y(77);
+    trans = matrix_translation(fixed_from_int(5), fixed_from_int(-3), fixed_from_int(10));
+    scale = matrix_scaling(fixed_from_int(2), fixed_from_int(2), fixed_from_int(2));
+
+    TEST_ASSERT("Identity is orthonormal", matrix_is_orthonormal(&trans));
+    TEST_ASSERT("Rotation is orthonormal", matrix_is_orthonormal(&rot_x));
+
+    /* Rigid combination of rotations and translation */
+    combined = matrix_mul(&rot_x, &rot_y);
+    combined = matrix_mul(&combined, &trans);
+    TEST_ASSERT("Rigid transform is orthonormal", matrix_is_orthonormal(&combined));
+
+    /* Any scale breaks it */
+    combined = matrix_mul(&combined, &scale);
+    TEST_ASSERT("Scaled transform is not orthonormal", !matrix_is_orthonormal(&combined));
+
+    /* Mirrors keep lengths and angles but are not rotations */
+    scale = matrix_scaling(fixed_from_int(-1), FIXED_ONE, FIXED_ONE);
+    TEST_ASSERT("Mirror is not orthonormal", !matrix_is_orthonormal(&scale));
+    combined = matrix_mul(&rot_x, &scale);
+    TEST_ASSERT("Rotated mirror is not orthonormal", !matrix_is_orthonormal(&combined));
+}
+
+/* Test affine inverse for rigid and scaled matrices */
+void test_matrix_inverse_affine(void) {
+    matrix_t rot, trans, scale, m, inv, product;
+
+    trig_init();
+
+    rot = matrix_rotation_y(40);
+    trans = matrix_translation(fixed_from_int(5), fixed_from_int(-3), fixed_from_int(10));
+    scale = matrix_scaling(fixed_from_int(2), fixed_from_int(3), FIXED_HALF);
+
+    /* Rigid transform uses the transpose path */
+    m = matrix_mul(&trans, &rot);
+    inv = matrix_inverse_affine(&m);
+    product = matrix_mul(&m, &inv);
+
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, fixed_to_float(product.m[0][0]), 0.002f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fixed_to_float(product.m[0][3]), 0.01f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fixed_to_float(product.m[2][3]), 0.01f);
+
+    /* Non-uniform scale uses the cofactor path */
+    m = matrix_mul(&m, &scale);
+    inv = matrix_inverse_affine(&m);
+    product = matrix_mul(&m, &inv);
+
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, fixed_to_float(product.m[0][0]), 0.002f);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, fixed_to_float(product.m[1][1]), 0.002f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fixed_to_float(product.m[0][2]), 0.002f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fixed_to_float(product.m[1][3]), 0.01f);
+
+    /* Singular input falls back to identity */
+    m = matrix_init();
+    inv = matrix_inverse_affine(&m);
+    TEST_ASSERT("Singular inverse is identity", matrix_is_identity(&inv));
+}
+
+/* Test perspective projection maps the near and far planes to -w and +w */
+void test_matrix_perspective(void) {
+    vector4_t point, result;
+    matrix_t m;
+
+    trig_init();
+
+    /* 90 degree field of view, square aspect, near 1, far 9 */
+    m = matrix_perspective(64, FIXED_ONE, FIXED_ONE, fixed_from_int(9));
+
+    point = vector4_init_int(0, 0, 1, 1);
+    result = matrix_mul_vector4(&m, &point);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, fixed_to_float(result.z), 0.01f);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, fixed_to_float(result.w), 0.001f);
+
+    point = vector4_init_int(0, 0, 9, 1);
+    result = matrix_mul_vector4(&m, &point);
+    TEST_ASSERT_EQUAL_FLOAT(9.0f, fixed_to_float(result.z), 0.01f);
+
+    /* A point on the edge of the 90 degree view lands on x = w */
+    point = vector4_init_int(4, 0, 4, 1);
+    result = matrix_mul_vector4(&m, &point);
+    TEST_ASSERT_EQUAL_FLOAT(fixed_to_float(result.w), fixed_to_float(result.x), 0.01f);
+}
+
 int main(void) {
     test_results_t results;
 
@@ -757,6 +872,7 @@ int main(void) {
     test_begin_suite(&results, "Matrix Validation");
     test_run(&results, test_matrix_is_identity, "Identity Matrix Check");
     test_run(&results, test_matrix_equals, "Matrix Equality Check");
+    test_run(&results, test_matrix_is_orthonormal, "Orthonormal Matrix Check");
     test_end_suite(&results);
 
     /* Run matrix operation tests */
@@ -766,12 +882,14 @@ int main(void) {
     test_run(&results, test_matrix_add_sub_identity, "Add/Sub with Identity");
     test_run(&results, test_matrix_scale, "Scalar Multiplication");
     test_run(&results, test_matrix_multiplication, "Matrix-Matrix Multiplication");
+    test_run(&results, test_matrix_inverse_affine, "Affine Inverse");
     test_end_suite(&results);
 
     /* Run matrix-vector multiplication tests */
     test_begin_suite(&results, "Matrix-Vector Operations");
     test_run(&results, test_matrix_mul_vector4, "Matrix-Vector4 Multiplication");
     test_run(&results, test_matrix_mul_vector3, "Matrix-Vector3 Multiplication");
+    test_run(&results, test_matrix_rotate_vector3, "Matrix-Vector3 Rotation");
     test_end_suite(&results);
 
     /* Run matrix transform matrices tests */
@@ -782,6 +900,7 @@ int main(void) {
     test_run(&results, test_matrix_rotation_y, "Y-Axis Rotation Matrix");
     test_run(&results, test_matrix_rotation_z, "Z-Axis Rotation Matrix");
     test_run(&results, test_combined_transformations, "Combined Sequential Transformations");
+    test_run(&results, test_matrix_perspective, "Perspective Projection");
     test_end_suite(&results);
 
     /* Print final results */
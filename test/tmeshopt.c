@@ -0,0 +1,168 @@
+/*
+ * tmeshopt.c
+ *
+ * Test suite for offline mesh optimization
+ */
+
+#include <stdio.h>
+
+#include "..\include\meshopt.h"
+#include "..\include\triangle.h"
+#include "..\include\vertex.h"
+#include "tmath.h"
+
+/* Wall of GRID x GRID quads exported as unindexed triangles, plus two degenerates */
+#define GRID       4
+#define WALL_TRIS  (GRID * GRID * 2 + 2)
+#define WALL_VERTS (WALL_TRIS * 3)
+
+static vertex_t verts[WALL_VERTS];
+static unsigned short indices[WALL_TRIS * 3];
+static long scratch[MESHOPT_SCRATCH(WALL_VERTS, WALL_TRIS)];
+
+/* Emit one wall corner, odd corners are nudged inside the weld tolerance */
+static void emit(mesh_t *mesh, int x, int y) {
+    vertex_t *v = &mesh->vertices[mesh->vertex_count];
+
+    *v = vertex_init(fixed_from_int(x), fixed_from_int(y), fixed_from_int(8));
+    vertex_set_normal_xyz(v, FIXED_ZERO, FIXED_ZERO, -FIXED_ONE);
+    vertex_set_texcoord_uv(v, fixed_from_int(x), fixed_from_int(y));
+
+    if ((mesh->vertex_count & 1) != 0) {
+        v->position.x += MESHOPT_WELD_EPSILON / 2;
+    }
+
+    mesh->indices[mesh->vertex_count] = (unsigned short) mesh->vertex_count;
+    mesh->vertex_count++;
+}
+
+/* Build the wall the way a naive exporter would, three new vertices per triangle */
+static void make_wall(mesh_t *mesh) {
+    int x, y;
+
+    mesh->vertices = verts;
+    mesh->indices = indices;
+    mesh->vertex_count = 0;
+
+    for (y = 0; y < GRID; y++) {
+        for (x = 0; x < GRID; x++) {
+            emit(mesh, x, y);
+            emit(mesh, x, y + 1);
+            emit(mesh, x + 1, y);
+
+            emit(mesh, x + 1, y);
+            emit(mesh, x, y + 1);
+            emit(mesh, x + 1, y + 1);
+        }
+    }
+
+    /* Collinear sliver along the bottom edge and a triangle with a repeated corner */
+    emit(mesh, 0, 0);
+    emit(mesh, 1, 0);
+    emit(mesh, 2, 0);
+
+    emit(mesh, 3, 3);
+    emit(mesh, 3, 3);
+    emit(mesh, 4, 4);
+
+    mesh->triangle_count = mesh->vertex_count / 3;
+}
+
+/* Test weld tolerance and attribute matching */
+void test_meshopt_equal(void) {
+    vertex_t a, b;
+
+    a = vertex_init(fixed_from_int(1), fixed_from_int(2), fixed_from_int(3));
+    b = a;
+
+    b.position.z += MESHOPT_WELD_EPSILON;
+    TEST_ASSERT("Within tolerance", meshopt_vertices_equal(&a, &b, MESHOPT_WELD_EPSILON));
+
+    b.position.z += 1;
+    TEST_ASSERT("Outside tolerance", !meshopt_vertices_equal(&a, &b, MESHOPT_WELD_EPSILON));
+
+    /* Same position but a UV seam keeps both vertices */
+    b = a;
+    b.texcoord.u = FIXED_ONE;
+    TEST_ASSERT("UV seam", !meshopt_vertices_equal(&a, &b, MESHOPT_WELD_EPSILON));
+
+    b = a;
+    b.color.g = 0;
+    TEST_ASSERT("Color differs", !meshopt_vertices_equal(&a, &b, MESHOPT_WELD_EPSILON));
+}
+
+/* Test welding and degenerate removal on the exported wall */
+void test_meshopt_weld(void) {
+    mesh_t mesh;
+    int t;
+
+    make_wall(&mesh);
+
+    TEST_ASSERT_EQUAL_INT(WALL_VERTS - (GRID + 1) * (GRID + 1),
+                          meshopt_weld(&mesh, MESHOPT_WELD_EPSILON, scratch));
+    TEST_ASSERT_EQUAL_INT((GRID + 1) * (GRID + 1), mesh.vertex_count);
+
+    /* Welding turned the repeated corner into a repeated index */
+    TEST_ASSERT("Repeated index", meshopt_is_degenerate(&mesh, WALL_TRIS - 1));
+    TEST_ASSERT("Collinear", meshopt_is_degenerate(&mesh, WALL_TRIS - 2));
+    TEST_ASSERT("Wall triangle", !meshopt_is_degenerate(&mesh, 0));
+
+    TEST_ASSERT_EQUAL_INT(2, meshopt_remove_degenerates(&mesh));
+    TEST_ASSERT_EQUAL_INT(GRID * GRID * 2, mesh.triangle_count);
+
+    for (t = 0; t < mesh.triangle_count; t++) {
+        TEST_ASSERT("No degenerates left", !meshopt_is_degenerate(&mesh, t));
+    }
+}
+
+/* Test the full pipeline keeps every triangle and improves vertex reuse */
+void test_meshopt_optimize(void) {
+    meshopt_stats_t stats;
+    triangle_t tri;
+    mesh_t mesh;
+    int t;
+
+    make_wall(&mesh);
+    meshopt_optimize(&mesh, MESHOPT_WELD_EPSILON, scratch, &stats);
+
+    TEST_ASSERT_EQUAL_INT(WALL_VERTS, stats.vertices_before);
+    TEST_ASSERT_EQUAL_INT((GRID + 1) * (GRID + 1), stats.vertices_after);
+    TEST_ASSERT_EQUAL_INT(WALL_TRIS, stats.triangles_before);
+    TEST_ASSERT_EQUAL_INT(GRID * GRID * 2, stats.triangles_after);
+
+    /* Unindexed input misses on every vertex */
+    TEST_ASSERT_EQUAL_INT(3 * FIXED_ONE, stats.acmr_before);
+    TEST_ASSERT("Better than one miss per triangle", stats.acmr_after < FIXED_ONE);
+
+    /* Vertices are stored in the order triangles first use them */
+    TEST_ASSERT_EQUAL_INT(0, mesh.indices[0]);
+    TEST_ASSERT_EQUAL_INT(1, mesh.indices[1]);
+    TEST_ASSERT_EQUAL_INT(2, mesh.indices[2]);
+
+    /* Reordering kept the winding of every triangle */
+    for (t = 0; t < mesh.triangle_count; t++) {
+        tri = triangle_init(mesh.vertices[mesh.indices[t * 3]],
+                            mesh.vertices[mesh.indices[t * 3 + 1]],
+                            mesh.vertices[mesh.indices[t * 3 + 2]]);
+        TEST_ASSERT("Facing the wall normal", tri.normal.z < 0);
+    }
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run optimizer tests */
+    test_begin_suite(&results, "Mesh Optimization");
+    test_run(&results, test_meshopt_equal, "Vertex Matching");
+    test_run(&results, test_meshopt_weld, "Welding and Degenerates");
+    test_run(&results, test_meshopt_optimize, "Cache Order Pipeline");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
@@ -0,0 +1,253 @@
+/*
+ * tmipmap.c
+ *
+ * Test suite for mip chains and mip level selection
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "..\include\mipmap.h"
+#include "..\include\trig.h"
+#include "..\include\visplane.h"
+#include "..\include\wall.h"
+#include "fixroom.h"
+#include "fixture.h"
+#include "tmath.h"
+
+#define TEX_SIZE   64
+#define LEVELS     7
+#define BENCH_RUNS 20
+#define CORRIDOR   12
+
+static color_t palette[256];
+static unsigned char texels[TEX_SIZE * TEX_SIZE];
+static unsigned char mip_texels[TEX_SIZE * TEX_SIZE];
+static unsigned char screen[SCREEN_SIZE];
+static unsigned char reference[SCREEN_SIZE];
+static texture_t levels[LEVELS];
+static wall_view_t view;
+static visplane_t floor_plane, ceiling_plane;
+static wall_t walls[2 * CORRIDOR + 1];
+
+/* Black and white checkerboard one texel to a square, with its mip chain */
+static void make_checker(void) {
+    int u, v;
+
+    fixture_grey_palette(palette);
+
+    for (v = 0; v < TEX_SIZE; v++) {
+        for (u = 0; u < TEX_SIZE; u++) {
+            texels[v * TEX_SIZE + u] = (unsigned char) (((u ^ v) & 1) ? 255 : 0);
+        }
+    }
+
+    texture_init(&levels[0], texels, TEX_SIZE, TEX_SIZE);
+    mipmap_build(levels, LEVELS, mip_texels, palette);
+}
+
+/* Walls down both sides of a corridor and one across its far end */
+static void make_corridor(void) {
+    int i;
+
+    for (i = 0; i < CORRIDOR; i++) {
+        fixture_wall(&walls[2 * i], &levels[0], -1.0f, i * 4.0f, -1.0f, i * 4.0f + 4.0f);
+        fixture_wall(&walls[2 * i + 1], &levels[0], 1.0f, i * 4.0f + 4.0f, 1.0f, i * 4.0f);
+    }
+
+    fixture_wall(&walls[2 * CORRIDOR], &levels[0], -1.0f, CORRIDOR * 4.0f, 1.0f, CORRIDOR * 4.0f);
+}
+
+/* Draw the corridor looking down it, with or without the mip chain */
+static long draw_corridor(unsigned char *buffer, int mipmapped) {
+    long pixels;
+
+    levels[0].mip_levels = mipmapped ? LEVELS - 1 : 0;
+    trig_init();
+    wall_view_init(&view, 0, fixed_from_float(0.5f), FIXED_HALF, FIXED_ONE, 2, 64);
+    memset(buffer, 0, SCREEN_SIZE);
+
+    pixels = wall_draw_list(&view, buffer, walls, 2 * CORRIDOR + 1);
+    visplane_init(&floor_plane, 0, &levels[0]);
+    visplane_init(&ceiling_plane, FIXED_ONE, &levels[0]);
+    visplane_from_walls(&floor_plane, &ceiling_plane, &view);
+    pixels += visplane_draw(&floor_plane, &view, buffer);
+    pixels += visplane_draw(&ceiling_plane, &view, buffer);
+
+    return pixels;
+}
+
+/* Test chain sizes */
+void test_mipmap_sizes(void) {
+    TEST_ASSERT_EQUAL_INT(7, mipmap_levels(64, 64));
+    TEST_ASSERT_EQUAL_INT(5, mipmap_levels(64, 16));
+    TEST_ASSERT_EQUAL_INT(1, mipmap_levels(48, 64));
+    TEST_ASSERT_EQUAL_INT(1365, (int) mipmap_size(64, 64, 7));
+    TEST_ASSERT_EQUAL_INT(1365, (int) mipmap_size(64, 64, 20));
+    TEST_ASSERT_EQUAL_INT(512 + 128, (int) mipmap_size(32, 64, 3));
+    TEST_ASSERT_EQUAL_INT(0, (int) mipmap_size(64, 64, 1));
+}
+
+/* Test each level averages the one above it */
+void test_mipmap_build(void) {
+    texture_t odd[2];
+    int u, v, wrong = 0;
+
+    fixture_grey_palette(palette);
+
+    /* Brightness rising along u, each level halves the ramp */
+    for (v = 0; v < TEX_SIZE; v++) {
+        for (u = 0; u < TEX_SIZE; u++) {
+            texels[v * TEX_SIZE + u] = (unsigned char) (u * 4);
+        }
+    }
+
+    texture_init(&levels[0], texels, TEX_SIZE, TEX_SIZE);
+    TEST_ASSERT_EQUAL_INT(LEVELS, mipmap_build(levels, LEVELS, mip_texels, palette));
+    TEST_ASSERT_EQUAL_INT(LEVELS - 1, levels[0].mip_levels);
+    TEST_ASSERT_EQUAL_INT(0, levels[LEVELS - 1].mip_levels);
+    TEST_ASSERT_EQUAL_INT(32, levels[1].width);
+    TEST_ASSERT_EQUAL_INT(5, levels[1].width_shift);
+    TEST_ASSERT_EQUAL_INT(1, levels[LEVELS - 1].height);
+
+    for (v = 0; v < 32; v++) {
+        for (u = 0; u < 32; u++) {
+            wrong += levels[1].texture_data[v * 32 + u] != u * 8 + 2;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, wrong);
+    TEST_ASSERT_EQUAL_INT(64 + 30, levels[4].texture_data[5]);
+    TEST_ASSERT_EQUAL_INT(126, levels[LEVELS - 1].texture_data[0]);
+
+    /* Levels stop where the texture runs out of halvings */
+    TEST_ASSERT_EQUAL_INT(3, mipmap_build(levels, 3, mip_texels, palette));
+    TEST_ASSERT_EQUAL_INT(2, levels[0].mip_levels);
+
+    texture_init(&odd[0], texels, 48, 48);
+    TEST_ASSERT_EQUAL_INT(1, mipmap_build(odd, 2, mip_texels, palette));
+    TEST_ASSERT_EQUAL_INT(0, odd[0].mip_levels);
+}
+
+/* Test the level follows the footprint */
+void test_mipmap_select(void) {
+    const texture_t *t;
+    int level;
+
+    make_checker();
+
+    t = texture_mip(&levels[0], fixed_from_float(1.9f), &level);
+    TEST_ASSERT_EQUAL_INT(0, level);
+    TEST_ASSERT("Full size", t == &levels[0]);
+
+    t = texture_mip(&levels[0], 2 * FIXED_ONE, &level);
+    TEST_ASSERT_EQUAL_INT(1, level);
+    TEST_ASSERT("Half size", t == &levels[1]);
+
+    texture_mip(&levels[0], fixed_from_float(7.9f), &level);
+    TEST_ASSERT_EQUAL_INT(2, level);
+    texture_mip(&levels[0], fixed_from_int(1000), &level);
+    TEST_ASSERT_EQUAL_INT(LEVELS - 1, level);
+
+    /* Without a chain the full size texture is all there is */
+    levels[0].mip_levels = 0;
+    texture_mip(&levels[0], fixed_from_int(1000), &level);
+    TEST_ASSERT_EQUAL_INT(0, level);
+}
+
+/* Test near surfaces keep full detail and far ones settle to the average */
+void test_mipmap_render(void) {
+    long plain, mipped;
+    int c, y, i, far = 0, near_wrong = 0, far_noisy = 0, far_mixed = 0, floor_wrong = 0;
+
+    make_checker();
+    make_corridor();
+    plain = draw_corridor(reference, FALSE);
+    mipped = draw_corridor(screen, TRUE);
+
+    TEST_ASSERT_EQUAL_INT((int) plain, (int) mipped);
+
+    for (c = 0; c < SCREEN_WIDTH; c++) {
+        for (y = view.top[c]; y < view.bottom[c]; y++) {
+            i = y * SCREEN_WIDTH + c;
+
+            /* Under two texels a pixel either way the full size texture is used */
+            if (view.depth[c] > fixed_from_float(0.7f)) {
+                near_wrong += screen[i] != reference[i];
+            } else if (view.depth[c] < fixed_from_float(0.2f)) {
+                /* Two texels a pixel down the column, every level past the first is grey */
+                far++;
+                far_noisy += screen[i] != 128;
+                far_mixed += reference[i] != 128;
+            }
+        }
+    }
+
+    /* The floor right under the viewer is sharp */
+    for (i = (SCREEN_HEIGHT - 4) * SCREEN_WIDTH; i < SCREEN_SIZE; i++) {
+        floor_wrong += screen[i] != reference[i];
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, near_wrong);
+    TEST_ASSERT_EQUAL_INT(0, far_noisy);
+    TEST_ASSERT("Far walls seen", far > 500);
+    TEST_ASSERT_EQUAL_INT(far, far_mixed);
+    TEST_ASSERT_EQUAL_INT(0, floor_wrong);
+    TEST_ASSERT_EQUAL_INT(128, screen[(SCREEN_HEIGHT / 2 + 6) * SCREEN_WIDTH + SCREEN_WIDTH / 2]);
+}
+
+/* Measure texels touched and fill rate with and without mips, reported rather than asserted */
+void test_mipmap_benchmark(void) {
+    clock_t start, ticks[2];
+    long pixels[2], touched[2];
+    int run, k;
+
+    make_checker();
+    make_corridor();
+
+    for (k = 0; k < 2; k++) {
+        pixels[k] = 0;
+        start = clock();
+
+        for (run = 0; run < BENCH_RUNS; run++) {
+            pixels[k] += draw_corridor(screen, k == 1);
+        }
+
+        ticks[k] = clock() - start;
+        touched[k] = view.texels;
+    }
+
+    TEST_ASSERT_EQUAL_INT((int) pixels[0], (int) pixels[1]);
+    TEST_ASSERT("Fewer texels touched", touched[1] < touched[0]);
+
+    printf("\n  Texels touched per frame without mips %ld, with mips %ld\n", touched[0],
+           touched[1]);
+
+    if (ticks[0] > 0 && ticks[1] > 0) {
+        printf("  Corridor without mips %ld, with mips %ld pixels per second\n",
+               (long) ((double) pixels[0] * CLOCKS_PER_SEC / ticks[0]),
+               (long) ((double) pixels[1] * CLOCKS_PER_SEC / ticks[1]));
+    }
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run mipmap tests */
+    test_begin_suite(&results, "Mipmaps");
+    test_run(&results, test_mipmap_sizes, "Chain Sizes");
+    test_run(&results, test_mipmap_build, "Box Filter");
+    test_run(&results, test_mipmap_select, "Level Selection");
+    test_run(&results, test_mipmap_render, "Walls and Floors");
+    test_run(&results, test_mipmap_benchmark, "Texels and Fill Rate");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
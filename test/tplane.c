@@ -0,0 +1,77 @@
+/*
+ * tplane.c
+ *
+ * Test suite for plane equations
+ */
+
+#include <stdio.h>
+
+#include "..\include\plane.h"
+#include "..\include\vector.h"
+#include "tmath.h"
+
+/* Test plane construction */
+void test_plane_construction(void) {
+    plane_t p;
+
+    /* Floor at y = 2 facing up */
+    p = plane_from_point_normal(vector3_init_int(5, 2, -3), vector3_init_int(0, 1, 0));
+    TEST_ASSERT_EQUAL_INT(-fixed_from_int(2), p.d);
+
+    /* Same plane from three points, wound to face up */
+    p = plane_from_points(vector3_init_int(0, 2, 0),
+                          vector3_init_int(0, 2, 1),
+                          vector3_init_int(1, 2, 0));
+    TEST_ASSERT_EQUAL_INT(FIXED_ONE, p.normal.y);
+    TEST_ASSERT_EQUAL_INT(-fixed_from_int(2), p.d);
+}
+
+/* Test distances and classification */
+void test_plane_distance(void) {
+    plane_t p = plane_init(vector3_init_int(0, 0, 1), -fixed_from_int(4));
+
+    TEST_ASSERT_EQUAL_INT(fixed_from_int(3), plane_distance(&p, vector3_init_int(9, 9, 7)));
+    TEST_ASSERT_EQUAL_INT(-fixed_from_int(4), plane_distance(&p, vector3_init_int(0, 0, 0)));
+
+    TEST_ASSERT_EQUAL_INT(PLANE_FRONT, plane_classify_point(&p, vector3_init_int(0, 0, 5), 16));
+    TEST_ASSERT_EQUAL_INT(PLANE_BACK, plane_classify_point(&p, vector3_init_int(0, 0, 3), 16));
+    TEST_ASSERT_EQUAL_INT(PLANE_ON, plane_classify_point(&p,
+                          vector3_init(FIXED_ZERO, FIXED_ZERO, fixed_from_int(4) + 8), 16));
+}
+
+/* Test segment crossings */
+void test_plane_segment(void) {
+    plane_t p = plane_init(vector3_init_int(1, 0, 0), -fixed_from_int(2));
+    fixed_t t;
+
+    TEST_ASSERT("Crosses", plane_intersect_segment(&p, vector3_init_int(0, 0, 0),
+                                                   vector3_init_int(8, 0, 0), &t));
+    TEST_ASSERT_EQUAL_INT(FIXED_ONE / 4, t);
+
+    TEST_ASSERT("Both in front", !plane_intersect_segment(&p, vector3_init_int(3, 0, 0),
+                                                          vector3_init_int(8, 0, 0), &t));
+
+    /* Touching the plane counts, at the touching end */
+    TEST_ASSERT("Touches", plane_intersect_segment(&p, vector3_init_int(5, 0, 0),
+                                                   vector3_init_int(2, 1, 0), &t));
+    TEST_ASSERT_EQUAL_INT(FIXED_ONE, t);
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run plane tests */
+    test_begin_suite(&results, "Plane Equations");
+    test_run(&results, test_plane_construction, "Construction");
+    test_run(&results, test_plane_distance, "Distance and Classification");
+    test_run(&results, test_plane_segment, "Segment Crossing");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * tproject.c
+ *
+ * Test suite for the perspective divide and viewport transformation
+ */
+
+#include <stdio.h>
+
+#include "..\include\clip.h"
+#include "..\include\project.h"
+#include "tmath.h"
+
+/* Make a clip vertex from clip space floats */
+static clip_vertex_t make_vertex(float x, float y, float z, float w, float u) {
+    clip_vertex_t v;
+
+    v.position = vector4_init(fixed_from_float(x), fixed_from_float(y), fixed_from_float(z),
+                              fixed_from_float(w));
+    v.color.r = 10;
+    v.color.g = 20;
+    v.color.b = 30;
+    v.texcoord.u = fixed_from_float(u);
+    v.texcoord.v = fixed_from_float(-u);
+
+    return v;
+}
+
+/* Test viewport setup for the full mode 13h screen */
+void test_viewport_init(void) {
+    viewport_t vp;
+
+    viewport_init(&vp, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, PROJECT_PIXEL_ASPECT_13H);
+
+    TEST_ASSERT_EQUAL_FLOAT(160.0f, fixed_to_float(vp.scale_x), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(-100.0f, fixed_to_float(vp.scale_y), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(160.0f, fixed_to_float(vp.bias_x), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, fixed_to_float(vp.bias_y), 0.001f);
+
+    /* 320x200 shown on a 4:3 monitor */
+    TEST_ASSERT_EQUAL_FLOAT(1.3333f, fixed_to_float(vp.aspect), 0.001f);
+}
+
+/* Test the frustum edges land on the screen edges */
+void test_project_edges(void) {
+    viewport_t vp;
+    clip_vertex_t in[3];
+    screen_vertex_t out[3];
+
+    viewport_init(&vp, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, FIXED_ONE);
+
+    in[0] = make_vertex(0.0f, 0.0f, 0.0f, 2.0f, 0.0f);
+    in[1] = make_vertex(4.0f, 4.0f, -4.0f, 4.0f, 0.0f);
+    in[2] = make_vertex(-3.0f, -3.0f, 3.0f, 3.0f, 0.0f);
+
+    TEST_ASSERT_EQUAL_INT(3, project_polygon(&vp, in, 3, out));
+
+    TEST_ASSERT_EQUAL_FLOAT(160.0f, fixed_to_float(out[0].x), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, fixed_to_float(out[0].y), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, fixed_to_float(out[0].z), 0.001f);
+
+    /* Top right at the near plane */
+    TEST_ASSERT_EQUAL_FLOAT(320.0f, fixed_to_float(out[1].x), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fixed_to_float(out[1].y), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fixed_to_float(out[1].z), 0.001f);
+
+    /* Bottom left at the far plane */
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fixed_to_float(out[2].x), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(200.0f, fixed_to_float(out[2].y), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, fixed_to_float(out[2].z), 0.001f);
+}
+
+/* Test the attributes kept for perspective-correct interpolation */
+void test_project_attributes(void) {
+    viewport_t vp;
+    clip_vertex_t in;
+    screen_vertex_t out;
+
+    viewport_init(&vp, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, FIXED_ONE);
+
+    in = make_vertex(1.0f, 0.0f, 0.0f, 4.0f, 2.0f);
+    project_vertex(&vp, &in, &out);
+
+    TEST_ASSERT_EQUAL_FLOAT(0.25f, fixed_to_float(out.inv_w), 0.0001f);
+    TEST_ASSERT_EQUAL_FLOAT(0.5f, fixed_to_float(out.u_over_w), 0.0001f);
+    TEST_ASSERT_EQUAL_FLOAT(-0.5f, fixed_to_float(out.v_over_w), 0.0001f);
+    TEST_ASSERT_EQUAL_INT(20, out.color.g);
+    TEST_ASSERT_EQUAL_FLOAT(0.0711f, fixed_to_float(out.light), 0.0005f);
+
+    /* Dividing back gives the original coordinate */
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, fixed_to_float(fixed_div(out.u_over_w, out.inv_w)), 0.001f);
+}
+
+/* Test subpixel precision holds for distant vertices */
+void test_project_precision(void) {
+    viewport_t vp;
+    clip_vertex_t in;
+    screen_vertex_t out;
+
+    viewport_init(&vp, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, FIXED_ONE);
+
+    /* A plain 16.16 reciprocal of 300 would put x a quarter pixel off */
+    in = make_vertex(225.0f, -150.0f, 0.0f, 300.0f, 0.0f);
+    project_vertex(&vp, &in, &out);
+
+    TEST_ASSERT_EQUAL_FLOAT(280.0f, fixed_to_float(out.x), 0.01f);
+    TEST_ASSERT_EQUAL_FLOAT(150.0f, fixed_to_float(out.y), 0.01f);
+}
+
+/* Test texture coordinates far past 128 texels a unit of w */
+void test_project_texcoord_range(void) {
+    viewport_t vp;
+    clip_vertex_t in;
+    screen_vertex_t out;
+
+    viewport_init(&vp, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, FIXED_ONE);
+
+    /* A wall tiled 1024 texels wide seen at w = 0.5 */
+    in = make_vertex(0.0f, 0.0f, 0.0f, 0.5f, 1024.0f);
+    project_vertex(&vp, &in, &out);
+
+    TEST_ASSERT_EQUAL_FLOAT(2048.0f, fixed_to_float(out.u_over_w), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(-2048.0f, fixed_to_float(out.v_over_w), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(1024.0f, fixed_to_float(fixed_div(out.u_over_w, out.inv_w)), 0.01f);
+}
+
+/* Test a viewport offset inside the screen */
+void test_project_offset(void) {
+    viewport_t vp;
+    clip_vertex_t in;
+    screen_vertex_t out;
+
+    viewport_init(&vp, 40, 20, 240, 160, FIXED_ONE);
+
+    in = make_vertex(-1.0f, 1.0f, 0.0f, 1.0f, 0.0f);
+    project_vertex(&vp, &in, &out);
+
+    TEST_ASSERT_EQUAL_FLOAT(40.0f, fixed_to_float(out.x), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, fixed_to_float(out.y), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(1.5f, fixed_to_float(vp.aspect), 0.001f);
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run projection tests */
+    test_begin_suite(&results, "Viewport Projection");
+    test_run(&results, test_viewport_init, "Viewport Setup");
+    test_run(&results, test_project_edges, "Frustum Edges");
+    test_run(&results, test_project_attributes, "Interpolation Attributes");
+    test_run(&results, test_project_precision, "Distant Precision");
+    test_run(&results, test_project_texcoord_range, "Texture Coordinate Range");
+    test_run(&results, test_project_offset, "Viewport Offset");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
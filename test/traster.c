@@ -0,0 +1,240 @@
+/*
+ * traster.c
+ *
+ * Test suite for flat shaded triangle rasterization
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "..\include\raster.h"
+#include "..\include\tristrip.h"
+#include "tmath.h"
+
+#define GRID_COLS 8
+#define GRID_ROWS 6
+#define STRIP_LEN 14
+
+static unsigned char screen[SCREEN_SIZE];
+static unsigned char reference[SCREEN_SIZE];
+
+/* Make a screen vertex from pixel coordinates */
+static screen_vertex_t make_vertex(float x, float y) {
+    screen_vertex_t v;
+
+    memset(&v, 0, sizeof(v));
+    v.x = fixed_from_float(x);
+    v.y = fixed_from_float(y);
+
+    return v;
+}
+
+/* Count pixels that are not background */
+static long count_written(void) {
+    long count = 0;
+    int i;
+
+    for (i = 0; i < SCREEN_SIZE; i++) {
+        if (screen[i] != 0) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+/* Test a rectangle split into two triangles covers exactly its pixels */
+void test_raster_rectangle(void) {
+    screen_vertex_t v[4];
+    long a, b;
+
+    memset(screen, 0, SCREEN_SIZE);
+
+    v[0] = make_vertex(10.0f, 10.0f);
+    v[1] = make_vertex(20.0f, 10.0f);
+    v[2] = make_vertex(20.0f, 30.0f);
+    v[3] = make_vertex(10.0f, 30.0f);
+
+    a = raster_flat_triangle(screen, &v[0], &v[1], &v[2], 1);
+    b = raster_flat_triangle(screen, &v[0], &v[2], &v[3], 2);
+
+    TEST_ASSERT_EQUAL_INT(200, (int) (a + b));
+    TEST_ASSERT_EQUAL_INT(200, (int) count_written());
+
+    /* Top and left edges are in, bottom and right edges are out */
+    TEST_ASSERT_EQUAL_INT(1, screen[10 * SCREEN_WIDTH + 10]);
+    TEST_ASSERT_EQUAL_INT(2, screen[29 * SCREEN_WIDTH + 10]);
+    TEST_ASSERT_EQUAL_INT(1, screen[10 * SCREEN_WIDTH + 19]);
+    TEST_ASSERT_EQUAL_INT(0, screen[10 * SCREEN_WIDTH + 20]);
+    TEST_ASSERT_EQUAL_INT(0, screen[30 * SCREEN_WIDTH + 10]);
+}
+
+/* Test pixel centres lying exactly on edges */
+void test_raster_fill_rule(void) {
+    screen_vertex_t v[3];
+
+    memset(screen, 0, SCREEN_SIZE);
+
+    /* Flat top along row 5's centres, flat bottom along row 9's */
+    v[0] = make_vertex(4.5f, 5.5f);
+    v[1] = make_vertex(8.5f, 5.5f);
+    v[2] = make_vertex(4.5f, 9.5f);
+
+    /* Rows 5..8, widths 4, 3, 2, 1 with the right edge excluded */
+    TEST_ASSERT_EQUAL_INT(10, (int) raster_flat_triangle(screen, &v[0], &v[1], &v[2], 3));
+    TEST_ASSERT_EQUAL_INT(3, screen[5 * SCREEN_WIDTH + 4]);
+    TEST_ASSERT_EQUAL_INT(0, screen[5 * SCREEN_WIDTH + 8]);
+    TEST_ASSERT_EQUAL_INT(0, screen[9 * SCREEN_WIDTH + 4]);
+
+    /* Reversed winding draws the same pixels */
+    TEST_ASSERT_EQUAL_INT(10, (int) raster_flat_triangle(screen, &v[0], &v[2], &v[1], 3));
+    TEST_ASSERT_EQUAL_INT(10, (int) count_written());
+
+    /* Too thin to cover any pixel centre */
+    v[0] = make_vertex(4.5f, 5.6f);
+    v[1] = make_vertex(8.5f, 5.6f);
+    v[2] = make_vertex(6.0f, 6.4f);
+    TEST_ASSERT_EQUAL_INT(0, (int) raster_flat_triangle(screen, &v[0], &v[1], &v[2], 3));
+}
+
+/* Test a jittered mesh has no cracks and no pixel written twice */
+void test_raster_mesh(void) {
+    screen_vertex_t grid[GRID_ROWS + 1][GRID_COLS + 1];
+    long total = 0;
+    int row, col, x, y, holes = 0;
+    float jx, jy;
+
+    memset(screen, 0, SCREEN_SIZE);
+
+    for (row = 0; row <= GRID_ROWS; row++) {
+        for (col = 0; col <= GRID_COLS; col++) {
+            jx = (float) ((row * 7 + col * 13) % 11) / 7.0f - 0.7f;
+            jy = (float) ((row * 5 + col * 3) % 9) / 6.0f - 0.6f;
+            grid[row][col] = make_vertex(20.0f + col * 33.3f + jx, 15.0f + row * 27.7f + jy);
+        }
+    }
+
+    for (row = 0; row < GRID_ROWS; row++) {
+        for (col = 0; col < GRID_COLS; col++) {
+            total += raster_flat_triangle(screen, &grid[row][col], &grid[row][col + 1],
+                                          &grid[row + 1][col + 1], (unsigned char) (row + 1));
+            total += raster_flat_triangle(screen, &grid[row][col], &grid[row + 1][col + 1],
+                                          &grid[row + 1][col], (unsigned char) (col + 1));
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT((int) count_written(), (int) total);
+
+    /* Everything well inside the jittered border is covered */
+    for (y = 17; y < 180; y++) {
+        for (x = 22; x < 284; x++) {
+            holes += screen[y * SCREEN_WIDTH + x] == 0;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, holes);
+}
+
+/* Test strips and fans with shared edge setup draw what their triangles do one by one */
+void test_raster_strip(void) {
+    screen_vertex_t v[STRIP_LEN];
+    long strip, single;
+    int type, i;
+
+    for (type = TRISTRIP_STRIP; type <= TRISTRIP_FAN; type++) {
+        for (i = 0; i < STRIP_LEN; i++) {
+            if (type == TRISTRIP_STRIP) {
+                /* Zig-zag along a wall, crossing the guard band at the right */
+                v[i] = make_vertex(-10.0f + i * 26.3f + (i % 3) * 0.4f,
+                                   (i & 1) ? 150.7f - i * 2.1f : 40.2f + i * 1.3f);
+            } else if (i == 0) {
+                v[i] = make_vertex(160.3f, 100.6f);
+            } else {
+                /* Half a turn around the hub */
+                v[i] = make_vertex(160.3f + (float) cos(i * 0.24) * 90.0f,
+                                   100.6f + (float) sin(i * 0.24) * 80.0f);
+            }
+        }
+
+        memset(reference, 0, SCREEN_SIZE);
+        single = 0;
+
+        for (i = 0; i + 2 < STRIP_LEN; i++) {
+            single += raster_flat_triangle(reference, type == TRISTRIP_FAN ? &v[0] : &v[i],
+                                           &v[i + 1], &v[i + 2], 7);
+        }
+
+        memset(screen, 0, SCREEN_SIZE);
+        strip = raster_flat_strip(screen, v, STRIP_LEN, type, 7);
+
+        TEST_ASSERT("Strip drawn", strip > 1000);
+        TEST_ASSERT_EQUAL_INT((int) single, (int) strip);
+        TEST_ASSERT("Same pixels", memcmp(screen, reference, SCREEN_SIZE) == 0);
+    }
+
+    /* Too few vertices draw nothing */
+    TEST_ASSERT_EQUAL_INT(0, (int) raster_flat_strip(screen, v, 2, TRISTRIP_STRIP, 7));
+}
+
+/* Test triangles reaching into the guard band are scissored to the screen */
+void test_raster_guard_band(void) {
+    screen_vertex_t v[4];
+
+    memset(screen, 0, SCREEN_SIZE);
+
+    v[0] = make_vertex(-1000.0f, -600.0f);
+    v[1] = make_vertex(1400.0f, -600.0f);
+    v[2] = make_vertex(1400.0f, 800.0f);
+    v[3] = make_vertex(-1000.0f, 800.0f);
+
+    TEST_ASSERT_EQUAL_INT(SCREEN_SIZE, (int) raster_flat_polygon(screen, v, 4, 5));
+    TEST_ASSERT_EQUAL_INT(SCREEN_SIZE, (int) count_written());
+
+    /* Entirely to the left of the screen */
+    memset(screen, 0, SCREEN_SIZE);
+    v[1] = make_vertex(-10.0f, 50.0f);
+    v[2] = make_vertex(-200.0f, 150.0f);
+    TEST_ASSERT_EQUAL_INT(0, (int) raster_flat_triangle(screen, &v[0], &v[1], &v[2], 5));
+    TEST_ASSERT_EQUAL_INT(0, (int) count_written());
+}
+
+/* Test the span fill at every alignment and length */
+void test_raster_fill_span(void) {
+    unsigned char row[64];
+    int offset, count, i, bad = 0;
+
+    for (offset = 0; offset < 8; offset++) {
+        for (count = 0; count < 40; count++) {
+            memset(row, 0, sizeof(row));
+            raster_fill_span(row + offset, count, 0xAB);
+
+            for (i = 0; i < (int) sizeof(row); i++) {
+                bad += row[i] != ((i >= offset && i < offset + count) ? 0xAB : 0);
+            }
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, bad);
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run rasterizer tests */
+    test_begin_suite(&results, "Flat Triangle Rasterization");
+    test_run(&results, test_raster_rectangle, "Rectangle Coverage");
+    test_run(&results, test_raster_fill_rule, "Top-Left Fill Rule");
+    test_run(&results, test_raster_mesh, "Shared Edges");
+    test_run(&results, test_raster_strip, "Strips and Fans");
+    test_run(&results, test_raster_guard_band, "Guard Band Scissoring");
+    test_run(&results, test_raster_fill_span, "Span Fill");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*
+ * trqueue.c
+ *
+ * Test suite for the render state sorting queue
+ */
+
+#include <stdio.h>
+
+#include "..\include\rqueue.h"
+#include "..\include\triangle.h"
+#include "..\include\vertex.h"
+#include "tmath.h"
+
+#define TEST_TRIS 12
+
+static triangle_t tris[TEST_TRIS];
+static texture_t tex_a, tex_b;
+static unsigned char texels[16];
+
+/* Build triangles alternating between flat and two textures */
+static void make_tris(void) {
+    vertex_t v1 = vertex_init(fixed_from_int(0), fixed_from_int(0), fixed_from_int(0));
+    vertex_t v2 = vertex_init(fixed_from_int(1), fixed_from_int(0), fixed_from_int(0));
+    vertex_t v3 = vertex_init(fixed_from_int(0), fixed_from_int(1), fixed_from_int(0));
+    int i;
+
+    tex_a.texture_data = texels;
+    tex_a.width = 4;
+    tex_a.height = 4;
+    tex_b = tex_a;
+
+    for (i = 0; i < TEST_TRIS; i++) {
+        tris[i] = triangle_init(v1, v2, v3);
+
+        if (i % 3 == 1) {
+            triangle_set_texture(&tris[i], &tex_a);
+        } else if (i % 3 == 2) {
+            triangle_set_texture(&tris[i], &tex_b);
+        }
+    }
+}
+
+/* Test state grouping of opaque triangles */
+void test_rqueue_state_sort(void) {
+    rqueue_entry_t entries[TEST_TRIS], scratch[TEST_TRIS];
+    rqueue_t q;
+    int i;
+
+    make_tris();
+    rqueue_init(&q, entries, scratch, TEST_TRIS);
+
+    for (i = 0; i < TEST_TRIS; i++) {
+        TEST_ASSERT("Queued", rqueue_add(&q, &tris[i], fixed_from_int(TEST_TRIS - i), 0));
+    }
+
+    /* Queue is full */
+    TEST_ASSERT("Full queue refuses", !rqueue_add(&q, &tris[0], FIXED_ZERO, 0));
+
+    rqueue_sort(&q);
+
+    TEST_ASSERT_EQUAL_INT(TEST_TRIS, q.stats.submitted);
+    TEST_ASSERT_EQUAL_INT(TEST_TRIS, q.stats.changes_before);
+    TEST_ASSERT_EQUAL_INT(3, q.stats.changes_after);
+
+    /* Flat first, then front to back inside each bucket */
+    TEST_ASSERT_EQUAL_INT(TRIANGLE_FLAT, q.entries[0].tri->render_mode);
+    TEST_ASSERT("Front to back in bucket", q.entries[0].tri == &tris[9]);
+    TEST_ASSERT("Last of the flat bucket", q.entries[3].tri == &tris[0]);
+}
+
+/* Test ordered triangles stay back to front after opaque ones */
+void test_rqueue_ordered(void) {
+    rqueue_entry_t entries[TEST_TRIS], scratch[TEST_TRIS];
+    rqueue_t q;
+
+    make_tris();
+    rqueue_init(&q, entries, scratch, TEST_TRIS);
+
+    rqueue_add(&q, &tris[1], fixed_from_int(5), RQUEUE_ORDERED);
+    rqueue_add(&q, &tris[2], fixed_from_int(20), RQUEUE_ORDERED);
+    rqueue_add(&q, &tris[0], fixed_from_int(50), RQUEUE_OPAQUE);
+    rqueue_add(&q, &tris[4], fixed_from_int(10), RQUEUE_ORDERED);
+
+    rqueue_sort(&q);
+
+    TEST_ASSERT("Opaque first", q.entries[0].tri == &tris[0]);
+    TEST_ASSERT("Furthest ordered", q.entries[1].tri == &tris[2]);
+    TEST_ASSERT("Middle ordered", q.entries[2].tri == &tris[4]);
+    TEST_ASSERT("Nearest ordered", q.entries[3].tri == &tris[1]);
+}
+
+/* Test clearing keeps texture ids and resets counts */
+void test_rqueue_clear(void) {
+    rqueue_entry_t entries[TEST_TRIS], scratch[TEST_TRIS];
+    rqueue_t q;
+
+    make_tris();
+    rqueue_init(&q, entries, scratch, TEST_TRIS);
+
+    rqueue_add(&q, &tris[1], FIXED_ZERO, 0);
+    rqueue_add(&q, &tris[2], FIXED_ZERO, 0);
+    TEST_ASSERT_EQUAL_INT(2, q.texture_count);
+
+    rqueue_clear(&q);
+    TEST_ASSERT_EQUAL_INT(0, q.count);
+    TEST_ASSERT_EQUAL_INT(0, rqueue_count_state_changes(&q));
+
+    rqueue_add(&q, &tris[4], FIXED_ZERO, 0);
+    TEST_ASSERT_EQUAL_INT(2, q.texture_count);
+}
+
+/* Test textures past the id table never share a bucket with missing textures */
+void test_rqueue_texture_overflow(void) {
+    static texture_t many[RQUEUE_MAX_TEXTURES + 1];
+    static triangle_t tri[RQUEUE_MAX_TEXTURES + 2];
+    static rqueue_entry_t entries[RQUEUE_MAX_TEXTURES + 2], scratch[RQUEUE_MAX_TEXTURES + 2];
+    rqueue_t q;
+    int i;
+
+    make_tris();
+    rqueue_init(&q, entries, scratch, RQUEUE_MAX_TEXTURES + 2);
+
+    /* The last texture has no id left, the first triangle has no texture */
+    for (i = 0; i <= RQUEUE_MAX_TEXTURES; i++) {
+        many[i] = tex_a;
+        tri[i + 1] = tris[1];
+        triangle_set_texture(&tri[i + 1], &many[i]);
+    }
+
+    tri[0] = tris[1];
+    tri[0].texture = NULL;
+
+    for (i = RQUEUE_MAX_TEXTURES + 1; i >= 0; i--) {
+        TEST_ASSERT("Queued", rqueue_add(&q, &tri[i], FIXED_ZERO, 0));
+    }
+
+    TEST_ASSERT_EQUAL_INT(RQUEUE_MAX_TEXTURES, q.texture_count);
+
+    rqueue_sort(&q);
+
+    TEST_ASSERT("Missing texture first", q.entries[0].tri == &tri[0]);
+    TEST_ASSERT("Overflow texture last", q.entries[RQUEUE_MAX_TEXTURES + 1].tri == &tri[1]);
+    TEST_ASSERT_EQUAL_INT(RQUEUE_MAX_TEXTURES + 2, q.stats.changes_after);
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run sorting tests */
+    test_begin_suite(&results, "Render Queue Sorting");
+    test_run(&results, test_rqueue_state_sort, "State Bucketing");
+    test_run(&results, test_rqueue_ordered, "Back to Front Ordering");
+    test_run(&results, test_rqueue_clear, "Frame Reset");
+    test_run(&results, test_rqueue_texture_overflow, "Texture Id Overflow");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
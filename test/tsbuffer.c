@@ -0,0 +1,246 @@
+/*
+ * tsbuffer.c
+ *
+ * Test suite for span buffer hidden surface removal
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "..\include\raster.h"
+#include "..\include\sbuffer.h"
+#include "tmath.h"
+
+#define POOL_SIZE    4096
+#define RANDOM_SPANS 400
+#define RANDOM_ROWS  4
+#define SCENE_TRIS   40
+
+static sbuffer_span_t pool[POOL_SIZE];
+static sbuffer_t sb;
+static unsigned char screen[SCREEN_SIZE];
+static unsigned char reference[SCREEN_SIZE];
+static fixed_t depth[RANDOM_ROWS * SCREEN_WIDTH];
+static unsigned long seed;
+
+/* Small deterministic generator so runs are repeatable */
+static int next_random(int range) {
+    seed = seed * 1103515245UL + 12345UL;
+    return (int) ((seed >> 16) & 0x7FFF) % range;
+}
+
+/* Test overlapping constant depth spans on one row */
+void test_sbuffer_layers(void) {
+    sbuffer_init(&sb, pool, POOL_SIZE);
+
+    TEST_ASSERT_EQUAL_INT(40, sbuffer_insert(&sb, 0, 10, 50, FIXED_ONE, 0, 1));
+    TEST_ASSERT_EQUAL_INT(40, sbuffer_insert(&sb, 0, 30, 70, 2 * FIXED_ONE, 0, 2));
+    TEST_ASSERT_EQUAL_INT(40, sbuffer_insert(&sb, 0, 0, 100, FIXED_HALF, 0, 3));
+    TEST_ASSERT_EQUAL_INT(0, sbuffer_insert(&sb, 0, 20, 40, FIXED_ONE >> 4, 0, 4));
+
+    memset(screen, 0, SCREEN_SIZE);
+    TEST_ASSERT_EQUAL_INT(100, (int) sbuffer_flush(&sb, screen));
+
+    TEST_ASSERT_EQUAL_INT(3, screen[5]);
+    TEST_ASSERT_EQUAL_INT(1, screen[29]);
+    TEST_ASSERT_EQUAL_INT(2, screen[30]);
+    TEST_ASSERT_EQUAL_INT(2, screen[69]);
+    TEST_ASSERT_EQUAL_INT(3, screen[70]);
+    TEST_ASSERT_EQUAL_INT(0, screen[100]);
+
+    TEST_ASSERT_EQUAL_INT(4, (int) sb.stats.inserted);
+    TEST_ASSERT_EQUAL_INT(1, (int) sb.stats.clipped);
+    TEST_ASSERT_EQUAL_INT(1, (int) sb.stats.rejected);
+    TEST_ASSERT_EQUAL_INT(200, (int) sb.stats.pixels_in);
+    TEST_ASSERT_EQUAL_INT(100, (int) sb.stats.pixels_out);
+}
+
+/* Test spans whose depths cross split at the crossing pixel */
+void test_sbuffer_crossing(void) {
+    fixed_t slope = -(FIXED_ONE / 100);
+
+    sbuffer_init(&sb, pool, POOL_SIZE);
+
+    /* 1 - x / 100 is nearer than 0.505 up to pixel 49 */
+    sbuffer_insert(&sb, 3, 0, 100, FIXED_ONE, slope, 1);
+    TEST_ASSERT_EQUAL_INT(50, sbuffer_insert(&sb, 3, 0, 100, fixed_from_float(0.505f), 0, 2));
+
+    memset(screen, 0, SCREEN_SIZE);
+    sbuffer_flush(&sb, screen);
+    TEST_ASSERT_EQUAL_INT(1, screen[3 * SCREEN_WIDTH + 49]);
+    TEST_ASSERT_EQUAL_INT(2, screen[3 * SCREEN_WIDTH + 50]);
+
+    /* Same result the other way round */
+    sbuffer_clear(&sb);
+    sbuffer_insert(&sb, 3, 0, 100, fixed_from_float(0.505f), 0, 2);
+    TEST_ASSERT_EQUAL_INT(50, sbuffer_insert(&sb, 3, 0, 100, FIXED_ONE, slope, 1));
+
+    memset(screen, 0, SCREEN_SIZE);
+    sbuffer_flush(&sb, screen);
+    TEST_ASSERT_EQUAL_INT(1, screen[3 * SCREEN_WIDTH + 49]);
+    TEST_ASSERT_EQUAL_INT(2, screen[3 * SCREEN_WIDTH + 50]);
+}
+
+/* Test random sloped spans resolve exactly like a per-pixel depth test */
+void test_sbuffer_random(void) {
+    int i, y, x0, x1, x, mismatches = 0;
+    fixed_t z, dz, pz;
+    unsigned char color;
+
+    sbuffer_init(&sb, pool, POOL_SIZE);
+    memset(reference, 0, SCREEN_SIZE);
+    memset(depth, 0, sizeof(depth));
+    seed = 1;
+
+    for (i = 0; i < RANDOM_SPANS; i++) {
+        y = next_random(RANDOM_ROWS);
+        x0 = next_random(SCREEN_WIDTH);
+        x1 = x0 + 1 + next_random(SCREEN_WIDTH - x0);
+        z = FIXED_ONE + next_random(4 * FIXED_ONE / 8) * 8;
+        dz = next_random(512) - 256;
+        color = (unsigned char) (1 + i % 255);
+
+        sbuffer_insert(&sb, y, x0, x1, z, dz, color);
+
+        /* Reference keeps the stored pixel on ties, like the span buffer */
+        for (x = x0; x < x1; x++) {
+            pz = z + dz * (x - x0);
+
+            if (pz > depth[y * SCREEN_WIDTH + x]) {
+                depth[y * SCREEN_WIDTH + x] = pz;
+                reference[y * SCREEN_WIDTH + x] = color;
+            }
+        }
+    }
+
+    memset(screen, 0, SCREEN_SIZE);
+    sbuffer_flush(&sb, screen);
+
+    for (i = 0; i < RANDOM_ROWS * SCREEN_WIDTH; i++) {
+        mismatches += screen[i] != reference[i];
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, mismatches);
+    TEST_ASSERT_EQUAL_INT(0, (int) sb.stats.overflow);
+}
+
+/* Test a triangle scene matches painter's order with no overdraw */
+void test_sbuffer_overdraw(void) {
+    static screen_vertex_t v[SCENE_TRIS][3];
+    long painter = 0, covered = 0;
+    int i, j, order[SCENE_TRIS], t;
+
+    memset(v, 0, sizeof(v));
+    seed = 7;
+
+    for (i = 0; i < SCENE_TRIS; i++) {
+        for (j = 0; j < 3; j++) {
+            v[i][j].x = fixed_from_int(next_random(SCREEN_WIDTH + 80) - 40) + next_random(256);
+            v[i][j].y = fixed_from_int(next_random(SCREEN_HEIGHT + 60) - 30) + next_random(256);
+            v[i][j].inv_w = FIXED_ONE / 16 + i * 97;
+        }
+
+        order[i] = i;
+    }
+
+    /* Painter's order draws farthest first, which is index order here */
+    memset(reference, 0, SCREEN_SIZE);
+
+    for (i = 0; i < SCENE_TRIS; i++) {
+        painter += raster_flat_triangle(reference, &v[i][0], &v[i][1], &v[i][2],
+                                        (unsigned char) (i + 1));
+    }
+
+    /* The span buffer gets them shuffled */
+    for (i = SCENE_TRIS - 1; i > 0; i--) {
+        j = next_random(i + 1);
+        t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+
+    sbuffer_init(&sb, pool, POOL_SIZE);
+
+    for (i = 0; i < SCENE_TRIS; i++) {
+        sbuffer_add_triangle(&sb, &v[order[i]][0], &v[order[i]][1], &v[order[i]][2],
+                             (unsigned char) (order[i] + 1));
+    }
+
+    memset(screen, 0, SCREEN_SIZE);
+    sbuffer_flush(&sb, screen);
+
+    for (i = 0; i < SCREEN_SIZE; i++) {
+        covered += reference[i] != 0;
+    }
+
+    TEST_ASSERT("Same image", memcmp(screen, reference, SCREEN_SIZE) == 0);
+    TEST_ASSERT_EQUAL_INT((int) painter, (int) sb.stats.pixels_in);
+    TEST_ASSERT_EQUAL_INT((int) covered, (int) sb.stats.pixels_out);
+
+    printf("\n  Painter's order wrote %ld pixels, span buffer %ld, overdraw %ld.%02ld\n", painter,
+           sb.stats.pixels_out, painter / covered, (painter * 100 / covered) % 100);
+}
+
+/* Test an exhausted pool drops pieces and counts them */
+void test_sbuffer_overflow(void) {
+    sbuffer_init(&sb, pool, 2);
+
+    sbuffer_insert(&sb, 0, 0, 10, FIXED_ONE, 0, 1);
+    sbuffer_insert(&sb, 1, 0, 10, FIXED_ONE, 0, 1);
+    TEST_ASSERT_EQUAL_INT(0, sbuffer_insert(&sb, 2, 0, 10, FIXED_ONE, 0, 1));
+    TEST_ASSERT_EQUAL_INT(1, (int) sb.stats.overflow);
+
+    /* A nearer span covering one completely reuses its node */
+    TEST_ASSERT_EQUAL_INT(10, sbuffer_insert(&sb, 0, 0, 10, 2 * FIXED_ONE, 0, 2));
+    TEST_ASSERT_EQUAL_INT(1, (int) sb.stats.overflow);
+}
+
+/* Test a split with no node for the far side leaves the stored span whole */
+void test_sbuffer_overflow_split(void) {
+    int i;
+
+    sbuffer_init(&sb, pool, 2);
+
+    sbuffer_insert(&sb, 0, 0, 20, FIXED_ONE, 0, 1);
+    sbuffer_insert(&sb, 1, 0, 20, FIXED_ONE, 0, 1);
+
+    /* Nearer in the middle, needs a node for itself and one for the tail */
+    TEST_ASSERT_EQUAL_INT(0, sbuffer_insert(&sb, 0, 5, 10, 2 * FIXED_ONE, 0, 2));
+    TEST_ASSERT_EQUAL_INT(1, (int) sb.stats.overflow);
+
+    memset(screen, 0, sizeof(screen));
+    TEST_ASSERT_EQUAL_INT(40, (int) sbuffer_flush(&sb, screen));
+
+    for (i = 0; i < 20; i++) {
+        TEST_ASSERT_EQUAL_INT(1, screen[i]);
+    }
+
+    /* With room for the piece and the tail the split goes ahead */
+    sbuffer_init(&sb, pool, 3);
+    sbuffer_insert(&sb, 0, 0, 20, FIXED_ONE, 0, 1);
+    TEST_ASSERT_EQUAL_INT(5, sbuffer_insert(&sb, 0, 5, 10, 2 * FIXED_ONE, 0, 2));
+    TEST_ASSERT_EQUAL_INT(0, (int) sb.stats.overflow);
+    TEST_ASSERT_EQUAL_INT(20, (int) sbuffer_flush(&sb, screen));
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run span buffer tests */
+    test_begin_suite(&results, "Span Buffer");
+    test_run(&results, test_sbuffer_layers, "Layered Spans");
+    test_run(&results, test_sbuffer_crossing, "Crossing Depths");
+    test_run(&results, test_sbuffer_random, "Per-Pixel Reference");
+    test_run(&results, test_sbuffer_overdraw, "Painter's Order Overdraw");
+    test_run(&results, test_sbuffer_overflow, "Pool Overflow");
+    test_run(&results, test_sbuffer_overflow_split, "Pool Overflow Split");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
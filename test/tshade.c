@@ -0,0 +1,245 @@
+/*
+ * tshade.c
+ *
+ * Test suite for Gouraud shading through palette shade ramps
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "..\include\raster.h"
+#include "..\include\shade.h"
+#include "fixture.h"
+#include "tmath.h"
+
+#define RANDOM_TRI 40
+#define BENCH_RUNS 20
+#define BACKGROUND 0xFF
+
+static color_t palette[256];
+static shade_ramp_t ramp;
+static unsigned char screen[SCREEN_SIZE];
+static unsigned char reference[SCREEN_SIZE];
+static unsigned long seed;
+
+/* Small deterministic generator so runs are repeatable */
+static int next_random(int range) {
+    seed = seed * 1103515245UL + 12345UL;
+    return (int) ((seed >> 16) & 0x7FFF) % range;
+}
+
+/* Light level a pixel was drawn with, from its palette index */
+static int level_of(unsigned char index) {
+    return index % SHADE_LEVELS;
+}
+
+/* Test nearest color search */
+void test_shade_nearest(void) {
+    fixture_hue_palette(palette, SHADE_LEVELS);
+
+    TEST_ASSERT_EQUAL_INT(0, shade_nearest(palette, 0, 0, 0));
+    TEST_ASSERT_EQUAL_INT(SHADE_LEVELS - 1, shade_nearest(palette, 255, 0, 0));
+    TEST_ASSERT_EQUAL_INT(2 * SHADE_LEVELS + 16, shade_nearest(palette, 0, 0, 132));
+    TEST_ASSERT_EQUAL_INT(7 * SHADE_LEVELS + 31, shade_nearest(palette, 250, 130, 60));
+
+    /* Slightly off a green entry still finds it */
+    TEST_ASSERT_EQUAL_INT(SHADE_LEVELS + 20, shade_nearest(palette, 3, 166, 2));
+}
+
+/* Test a ramp walks its hue from black to the base color */
+void test_shade_ramp(void) {
+    int hue, level;
+
+    fixture_hue_palette(palette, SHADE_LEVELS);
+
+    for (hue = 0; hue < FIXTURE_HUES; hue++) {
+        shade_build_ramp(&ramp, palette, (unsigned char) (hue * SHADE_LEVELS + SHADE_LEVELS - 1));
+
+        TEST_ASSERT_EQUAL_INT(0, ramp.index[0]);
+
+        for (level = 1; level < SHADE_LEVELS; level++) {
+            TEST_ASSERT_EQUAL_INT(hue * SHADE_LEVELS + level, ramp.index[level]);
+        }
+    }
+
+    /* A base partway up a hue ramp tops out at itself */
+    shade_build_ramp(&ramp, palette, (unsigned char) (3 * SHADE_LEVELS + 10));
+    TEST_ASSERT_EQUAL_INT(3 * SHADE_LEVELS + 10, ramp.index[SHADE_LEVELS - 1]);
+    TEST_ASSERT_EQUAL_INT(3 * SHADE_LEVELS + 5, ramp.index[15]);
+}
+
+/* Test span light rounds, steps evenly and clamps */
+void test_shade_span(void) {
+    unsigned char *row = screen;
+    int i;
+
+    fixture_hue_palette(palette, SHADE_LEVELS);
+    shade_build_ramp(&ramp, palette, SHADE_LEVELS - 1);
+
+    /* Black to full over 32 pixels hits every level once */
+    shade_gouraud_span(row, SHADE_LEVELS, &ramp, FIXED_ZERO, FIXED_ONE / (SHADE_LEVELS - 1));
+
+    for (i = 1; i < SHADE_LEVELS; i++) {
+        TEST_ASSERT_EQUAL_INT(i, level_of(row[i]));
+    }
+
+    /* Half light rounds to the nearer level */
+    shade_gouraud_span(row, 4, &ramp, FIXED_HALF, 0);
+    TEST_ASSERT_EQUAL_INT(16, level_of(row[3]));
+
+    /* Light past either end is held at the end of the ramp */
+    shade_gouraud_span(row, 40, &ramp, -FIXED_HALF, FIXED_ONE / 10);
+    TEST_ASSERT_EQUAL_INT(0, row[0]);
+    TEST_ASSERT_EQUAL_INT(SHADE_LEVELS - 1, row[39]);
+
+    for (i = 1; i < 40; i++) {
+        TEST_ASSERT("Never darker", level_of(row[i]) >= level_of(row[i - 1]));
+    }
+}
+
+/* Test triangles against light interpolated per pixel in floating point */
+void test_shade_reference(void) {
+    screen_vertex_t v[3];
+    float x[3], y[3], l[3], area, w0, w1, w2, px, py, expected;
+    long shaded, flat, checked = 0;
+    int t, i, px_x, px_y, error, worst = 0, differ = 0;
+
+    fixture_hue_palette(palette, SHADE_LEVELS);
+    shade_build_ramp(&ramp, palette, SHADE_LEVELS - 1);
+    memset(v, 0, sizeof(v));
+    seed = 11;
+
+    for (t = 0; t < RANDOM_TRI; t++) {
+        for (i = 0; i < 3; i++) {
+            v[i].x = fixed_from_int(next_random(SCREEN_WIDTH)) + next_random(256);
+            v[i].y = fixed_from_int(next_random(SCREEN_HEIGHT)) + next_random(256);
+            v[i].light = next_random(FIXED_ONE + 1);
+            x[i] = fixed_to_float(v[i].x);
+            y[i] = fixed_to_float(v[i].y);
+            l[i] = fixed_to_float(v[i].light);
+        }
+
+        area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+
+        /* Slivers have no stable barycentrics to compare against */
+        if (area < 200.0f && area > -200.0f) {
+            continue;
+        }
+
+        memset(screen, BACKGROUND, SCREEN_SIZE);
+        memset(reference, 0, SCREEN_SIZE);
+
+        shaded = shade_gouraud_triangle(screen, &ramp, &v[0], &v[1], &v[2]);
+        flat = raster_flat_triangle(reference, &v[0], &v[1], &v[2], 1);
+        TEST_ASSERT_EQUAL_INT((int) flat, (int) shaded);
+
+        for (i = 0; i < SCREEN_SIZE; i++) {
+            differ += (screen[i] != BACKGROUND) != (reference[i] != 0);
+
+            if (reference[i] == 0) {
+                continue;
+            }
+
+            px_x = i % SCREEN_WIDTH;
+            px_y = i / SCREEN_WIDTH;
+            px = px_x + 0.5f;
+            py = px_y + 0.5f;
+            w0 = ((x[1] - px) * (y[2] - py) - (x[2] - px) * (y[1] - py)) / area;
+            w1 = ((x[2] - px) * (y[0] - py) - (x[0] - px) * (y[2] - py)) / area;
+            w2 = 1.0f - w0 - w1;
+            expected = (w0 * l[0] + w1 * l[1] + w2 * l[2]) * (SHADE_LEVELS - 1) + 0.5f;
+
+            if (expected < 0.0f) {
+                expected = 0.0f;
+            }
+
+            error = level_of(screen[i]) - (int) expected;
+            error = error < 0 ? -error : error;
+
+            if (error > worst) {
+                worst = error;
+            }
+
+            checked++;
+        }
+    }
+
+    TEST_ASSERT("Pixels checked", checked > 10000);
+    TEST_ASSERT_EQUAL_INT(0, differ);
+    TEST_ASSERT("Within one level", worst <= 1);
+}
+
+/* Measure Gouraud fill rate against the flat rasterizer, reported rather than asserted */
+void test_shade_benchmark(void) {
+    screen_vertex_t v[4];
+    clock_t start, ticks;
+    long flat = 0, shaded = 0;
+    int run;
+
+    fixture_hue_palette(palette, SHADE_LEVELS);
+    shade_build_ramp(&ramp, palette, SHADE_LEVELS - 1);
+    memset(v, 0, sizeof(v));
+
+    v[0].x = fixed_from_int(10);
+    v[0].y = fixed_from_int(10);
+    v[0].light = FIXED_ONE;
+    v[1].x = fixed_from_int(310);
+    v[1].y = fixed_from_int(10);
+    v[1].light = FIXED_ONE / 4;
+    v[2].x = fixed_from_int(310);
+    v[2].y = fixed_from_int(190);
+    v[2].light = FIXED_ZERO;
+    v[3].x = fixed_from_int(10);
+    v[3].y = fixed_from_int(190);
+    v[3].light = FIXED_HALF;
+
+    start = clock();
+
+    for (run = 0; run < BENCH_RUNS; run++) {
+        flat += raster_flat_polygon(screen, v, 4, 1);
+    }
+
+    ticks = clock() - start;
+
+    if (ticks > 0) {
+        printf("\n  Flat: %ld pixels in %ld ticks, %ld per second\n", flat, (long) ticks,
+               (long) ((double) flat * CLOCKS_PER_SEC / ticks));
+    }
+
+    start = clock();
+
+    for (run = 0; run < BENCH_RUNS; run++) {
+        shaded += shade_gouraud_polygon(screen, &ramp, v, 4);
+    }
+
+    ticks = clock() - start;
+
+    TEST_ASSERT_EQUAL_INT((int) flat, (int) shaded);
+
+    if (ticks > 0) {
+        printf("  Gouraud: %ld pixels in %ld ticks, %ld per second\n", shaded, (long) ticks,
+               (long) ((double) shaded * CLOCKS_PER_SEC / ticks));
+    }
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run shading tests */
+    test_begin_suite(&results, "Gouraud Shading");
+    test_run(&results, test_shade_nearest, "Nearest Color");
+    test_run(&results, test_shade_ramp, "Shade Ramps");
+    test_run(&results, test_shade_span, "Span Stepping");
+    test_run(&results, test_shade_reference, "Per-Pixel Reference");
+    test_run(&results, test_shade_benchmark, "Fill Rate");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * tstattri.c
+ *
+ * Test suite for baked static triangle data
+ */
+
+#include <stdio.h>
+
+#include "..\include\matrix.h"
+#include "..\include\stattri.h"
+#include "..\include\triangle.h"
+#include "..\include\vertex.h"
+#include "tmath.h"
+
+/* Wall triangle in the z = 4 plane facing -z, towards the origin */
+static triangle_t make_wall(void) {
+    return triangle_init(vertex_init(fixed_from_int(0), fixed_from_int(0), fixed_from_int(4)),
+                         vertex_init(fixed_from_int(0), fixed_from_int(3), fixed_from_int(4)),
+                         vertex_init(fixed_from_int(3), fixed_from_int(0), fixed_from_int(4)));
+}
+
+/* Test the baked record matches the per-frame calculations */
+void test_stattri_bake(void) {
+    triangle_t t = make_wall();
+    static_triangle_t s;
+
+    stattri_bake(&t, &s);
+
+    TEST_ASSERT_EQUAL_INT(t.normal.x, s.plane.normal.x);
+    TEST_ASSERT_EQUAL_INT(t.normal.y, s.plane.normal.y);
+    TEST_ASSERT_EQUAL_INT(t.normal.z, s.plane.normal.z);
+    TEST_ASSERT_EQUAL_INT(fixed_from_int(4), s.plane.d);
+
+    TEST_ASSERT_EQUAL_INT(fixed_from_int(3), s.edges[0].y);
+    TEST_ASSERT_EQUAL_INT(fixed_from_int(-3), s.edges[2].x);
+
+    /* Centroid and the furthest corner from it */
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, fixed_to_float(s.center.x), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(4.0f, fixed_to_float(s.center.z), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(2.236f, fixed_to_float(s.radius), 0.01f);
+}
+
+/* Test facing and culling agree with the triangle versions */
+void test_stattri_cull(void) {
+    triangle_t tris[2];
+    static_triangle_t s[2];
+    vector3_t eye;
+    matrix_t m;
+
+    tris[0] = make_wall();
+    tris[1] = triangle_init(tris[0].vertices[0], tris[0].vertices[2], tris[0].vertices[1]);
+    stattri_bake_array(tris, s, 2);
+
+    eye = vector3_init_int(1, 1, 0);
+    TEST_ASSERT_EQUAL_INT(triangle_is_facing_point(&tris[0], &eye),
+                          stattri_is_facing_point(&s[0], &eye));
+    TEST_ASSERT_EQUAL_INT(triangle_is_facing_point(&tris[1], &eye),
+                          stattri_is_facing_point(&s[1], &eye));
+
+    m = matrix_identity();
+    TEST_ASSERT_EQUAL_INT(1, stattri_cull_backfaces(s, tris, 2, &m));
+    TEST_ASSERT_EQUAL_INT(FALSE, tris[0].face_culled);
+    TEST_ASSERT_EQUAL_INT(TRUE, tris[1].face_culled);
+}
+
+/* Test containment and segment hits used by collision */
+void test_stattri_collision(void) {
+    triangle_t t = make_wall();
+    static_triangle_t s;
+    vector3_t hit;
+
+    stattri_bake(&t, &s);
+
+    TEST_ASSERT("Inside", stattri_contains_point(&s, vector3_init_int(1, 1, 4)));
+    TEST_ASSERT("On edge", stattri_contains_point(&s, vector3_init_int(0, 2, 4)));
+    TEST_ASSERT("Past hypotenuse", !stattri_contains_point(&s, vector3_init_int(2, 2, 4)));
+
+    /* Walking through the wall */
+    TEST_ASSERT("Hits", stattri_intersect_segment(&s, vector3_init_int(1, 1, 2),
+                                                  vector3_init_int(1, 1, 6), &hit));
+    TEST_ASSERT_EQUAL_INT(fixed_from_int(4), hit.z);
+
+    /* Stopping short, and passing beside it */
+    TEST_ASSERT("Short", !stattri_intersect_segment(&s, vector3_init_int(1, 1, 2),
+                                                    vector3_init_int(1, 1, 3), NULL));
+    TEST_ASSERT("Beside", !stattri_intersect_segment(&s, vector3_init_int(5, 5, 2),
+                                                     vector3_init_int(5, 5, 6), NULL));
+
+    TEST_ASSERT("Near sphere", stattri_sphere_overlaps(&s, vector3_init_int(1, 1, 6), FIXED_ONE));
+    TEST_ASSERT("Far sphere", !stattri_sphere_overlaps(&s, vector3_init_int(1, 1, 9), FIXED_ONE));
+    TEST_ASSERT("Very far sphere",
+                !stattri_sphere_overlaps(&s, vector3_init_int(1000, 0, 0), FIXED_ONE));
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run static triangle tests */
+    test_begin_suite(&results, "Static Triangle Data");
+    test_run(&results, test_stattri_bake, "Baking");
+    test_run(&results, test_stattri_cull, "Facing and Culling");
+    test_run(&results, test_stattri_collision, "Containment and Segments");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
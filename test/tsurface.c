@@ -0,0 +1,275 @@
+/*
+ * tsurface.c
+ *
+ * Test suite for the pre-lit wall block cache
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "..\include\colormap.h"
+#include "..\include\lightmap.h"
+#include "..\include\surface.h"
+#include "..\include\wall.h"
+#include "fixroom.h"
+#include "fixture.h"
+#include "tmath.h"
+
+#define TEX_SIZE   16
+#define SLOT_BYTES (TEX_SIZE * TEX_SIZE * 2)
+#define SLOTS      32
+#define MAX_LUXELS 256
+#define BENCH_RUNS 40
+
+static color_t palette[256];
+static colormap_t cm;
+static unsigned char texels[TEX_SIZE * TEX_SIZE];
+static unsigned char flat_texels[TEX_SIZE * TEX_SIZE];
+static unsigned char pool[SLOTS * SLOT_BYTES];
+static unsigned char luxels[4][MAX_LUXELS];
+static unsigned char screen[SCREEN_SIZE];
+static unsigned char reference[SCREEN_SIZE];
+static texture_t tex, flat_tex;
+static lightmap_t lightmaps[4];
+static surface_cache_t cache;
+static wall_view_t view;
+static wall_t walls[4];
+
+/* Colormap, a texture of bright texels from every hue and a flat white one */
+static void setup(void) {
+    int i;
+
+    fixture_hue_palette(palette, COLORMAP_LEVELS);
+    colormap_build(&cm, palette, NULL);
+    fixture_hue_texels(texels, TEX_SIZE * TEX_SIZE, COLORMAP_LEVELS);
+
+    for (i = 0; i < TEX_SIZE * TEX_SIZE; i++) {
+        flat_texels[i] = (unsigned char) (6 * COLORMAP_LEVELS + COLORMAP_LEVELS - 1);
+    }
+
+    texture_init(&tex, texels, TEX_SIZE, TEX_SIZE);
+    texture_init(&flat_tex, flat_texels, TEX_SIZE, TEX_SIZE);
+    surface_cache_init(&cache, pool, sizeof(pool), SLOT_BYTES, &cm);
+}
+
+/* The inside of a 4 by 4 room around the viewer, every luxel at one light */
+static void make_room(fixed_t ceiling, int light) {
+    int i;
+
+    fixture_room(walls, &tex);
+
+    for (i = 0; i < 4; i++) {
+        walls[i].lightmap = &lightmaps[i];
+        lightmap_init(&lightmaps[i], luxels[i], walls[i].x0, walls[i].z0, walls[i].x1,
+                      walls[i].z1, ceiling);
+        memset(luxels[i], light, MAX_LUXELS);
+    }
+}
+
+/* Draw the room walls from a fixed viewpoint */
+static long draw_room(unsigned char *buffer, fixed_t ceiling, const colormap_t *colormap,
+                      surface_cache_t *surfaces) {
+    fixture_room_view(&view, ceiling);
+    view.colormap = colormap;
+    view.cache = surfaces;
+    memset(buffer, 0, SCREEN_SIZE);
+
+    return wall_draw_list(&view, buffer, walls, 4);
+}
+
+/* Test a uniformly lit wall gives every texel the same colormap row */
+void test_surface_uniform(void) {
+    const texture_t *lit;
+    int i, wrong = 0;
+
+    setup();
+    make_room(FIXED_ONE, 128);
+    lit = surface_cache_get(&cache, &lightmaps[0], &tex, 0, 1);
+
+    TEST_ASSERT("Block built", lit != NULL);
+    TEST_ASSERT_EQUAL_INT(TEX_SIZE, lit->width);
+    TEST_ASSERT_EQUAL_INT(TEX_SIZE, lit->height);
+
+    /* 128 of 255 is level 16 of 31 */
+    for (i = 0; i < TEX_SIZE * TEX_SIZE; i++) {
+        wrong += lit->texture_data[i] != cm.map[16][texels[i]];
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, wrong);
+    TEST_ASSERT_EQUAL_INT(TEX_SIZE * TEX_SIZE, (int) cache.stats.texels);
+}
+
+/* Test light rising along a wall brightens its blocks from one end to the other */
+void test_surface_gradient(void) {
+    const texture_t *lit;
+    int i, j, segment, last = -1, falls = 0, first;
+
+    setup();
+    make_room(FIXED_ONE, 0);
+
+    for (j = 0; j < lightmaps[0].height; j++) {
+        for (i = 0; i < lightmaps[0].width; i++) {
+            luxels[0][j * lightmaps[0].width + i] =
+                (unsigned char) (i * LIGHTMAP_FULL / (lightmaps[0].width - 1));
+        }
+    }
+
+    for (segment = 0; segment < 4; segment++) {
+        lit = surface_cache_get(&cache, &lightmaps[0], &flat_tex, 0, segment);
+
+        for (i = 0; i < TEX_SIZE; i++) {
+            j = palette[lit->texture_data[5 * TEX_SIZE + i]].r;
+            falls += j < last;
+            last = j;
+        }
+    }
+
+    first = surface_cache_get(&cache, &lightmaps[0], &flat_tex, 0, 0)->texture_data[0];
+
+    TEST_ASSERT_EQUAL_INT(0, falls);
+    TEST_ASSERT_EQUAL_INT(0, palette[first].r);
+    TEST_ASSERT("Full light at the far end", last >= palette[7 * COLORMAP_LEVELS - 3].r);
+}
+
+/* Test the least recently used block makes way when the pool is full */
+void test_surface_lru(void) {
+    const texture_t *kept;
+
+    setup();
+    make_room(FIXED_ONE, 200);
+    surface_cache_init(&cache, pool, 3 * SLOT_BYTES, SLOT_BYTES, &cm);
+    TEST_ASSERT_EQUAL_INT(3, cache.slot_count);
+
+    surface_cache_get(&cache, &lightmaps[0], &tex, 0, 0);
+    surface_cache_get(&cache, &lightmaps[0], &tex, 0, 1);
+    surface_cache_get(&cache, &lightmaps[0], &tex, 0, 2);
+    kept = surface_cache_get(&cache, &lightmaps[0], &tex, 0, 0);
+
+    /* Segment 1 is now the oldest, then segment 2 */
+    surface_cache_get(&cache, &lightmaps[0], &tex, 0, 3);
+    surface_cache_get(&cache, &lightmaps[0], &tex, 0, 1);
+    TEST_ASSERT("Still cached", surface_cache_get(&cache, &lightmaps[0], &tex, 0, 0) == kept);
+
+    TEST_ASSERT_EQUAL_INT(5, (int) cache.stats.misses);
+    TEST_ASSERT_EQUAL_INT(2, (int) cache.stats.hits);
+    TEST_ASSERT_EQUAL_INT(2, (int) cache.stats.evictions);
+
+    /* Other walls and offsets are other blocks */
+    surface_cache_get(&cache, &lightmaps[1], &tex, 0, 0);
+    surface_cache_get(&cache, &lightmaps[0], &tex, FIXED_ONE, 0);
+    TEST_ASSERT_EQUAL_INT(7, (int) cache.stats.misses);
+
+    surface_cache_flush(&cache);
+    TEST_ASSERT_EQUAL_INT(0, (int) cache.stats.misses);
+    surface_cache_get(&cache, &lightmaps[0], &tex, 0, 0);
+    TEST_ASSERT_EQUAL_INT(1, (int) cache.stats.misses);
+    TEST_ASSERT_EQUAL_INT(0, (int) cache.stats.evictions);
+
+    /* A large budget is capped at the block count */
+    surface_cache_init(&cache, pool, 1000L * SLOT_BYTES, SLOT_BYTES, &cm);
+    TEST_ASSERT_EQUAL_INT(SURFACE_CACHE_MAX_BLOCKS, cache.slot_count);
+}
+
+/* Test blocks that do not fit a slot, and missing inputs, give no block */
+void test_surface_limits(void) {
+    setup();
+    make_room(3 * FIXED_ONE, 255);
+
+    TEST_ASSERT("Too tall", surface_cache_get(&cache, &lightmaps[0], &tex, 0, 0) == NULL);
+
+    make_room(2 * FIXED_ONE, 255);
+    TEST_ASSERT("Fits", surface_cache_get(&cache, &lightmaps[0], &tex, 0, 0) != NULL);
+    TEST_ASSERT_EQUAL_INT(2 * TEX_SIZE, cache.blocks[cache.newest].texture.height);
+    TEST_ASSERT("No lightmap", surface_cache_get(&cache, NULL, &tex, 0, 0) == NULL);
+    TEST_ASSERT("No texture", surface_cache_get(&cache, &lightmaps[0], NULL, 0, 0) == NULL);
+}
+
+/* Test a room drawn from the cache matches the unlit room through the right row */
+void test_surface_room(void) {
+    fixed_t ceilings[2];
+    long unlit, lit;
+    int pass, i, wrong = 0;
+
+    setup();
+    ceilings[0] = FIXED_ONE;
+    ceilings[1] = 2 * FIXED_ONE;
+
+    for (pass = 0; pass < 2; pass++) {
+        /* Full light is the identity row */
+        make_room(ceilings[pass], LIGHTMAP_FULL);
+        surface_cache_flush(&cache);
+        unlit = draw_room(reference, ceilings[pass], NULL, NULL);
+        lit = draw_room(screen, ceilings[pass], NULL, &cache);
+        TEST_ASSERT_EQUAL_INT((int) unlit, (int) lit);
+        wrong += memcmp(screen, reference, SCREEN_SIZE) != 0;
+
+        /* Half light, and the view colormap is not applied on top */
+        make_room(ceilings[pass], 128);
+        surface_cache_flush(&cache);
+        draw_room(screen, ceilings[pass], &cm, &cache);
+
+        for (i = 0; i < SCREEN_SIZE; i++) {
+            wrong += screen[i] != cm.map[16][reference[i]];
+        }
+
+        TEST_ASSERT("Blocks reused", cache.stats.hits > cache.stats.misses);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, wrong);
+}
+
+/* Measure cached walls against unlit and colormap-lit ones, reported rather than asserted */
+void test_surface_benchmark(void) {
+    clock_t start, ticks[3];
+    long pixels[3];
+    int run, k;
+
+    setup();
+    make_room(FIXED_ONE, 128);
+
+    for (k = 0; k < 3; k++) {
+        pixels[k] = 0;
+        surface_cache_flush(&cache);
+        start = clock();
+
+        for (run = 0; run < BENCH_RUNS; run++) {
+            pixels[k] += draw_room(screen, FIXED_ONE, k == 1 ? &cm : NULL, k == 2 ? &cache : NULL);
+        }
+
+        ticks[k] = clock() - start;
+    }
+
+    TEST_ASSERT_EQUAL_INT((int) pixels[0], (int) pixels[1]);
+    TEST_ASSERT_EQUAL_INT((int) pixels[0], (int) pixels[2]);
+
+    if (ticks[0] > 0 && ticks[1] > 0 && ticks[2] > 0) {
+        printf("\n  Walls unlit %ld, colormap %ld, cached %ld pixels per second\n",
+               (long) ((double) pixels[0] * CLOCKS_PER_SEC / ticks[0]),
+               (long) ((double) pixels[1] * CLOCKS_PER_SEC / ticks[1]),
+               (long) ((double) pixels[2] * CLOCKS_PER_SEC / ticks[2]));
+        surface_cache_stats_print(&cache.stats);
+    }
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run surface cache tests */
+    test_begin_suite(&results, "Surface Cache");
+    test_run(&results, test_surface_uniform, "Uniform Light");
+    test_run(&results, test_surface_gradient, "Light Gradient");
+    test_run(&results, test_surface_lru, "Least Recently Used");
+    test_run(&results, test_surface_limits, "Limits");
+    test_run(&results, test_surface_room, "Room");
+    test_run(&results, test_surface_benchmark, "Fill Rate");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
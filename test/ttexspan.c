@@ -0,0 +1,310 @@
+/*
+ * ttexspan.c
+ *
+ * Test suite for perspective-correct textured spans
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "..\include\raster.h"
+#include "..\include\texspan.h"
+#include "tmath.h"
+
+#define TEX_SIZE   16
+#define ODD_WIDTH  24
+#define ODD_HEIGHT 20
+#define FOCAL      160.0f
+#define BENCH_RUNS 20
+
+static unsigned char texels[TEX_SIZE * TEX_SIZE];
+static unsigned char odd_texels[ODD_WIDTH * ODD_HEIGHT];
+static unsigned char screen[SCREEN_SIZE];
+static unsigned char reference[SCREEN_SIZE];
+static texture_t tex, odd_tex;
+
+/* Destination of reference_emit spans */
+typedef struct {
+    unsigned char *buffer;
+    const texture_t *tex;
+} reference_target_t;
+
+/* Textures where each texel records where it is */
+static void make_textures(void) {
+    int u, v;
+
+    for (v = 0; v < TEX_SIZE; v++) {
+        for (u = 0; u < TEX_SIZE; u++) {
+            texels[v * TEX_SIZE + u] = (unsigned char) ((v << 4) | u);
+        }
+    }
+
+    for (v = 0; v < ODD_HEIGHT; v++) {
+        for (u = 0; u < ODD_WIDTH; u++) {
+            odd_texels[v * ODD_WIDTH + u] = (unsigned char) (v * ODD_WIDTH + u);
+        }
+    }
+
+    texture_init(&tex, texels, TEX_SIZE, TEX_SIZE);
+    texture_init(&odd_tex, odd_texels, ODD_WIDTH, ODD_HEIGHT);
+}
+
+/* Project a camera space point the way project_vertex would */
+static void make_vertex(screen_vertex_t *sv, float x, float y, float z, float u, float v) {
+    memset(sv, 0, sizeof(*sv));
+    sv->x = fixed_from_float(160.0f + FOCAL * x / z);
+    sv->y = fixed_from_float(100.0f - FOCAL * y / z);
+    sv->inv_w = fixed_from_float(1.0f / z);
+    sv->u_over_w = fixed_from_float(u / z);
+    sv->v_over_w = fixed_from_float(v / z);
+}
+
+/* Wrap a texel coordinate into a texture */
+static int wrap(fixed_t c, int size) {
+    int t = (int) ((c >> FIXED_SHIFT) % size);
+
+    return t < 0 ? t + size : t;
+}
+
+/* Golden reference, an exact divide at every pixel */
+static void reference_emit(void *context, const raster_span_t *span) {
+    reference_target_t *target = (reference_target_t *) context;
+    unsigned char *dst = target->buffer + span->y * SCREEN_WIDTH + span->x0;
+    const texture_t *t = target->tex;
+    texspan_t s;
+    fixed_t z, u, v;
+    int i;
+
+    texspan_setup(&s, span);
+
+    for (i = 0; i < span->x1 - span->x0; i++) {
+        z = s.z + s.dz * i;
+        u = texspan_divide(s.u + s.du * i, z);
+        v = texspan_divide(s.v + s.dv * i, z);
+        dst[i] = t->texture_data[wrap(v, t->height) * t->width + wrap(u, t->width)];
+    }
+}
+
+/* Draw the same triangles with the span renderer and the reference */
+static long draw_both(const texture_t *t, const screen_vertex_t *v, int count) {
+    reference_target_t target;
+    long pixels;
+    int i;
+
+    memset(screen, 0, SCREEN_SIZE);
+    memset(reference, 0, SCREEN_SIZE);
+    target.buffer = reference;
+    target.tex = t;
+
+    pixels = texspan_polygon(screen, t, v, count);
+
+    for (i = 1; i + 1 < count; i++) {
+        raster_walk_triangle(&v[0], &v[i], &v[i + 1], RASTER_ATTR_Z | RASTER_ATTR_UV,
+                             reference_emit, &target);
+    }
+
+    return pixels;
+}
+
+/* Wrapped distance between two texel coordinates */
+static int texel_distance(int a, int b, int size) {
+    int d = a > b ? a - b : b - a;
+
+    return d < size - d ? d : size - d;
+}
+
+/* Test power of two detection and masks */
+void test_texture_init(void) {
+    texture_t t;
+
+    TEST_ASSERT_EQUAL_INT(0, texture_log2(1));
+    TEST_ASSERT_EQUAL_INT(6, texture_log2(64));
+    TEST_ASSERT_EQUAL_INT(-1, texture_log2(48));
+    TEST_ASSERT_EQUAL_INT(-1, texture_log2(0));
+
+    TEST_ASSERT("Power of two", texture_init(&t, texels, 64, 32));
+    TEST_ASSERT_EQUAL_INT(6, t.width_shift);
+    TEST_ASSERT_EQUAL_INT(63, t.width_mask);
+    TEST_ASSERT_EQUAL_INT(31, t.height_mask);
+
+    TEST_ASSERT("Not power of two", !texture_init(&t, texels, 64, 48));
+    TEST_ASSERT_EQUAL_INT(-1, t.width_shift);
+}
+
+/* Test a span at constant depth, where affine stepping is exact */
+void test_texspan_constant(void) {
+    texspan_t s;
+    int i, errors = 0;
+
+    make_textures();
+    memset(screen, 0, SCREEN_SIZE);
+
+    /* One texel per pixel from texel (0, 3), run backwards past 0 to wrap */
+    s.z = FIXED_ONE << TEXSPAN_Z_SHIFT;
+    s.dz = 0;
+    s.u = FIXED_HALF;
+    s.du = -FIXED_ONE;
+    s.v = fixed_from_int(3) + FIXED_HALF;
+    s.dv = 0;
+    s.colormap = NULL;
+    s.light = FIXED_ONE;
+    texspan_draw(screen, 40, &tex, &s);
+
+    for (i = 0; i < 40; i++) {
+        errors += screen[i] != ((3 << 4) | ((TEX_SIZE - i % TEX_SIZE) % TEX_SIZE));
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, errors);
+    TEST_ASSERT_EQUAL_INT(0, screen[40]);
+}
+
+/* Test a receding floor against the per-pixel divide */
+void test_texspan_golden(void) {
+    screen_vertex_t v[4];
+    long pixels, mismatches = 0;
+    int i, error, max_error = 0;
+
+    make_textures();
+    make_vertex(&v[0], -4.0f, -1.0f, 2.0f, 0.0f, 32.0f);
+    make_vertex(&v[1], 4.0f, -1.0f, 2.0f, 128.0f, 32.0f);
+    make_vertex(&v[2], 4.0f, -1.0f, 40.0f, 128.0f, 640.0f);
+    make_vertex(&v[3], -4.0f, -1.0f, 40.0f, 0.0f, 640.0f);
+
+    pixels = draw_both(&tex, v, 4);
+    TEST_ASSERT("Drew the floor", pixels > 10000);
+
+    for (i = 0; i < SCREEN_SIZE; i++) {
+        if (screen[i] != reference[i]) {
+            mismatches++;
+            error = texel_distance(screen[i] & 15, reference[i] & 15, TEX_SIZE) +
+                    texel_distance(screen[i] >> 4, reference[i] >> 4, TEX_SIZE);
+
+            if (error > max_error) {
+                max_error = error;
+            }
+        }
+    }
+
+    /* Off by at most one texel, and only where a texel boundary is close */
+    TEST_ASSERT("Within a texel", max_error <= 1);
+    TEST_ASSERT("Few mismatches", mismatches * 20 < pixels);
+
+    printf("\n  %ld of %ld pixels differ from the per-pixel divide\n", mismatches, pixels);
+}
+
+/* Test textures that are not a power of two */
+void test_texspan_any_size(void) {
+    screen_vertex_t v[4];
+    long pixels, mismatches = 0;
+    int i, shift;
+
+    make_textures();
+
+    /* A wall at an angle, wrapping several times in both directions */
+    make_vertex(&v[0], -3.0f, 2.0f, 3.0f, -30.0f, -25.0f);
+    make_vertex(&v[1], 3.0f, 2.0f, 6.0f, 30.0f, -25.0f);
+    make_vertex(&v[2], 3.0f, -2.0f, 6.0f, 30.0f, 55.0f);
+    make_vertex(&v[3], -3.0f, -2.0f, 3.0f, -30.0f, 55.0f);
+
+    pixels = draw_both(&odd_tex, v, 4);
+    TEST_ASSERT("Drew the wall", pixels > 5000);
+
+    for (i = 0; i < SCREEN_SIZE; i++) {
+        mismatches += screen[i] != reference[i];
+    }
+
+    TEST_ASSERT("Few mismatches", mismatches * 20 < pixels);
+
+    /* The general path gives the same image as the masked one */
+    texspan_polygon(screen, &tex, v, 4);
+    memcpy(reference, screen, SCREEN_SIZE);
+    shift = tex.width_shift;
+    tex.width_shift = -1;
+    texspan_polygon(screen, &tex, v, 4);
+    tex.width_shift = shift;
+
+    TEST_ASSERT("Same image", memcmp(screen, reference, SCREEN_SIZE) == 0);
+}
+
+/* Test coverage matches the flat rasterizer */
+void test_texspan_coverage(void) {
+    screen_vertex_t v[3];
+    long textured, flat;
+    int i, differ = 0;
+
+    make_textures();
+    make_vertex(&v[0], -1.5f, 1.0f, 4.0f, 0.0f, 0.0f);
+    make_vertex(&v[1], 2.0f, 0.5f, 6.0f, 64.0f, 0.0f);
+    make_vertex(&v[2], 0.0f, -1.2f, 3.0f, 32.0f, 64.0f);
+
+    /* Texel 0 is also 0, so compare against a texture with no zero texels */
+    for (i = 0; i < TEX_SIZE * TEX_SIZE; i++) {
+        odd_texels[i] = (unsigned char) (i | 1);
+    }
+
+    texture_init(&odd_tex, odd_texels, TEX_SIZE, TEX_SIZE);
+    memset(screen, 0, SCREEN_SIZE);
+    memset(reference, 0, SCREEN_SIZE);
+
+    textured = texspan_triangle(screen, &odd_tex, &v[0], &v[1], &v[2]);
+    flat = raster_flat_triangle(reference, &v[0], &v[1], &v[2], 1);
+
+    for (i = 0; i < SCREEN_SIZE; i++) {
+        differ += (screen[i] != 0) != (reference[i] != 0);
+    }
+
+    TEST_ASSERT_EQUAL_INT((int) flat, (int) textured);
+    TEST_ASSERT_EQUAL_INT(0, differ);
+}
+
+/* Measure texture fill rate, reported rather than asserted */
+void test_texspan_benchmark(void) {
+    screen_vertex_t v[4];
+    clock_t start, ticks;
+    long texels_drawn = 0;
+    int run;
+
+    make_textures();
+    make_vertex(&v[0], -4.0f, -1.0f, 2.0f, 0.0f, 32.0f);
+    make_vertex(&v[1], 4.0f, -1.0f, 2.0f, 128.0f, 32.0f);
+    make_vertex(&v[2], 4.0f, -1.0f, 40.0f, 128.0f, 640.0f);
+    make_vertex(&v[3], -4.0f, -1.0f, 40.0f, 0.0f, 640.0f);
+
+    start = clock();
+
+    for (run = 0; run < BENCH_RUNS; run++) {
+        texels_drawn += texspan_polygon(screen, &tex, v, 4);
+    }
+
+    ticks = clock() - start;
+
+    TEST_ASSERT("Texels drawn", texels_drawn > 0);
+
+    if (ticks > 0) {
+        printf("\n  %ld texels in %ld ticks, %ld per second\n", texels_drawn, (long) ticks,
+               (long) ((double) texels_drawn * CLOCKS_PER_SEC / ticks));
+    }
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run textured span tests */
+    test_begin_suite(&results, "Textured Spans");
+    test_run(&results, test_texture_init, "Texture Setup");
+    test_run(&results, test_texspan_constant, "Constant Depth");
+    test_run(&results, test_texspan_golden, "Per-Pixel Divide Reference");
+    test_run(&results, test_texspan_any_size, "Any Size Textures");
+    test_run(&results, test_texspan_coverage, "Coverage");
+    test_run(&results, test_texspan_benchmark, "Fill Rate");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
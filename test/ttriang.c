@@ -151,6 +151,111 @@ void test_triangle_transform_normal(void) {
     TEST_ASSERT_EQUAL_FLOAT(0.0f, fixed_to_float(result.normal.z), 0.001f);
 }
 
+/* Test rigid normal mode against full recalculation */
+void test_triangle_transform_rigid(void) {
+    vertex_t v1 = vertex_init(fixed_from_int(0), fixed_from_int(0), fixed_from_int(0));
+    vertex_t v2 = vertex_init(fixed_from_int(1), fixed_from_int(0), fixed_from_int(0));
+    vertex_t v3 = vertex_init(fixed_from_int(0), fixed_from_int(1), fixed_from_int(0));
+    triangle_t t = triangle_init(v1, v2, v3);
+    triangle_t rigid, recalc;
+    matrix_t rot, trans, m;
+
+    trig_init();
+
+    /* Rotate 45 degrees around X then move away from the origin */
+    rot = matrix_rotation_x(32);
+    trans = matrix_translation(fixed_from_int(3), fixed_from_int(4), fixed_from_int(5));
+    m = matrix_mul(&trans, &rot);
+
+    TEST_ASSERT_EQUAL_INT(TRIANGLE_NORMAL_RIGID, triangle_select_normal_mode(&m));
+
+    rigid = triangle_transform_mode(&t, &m, TRIANGLE_NORMAL_RIGID);
+    recalc = triangle_transform_mode(&t, &m, TRIANGLE_NORMAL_RECALC);
+
+    /* Positions are identical, normals agree within table precision */
+    TEST_ASSERT_EQUAL_INT(recalc.vertices[2].position.y, rigid.vertices[2].position.y);
+    TEST_ASSERT_EQUAL_FLOAT(
+        fixed_to_float(recalc.normal.x), fixed_to_float(rigid.normal.x), 0.002f);
+    TEST_ASSERT_EQUAL_FLOAT(
+        fixed_to_float(recalc.normal.y), fixed_to_float(rigid.normal.y), 0.002f);
+    TEST_ASSERT_EQUAL_FLOAT(
+        fixed_to_float(recalc.normal.z), fixed_to_float(rigid.normal.z), 0.002f);
+
+    /* A mirror reverses the winding, so only recalculation matches the faces */
+    m = matrix_scaling(fixed_from_int(-1), FIXED_ONE, FIXED_ONE);
+    TEST_ASSERT_EQUAL_INT(TRIANGLE_NORMAL_RECALC, triangle_select_normal_mode(&m));
+    recalc = triangle_transform_mode(&t, &m, TRIANGLE_NORMAL_RECALC);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, fixed_to_float(recalc.normal.z), 0.002f);
+}
+
+/* Test rotate mode renormalizes under uniform scale */
+void test_triangle_transform_rotate(void) {
+    vertex_t v1 = vertex_init(fixed_from_int(0), fixed_from_int(0), fixed_from_int(0));
+    vertex_t v2 = vertex_init(fixed_from_int(1), fixed_from_int(0), fixed_from_int(0));
+    vertex_t v3 = vertex_init(fixed_from_int(0), fixed_from_int(1), fixed_from_int(0));
+    triangle_t t = triangle_init(v1, v2, v3);
+    triangle_t result;
+    matrix_t scale;
+
+    scale = matrix_scaling(fixed_from_int(4), fixed_from_int(4), fixed_from_int(4));
+
+    /* Scaled matrices must fall back to recalculation */
+    TEST_ASSERT_EQUAL_INT(TRIANGLE_NORMAL_RECALC, triangle_select_normal_mode(&scale));
+
+    result = triangle_transform_mode(&t, &scale, TRIANGLE_NORMAL_ROTATE);
+
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fixed_to_float(result.normal.x), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, fixed_to_float(result.normal.y), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, fixed_to_float(result.normal.z), 0.001f);
+}
+
+/* Test object space backface culling before transformation */
+void test_triangle_cull_backfaces(void) {
+    triangle_t mesh[2];
+    triangle_t out[2];
+    vector3_t eye;
+    matrix_t rot, trans, m;
+    int visible, i;
+
+    /* Two faces of a unit box, one facing -Z and one facing +Z */
+    mesh[0] = triangle_init(vertex_init(fixed_from_int(0), fixed_from_int(0), fixed_from_int(0)),
+                            vertex_init(fixed_from_int(0), fixed_from_int(1), fixed_from_int(0)),
+                            vertex_init(fixed_from_int(1), fixed_from_int(0), fixed_from_int(0)));
+    mesh[1] = triangle_init(vertex_init(fixed_from_int(0), fixed_from_int(0), fixed_from_int(1)),
+                            vertex_init(fixed_from_int(1), fixed_from_int(0), fixed_from_int(1)),
+                            vertex_init(fixed_from_int(0), fixed_from_int(1), fixed_from_int(1)));
+
+    trig_init();
+
+    /* Box placed in front of the camera and turned slightly */
+    rot = matrix_rotation_y(10);
+    trans = matrix_translation(FIXED_ZERO, FIXED_ZERO, fixed_from_int(10));
+    m = matrix_mul(&trans, &rot);
+
+    /* Eye sits 10 units behind the box in object space */
+    eye = triangle_object_eye(&m);
+    TEST_ASSERT("Eye is behind the box", eye.z < fixed_from_int(-9));
+
+    visible = triangle_cull_backfaces(mesh, 2, &m);
+
+    TEST_ASSERT_EQUAL_INT(1, visible);
+    TEST_ASSERT_EQUAL_INT(FALSE, mesh[0].face_culled);
+    TEST_ASSERT_EQUAL_INT(TRUE, mesh[1].face_culled);
+
+    /* Only the front face reaches the transform, and it agrees with view space */
+    visible = triangle_transform_visible(mesh, out, 2, &m, TRIANGLE_NORMAL_RIGID);
+
+    TEST_ASSERT_EQUAL_INT(1, visible);
+
+    for (i = 0; i < visible; i++) {
+        TEST_ASSERT_EQUAL_INT(TRUE, triangle_is_facing_camera(&out[i]));
+    }
+
+    /* Null handling */
+    TEST_ASSERT_EQUAL_INT(0, triangle_cull_backfaces(NULL, 2, &m));
+    TEST_ASSERT_EQUAL_INT(FALSE, triangle_is_facing_point(&mesh[0], NULL));
+}
+
 /* Test color setting */
 void test_triangle_set_color(void) {
     /* Create a triangle on the XY plane */
@@ -262,12 +367,15 @@ int main(void) {
     test_begin_suite(&results, "Triangle Normal Calculation");
     test_run(&results, test_triangle_calculate_normal, "Normal Calculation");
     test_run(&results, test_triangle_is_facing_camera, "Camera Facing Check");
+    test_run(&results, test_triangle_cull_backfaces, "Object Space Backface Culling");
     test_end_suite(&results);
 
     /* Run transformation tests */
     test_begin_suite(&results, "Triangle Transformation");
     test_run(&results, test_triangle_transform, "Position Transformation");
     test_run(&results, test_triangle_transform_normal, "Normal Transformation");
+    test_run(&results, test_triangle_transform_rigid, "Rigid Normal Mode");
+    test_run(&results, test_triangle_transform_rotate, "Rotate Normal Mode");
     test_end_suite(&results);
 
     /* Run property tests */
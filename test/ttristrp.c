@@ -0,0 +1,131 @@
+/*
+ * ttristrp.c
+ *
+ * Test suite for triangle strip and fan primitives
+ */
+
+#include <stdio.h>
+
+#include "..\include\matrix.h"
+#include "..\include\triangle.h"
+#include "..\include\tristrip.h"
+#include "..\include\vertex.h"
+#include "tmath.h"
+
+#define WALL_VERTS 6
+
+/* Build a wall of two quads as a strip, zig-zagging bottom and top */
+static void make_wall(vertex_t *v) {
+    v[0] = vertex_init(fixed_from_int(0), fixed_from_int(0), fixed_from_int(5));
+    v[1] = vertex_init(fixed_from_int(0), fixed_from_int(1), fixed_from_int(5));
+    v[2] = vertex_init(fixed_from_int(1), fixed_from_int(0), fixed_from_int(5));
+    v[3] = vertex_init(fixed_from_int(1), fixed_from_int(1), fixed_from_int(5));
+    v[4] = vertex_init(fixed_from_int(2), fixed_from_int(0), fixed_from_int(5));
+    v[5] = vertex_init(fixed_from_int(2), fixed_from_int(1), fixed_from_int(5));
+}
+
+/* Test strip triangle indexing keeps a consistent winding */
+void test_tristrip_indices(void) {
+    vertex_t v[WALL_VERTS];
+    vector3_t normals[WALL_VERTS - 2];
+    tristrip_t s;
+    triangle_t t;
+    int i, i0, i1, i2;
+
+    make_wall(v);
+    tristrip_init(&s, TRISTRIP_STRIP, v, WALL_VERTS, normals, NULL);
+
+    TEST_ASSERT_EQUAL_INT(4, tristrip_triangle_count(&s));
+
+    tristrip_get_indices(&s, 1, &i0, &i1, &i2);
+    TEST_ASSERT_EQUAL_INT(2, i0);
+    TEST_ASSERT_EQUAL_INT(1, i1);
+    TEST_ASSERT_EQUAL_INT(3, i2);
+
+    /* Every shared-edge normal matches an independent triangle's normal */
+    for (i = 0; i < tristrip_triangle_count(&s); i++) {
+        tristrip_get_indices(&s, i, &i0, &i1, &i2);
+        t = triangle_init(v[i0], v[i1], v[i2]);
+
+        TEST_ASSERT_EQUAL_INT(t.normal.x, normals[i].x);
+        TEST_ASSERT_EQUAL_INT(t.normal.y, normals[i].y);
+        TEST_ASSERT_EQUAL_INT(t.normal.z, normals[i].z);
+        TEST_ASSERT_EQUAL_INT(-FIXED_ONE, normals[i].z);
+    }
+}
+
+/* Test fan normals and triangle expansion */
+void test_tristrip_fan(void) {
+    vertex_t v[5];
+    vector3_t normals[3];
+    tristrip_t s;
+    triangle_t t;
+    int i;
+
+    /* Fan around the origin in the XZ plane */
+    v[0] = vertex_init(fixed_from_int(0), fixed_from_int(0), fixed_from_int(0));
+    v[1] = vertex_init(fixed_from_int(1), fixed_from_int(0), fixed_from_int(0));
+    v[2] = vertex_init(fixed_from_int(1), fixed_from_int(0), fixed_from_int(1));
+    v[3] = vertex_init(fixed_from_int(0), fixed_from_int(0), fixed_from_int(1));
+    v[4] = vertex_init(fixed_from_int(-1), fixed_from_int(0), fixed_from_int(1));
+
+    tristrip_init(&s, TRISTRIP_FAN, v, 5, normals, NULL);
+
+    for (i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL_INT(-FIXED_ONE, normals[i].y);
+    }
+
+    t = tristrip_get_triangle(&s, 2);
+    TEST_ASSERT_EQUAL_INT(0, fixed_to_int(t.vertices[0].position.x));
+    TEST_ASSERT_EQUAL_INT(-1, fixed_to_int(t.vertices[2].position.x));
+    TEST_ASSERT_EQUAL_INT(-FIXED_ONE, t.normal.y);
+
+    /* Out of range triangles come back culled */
+    t = tristrip_get_triangle(&s, 3);
+    TEST_ASSERT_EQUAL_INT(TRUE, t.face_culled);
+}
+
+/* Test culling and transform reuse shared vertices */
+void test_tristrip_cull_transform(void) {
+    vertex_t v[WALL_VERTS], out[WALL_VERTS];
+    vector3_t normals[WALL_VERTS - 2], out_normals[WALL_VERTS - 2];
+    unsigned char culled[WALL_VERTS - 2];
+    tristrip_t s;
+    matrix_t m, back;
+
+    make_wall(v);
+    tristrip_init(&s, TRISTRIP_STRIP, v, WALL_VERTS, normals, culled);
+
+    /* Camera at the origin sees the wall face on */
+    m = matrix_identity();
+    TEST_ASSERT_EQUAL_INT(4, tristrip_cull(&s, &m));
+
+    /* Six vertex transforms for four triangles instead of twelve */
+    TEST_ASSERT_EQUAL_INT(WALL_VERTS, tristrip_transform(&s, out, out_normals, &m));
+    TEST_ASSERT_EQUAL_INT(2, fixed_to_int(out[5].position.x));
+    TEST_ASSERT_EQUAL_INT(-FIXED_ONE, out_normals[0].z);
+
+    /* Moved behind the camera the wall shows its back, nothing is transformed */
+    back = matrix_translation(FIXED_ZERO, FIXED_ZERO, fixed_from_int(-10));
+    TEST_ASSERT_EQUAL_INT(0, tristrip_cull(&s, &back));
+    TEST_ASSERT_EQUAL_INT(0, tristrip_transform(&s, out, NULL, &back));
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run primitive tests */
+    test_begin_suite(&results, "Strip and Fan Primitives");
+    test_run(&results, test_tristrip_indices, "Strip Winding and Normals");
+    test_run(&results, test_tristrip_fan, "Fan Normals and Expansion");
+    test_run(&results, test_tristrip_cull_transform, "Shared Vertex Cull and Transform");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
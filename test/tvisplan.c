@@ -0,0 +1,279 @@
+/*
+ * tvisplan.c
+ *
+ * Test suite for the floor and ceiling span renderer
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "..\include\trig.h"
+#include "..\include\visplane.h"
+#include "..\include\wall.h"
+#include "tmath.h"
+
+#define TEX_SIZE   16
+#define ODD_SIZE   12
+#define BENCH_RUNS 40
+#define HORIZON    (SCREEN_HEIGHT / 2)
+
+static unsigned char texels[TEX_SIZE * TEX_SIZE];
+static unsigned char odd_texels[ODD_SIZE * ODD_SIZE];
+static unsigned char screen[SCREEN_SIZE];
+static unsigned char reference[SCREEN_SIZE];
+static texture_t tex, odd_tex;
+static wall_view_t view;
+static visplane_t floor_plane, ceiling_plane;
+static unsigned long seed;
+
+/* Small deterministic generator so runs are repeatable */
+static int next_random(int range) {
+    seed = seed * 1103515245UL + 12345UL;
+    return (int) ((seed >> 16) & 0x7FFF) % range;
+}
+
+/* Textures where each texel records where it is, and a view */
+static void setup(unsigned char angle) {
+    int u, v;
+
+    trig_init();
+
+    for (v = 0; v < TEX_SIZE; v++) {
+        for (u = 0; u < TEX_SIZE; u++) {
+            texels[v * TEX_SIZE + u] = (unsigned char) ((v << 4) | u);
+        }
+    }
+
+    for (v = 0; v < ODD_SIZE; v++) {
+        for (u = 0; u < ODD_SIZE; u++) {
+            odd_texels[v * ODD_SIZE + u] = (unsigned char) ((v << 4) | u);
+        }
+    }
+
+    texture_init(&tex, texels, TEX_SIZE, TEX_SIZE);
+    texture_init(&odd_tex, odd_texels, ODD_SIZE, ODD_SIZE);
+    wall_view_init(&view, fixed_from_float(0.3f), fixed_from_float(-0.7f), FIXED_HALF, FIXED_ONE,
+                   angle, 64);
+    memset(screen, 0xFF, SCREEN_SIZE);
+}
+
+/* Wrapped distance between two texel coordinates */
+static int texel_distance(int a, int b, int size) {
+    int d = a > b ? a - b : b - a;
+
+    return d < size - d ? d : size - d;
+}
+
+/* Test random column ranges become exactly the same pixels as row spans */
+void test_visplane_spans(void) {
+    long expected = 0;
+    int c, y, differ = 0;
+
+    setup(0);
+    visplane_init(&floor_plane, 0, &tex);
+    memset(reference, 0xFF, SCREEN_SIZE);
+
+    /* 0xFF marks unwritten pixels, so no texel may have it */
+    texels[TEX_SIZE * TEX_SIZE - 1] = 0xFE;
+    seed = 3;
+
+    for (c = 0; c < SCREEN_WIDTH; c++) {
+        /* Runs of equal columns, steps and gaps */
+        if (c == 0 || next_random(4) == 0) {
+            floor_plane.top[c] = (short) (HORIZON + next_random(HORIZON));
+            floor_plane.bottom[c] = (short) (HORIZON + next_random(HORIZON + 1));
+        } else {
+            floor_plane.top[c] = floor_plane.top[c - 1];
+            floor_plane.bottom[c] = floor_plane.bottom[c - 1];
+        }
+
+        for (y = floor_plane.top[c]; y < floor_plane.bottom[c]; y++) {
+            reference[y * SCREEN_WIDTH + c] = 0;
+            expected++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT((int) expected, (int) visplane_draw(&floor_plane, &view, screen));
+
+    for (c = 0; c < SCREEN_SIZE; c++) {
+        differ += (screen[c] == 0xFF) != (reference[c] == 0xFF);
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, differ);
+}
+
+/* Test the floor against a per-pixel ray cast in floating point */
+void test_visplane_reference(void) {
+    float s, co, k, dist, wx, wz;
+    int x, y, got, errors = 0, checked = 0;
+
+    setup(20);
+    visplane_init(&floor_plane, 0, &tex);
+    visplane_from_walls(&floor_plane, NULL, &view);
+    visplane_draw(&floor_plane, &view, screen);
+
+    s = fixed_to_float(view.sin);
+    co = fixed_to_float(view.cos);
+
+    /* Rows near the horizon squeeze many texels into a pixel, skip them */
+    for (y = SCREEN_HEIGHT / 2 + 10; y < SCREEN_HEIGHT; y++) {
+        dist = 0.5f * fixed_to_float(view.focal) / (y + 0.5f - SCREEN_HEIGHT / 2);
+
+        for (x = 0; x < SCREEN_WIDTH; x++) {
+            k = (x + 0.5f - SCREEN_WIDTH / 2) / fixed_to_float(view.focal);
+            wx = fixed_to_float(view.x) + (s + co * k) * dist;
+            wz = fixed_to_float(view.z) + (co - s * k) * dist;
+            got = screen[y * SCREEN_WIDTH + x];
+
+            if (texel_distance(got & 15, (int) floor(wx * TEX_SIZE) & 15, TEX_SIZE) > 1 ||
+                texel_distance(got >> 4, (int) floor(wz * TEX_SIZE) & 15, TEX_SIZE) > 1) {
+                errors++;
+            }
+
+            checked++;
+        }
+    }
+
+    TEST_ASSERT_EQUAL_INT(SCREEN_WIDTH * (SCREEN_HEIGHT / 2 - 10), checked);
+    TEST_ASSERT_EQUAL_INT(0, errors);
+}
+
+/* Test the ceiling and a texture that is not a power of two */
+void test_visplane_ceiling(void) {
+    long pixels, mismatches = 0;
+    int i;
+
+    setup(100);
+    visplane_init(&ceiling_plane, FIXED_ONE, &tex);
+    visplane_from_walls(NULL, &ceiling_plane, &view);
+    pixels = visplane_draw(&ceiling_plane, &view, screen);
+    TEST_ASSERT_EQUAL_INT(SCREEN_SIZE / 2, (int) pixels);
+    TEST_ASSERT_EQUAL_INT(0xFF, screen[(SCREEN_HEIGHT / 2) * SCREEN_WIDTH]);
+
+    /* The general walk agrees with the packed one away from the horizon */
+    memcpy(reference, screen, SCREEN_SIZE);
+    i = tex.width_shift;
+    tex.width_shift = -1;
+    visplane_draw(&ceiling_plane, &view, screen);
+    tex.width_shift = i;
+
+    for (i = 0; i < (SCREEN_HEIGHT / 2 - 10) * SCREEN_WIDTH; i++) {
+        mismatches += texel_distance(screen[i] & 15, reference[i] & 15, TEX_SIZE) > 1 ||
+                      texel_distance(screen[i] >> 4, reference[i] >> 4, TEX_SIZE) > 1;
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, (int) mismatches);
+
+    /* Any size texture only uses its own texels */
+    memset(screen, 0xFF, SCREEN_SIZE);
+    ceiling_plane.texture = &odd_tex;
+    visplane_draw(&ceiling_plane, &view, screen);
+    mismatches = 0;
+
+    for (i = 0; i < SCREEN_SIZE / 2; i++) {
+        mismatches += (screen[i] & 15) >= ODD_SIZE || (screen[i] >> 4) >= ODD_SIZE;
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, (int) mismatches);
+}
+
+/* Test walls, floor and ceiling together cover every pixel once */
+void test_visplane_room(void) {
+    wall_t walls[4];
+    long pixels;
+    int i, unwritten = 0;
+
+    setup(40);
+
+    /* The inside of a 4 by 4 room around the viewer */
+    walls[0].x0 = -2 * FIXED_ONE;
+    walls[0].z0 = 2 * FIXED_ONE;
+    walls[0].x1 = 2 * FIXED_ONE;
+    walls[0].z1 = 2 * FIXED_ONE;
+    walls[1].x0 = 2 * FIXED_ONE;
+    walls[1].z0 = 2 * FIXED_ONE;
+    walls[1].x1 = 2 * FIXED_ONE;
+    walls[1].z1 = -2 * FIXED_ONE;
+    walls[2].x0 = 2 * FIXED_ONE;
+    walls[2].z0 = -2 * FIXED_ONE;
+    walls[2].x1 = -2 * FIXED_ONE;
+    walls[2].z1 = -2 * FIXED_ONE;
+    walls[3].x0 = -2 * FIXED_ONE;
+    walls[3].z0 = -2 * FIXED_ONE;
+    walls[3].x1 = -2 * FIXED_ONE;
+    walls[3].z1 = 2 * FIXED_ONE;
+
+    for (i = 0; i < 4; i++) {
+        walls[i].texture = &tex;
+        walls[i].u_offset = 0;
+        walls[i].lightmap = NULL;
+        walls[i].mask = NULL;
+    }
+
+    texels[TEX_SIZE * TEX_SIZE - 1] = 0xFE;
+
+    pixels = wall_draw_list(&view, screen, walls, 4);
+    visplane_init(&floor_plane, 0, &tex);
+    visplane_init(&ceiling_plane, FIXED_ONE, &tex);
+    visplane_from_walls(&floor_plane, &ceiling_plane, &view);
+    pixels += visplane_draw(&floor_plane, &view, screen);
+    pixels += visplane_draw(&ceiling_plane, &view, screen);
+
+    for (i = 0; i < SCREEN_SIZE; i++) {
+        unwritten += screen[i] == 0xFF;
+    }
+
+    TEST_ASSERT_EQUAL_INT(SCREEN_SIZE, (int) pixels);
+    TEST_ASSERT_EQUAL_INT(0, unwritten);
+}
+
+/* Measure floor fill rate, reported rather than asserted */
+void test_visplane_benchmark(void) {
+    clock_t start, ticks;
+    long pixels = 0;
+    int run;
+
+    setup(20);
+    visplane_init(&floor_plane, 0, &tex);
+    visplane_init(&ceiling_plane, FIXED_ONE, &tex);
+    visplane_from_walls(&floor_plane, &ceiling_plane, &view);
+
+    start = clock();
+
+    for (run = 0; run < BENCH_RUNS; run++) {
+        pixels += visplane_draw(&floor_plane, &view, screen);
+        pixels += visplane_draw(&ceiling_plane, &view, screen);
+    }
+
+    ticks = clock() - start;
+
+    TEST_ASSERT("Pixels drawn", pixels > 0);
+
+    if (ticks > 0) {
+        printf("\n  %ld floor and ceiling pixels in %ld ticks, %ld per second\n", pixels,
+               (long) ticks, (long) ((double) pixels * CLOCKS_PER_SEC / ticks));
+    }
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run floor and ceiling tests */
+    test_begin_suite(&results, "Floors and Ceilings");
+    test_run(&results, test_visplane_spans, "Column Ranges to Spans");
+    test_run(&results, test_visplane_reference, "Ray Cast Reference");
+    test_run(&results, test_visplane_ceiling, "Ceiling and Texture Sizes");
+    test_run(&results, test_visplane_room, "Room Coverage");
+    test_run(&results, test_visplane_benchmark, "Fill Rate");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * tvpack.c
+ *
+ * Test suite for the packed vertex format
+ */
+
+#include <stdio.h>
+
+#include "..\include\matrix.h"
+#include "..\include\trig.h"
+#include "..\include\vertex.h"
+#include "..\include\vpack.h"
+#include "tmath.h"
+
+/* Test packed record size against the full vertex */
+void test_vpack_size(void) {
+    TEST_ASSERT_EQUAL_INT(12, (int) sizeof(packed_vertex_t));
+    TEST_ASSERT("Packed vertex is a third of vertex_t",
+                sizeof(vertex_t) >= 3 * sizeof(packed_vertex_t));
+}
+
+/* Test the shared normal table */
+void test_vpack_normal_table(void) {
+    const vector3_t *table;
+    int i;
+
+    trig_init();
+    vpack_init();
+    table = vpack_get_normal_table();
+
+    /* Axis entries are exact */
+    TEST_ASSERT_EQUAL_INT(FIXED_ONE, table[VPACK_NORMAL_POS_X].x);
+    TEST_ASSERT_EQUAL_INT(-FIXED_ONE, table[VPACK_NORMAL_NEG_Y].y);
+    TEST_ASSERT_EQUAL_INT(FIXED_ONE, table[VPACK_NORMAL_POS_Z].z);
+
+    /* Every entry is unit length */
+    for (i = 0; i < VPACK_NORMAL_COUNT; i++) {
+        TEST_ASSERT_EQUAL_FLOAT(1.0f, fixed_to_float(vector3_length(table[i])), 0.01f);
+    }
+}
+
+/* Test normal quantization */
+void test_vpack_quantize_normal(void) {
+    vector3_t n;
+    const vector3_t *table;
+
+    trig_init();
+    vpack_init();
+    table = vpack_get_normal_table();
+
+    /* Axis normals map to their exact entries */
+    n = vector3_init(FIXED_ZERO, FIXED_ZERO, -FIXED_ONE);
+    TEST_ASSERT_EQUAL_INT(VPACK_NORMAL_NEG_Z, vpack_quantize_normal(n));
+
+    n = vector3_init(-FIXED_ONE, FIXED_ZERO, FIXED_ZERO);
+    TEST_ASSERT_EQUAL_INT(VPACK_NORMAL_NEG_X, vpack_quantize_normal(n));
+
+    /* A diagonal normal lands within about 15 degrees */
+    n = vector3_normalize(vector3_init_int(1, 1, 1));
+    TEST_ASSERT("Diagonal quantization error",
+                vector3_dot(n, table[vpack_quantize_normal(n)]) > fixed_from_float(0.96f));
+}
+
+/* Test pack and unpack round trip */
+void test_vpack_round_trip(void) {
+    vector3_t origin = vector3_init_int(100, 0, -200);
+    vertex_t v =
+        vertex_init(fixed_from_float(110.25f), fixed_from_float(-3.5f), fixed_from_int(-150));
+    color_t palette[256];
+    packed_vertex_t p;
+    vertex_t out;
+
+    trig_init();
+    vpack_init();
+
+    vertex_set_normal_xyz(&v, FIXED_ZERO, FIXED_ONE, FIXED_ZERO);
+    vertex_set_texcoord_uv(&v, fixed_from_float(2.5f), fixed_from_float(0.75f));
+
+    palette[7].r = 10;
+    palette[7].g = 20;
+    palette[7].b = 30;
+
+    p = vpack_pack(&v, &origin, 7);
+    out = vpack_unpack(&p, &origin, palette);
+
+    TEST_ASSERT_EQUAL_FLOAT(110.25f, fixed_to_float(out.position.x), 0.004f);
+    TEST_ASSERT_EQUAL_FLOAT(-3.5f, fixed_to_float(out.position.y), 0.004f);
+    TEST_ASSERT_EQUAL_FLOAT(-150.0f, fixed_to_float(out.position.z), 0.004f);
+    TEST_ASSERT_EQUAL_INT(FIXED_ONE, out.normal.y);
+    TEST_ASSERT_EQUAL_FLOAT(2.5f, fixed_to_float(out.texcoord.u), 0.004f);
+    TEST_ASSERT_EQUAL_FLOAT(0.75f, fixed_to_float(out.texcoord.v), 0.004f);
+    TEST_ASSERT_EQUAL_INT(20, out.color.g);
+
+    /* Null palette leaves the default white */
+    out = vpack_unpack(&p, &origin, NULL);
+    TEST_ASSERT_EQUAL_INT(255, out.color.r);
+}
+
+/* Test packed transform against unpack then transform */
+void test_vpack_transform(void) {
+    vector3_t origin = vector3_init_int(64, 8, 32);
+    vertex_t v = vertex_init(fixed_from_int(70), fixed_from_int(10), fixed_from_float(20.5f));
+    vector3_t table[VPACK_NORMAL_COUNT];
+    vector3_t out;
+    vertex_t reference;
+    packed_vertex_t p;
+    matrix_t rot, trans, m;
+
+    trig_init();
+    vpack_init();
+
+    rot = matrix_rotation_y(50);
+    trans = matrix_translation(fixed_from_int(-60), FIXED_ZERO, fixed_from_int(15));
+    m = matrix_mul(&trans, &rot);
+
+    p = vpack_pack(&v, &origin, 0);
+    vpack_transform(&p, &out, 1, &origin, &m);
+    reference = vertex_transform(&v, &m);
+
+    TEST_ASSERT_EQUAL_FLOAT(fixed_to_float(reference.position.x), fixed_to_float(out.x), 0.01f);
+    TEST_ASSERT_EQUAL_FLOAT(fixed_to_float(reference.position.y), fixed_to_float(out.y), 0.01f);
+    TEST_ASSERT_EQUAL_FLOAT(fixed_to_float(reference.position.z), fixed_to_float(out.z), 0.01f);
+
+    /* Rotated table entry matches a direct rotation */
+    vpack_rotate_normal_table(&rot, table);
+    out = matrix_rotate_vector3(&rot, &vpack_get_normal_table()[VPACK_NORMAL_POS_X]);
+    TEST_ASSERT_EQUAL_INT(out.z, table[VPACK_NORMAL_POS_X].z);
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run format tests */
+    test_begin_suite(&results, "Packed Vertex Format");
+    test_run(&results, test_vpack_size, "Record Size");
+    test_run(&results, test_vpack_normal_table, "Normal Table");
+    test_run(&results, test_vpack_quantize_normal, "Normal Quantization");
+    test_end_suite(&results);
+
+    /* Run conversion tests */
+    test_begin_suite(&results, "Packed Vertex Conversion");
+    test_run(&results, test_vpack_round_trip, "Pack and Unpack");
+    test_run(&results, test_vpack_transform, "Packed Transform");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * tvstream.c
+ *
+ * Test suite for structure-of-arrays vertex streams
+ */
+
+#include <stdio.h>
+
+#include "..\include\matrix.h"
+#include "..\include\triangle.h"
+#include "..\include\trig.h"
+#include "..\include\vertex.h"
+#include "..\include\vstream.h"
+#include "tmath.h"
+
+#define TEST_VERTS 4
+
+/* Build a small quad of vertices with distinct attributes */
+static void make_quad(vertex_t *v) {
+    v[0] = vertex_init(fixed_from_int(0), fixed_from_int(0), fixed_from_int(0));
+    v[1] = vertex_init(fixed_from_int(1), fixed_from_int(0), fixed_from_int(0));
+    v[2] = vertex_init(fixed_from_int(1), fixed_from_int(1), fixed_from_int(0));
+    v[3] = vertex_init(fixed_from_int(0), fixed_from_int(1), fixed_from_int(0));
+
+    vertex_set_texcoord_uv(&v[2], fixed_from_int(1), fixed_from_int(1));
+    vertex_set_color_rgb(&v[3], 10, 20, 30);
+}
+
+/* Test stream setup and render mode selection */
+void test_vstream_init(void) {
+    vertex_stream_t s;
+    vector3_t positions[TEST_VERTS];
+    texcoord_t texcoords[TEST_VERTS];
+
+    vstream_init(&s, positions, NULL, NULL, texcoords, TEST_VERTS);
+
+    TEST_ASSERT_EQUAL_INT(VSTREAM_POSITION | VSTREAM_TEXCOORD, s.attribs);
+    TEST_ASSERT_EQUAL_INT(0, s.count);
+
+    TEST_ASSERT_EQUAL_INT(VSTREAM_POSITION, vstream_attribs_for_mode(TRIANGLE_FLAT));
+    TEST_ASSERT_EQUAL_INT(VSTREAM_POSITION | VSTREAM_TEXCOORD,
+                          vstream_attribs_for_mode(TRIANGLE_TEXTURED));
+}
+
+/* Test loading and gathering vertices */
+void test_vstream_load(void) {
+    vertex_t v[TEST_VERTS];
+    vertex_stream_t s;
+    vector3_t positions[TEST_VERTS];
+    color_t colors[TEST_VERTS];
+    vertex_t out;
+
+    make_quad(v);
+    vstream_init(&s, positions, NULL, colors, NULL, TEST_VERTS);
+
+    TEST_ASSERT_EQUAL_INT(TEST_VERTS, vstream_load(&s, v, TEST_VERTS, VSTREAM_ALL));
+
+    out = vstream_get(&s, 3);
+    TEST_ASSERT_EQUAL_INT(1, fixed_to_int(out.position.y));
+    TEST_ASSERT_EQUAL_INT(20, out.color.g);
+
+    /* Too many vertices are refused */
+    TEST_ASSERT_EQUAL_INT(0, vstream_load(&s, v, TEST_VERTS + 1, VSTREAM_ALL));
+}
+
+/* Test transform touches only the requested streams */
+void test_vstream_transform(void) {
+    vertex_t v[TEST_VERTS];
+    vertex_stream_t src, dst;
+    vector3_t src_pos[TEST_VERTS], dst_pos[TEST_VERTS];
+    vector3_t src_norm[TEST_VERTS], dst_norm[TEST_VERTS];
+    texcoord_t src_uv[TEST_VERTS], dst_uv[TEST_VERTS];
+    matrix_t m;
+    int count;
+
+    trig_init();
+    make_quad(v);
+
+    vstream_init(&src, src_pos, src_norm, NULL, src_uv, TEST_VERTS);
+    vstream_init(&dst, dst_pos, dst_norm, NULL, dst_uv, TEST_VERTS);
+    vstream_load(&src, v, TEST_VERTS, VSTREAM_ALL);
+
+    dst_uv[2].u = fixed_from_int(-7);
+    dst_norm[0] = vector3_init(FIXED_ZERO, FIXED_ZERO, FIXED_ZERO);
+
+    /* Flat mode needs positions only */
+    m = matrix_rotation_x(64);
+    count = vstream_transform(&src, &dst, &m, vstream_attribs_for_mode(TRIANGLE_FLAT));
+    TEST_ASSERT_EQUAL_INT(TEST_VERTS, count);
+
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, fixed_to_float(dst_pos[2].z), 0.001f);
+    TEST_ASSERT_EQUAL_INT(-7, fixed_to_int(dst_uv[2].u));
+    TEST_ASSERT_EQUAL_INT(0, dst_norm[0].z);
+
+    /* Textured and lit passes add their streams */
+    vstream_transform(&src, &dst, &m, VSTREAM_POSITION | VSTREAM_NORMAL | VSTREAM_TEXCOORD);
+
+    TEST_ASSERT_EQUAL_INT(1, fixed_to_int(dst_uv[2].u));
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, fixed_to_float(dst_norm[0].y), 0.001f);
+}
+
+/* Test the per-vertex lighting pass */
+void test_vstream_light(void) {
+    vertex_t v[TEST_VERTS];
+    vertex_stream_t s;
+    vector3_t normals[TEST_VERTS];
+    fixed_t intensity[TEST_VERTS];
+
+    make_quad(v);
+    vertex_set_normal_xyz(&v[1], FIXED_ZERO, FIXED_ZERO, -FIXED_ONE);
+    vertex_set_normal_xyz(&v[2], FIXED_ONE, FIXED_ZERO, FIXED_ZERO);
+
+    vstream_init(&s, NULL, normals, NULL, NULL, TEST_VERTS);
+    vstream_load(&s, v, TEST_VERTS, VSTREAM_ALL);
+
+    vstream_light(&s, vector3_init(FIXED_ZERO, FIXED_ZERO, FIXED_ONE), FIXED_HALF / 2, intensity);
+
+    TEST_ASSERT_EQUAL_INT(FIXED_ONE, intensity[0]);
+    TEST_ASSERT_EQUAL_INT(FIXED_HALF / 2, intensity[1]);
+    TEST_ASSERT_EQUAL_INT(FIXED_HALF / 2, intensity[2]);
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run stream layout tests */
+    test_begin_suite(&results, "Vertex Stream Layout");
+    test_run(&results, test_vstream_init, "Stream Initialization");
+    test_run(&results, test_vstream_load, "Load and Gather");
+    test_end_suite(&results);
+
+    /* Run batch pass tests */
+    test_begin_suite(&results, "Vertex Stream Passes");
+    test_run(&results, test_vstream_transform, "Attribute Selective Transform");
+    test_run(&results, test_vstream_light, "Lighting Pass");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
@@ -0,0 +1,258 @@
+/*
+ * twall.c
+ *
+ * Test suite for the wall column renderer
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "..\include\texspan.h"
+#include "..\include\trig.h"
+#include "..\include\wall.h"
+#include "tmath.h"
+
+#define TEX_SIZE   16
+#define BENCH_RUNS 40
+
+static unsigned char texels[TEX_SIZE * TEX_SIZE];
+static unsigned char screen[SCREEN_SIZE];
+static unsigned char reference[SCREEN_SIZE];
+static texture_t tex;
+static wall_view_t view;
+
+/* Texture where each texel records where it is, and a standard view */
+static void setup(unsigned char angle) {
+    int u, v;
+
+    trig_init();
+
+    for (v = 0; v < TEX_SIZE; v++) {
+        for (u = 0; u < TEX_SIZE; u++) {
+            texels[v * TEX_SIZE + u] = (unsigned char) ((v << 4) | u);
+        }
+    }
+
+    texture_init(&tex, texels, TEX_SIZE, TEX_SIZE);
+    wall_view_init(&view, 0, 0, FIXED_HALF, FIXED_ONE, angle, 64);
+    memset(screen, 0xFF, SCREEN_SIZE);
+}
+
+/* Fill in a wall from floor plan coordinates */
+static void make_wall(wall_t *w, float x0, float z0, float x1, float z1) {
+    w->x0 = fixed_from_float(x0);
+    w->z0 = fixed_from_float(z0);
+    w->x1 = fixed_from_float(x1);
+    w->z1 = fixed_from_float(z1);
+    w->texture = &tex;
+    w->u_offset = 0;
+    w->lightmap = NULL;
+    w->mask = NULL;
+}
+
+/* Test the view setup and transform */
+void test_wall_view(void) {
+    fixed_t vx, vz;
+
+    setup(0);
+    TEST_ASSERT_EQUAL_FLOAT(160.0f, fixed_to_float(view.focal), 0.01f);
+    TEST_ASSERT_EQUAL_INT(SCREEN_HEIGHT / 2, view.top[0]);
+    TEST_ASSERT_EQUAL_INT(0, (int) view.depth[SCREEN_WIDTH - 1]);
+
+    /* Looking along +x, +x is ahead and -z is to the right */
+    wall_view_init(&view, FIXED_ONE, 0, FIXED_HALF, FIXED_ONE, 64, 64);
+    wall_view_transform(&view, 3 * FIXED_ONE, -FIXED_ONE, &vx, &vz);
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, fixed_to_float(vz), 0.001f);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, fixed_to_float(vx), 0.001f);
+}
+
+/* Test a wall square on to the view lands on exact pixels and texels */
+void test_wall_straight(void) {
+    wall_t w;
+
+    setup(0);
+    make_wall(&w, -1.0f, 2.0f, 1.0f, 2.0f);
+
+    /* Columns 80 to 239, rows 60 to 139, five pixels a texel both ways */
+    TEST_ASSERT_EQUAL_INT(160 * 80, (int) wall_draw(&view, screen, &w));
+    TEST_ASSERT_EQUAL_INT(60, view.top[80]);
+    TEST_ASSERT_EQUAL_INT(140, view.bottom[239]);
+    TEST_ASSERT_EQUAL_INT(0, (int) view.depth[79]);
+    TEST_ASSERT_EQUAL_INT(0, (int) view.depth[240]);
+    TEST_ASSERT_EQUAL_INT(FIXED_HALF, (int) view.depth[160]);
+
+    TEST_ASSERT_EQUAL_INT(0x00, screen[60 * SCREEN_WIDTH + 80]);
+    TEST_ASSERT_EQUAL_INT(0x11, screen[65 * SCREEN_WIDTH + 85]);
+    TEST_ASSERT_EQUAL_INT(0xFF, screen[139 * SCREEN_WIDTH + 239]);
+    TEST_ASSERT_EQUAL_INT(0xFF, screen[59 * SCREEN_WIDTH + 80]);
+    TEST_ASSERT_EQUAL_INT(0xFF, screen[100 * SCREEN_WIDTH + 240]);
+
+    /* The back of the wall draws nothing */
+    setup(0);
+    make_wall(&w, 1.0f, 2.0f, -1.0f, 2.0f);
+    TEST_ASSERT_EQUAL_INT(0, (int) wall_draw(&view, screen, &w));
+    TEST_ASSERT_EQUAL_INT(0, (int) view.depth[160]);
+}
+
+/* Test an oblique wall against a per-column ray cast in floating point */
+void test_wall_reference(void) {
+    wall_t w;
+    float s, co, ax, az, bx, bz, k, t, z, u;
+    int c, r0, top_errors = 0, texel_errors = 0, columns = 0, got, d;
+
+    setup(20);
+    make_wall(&w, -4.0f, 5.0f, 20.0f, 5.0f);
+    wall_draw(&view, screen, &w);
+
+    s = fixed_to_float(view.sin);
+    co = fixed_to_float(view.cos);
+    ax = -4.0f * co - 5.0f * s;
+    az = -4.0f * s + 5.0f * co;
+    bx = 20.0f * co - 5.0f * s;
+    bz = 20.0f * s + 5.0f * co;
+
+    for (c = 0; c < SCREEN_WIDTH; c++) {
+        k = (c + 0.5f - 160.0f) / fixed_to_float(view.focal);
+        t = (k * az - ax) / ((bx - ax) - k * (bz - az));
+
+        if (t < 0.0f || t >= 1.0f) {
+            continue;
+        }
+
+        columns++;
+        z = az + t * (bz - az);
+        u = t * 24.0f * TEX_SIZE;
+        r0 = (int) ceil(100.0f - 0.5f * fixed_to_float(view.focal) / z - 0.5f);
+
+        if (view.top[c] < r0 - 1 || view.top[c] > r0 + 1) {
+            top_errors++;
+        }
+
+        got = screen[(SCREEN_HEIGHT / 2) * SCREEN_WIDTH + c] & 15;
+        d = (got - ((int) floor(u) & 15) + TEX_SIZE) % TEX_SIZE;
+
+        if (d != 0 && d != 1 && d != TEX_SIZE - 1) {
+            texel_errors++;
+        }
+    }
+
+    TEST_ASSERT("Covers the screen", columns == SCREEN_WIDTH);
+    TEST_ASSERT_EQUAL_INT(0, top_errors);
+    TEST_ASSERT_EQUAL_INT(0, texel_errors);
+}
+
+/* Test overlapping walls give the same image in either order */
+void test_wall_order(void) {
+    wall_t w[2];
+    long front_first, back_first;
+
+    setup(0);
+    make_wall(&w[0], -1.0f, 2.0f, 1.0f, 2.0f);
+    make_wall(&w[1], -3.0f, 4.0f, 3.0f, 4.0f);
+    front_first = wall_draw_list(&view, screen, w, 2);
+    memcpy(reference, screen, SCREEN_SIZE);
+
+    setup(0);
+    back_first = wall_draw(&view, screen, &w[1]);
+    back_first += wall_draw(&view, screen, &w[0]);
+
+    TEST_ASSERT("Same image", memcmp(screen, reference, SCREEN_SIZE) == 0);
+    TEST_ASSERT("Front to back draws less", front_first < back_first);
+    TEST_ASSERT_EQUAL_INT(60, view.top[160]);
+    TEST_ASSERT_EQUAL_INT(80, view.top[40]);
+}
+
+/* Test a wall running past the viewer is clipped at the near plane */
+void test_wall_near_clip(void) {
+    wall_t w;
+    long pixels;
+
+    /* A wall on the right, seen with its far end on the left */
+    setup(0);
+    make_wall(&w, 1.0f, 10.0f, 1.0f, -5.0f);
+    pixels = wall_draw(&view, screen, &w);
+
+    TEST_ASSERT("Drew the wall", pixels > 0);
+    TEST_ASSERT("Reaches the edge", view.depth[SCREEN_WIDTH - 1] > 0);
+    TEST_ASSERT("Left of the wall is empty", view.depth[160] == 0);
+    TEST_ASSERT("Taller when nearer", view.bottom[SCREEN_WIDTH - 1] - view.top[SCREEN_WIDTH - 1] >
+                                          view.bottom[200] - view.top[200]);
+}
+
+/* Project a view space point the way the wall renderer does */
+static void make_vertex(screen_vertex_t *sv, float x, float y, float z, float u, float v) {
+    memset(sv, 0, sizeof(*sv));
+    sv->x = fixed_from_float(160.0f + 160.0f * x / z);
+    sv->y = fixed_from_float(100.0f - 160.0f * y / z);
+    sv->inv_w = fixed_from_float(1.0f / z);
+    sv->u_over_w = fixed_from_float(u / z);
+    sv->v_over_w = fixed_from_float(v / z);
+}
+
+/* Measure wall fill rate against textured triangles, reported rather than asserted */
+void test_wall_benchmark(void) {
+    screen_vertex_t v[4];
+    wall_t w;
+    clock_t start, wall_ticks, tri_ticks;
+    long wall_pixels = 0, tri_pixels = 0;
+    int run;
+
+    setup(0);
+    make_wall(&w, -3.0f, 1.5f, 3.0f, 4.5f);
+
+    start = clock();
+
+    for (run = 0; run < BENCH_RUNS; run++) {
+        wall_view_clear(&view);
+        wall_pixels += wall_draw(&view, screen, &w);
+    }
+
+    wall_ticks = clock() - start;
+
+    /* The same wall through the general triangle path */
+    make_vertex(&v[0], -3.0f, 0.5f, 1.5f, 0.0f, 0.0f);
+    make_vertex(&v[1], 3.0f, 0.5f, 4.5f, 9.0f * TEX_SIZE, 0.0f);
+    make_vertex(&v[2], 3.0f, -0.5f, 4.5f, 9.0f * TEX_SIZE, TEX_SIZE);
+    make_vertex(&v[3], -3.0f, -0.5f, 1.5f, 0.0f, TEX_SIZE);
+
+    start = clock();
+
+    for (run = 0; run < BENCH_RUNS; run++) {
+        tri_pixels += texspan_polygon(screen, &tex, v, 4);
+    }
+
+    tri_ticks = clock() - start;
+
+    TEST_ASSERT("Wall pixels drawn", wall_pixels > 0);
+    TEST_ASSERT("Triangle pixels drawn", tri_pixels > 0);
+
+    if (wall_ticks > 0 && tri_ticks > 0) {
+        printf("\n  Wall columns %ld pixels per second, textured triangles %ld\n",
+               (long) ((double) wall_pixels * CLOCKS_PER_SEC / wall_ticks),
+               (long) ((double) tri_pixels * CLOCKS_PER_SEC / tri_ticks));
+    }
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run wall renderer tests */
+    test_begin_suite(&results, "Wall Columns");
+    test_run(&results, test_wall_view, "View Setup");
+    test_run(&results, test_wall_straight, "Straight Wall");
+    test_run(&results, test_wall_reference, "Ray Cast Reference");
+    test_run(&results, test_wall_order, "Draw Order");
+    test_run(&results, test_wall_near_clip, "Near Clipping");
+    test_run(&results, test_wall_benchmark, "Fill Rate");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+/*
+ * tzbuffer.c
+ *
+ * Test suite for the lazily cleared depth buffer
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "..\include\raster.h"
+#include "..\include\zbuffer.h"
+#include "tmath.h"
+
+#define SCENE_TRIS 40
+#define NEAR_DIST  (FIXED_ONE / 4)
+
+static unsigned short depth[SCREEN_SIZE];
+static unsigned char screen[SCREEN_SIZE];
+static unsigned char reference[SCREEN_SIZE];
+static zbuffer_t zb;
+static unsigned long seed;
+
+/* Small deterministic generator so runs are repeatable */
+static int next_random(int range) {
+    seed = seed * 1103515245UL + 12345UL;
+    return (int) ((seed >> 16) & 0x7FFF) % range;
+}
+
+/* Test 1/w is spread over the depth range */
+void test_zbuffer_values(void) {
+    zbuffer_init(&zb, depth, NEAR_DIST);
+    zbuffer_begin_frame(&zb);
+
+    TEST_ASSERT_EQUAL_INT(1, zbuffer_value(&zb, FIXED_ZERO));
+    TEST_ASSERT_EQUAL_INT(ZBUFFER_DEPTH_MAX + 1, zbuffer_value(&zb, 4 * FIXED_ONE));
+    TEST_ASSERT_EQUAL_INT(ZBUFFER_DEPTH_MAX + 1, zbuffer_value(&zb, 100 * FIXED_ONE));
+
+    /* Twice as far is half the value */
+    TEST_ASSERT_EQUAL_INT(ZBUFFER_DEPTH_MAX / 2 + 1, zbuffer_value(&zb, 2 * FIXED_ONE));
+}
+
+/* Test the three span routines */
+void test_zbuffer_spans(void) {
+    zbuffer_init(&zb, depth, NEAR_DIST);
+    zbuffer_begin_frame(&zb);
+    memset(screen, 0, SCREEN_SIZE);
+
+    TEST_ASSERT_EQUAL_INT(40, zbuffer_span_test_write(&zb, screen, 2, 10, 50, FIXED_ONE, 0, 1));
+
+    /* Test-only passes a nearer span everywhere and changes nothing */
+    TEST_ASSERT_EQUAL_INT(40, zbuffer_span_test(&zb, 2, 30, 70, 2 * FIXED_ONE, 0));
+    TEST_ASSERT_EQUAL_INT(0, screen[2 * SCREEN_WIDTH + 69]);
+
+    TEST_ASSERT_EQUAL_INT(20, zbuffer_span_test_write(&zb, screen, 2, 30, 70, FIXED_HALF, 0, 2));
+    TEST_ASSERT_EQUAL_INT(1, screen[2 * SCREEN_WIDTH + 49]);
+    TEST_ASSERT_EQUAL_INT(2, screen[2 * SCREEN_WIDTH + 50]);
+
+    /* Equal depth does not pass */
+    TEST_ASSERT_EQUAL_INT(0, zbuffer_span_test(&zb, 2, 10, 50, FIXED_ONE, 0));
+
+    /* Write-only stores a far depth over a near one */
+    zbuffer_span_write(&zb, 2, 10, 20, FIXED_ONE >> 4, 0);
+    TEST_ASSERT_EQUAL_INT(10, zbuffer_span_test(&zb, 2, 10, 50, FIXED_HALF, 0));
+
+    /* A sloped span stays inside the epoch even with its far end behind the eye */
+    TEST_ASSERT_EQUAL_INT(40, zbuffer_span_test_write(&zb, screen, 3, 0, 40, FIXED_ONE,
+                                                      -(FIXED_ONE / 8), 3));
+    TEST_ASSERT("Inside epoch", depth[3 * SCREEN_WIDTH + 39] >= zb.base + 1);
+    TEST_ASSERT("Decreasing", depth[3 * SCREEN_WIDTH + 39] < depth[3 * SCREEN_WIDTH]);
+}
+
+/* Test old frames are hidden without clearing and full clears are rare */
+void test_zbuffer_epochs(void) {
+    int frame;
+
+    zbuffer_init(&zb, depth, NEAR_DIST);
+
+    for (frame = 0; frame < 4 * ZBUFFER_EPOCHS; frame++) {
+        zbuffer_begin_frame(&zb);
+        memset(screen, 0, SCREEN_SIZE);
+
+        /* Nearest possible depth in one frame, farthest in the next */
+        TEST_ASSERT_EQUAL_INT(SCREEN_WIDTH,
+                              zbuffer_span_test_write(&zb, screen, 100, 0, SCREEN_WIDTH,
+                                                      (frame & 1) ? FIXED_ZERO : 4 * FIXED_ONE,
+                                                      0, 1));
+    }
+
+    TEST_ASSERT_EQUAL_INT(3, (int) zb.clears);
+    TEST_ASSERT_EQUAL_INT(ZBUFFER_EPOCHS - 1, zb.epoch);
+}
+
+/* Test a triangle scene matches painter's order */
+void test_zbuffer_scene(void) {
+    static screen_vertex_t v[SCENE_TRIS][3];
+    long written = 0;
+    int i, j;
+
+    memset(v, 0, sizeof(v));
+    seed = 7;
+
+    for (i = 0; i < SCENE_TRIS; i++) {
+        for (j = 0; j < 3; j++) {
+            v[i][j].x = fixed_from_int(next_random(SCREEN_WIDTH + 80) - 40) + next_random(256);
+            v[i][j].y = fixed_from_int(next_random(SCREEN_HEIGHT + 60) - 30) + next_random(256);
+            v[i][j].inv_w = FIXED_ONE / 16 + i * 97;
+        }
+    }
+
+    memset(reference, 0, SCREEN_SIZE);
+
+    for (i = 0; i < SCENE_TRIS; i++) {
+        raster_flat_triangle(reference, &v[i][0], &v[i][1], &v[i][2], (unsigned char) (i + 1));
+    }
+
+    /* Nearest first, so most pixels fail the depth test */
+    zbuffer_init(&zb, depth, NEAR_DIST);
+    zbuffer_begin_frame(&zb);
+    memset(screen, 0, SCREEN_SIZE);
+
+    for (i = SCENE_TRIS - 1; i >= 0; i--) {
+        written += zbuffer_draw_triangle(&zb, screen, &v[i][0], &v[i][1], &v[i][2],
+                                         (unsigned char) (i + 1));
+    }
+
+    TEST_ASSERT("Same image", memcmp(screen, reference, SCREEN_SIZE) == 0);
+
+    for (i = 0; i < SCREEN_SIZE; i++) {
+        written -= reference[i] != 0;
+    }
+
+    TEST_ASSERT_EQUAL_INT(0, (int) written);
+}
+
+int main(void) {
+    test_results_t results;
+
+    /* Initialize the test framework */
+    test_init(&results);
+
+    /* Run depth buffer tests */
+    test_begin_suite(&results, "Depth Buffer");
+    test_run(&results, test_zbuffer_values, "Depth Values");
+    test_run(&results, test_zbuffer_spans, "Span Routines");
+    test_run(&results, test_zbuffer_epochs, "Frame Epochs");
+    test_run(&results, test_zbuffer_scene, "Triangle Scene");
+    test_end_suite(&results);
+
+    /* Print final results */
+    test_print_results(&results);
+
+    return 0;
+}
@@ -0,0 +1,370 @@
+/*
+ * optmesh.c
+ *
+ * Offline mesh optimizer
+ * Reads a Wavefront OBJ mesh, welds, removes degenerates, reorders for
+ * vertex reuse and writes the result back out as OBJ
+ *
+ * Usage: optmesh input.obj output.obj [epsilon]
+ *
+ * Only v, vt, vn and f lines are read. Polygons are split into fans and
+ * every face corner becomes its own vertex, welding then shares them.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "..\include\fixed.h"
+#include "..\include\meshopt.h"
+#include "..\include\vertex.h"
+
+/* Loader limits */
+#define OPTMESH_MAX_VERTICES 65535 /* Largest index an unsigned short can hold */
+#define OPTMESH_MAX_CORNERS  32    /* Most corners read from one face */
+#define OPTMESH_LINE         256   /* Longest line read */
+
+/* Attribute arrays read from the OBJ file */
+typedef struct {
+    vector3_t *positions;
+    texcoord_t *texcoords;
+    vector3_t *normals;
+    int position_count;
+    int texcoord_count;
+    int normal_count;
+} obj_data_t;
+
+/*
+ * count_lines: Count OBJ lines of each kind to size the arrays
+ *
+ * Parameters:
+ *   file - Open input file, rewound afterwards
+ *   obj - Receives the v, vt and vn counts
+ *   corners - Receives the number of triangle corners after fan splitting
+ *
+ * Returns:
+ *   Most corners found on one face, the caller rejects files with faces
+ *   over OPTMESH_MAX_CORNERS before load_obj reads them
+ */
+static int count_lines(FILE *file, obj_data_t *obj, long *corners) {
+    char line[OPTMESH_LINE];
+    char *token;
+    int n, most = 0;
+
+    obj->position_count = 0;
+    obj->texcoord_count = 0;
+    obj->normal_count = 0;
+    *corners = 0;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        if (strncmp(line, "v ", 2) == 0) {
+            obj->position_count++;
+        } else if (strncmp(line, "vt ", 3) == 0) {
+            obj->texcoord_count++;
+        } else if (strncmp(line, "vn ", 3) == 0) {
+            obj->normal_count++;
+        } else if (strncmp(line, "f ", 2) == 0) {
+            n = 0;
+
+            for (token = strtok(line + 2, " \t\r\n"); token != NULL;
+                 token = strtok(NULL, " \t\r\n")) {
+                n++;
+            }
+
+            if (n >= 3) {
+                *corners += (n - 2) * 3L;
+            }
+
+            if (n > most) {
+                most = n;
+            }
+        }
+    }
+
+    rewind(file);
+
+    return most;
+}
+
+/*
+ * resolve_index: Turn a 1-based or negative OBJ index into a 0-based one
+ *
+ * Returns:
+ *   Array index, -1 if missing or out of range
+ */
+static int resolve_index(int index, int count) {
+    if (index < 0) {
+        index += count;
+    } else {
+        index--;
+    }
+
+    return (index >= 0 && index < count) ? index : -1;
+}
+
+/*
+ * parse_corner: Build a vertex from one "v/vt/vn" face corner
+ *
+ * Parameters:
+ *   token - Corner text
+ *   obj - Attribute arrays
+ *   v - Receives the vertex
+ *
+ * Returns:
+ *   1 on success, 0 if the position index is invalid
+ */
+static int parse_corner(const char *token, const obj_data_t *obj, vertex_t *v) {
+    int p = 0, t = 0, n = 0;
+    const char *slash;
+
+    p = resolve_index(atoi(token), obj->position_count);
+
+    if (p < 0) {
+        return 0;
+    }
+
+    *v = vertex_init_vec(obj->positions[p]);
+
+    slash = strchr(token, '/');
+
+    if (slash != NULL) {
+        if (slash[1] != '/') {
+            t = resolve_index(atoi(slash + 1), obj->texcoord_count);
+
+            if (t >= 0) {
+                vertex_set_texcoord(v, obj->texcoords[t]);
+            }
+        }
+
+        slash = strchr(slash + 1, '/');
+
+        if (slash != NULL) {
+            n = resolve_index(atoi(slash + 1), obj->normal_count);
+
+            if (n >= 0) {
+                vertex_set_normal(v, obj->normals[n]);
+            }
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * load_obj: Read an OBJ file into an unindexed mesh
+ *
+ * Parameters:
+ *   file - Open input file
+ *   obj - Attribute arrays, sized by count_lines
+ *   mesh - Mesh with vertex and index arrays sized by count_lines
+ *
+ * Returns:
+ *   1 on success, 0 on a face with a missing vertex or more than
+ *   OPTMESH_MAX_CORNERS corners
+ */
+static int load_obj(FILE *file, obj_data_t *obj, mesh_t *mesh) {
+    char line[OPTMESH_LINE];
+    char *corners[OPTMESH_MAX_CORNERS];
+    char *token;
+    float x, y, z;
+    int n, k, c;
+
+    obj->position_count = 0;
+    obj->texcoord_count = 0;
+    obj->normal_count = 0;
+    mesh->vertex_count = 0;
+    mesh->triangle_count = 0;
+
+    while (fgets(line, sizeof(line), file) != NULL) {
+        x = y = z = 0.0f;
+
+        if (strncmp(line, "v ", 2) == 0) {
+            sscanf(line + 2, "%f %f %f", &x, &y, &z);
+            obj->positions[obj->position_count++] =
+                vector3_init(fixed_from_float(x), fixed_from_float(y), fixed_from_float(z));
+        } else if (strncmp(line, "vt ", 3) == 0) {
+            sscanf(line + 3, "%f %f", &x, &y);
+            obj->texcoords[obj->texcoord_count].u = fixed_from_float(x);
+            obj->texcoords[obj->texcoord_count].v = fixed_from_float(y);
+            obj->texcoord_count++;
+        } else if (strncmp(line, "vn ", 3) == 0) {
+            sscanf(line + 3, "%f %f %f", &x, &y, &z);
+            obj->normals[obj->normal_count++] =
+                vector3_init(fixed_from_float(x), fixed_from_float(y), fixed_from_float(z));
+        } else if (strncmp(line, "f ", 2) == 0) {
+            n = 0;
+
+            for (token = strtok(line + 2, " \t\r\n"); token != NULL && n < OPTMESH_MAX_CORNERS;
+                 token = strtok(NULL, " \t\r\n")) {
+                corners[n++] = token;
+            }
+
+            /* count_lines sized the mesh for every corner, never drop any */
+            if (token != NULL) {
+                return 0;
+            }
+
+            /* Fan split, corner 0 is shared by every triangle */
+            for (k = 1; k + 1 < n; k++) {
+                if (!parse_corner(corners[0], obj, &mesh->vertices[mesh->vertex_count]) ||
+                    !parse_corner(corners[k], obj, &mesh->vertices[mesh->vertex_count + 1]) ||
+                    !parse_corner(corners[k + 1], obj, &mesh->vertices[mesh->vertex_count + 2])) {
+                    return 0;
+                }
+
+                for (c = 0; c < 3; c++) {
+                    mesh->indices[mesh->vertex_count] = (unsigned short) mesh->vertex_count;
+                    mesh->vertex_count++;
+                }
+
+                mesh->triangle_count++;
+            }
+        }
+    }
+
+    return 1;
+}
+
+/*
+ * save_obj: Write an indexed mesh as OBJ, one v, vt and vn per vertex
+ *
+ * Parameters:
+ *   file - Open output file
+ *   mesh - Mesh to write
+ */
+static void save_obj(FILE *file, const mesh_t *mesh) {
+    const vertex_t *v;
+    int i, t;
+
+    fprintf(file, "# optmesh: %d vertices, %d triangles\n", mesh->vertex_count,
+            mesh->triangle_count);
+
+    for (i = 0; i < mesh->vertex_count; i++) {
+        v = &mesh->vertices[i];
+        fprintf(file, "v %f %f %f\n", fixed_to_float(v->position.x),
+                fixed_to_float(v->position.y), fixed_to_float(v->position.z));
+        fprintf(file, "vt %f %f\n", fixed_to_float(v->texcoord.u),
+                fixed_to_float(v->texcoord.v));
+        fprintf(file, "vn %f %f %f\n", fixed_to_float(v->normal.x), fixed_to_float(v->normal.y),
+                fixed_to_float(v->normal.z));
+    }
+
+    for (t = 0; t < mesh->triangle_count; t++) {
+        fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d\n",
+                mesh->indices[t * 3] + 1, mesh->indices[t * 3] + 1, mesh->indices[t * 3] + 1,
+                mesh->indices[t * 3 + 1] + 1, mesh->indices[t * 3 + 1] + 1,
+                mesh->indices[t * 3 + 1] + 1, mesh->indices[t * 3 + 2] + 1,
+                mesh->indices[t * 3 + 2] + 1, mesh->indices[t * 3 + 2] + 1);
+    }
+}
+
+/*
+ * free_buffers: Release the attribute, mesh and scratch arrays
+ *
+ * Parameters:
+ *   obj - Attribute arrays, NULL entries are skipped
+ *   mesh - Mesh arrays, NULL entries are skipped
+ *   scratch - Optimizer work area, may be NULL
+ */
+static void free_buffers(obj_data_t *obj, mesh_t *mesh, long *scratch) {
+    free(scratch);
+    free(mesh->indices);
+    free(mesh->vertices);
+    free(obj->normals);
+    free(obj->texcoords);
+    free(obj->positions);
+}
+
+int main(int argc, char *argv[]) {
+    FILE *in, *out;
+    obj_data_t obj;
+    mesh_t mesh;
+    meshopt_stats_t stats;
+    fixed_t epsilon = MESHOPT_WELD_EPSILON;
+    long corners;
+    long *scratch;
+    int most;
+
+    if (argc < 3) {
+        printf("Usage: optmesh input.obj output.obj [epsilon]\n");
+        return 1;
+    }
+
+    if (argc > 3) {
+        epsilon = fixed_from_float((float) atof(argv[3]));
+    }
+
+    in = fopen(argv[1], "r");
+
+    if (in == NULL) {
+        printf("Cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    most = count_lines(in, &obj, &corners);
+
+    if (most > OPTMESH_MAX_CORNERS) {
+        printf("%s: face with %d corners, at most %d\n", argv[1], most, OPTMESH_MAX_CORNERS);
+        fclose(in);
+        return 1;
+    }
+
+    if (corners == 0 || corners > OPTMESH_MAX_VERTICES) {
+        printf("%s: %ld face corners, need 1 to %d\n", argv[1], corners, OPTMESH_MAX_VERTICES);
+        fclose(in);
+        return 1;
+    }
+
+    obj.positions = (vector3_t *) malloc((obj.position_count + 1) * sizeof(vector3_t));
+    obj.texcoords = (texcoord_t *) malloc((obj.texcoord_count + 1) * sizeof(texcoord_t));
+    obj.normals = (vector3_t *) malloc((obj.normal_count + 1) * sizeof(vector3_t));
+    mesh.vertices = (vertex_t *) malloc(corners * sizeof(vertex_t));
+    mesh.indices = (unsigned short *) malloc(corners * sizeof(unsigned short));
+    scratch = (long *) malloc(MESHOPT_SCRATCH(corners, corners / 3) * sizeof(long));
+
+    if (obj.positions == NULL || obj.texcoords == NULL || obj.normals == NULL ||
+        mesh.vertices == NULL || mesh.indices == NULL || scratch == NULL) {
+        printf("Out of memory\n");
+        free_buffers(&obj, &mesh, scratch);
+        fclose(in);
+        return 1;
+    }
+
+    if (!load_obj(in, &obj, &mesh)) {
+        printf("%s: face references a missing vertex\n", argv[1]);
+        free_buffers(&obj, &mesh, scratch);
+        fclose(in);
+        return 1;
+    }
+
+    fclose(in);
+
+    meshopt_optimize(&mesh, epsilon, scratch, &stats);
+
+    out = fopen(argv[2], "w");
+
+    if (out == NULL) {
+        printf("Cannot create %s\n", argv[2]);
+        free_buffers(&obj, &mesh, scratch);
+        return 1;
+    }
+
+    save_obj(out, &mesh);
+
+    if (ferror(out) | fclose(out)) {
+        printf("Cannot write %s\n", argv[2]);
+        free_buffers(&obj, &mesh, scratch);
+        return 1;
+    }
+
+    printf("%s\n", argv[1]);
+    printf("  Vertices:  %6d -> %6d\n", stats.vertices_before, stats.vertices_after);
+    printf("  Triangles: %6d -> %6d (%d degenerate)\n", stats.triangles_before,
+           stats.triangles_after, stats.triangles_before - stats.triangles_after);
+    printf("  ACMR:      %6.3f -> %6.3f\n", fixed_to_float(stats.acmr_before),
+           fixed_to_float(stats.acmr_after));
+
+    free_buffers(&obj, &mesh, scratch);
+
+    return 0;
+}